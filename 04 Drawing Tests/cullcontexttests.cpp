@@ -0,0 +1,192 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: cullcontexttests.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "testclass.h"
+#include "cullcontextclass.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <random>
+
+
+//////////////
+// TYPEDEFS //
+//////////////
+// Laid out like the kernel's instances.  The color carries the instance's index, so every copy
+// can be traced back to where it came from.
+struct TestInstanceType
+{
+    XMFLOAT3 position;
+    XMFLOAT3 hsv;
+};
+
+
+/////////////
+// GLOBALS //
+/////////////
+static const float g_instanceRadius = 1.5f;
+
+
+static FrustumCullerClass::FrustumType GetTestFrustum()
+{
+    const XMMATRIX viewProjection = XMMatrixMultiply(
+        XMMatrixTranslation(-1.0f, 2.0f, 4.0f),
+        XMMatrixPerspectiveFovLH(XM_PIDIV4, 4.0f / 3.0f, 0.5f, 30.0f));
+    return FrustumCullerClass::ExtractFrustum(viewProjection);
+}
+
+
+static std::vector<TestInstanceType> GetRandomInstances(UINT count, uint32_t seed)
+{
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> position(-15.0f, 15.0f);
+
+    std::vector<TestInstanceType> instances(count);
+    for (UINT i = 0u; i < count; ++i)
+    {
+        instances[i].position = XMFLOAT3(position(random), position(random), position(random) + 15.0f);
+        instances[i].hsv      = XMFLOAT3(static_cast<float>(i), 1.0f, 1.0f);
+    }
+    return instances;
+}
+
+
+static std::vector<UINT> CullOnCpu(WorkerPoolClass *workers, const FrustumCullerClass::FrustumType &frustum, const std::vector<TestInstanceType> &instances)
+{
+    FrustumCullerClass culler(workers);
+    FrustumCullerClass::BoundsType bounds;
+    bounds.Resize(instances.size());
+    for (size_t i = 0ull; i < instances.size(); ++i)
+    {
+        bounds.x[i]      = instances[i].position.x;
+        bounds.y[i]      = instances[i].position.y;
+        bounds.z[i]      = instances[i].position.z;
+        bounds.radius[i] = g_instanceRadius;
+    }
+
+    std::vector<UINT> survivors(instances.size());
+    survivors.resize(culler.Cull(frustum, bounds, survivors.data()));
+    return survivors;
+}
+
+
+static std::vector<UINT> GetIndices(const TestInstanceType *instances, UINT count)
+{
+    // Slots are claimed in whatever order the groups run, so compare the sets.
+    std::vector<UINT> indices;
+    for (UINT i = 0u; i < count; ++i)
+    {
+        indices.push_back(static_cast<UINT>(instances[i].hsv.x));
+    }
+    std::sort(indices.begin(), indices.end());
+    return indices;
+}
+
+
+TEST(CullReferenceMatchesCpuCuller)
+{
+    WorkerPoolClass workers(4u);
+    const FrustumCullerClass::FrustumType frustum   = GetTestFrustum();
+    const std::vector<TestInstanceType>   instances = GetRandomInstances(5'000u + 37u, 42u);
+
+    std::vector<TestInstanceType> visible(instances.size());
+    D3D12_DRAW_INDEXED_ARGUMENTS arguments = CullContextClass::PackDrawArguments(36u, 0u, 120u, 7);
+    CullContextClass::CullReference(&workers,
+                                    frustum,
+                                    g_instanceRadius,
+                                    static_cast<UINT>(instances.size()),
+                                    reinterpret_cast<const BYTE *>(instances.data()),
+                                    sizeof(TestInstanceType),
+                                    reinterpret_cast<BYTE *>(visible.data()),
+                                    &arguments);
+
+    // The kernel only adds to the instance count, and keeps the same instances as the CPU.
+    const std::vector<UINT> survivors = CullOnCpu(&workers, frustum, instances);
+    CHECK(!survivors.empty() && survivors.size() < instances.size());
+    CHECK(arguments.InstanceCount == survivors.size());
+    CHECK(arguments.IndexCountPerInstance == 36u);
+    CHECK(arguments.StartIndexLocation == 120u);
+    CHECK(arguments.BaseVertexLocation == 7);
+    CHECK(arguments.StartInstanceLocation == 0u);
+    CHECK(GetIndices(visible.data(), arguments.InstanceCount) == survivors);
+
+    // Every instance is copied over whole.
+    for (UINT i = 0u; i < arguments.InstanceCount; ++i)
+    {
+        const TestInstanceType &source = instances[static_cast<UINT>(visible[i].hsv.x)];
+        CHECK(memcmp(&source, &visible[i], sizeof(TestInstanceType)) == 0);
+    }
+}
+
+
+TEST(CullReferenceAppendsAfterExistingCount)
+{
+    WorkerPoolClass workers(4u);
+    const FrustumCullerClass::FrustumType frustum   = GetTestFrustum();
+    const std::vector<TestInstanceType>   instances = GetRandomInstances(1'000u, 7u);
+
+    // Whatever the count held already stays in front, untouched.
+    const UINT existingCount = 5u;
+    std::vector<TestInstanceType> visible(existingCount + instances.size());
+    for (UINT i = 0u; i < existingCount; ++i)
+    {
+        visible[i].hsv = XMFLOAT3(-1.0f, 0.0f, 0.0f);
+    }
+
+    D3D12_DRAW_INDEXED_ARGUMENTS arguments = CullContextClass::PackDrawArguments(6u, existingCount);
+    CullContextClass::CullReference(&workers,
+                                    frustum,
+                                    g_instanceRadius,
+                                    static_cast<UINT>(instances.size()),
+                                    reinterpret_cast<const BYTE *>(instances.data()),
+                                    sizeof(TestInstanceType),
+                                    reinterpret_cast<BYTE *>(visible.data()),
+                                    &arguments);
+
+    const std::vector<UINT> survivors = CullOnCpu(&workers, frustum, instances);
+    CHECK(arguments.InstanceCount == existingCount + survivors.size());
+    for (UINT i = 0u; i < existingCount; ++i)
+    {
+        CHECK(visible[i].hsv.x == -1.0f);
+    }
+    CHECK(GetIndices(visible.data() + existingCount, arguments.InstanceCount - existingCount) == survivors);
+}
+
+
+TEST(CullReferenceStopsAtInstanceCount)
+{
+    WorkerPoolClass workers(2u);
+    const FrustumCullerClass::FrustumType frustum = GetTestFrustum();
+
+    // Every instance sits in front of the camera, but only the first 65 are handed to the kernel,
+    // so the second group's other threads must leave the rest alone.
+    std::vector<TestInstanceType> instances(128u);
+    for (UINT i = 0u; i < instances.size(); ++i)
+    {
+        instances[i].position = XMFLOAT3(-1.0f, 2.0f, 6.0f);
+        instances[i].hsv      = XMFLOAT3(static_cast<float>(i), 1.0f, 1.0f);
+    }
+
+    std::vector<TestInstanceType> visible(instances.size());
+    D3D12_DRAW_INDEXED_ARGUMENTS arguments = CullContextClass::PackDrawArguments(6u);
+    CullContextClass::CullReference(&workers,
+                                    frustum,
+                                    g_instanceRadius,
+                                    65u,
+                                    reinterpret_cast<const BYTE *>(instances.data()),
+                                    sizeof(TestInstanceType),
+                                    reinterpret_cast<BYTE *>(visible.data()),
+                                    &arguments);
+
+    std::vector<UINT> expected(65u);
+    for (UINT i = 0u; i < expected.size(); ++i)
+    {
+        expected[i] = i;
+    }
+    CHECK(arguments.InstanceCount == 65u);
+    CHECK(GetIndices(visible.data(), arguments.InstanceCount) == expected);
+}
@@ -0,0 +1,169 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: frustumcullertests.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "testclass.h"
+#include "frustumcullerclass.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <random>
+
+
+/////////////
+// GLOBALS //
+/////////////
+// A box from -5 to 5 across and 0 to 10 deep.  Its planes are already normalized and every
+// distance to them is exact, so spheres can be made to touch them exactly.
+static const float g_boxPlanes[6][4] =
+{
+    {  1.0f,  0.0f,  0.0f, 5.0f },
+    { -1.0f,  0.0f,  0.0f, 5.0f },
+    {  0.0f,  1.0f,  0.0f, 5.0f },
+    {  0.0f, -1.0f,  0.0f, 5.0f },
+    {  0.0f,  0.0f,  1.0f, 0.0f },
+    {  0.0f,  0.0f, -1.0f, 10.0f },
+};
+
+
+static FrustumCullerClass::FrustumType GetBoxFrustum()
+{
+    FrustumCullerClass::FrustumType frustum;
+    for (UINT i = 0u; i < 6u; ++i)
+    {
+        frustum.planes[i] = XMVectorSet(g_boxPlanes[i][0], g_boxPlanes[i][1], g_boxPlanes[i][2], g_boxPlanes[i][3]);
+    }
+    return frustum;
+}
+
+
+static void AddSphere(FrustumCullerClass::BoundsType &bounds, float x, float y, float z, float radius)
+{
+    bounds.x.push_back(x);
+    bounds.y.push_back(y);
+    bounds.z.push_back(z);
+    bounds.radius.push_back(radius);
+}
+
+
+static std::vector<UINT> Cull(FrustumCullerClass &culler, const FrustumCullerClass::FrustumType &frustum, const FrustumCullerClass::BoundsType &bounds)
+{
+    std::vector<UINT> survivors(bounds.x.size());
+    survivors.resize(culler.Cull(frustum, bounds, survivors.data()));
+    return survivors;
+}
+
+
+static std::vector<UINT> CullOneByOne(FrustumCullerClass &culler, const FrustumCullerClass::FrustumType &frustum, const FrustumCullerClass::BoundsType &bounds)
+{
+    // A single sphere never fills a group of four, so this only ever takes the scalar path.
+    std::vector<UINT> survivors;
+    for (UINT i = 0u; i < bounds.x.size(); ++i)
+    {
+        FrustumCullerClass::BoundsType sphere;
+        AddSphere(sphere, bounds.x[i], bounds.y[i], bounds.z[i], bounds.radius[i]);
+        if (Cull(culler, frustum, sphere).size() == 1ull)
+        {
+            survivors.push_back(i);
+        }
+    }
+    return survivors;
+}
+
+
+static FrustumCullerClass::BoundsType GetRandomBounds(UINT count, uint32_t seed)
+{
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> position(-20.0f, 20.0f);
+    std::uniform_real_distribution<float> radius(0.0f, 4.0f);
+
+    FrustumCullerClass::BoundsType bounds;
+    for (UINT i = 0u; i < count; ++i)
+    {
+        AddSphere(bounds, position(random), position(random), position(random) + 10.0f, radius(random));
+    }
+    return bounds;
+}
+
+
+TEST(FrustumCullerGroupsMatchScalarPath)
+{
+    WorkerPoolClass workers(4u);
+    FrustumCullerClass culler(&workers);
+
+    // A perspective frustum, so the planes are not axis aligned, and spheres all around it.  An
+    // odd count puts the last few through the scalar path of the same call.
+    const XMMATRIX viewProjection = XMMatrixMultiply(
+        XMMatrixTranslation(1.0f, -2.0f, 3.0f),
+        XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, 0.5f, 40.0f));
+    const FrustumCullerClass::FrustumType frustum = FrustumCullerClass::ExtractFrustum(viewProjection);
+    const FrustumCullerClass::BoundsType  bounds  = GetRandomBounds(4'099u, 1234u);
+
+    const std::vector<UINT> grouped  = Cull(culler, frustum, bounds);
+    const std::vector<UINT> oneByOne = CullOneByOne(culler, frustum, bounds);
+    CHECK(!grouped.empty() && grouped.size() < bounds.x.size());
+    CHECK(grouped == oneByOne);
+}
+
+
+TEST(FrustumCullerKeepsTouchingSpheres)
+{
+    WorkerPoolClass workers(4u);
+    FrustumCullerClass culler(&workers);
+    const FrustumCullerClass::FrustumType frustum = GetBoxFrustum();
+
+    // Spheres that just touch each plane from outside are kept, and ones a little further out are
+    // not, in every lane of a group and in the scalar path alike.
+    FrustumCullerClass::BoundsType bounds;
+    std::vector<UINT> expected;
+    for (UINT i = 0u; i < 6u; ++i)
+    {
+        // Step outside the plane along its normal, which is exact for these planes.
+        const float outside[3] = { -g_boxPlanes[i][0] * 2.0f, -g_boxPlanes[i][1] * 2.0f, -g_boxPlanes[i][2] * 2.0f };
+        const float onPlane[3] =
+        {
+            (g_boxPlanes[i][0] != 0.0f) ? -g_boxPlanes[i][0] * g_boxPlanes[i][3] : 0.0f,
+            (g_boxPlanes[i][1] != 0.0f) ? -g_boxPlanes[i][1] * g_boxPlanes[i][3] : 0.0f,
+            (g_boxPlanes[i][2] != 0.0f) ? -g_boxPlanes[i][2] * g_boxPlanes[i][3] : 5.0f,
+        };
+
+        expected.push_back(static_cast<UINT>(bounds.x.size()));
+        AddSphere(bounds, onPlane[0] + outside[0], onPlane[1] + outside[1], onPlane[2] + outside[2], 2.0f);
+        AddSphere(bounds, onPlane[0] + outside[0], onPlane[1] + outside[1], onPlane[2] + outside[2], 1.5f);
+        expected.push_back(static_cast<UINT>(bounds.x.size()));
+        AddSphere(bounds, onPlane[0], onPlane[1], onPlane[2], 0.0f);
+    }
+    AddSphere(bounds, 0.0f, 0.0f, 5.0f, 0.0f);
+    expected.push_back(static_cast<UINT>(bounds.x.size()) - 1u);
+
+    CHECK(Cull(culler, frustum, bounds) == expected);
+    CHECK(CullOneByOne(culler, frustum, bounds) == expected);
+}
+
+
+TEST(FrustumCullerKeepsOrderAcrossChunks)
+{
+    WorkerPoolClass workers(4u);
+    FrustumCullerClass culler(&workers);
+    const FrustumCullerClass::FrustumType frustum = GetBoxFrustum();
+
+    // Enough spheres for several jobs, with every seventh one well outside, so each chunk has to
+    // move its survivors down to meet the previous one's.
+    const UINT count = 3u * 16'384u + 5u;
+    FrustumCullerClass::BoundsType bounds;
+    std::vector<UINT> expected;
+    for (UINT i = 0u; i < count; ++i)
+    {
+        const bool outside = (i % 7u) == 0u;
+        AddSphere(bounds, outside ? 100.0f : 0.0f, 0.0f, 5.0f, 1.0f);
+        if (!outside)
+        {
+            expected.push_back(i);
+        }
+    }
+
+    CHECK(Cull(culler, frustum, bounds) == expected);
+    CHECK(culler.GetTestedCount() == count);
+}
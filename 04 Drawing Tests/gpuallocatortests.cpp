@@ -0,0 +1,151 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: gpuallocatortests.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "testclass.h"
+#include "gpuallocatorclass.h"
+#include "uploadringclass.h"
+#include "nulldeviceclass.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+
+
+/////////////
+// GLOBALS //
+/////////////
+static const UINT64 g_blockSize  = 1024ull * 1024ull;
+static const UINT64 g_bufferSize = 64ull * 1024ull;
+
+
+static GpuAllocatorClass::AllocationType CreateGeometryBuffer(GpuAllocatorClass &allocator)
+{
+    return allocator.CreateBuffer(
+        GpuAllocatorClass::CategoryType::Geometry,
+        D3D12_HEAP_TYPE_DEFAULT,
+        g_bufferSize,
+        D3D12_RESOURCE_FLAG_NONE,
+        D3D12_RESOURCE_STATE_COMMON,
+        L"Test buffer"
+    );
+}
+
+
+TEST(GpuAllocatorWaitsForCopiesBeforeReusingMemory)
+{
+    ComPtr<ID3D12Device> device;
+    ComPtr<ID3D12Fence>  fence;
+    CHECK(SUCCEEDED(NullDeviceClass::CreateDevice(IID_PPV_ARGS(device.GetAddressOf()))));
+    CHECK(SUCCEEDED(device->CreateFence(0ull, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(fence.GetAddressOf()))));
+
+    UINT64 fenceValue = 0ull;
+    GpuAllocatorClass allocator(device.Get(), fence.Get(), fenceValue, 0ull, g_blockSize);
+    UploadRingClass uploader(&allocator, g_bufferSize);
+
+    // The ring's own buffer takes a heap, and the buffer we copy into another.
+    GpuAllocatorClass::AllocationType buffer = CreateGeometryBuffer(allocator);
+    const BYTE data[256] = {};
+    uploader.Upload(buffer.Get(), data, sizeof(data));
+    CHECK(allocator.GetStatistics().heapCount == 2u);
+
+    // Dropping the buffer while its copy has not even been submitted keeps its memory, however
+    // far the direct queue gets.
+    buffer = GpuAllocatorClass::AllocationType();
+    CHECK(SUCCEEDED(fence->Signal(++fenceValue)));
+    allocator.Collect();
+    CHECK(allocator.GetStatistics().heapCount == 2u);
+
+    // Once the copy is done, the memory and its heap go back.
+    uploader.Flush();
+    allocator.Collect();
+    CHECK(allocator.GetStatistics().heapCount == 1u);
+
+    // A buffer nothing copies into only waits for the direct queue.
+    buffer = CreateGeometryBuffer(allocator);
+    buffer = GpuAllocatorClass::AllocationType();
+    allocator.Collect();
+    CHECK(allocator.GetStatistics().heapCount == 2u);
+    CHECK(SUCCEEDED(fence->Signal(++fenceValue)));
+    allocator.Collect();
+    CHECK(allocator.GetStatistics().heapCount == 1u);
+}
+
+
+TEST(GpuAllocatorDefragmentMovesRelocatableBuffers)
+{
+    ComPtr<ID3D12Device> device;
+    ComPtr<ID3D12Fence>  fence;
+    CHECK(SUCCEEDED(NullDeviceClass::CreateDevice(IID_PPV_ARGS(device.GetAddressOf()))));
+    CHECK(SUCCEEDED(device->CreateFence(0ull, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(fence.GetAddressOf()))));
+
+    UINT64 fenceValue = 0ull;
+    GpuAllocatorClass allocator(device.Get(), fence.Get(), fenceValue, 0ull, g_blockSize);
+
+    // Fill one block, and start a second with two buffers.
+    const UINT bufferCount = static_cast<UINT>(g_blockSize / g_bufferSize) + 2u;
+    std::vector<GpuAllocatorClass::AllocationType> buffers;
+    for (UINT i = 0u; i < bufferCount; ++i)
+    {
+        buffers.push_back(CreateGeometryBuffer(allocator));
+    }
+    CHECK(allocator.GetStatistics().heapCount == 2u);
+
+    // Free two buffers in the full block, and let the GPU catch up with that.
+    std::vector<D3D12_GPU_VIRTUAL_ADDRESS> holes;
+    for (UINT i : { 3u, 7u })
+    {
+        holes.push_back(buffers[i]->GetGPUVirtualAddress());
+        buffers[i] = GpuAllocatorClass::AllocationType();
+    }
+    CHECK(SUCCEEDED(fence->Signal(++fenceValue)));
+
+    // The buffers in the second block follow wherever they are moved to.
+    std::vector<ID3D12Resource *> originals;
+    std::vector<ID3D12Resource *> relocated(2u, nullptr);
+    for (UINT i = 0u; i < 2u; ++i)
+    {
+        ID3D12Resource **moved = &relocated[i];
+        originals.push_back(buffers[bufferCount - 2u + i].Get());
+        buffers[bufferCount - 2u + i].SetRelocation([moved](ID3D12Resource *resource) { *moved = resource; });
+    }
+
+    const UINT frameIndex = 0u;
+    ResourceStateTrackerClass resourceStates;
+    CommandStreamClass stream;
+    PipelineClass pipeline(device.Get(), frameIndex, &resourceStates);
+    pipeline.Open();
+    pipeline.StartRecording(&stream);
+    CHECK(allocator.Defragment(&pipeline, ~0ull) == 2ull * g_bufferSize);
+    pipeline.StopRecording();
+    pipeline.Close();
+
+    // Both were copied into the holes, and their owners told about it.
+    const auto counts = stream.GetCommandCounts();
+    CHECK(counts[static_cast<size_t>(CommandStreamClass::CommandType::CopyBufferRegion)] == 2u);
+    for (UINT i = 0u; i < 2u; ++i)
+    {
+        ID3D12Resource *resource = buffers[bufferCount - 2u + i].Get();
+        CHECK(relocated[i] == resource);
+        CHECK(resource != originals[i]);
+        CHECK(std::find(holes.begin(), holes.end(), resource->GetGPUVirtualAddress()) != holes.end());
+    }
+    CHECK(relocated[0]->GetGPUVirtualAddress() != relocated[1]->GetGPUVirtualAddress());
+
+    // The copies still read the old buffers, so the second block stays until the GPU is done.
+    const GpuAllocatorClass::StatisticsType statistics = allocator.GetStatistics();
+    CHECK(statistics.categories[static_cast<size_t>(GpuAllocatorClass::CategoryType::Geometry)].usedBytes == g_blockSize);
+    CHECK(statistics.heapCount == 2u);
+    allocator.Collect();
+    CHECK(allocator.GetStatistics().heapCount == 2u);
+    CHECK(SUCCEEDED(fence->Signal(++fenceValue)));
+    allocator.Collect();
+    CHECK(allocator.GetStatistics().heapCount == 1u);
+
+    // With everything in one block, there is nothing left to move.
+    pipeline.Open();
+    CHECK(allocator.Defragment(&pipeline, ~0ull) == 0ull);
+    pipeline.Close();
+}
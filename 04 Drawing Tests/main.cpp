@@ -0,0 +1,12 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: main.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "testclass.h"
+
+
+int main(int argc, char **argv)
+{
+    // An optional argument runs only the tests whose names contain it.
+    return TestClass::RunAll(argc > 1 ? argv[1] : nullptr);
+}
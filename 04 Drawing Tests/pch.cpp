@@ -0,0 +1,4 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: pch.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
@@ -0,0 +1,309 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: pipelinecachetests.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "testclass.h"
+#include "pipelinecacheclass.h"
+#include "nulldeviceclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+static const BYTE g_vertexShader[] = { 0x44, 0x58, 0x42, 0x43, 0x01, 0x02, 0x03, 0x04 };
+static const BYTE g_pixelShader[]  = { 0x44, 0x58, 0x42, 0x43, 0x05, 0x06, 0x07, 0x08 };
+
+static const D3D12_INPUT_ELEMENT_DESC g_inputElements[] =
+{
+    { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+    { "COLOR", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+};
+
+static const D3D12_SO_DECLARATION_ENTRY g_streamOutput[] =
+{
+    { 0, "SV_POSITION", 0, 0, 4, 0 },
+    { 0, nullptr, 0, 0, 2, 0 },
+    { 0, "COLOR", 0, 0, 3, 0 },
+};
+
+static const UINT g_streamOutputStrides[] = { 36u };
+
+
+static D3D12_GRAPHICS_PIPELINE_STATE_DESC GetGraphicsDesc()
+{
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC desc{};
+    desc.VS                    = { g_vertexShader, sizeof(g_vertexShader) };
+    desc.PS                    = { g_pixelShader, sizeof(g_pixelShader) };
+    desc.SampleMask            = D3D12_DEFAULT_SAMPLE_MASK;
+    desc.InputLayout           = { g_inputElements, _countof(g_inputElements) };
+    desc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+    desc.NumRenderTargets      = 1u;
+    desc.RTVFormats[0]         = DXGI_FORMAT_R8G8B8A8_UNORM;
+    desc.DSVFormat             = DXGI_FORMAT_D32_FLOAT;
+    desc.SampleDesc.Count      = 1u;
+    return desc;
+}
+
+
+static D3D12_ROOT_SIGNATURE_DESC GetRootSignatureDesc(const D3D12_ROOT_PARAMETER *parameters, UINT parameterCount)
+{
+    D3D12_ROOT_SIGNATURE_DESC desc{};
+    desc.NumParameters = parameterCount;
+    desc.pParameters   = parameters;
+    desc.Flags         = D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT;
+    return desc;
+}
+
+
+static std::wstring GetCacheFilename(const wchar_t *name)
+{
+    // Start every test without a file from an earlier run.
+    const std::wstring filename = std::wstring(L"pipelinecachetests.") + name + L".bin";
+    DeleteFileW(filename.c_str());
+    return filename;
+}
+
+
+TEST(PipelineCacheHashesShadersByContents)
+{
+    // Copies of the same bytecode and semantic names hash the same as the originals.
+    std::vector<BYTE> vertexShader(std::begin(g_vertexShader), std::end(g_vertexShader));
+    std::string positionName = "POSITION";
+    D3D12_INPUT_ELEMENT_DESC elements[_countof(g_inputElements)];
+    memcpy(elements, g_inputElements, sizeof(elements));
+    elements[0].SemanticName = positionName.c_str();
+
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC copy = GetGraphicsDesc();
+    copy.VS          = { vertexShader.data(), vertexShader.size() };
+    copy.InputLayout = { elements, _countof(elements) };
+    CHECK(PipelineCacheClass::Hash(copy) == PipelineCacheClass::Hash(GetGraphicsDesc()));
+
+    // But a single changed byte does not.
+    vertexShader.back() ^= 1u;
+    CHECK(PipelineCacheClass::Hash(copy) != PipelineCacheClass::Hash(GetGraphicsDesc()));
+
+    // Neither does a cached blob, which is not part of what the state is.
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC cached = GetGraphicsDesc();
+    cached.CachedPSO = { g_pixelShader, sizeof(g_pixelShader) };
+    CHECK(PipelineCacheClass::Hash(cached) == PipelineCacheClass::Hash(GetGraphicsDesc()));
+}
+
+
+TEST(PipelineCacheHashesEverySetting)
+{
+    std::vector<uint64_t> hashes = { PipelineCacheClass::Hash(GetGraphicsDesc()) };
+
+    // Each of these describes a different state, so each has to get a hash of its own.
+    auto addChanged = [&hashes](const std::function<void(D3D12_GRAPHICS_PIPELINE_STATE_DESC &)> &change)
+    {
+        D3D12_GRAPHICS_PIPELINE_STATE_DESC desc = GetGraphicsDesc();
+        change(desc);
+        hashes.push_back(PipelineCacheClass::Hash(desc));
+    };
+    addChanged([](D3D12_GRAPHICS_PIPELINE_STATE_DESC &desc) { desc.PS = {}; });
+    addChanged([](D3D12_GRAPHICS_PIPELINE_STATE_DESC &desc) { desc.BlendState.RenderTarget[0].BlendEnable = TRUE; });
+    addChanged([](D3D12_GRAPHICS_PIPELINE_STATE_DESC &desc) { desc.SampleMask = 1u; });
+    addChanged([](D3D12_GRAPHICS_PIPELINE_STATE_DESC &desc) { desc.RasterizerState.CullMode = D3D12_CULL_MODE_BACK; });
+    addChanged([](D3D12_GRAPHICS_PIPELINE_STATE_DESC &desc) { desc.DepthStencilState.DepthEnable = TRUE; });
+    addChanged([](D3D12_GRAPHICS_PIPELINE_STATE_DESC &desc) { desc.InputLayout.NumElements = 1u; });
+    addChanged([](D3D12_GRAPHICS_PIPELINE_STATE_DESC &desc) { desc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_LINE; });
+    addChanged([](D3D12_GRAPHICS_PIPELINE_STATE_DESC &desc) { desc.RTVFormats[0] = DXGI_FORMAT_R16G16B16A16_FLOAT; });
+    addChanged([](D3D12_GRAPHICS_PIPELINE_STATE_DESC &desc) { desc.DSVFormat = DXGI_FORMAT_UNKNOWN; });
+
+    // Including everything about stream output.
+    addChanged([](D3D12_GRAPHICS_PIPELINE_STATE_DESC &desc) { desc.StreamOutput = { g_streamOutput, 1u, g_streamOutputStrides, 1u, 0u }; });
+    addChanged([](D3D12_GRAPHICS_PIPELINE_STATE_DESC &desc) { desc.StreamOutput = { g_streamOutput, 3u, g_streamOutputStrides, 1u, 0u }; });
+    addChanged([](D3D12_GRAPHICS_PIPELINE_STATE_DESC &desc) { desc.StreamOutput = { g_streamOutput + 2, 1u, g_streamOutputStrides, 1u, 0u }; });
+    addChanged([](D3D12_GRAPHICS_PIPELINE_STATE_DESC &desc) { desc.StreamOutput = { g_streamOutput, 1u, nullptr, 0u, 0u }; });
+    addChanged([](D3D12_GRAPHICS_PIPELINE_STATE_DESC &desc) { desc.StreamOutput = { g_streamOutput, 1u, g_streamOutputStrides, 1u, D3D12_SO_NO_RASTERIZED_STREAM }; });
+
+    for (size_t i = 0ull; i < hashes.size(); ++i)
+    {
+        for (size_t j = i + 1ull; j < hashes.size(); ++j)
+        {
+            CHECK(hashes[i] != hashes[j]);
+        }
+    }
+}
+
+
+TEST(PipelineCacheHashesStreamOutputByContents)
+{
+    // The names are compared by what they say, not where they are.
+    std::string positionName = "SV_POSITION";
+    D3D12_SO_DECLARATION_ENTRY entries[_countof(g_streamOutput)];
+    memcpy(entries, g_streamOutput, sizeof(entries));
+    entries[0].SemanticName = positionName.c_str();
+    const UINT strides[] = { g_streamOutputStrides[0] };
+
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC original = GetGraphicsDesc();
+    original.StreamOutput = { g_streamOutput, _countof(g_streamOutput), g_streamOutputStrides, 1u, 0u };
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC copy = GetGraphicsDesc();
+    copy.StreamOutput = { entries, _countof(entries), strides, 1u, 0u };
+    CHECK(PipelineCacheClass::Hash(copy) == PipelineCacheClass::Hash(original));
+
+    positionName[0] = 'X';
+    CHECK(PipelineCacheClass::Hash(copy) != PipelineCacheClass::Hash(original));
+}
+
+
+TEST(PipelineCacheHashesRootSignaturesByContents)
+{
+    D3D12_DESCRIPTOR_RANGE ranges[2]{};
+    ranges[0].RangeType      = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+    ranges[0].NumDescriptors = 4u;
+    ranges[1].RangeType      = D3D12_DESCRIPTOR_RANGE_TYPE_CBV;
+    ranges[1].NumDescriptors = 1u;
+    D3D12_DESCRIPTOR_RANGE rangesCopy[2];
+    memcpy(rangesCopy, ranges, sizeof(ranges));
+
+    D3D12_ROOT_PARAMETER parameters[2]{};
+    parameters[0].ParameterType                       = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+    parameters[0].DescriptorTable.NumDescriptorRanges = 2u;
+    parameters[0].DescriptorTable.pDescriptorRanges   = ranges;
+    parameters[1].ParameterType                       = D3D12_ROOT_PARAMETER_TYPE_CBV;
+    parameters[1].Descriptor.ShaderRegister           = 1u;
+    D3D12_ROOT_PARAMETER parametersCopy[2];
+    memcpy(parametersCopy, parameters, sizeof(parameters));
+    parametersCopy[0].DescriptorTable.pDescriptorRanges = rangesCopy;
+
+    // Tables are hashed by their ranges, wherever those are.
+    const uint64_t hash = PipelineCacheClass::Hash(GetRootSignatureDesc(parameters, 2u));
+    CHECK(PipelineCacheClass::Hash(GetRootSignatureDesc(parametersCopy, 2u)) == hash);
+
+    rangesCopy[1].NumDescriptors = 2u;
+    CHECK(PipelineCacheClass::Hash(GetRootSignatureDesc(parametersCopy, 2u)) != hash);
+    CHECK(PipelineCacheClass::Hash(GetRootSignatureDesc(parameters, 1u)) != hash);
+
+    // And compute states by their shader.
+    D3D12_COMPUTE_PIPELINE_STATE_DESC compute{};
+    compute.CS = { g_vertexShader, sizeof(g_vertexShader) };
+    const uint64_t computeHash = PipelineCacheClass::Hash(compute);
+    compute.CS = { g_pixelShader, sizeof(g_pixelShader) };
+    CHECK(PipelineCacheClass::Hash(compute) != computeHash);
+}
+
+
+TEST(PipelineCacheSerializeRoundTrips)
+{
+    ComPtr<ID3D12Device> device;
+    CHECK(SUCCEEDED(NullDeviceClass::CreateDevice(IID_PPV_ARGS(device.GetAddressOf()))));
+
+    // Root signatures are serialized on a miss, so creating a few fills the cache.
+    D3D12_ROOT_PARAMETER parameters[3]{};
+    for (UINT i = 0u; i < _countof(parameters); ++i)
+    {
+        parameters[i].ParameterType             = D3D12_ROOT_PARAMETER_TYPE_CBV;
+        parameters[i].Descriptor.ShaderRegister = i;
+    }
+
+    PipelineCacheClass cache(GetCacheFilename(L"source"));
+    const size_t emptySize = cache.Serialize().size();
+    for (UINT count = 1u; count <= _countof(parameters); ++count)
+    {
+        CHECK(cache.GetRootSignature(device.Get(), GetRootSignatureDesc(parameters, count)));
+    }
+    const std::vector<BYTE> data = cache.Serialize();
+    CHECK(data.size() > emptySize);
+
+    // Another cache reads it back to the same size.  The entries come out in whatever order the
+    // map holds them, so the bytes themselves are only compared for single entries below.
+    PipelineCacheClass copy(GetCacheFilename(L"copy"));
+    CHECK(copy.Deserialize(data.data(), data.size()));
+    CHECK(copy.Serialize().size() == data.size());
+
+    // The loaded blobs are found by the same hashes, so asking again adds nothing, while a
+    // description it has not seen still does.
+    for (UINT count = 1u; count <= _countof(parameters); ++count)
+    {
+        CHECK(copy.GetRootSignature(device.Get(), GetRootSignatureDesc(parameters, count)));
+    }
+    CHECK(copy.Serialize().size() == data.size());
+    CHECK(copy.GetRootSignature(device.Get(), GetRootSignatureDesc(nullptr, 0u)));
+    CHECK(copy.Serialize().size() > data.size());
+}
+
+
+TEST(PipelineCacheDeserializeRejectsDamagedFiles)
+{
+    ComPtr<ID3D12Device> device;
+    CHECK(SUCCEEDED(NullDeviceClass::CreateDevice(IID_PPV_ARGS(device.GetAddressOf()))));
+
+    D3D12_ROOT_PARAMETER parameter{};
+    parameter.ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;
+    PipelineCacheClass cache(GetCacheFilename(L"damaged"));
+    CHECK(cache.GetRootSignature(device.Get(), GetRootSignatureDesc(&parameter, 1u)));
+    const std::vector<BYTE> data = cache.Serialize();
+
+    // Every truncation fails, and leaves what the cache held alone.
+    PipelineCacheClass target(GetCacheFilename(L"target"));
+    CHECK(target.Deserialize(data.data(), data.size()));
+    for (size_t size = 0ull; size < data.size(); ++size)
+    {
+        CHECK(!target.Deserialize(data.data(), size));
+    }
+    CHECK(target.Serialize() == data);
+
+    // So does a file with another magic number or version.
+    std::vector<BYTE> damaged = data;
+    damaged[0] ^= 0xFFu;
+    CHECK(!target.Deserialize(damaged.data(), damaged.size()));
+    damaged = data;
+    damaged[4] ^= 0xFFu;
+    CHECK(!target.Deserialize(damaged.data(), damaged.size()));
+    CHECK(target.Serialize() == data);
+}
+
+
+TEST(PipelineCacheKeepsBlobKindsApart)
+{
+    ComPtr<ID3D12Device> device;
+    CHECK(SUCCEEDED(NullDeviceClass::CreateDevice(IID_PPV_ARGS(device.GetAddressOf()))));
+
+    D3D12_ROOT_PARAMETER parameter{};
+    parameter.ParameterType = D3D12_ROOT_PARAMETER_TYPE_UAV;
+    PipelineCacheClass cache(GetCacheFilename(L"kinds"));
+    CHECK(cache.GetRootSignature(device.Get(), GetRootSignatureDesc(&parameter, 1u)));
+    const std::vector<BYTE> data = cache.Serialize();
+
+    // Relabel the only entry as a pipeline state blob.  It keeps the root signature's hash, but a
+    // root signature lookup must not find it, so the signature is serialized and stored again.
+    // The kind follows the 16-byte file header and the entry's hash and size.
+    const size_t fileHeaderSize = 16ull;
+    const size_t kindOffset     = fileHeaderSize + 16ull;
+    std::vector<BYTE> relabeled = data;
+    relabeled[kindOffset] = 1u;
+    PipelineCacheClass target(GetCacheFilename(L"relabeled"));
+    CHECK(target.Deserialize(relabeled.data(), relabeled.size()));
+    CHECK(target.Serialize().size() == data.size());
+    CHECK(target.GetRootSignature(device.Get(), GetRootSignatureDesc(&parameter, 1u)));
+    CHECK(target.Serialize().size() == data.size() + (data.size() - fileHeaderSize));
+
+    // And a kind it does not know makes the whole file unreadable.
+    relabeled[kindOffset] = 2u;
+    CHECK(!target.Deserialize(relabeled.data(), relabeled.size()));
+}
+
+
+TEST(PipelineCacheSavesAndLoads)
+{
+    ComPtr<ID3D12Device> device;
+    CHECK(SUCCEEDED(NullDeviceClass::CreateDevice(IID_PPV_ARGS(device.GetAddressOf()))));
+
+    D3D12_ROOT_PARAMETER parameter{};
+    parameter.ParameterType = D3D12_ROOT_PARAMETER_TYPE_SRV;
+    const std::wstring filename = GetCacheFilename(L"file");
+
+    std::vector<BYTE> data;
+    {
+        PipelineCacheClass cache(filename);
+        CHECK(cache.GetRootSignature(device.Get(), GetRootSignatureDesc(&parameter, 1u)));
+        cache.Save();
+        data = cache.Serialize();
+    }
+
+    // The next run picks up the file on its own.
+    PipelineCacheClass cache(filename);
+    CHECK(cache.Serialize() == data);
+    DeleteFileW(filename.c_str());
+}
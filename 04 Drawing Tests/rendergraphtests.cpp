@@ -0,0 +1,496 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: rendergraphtests.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "testclass.h"
+#include "rendergraphclass.h"
+#include "nulldeviceclass.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <random>
+
+
+//////////////
+// TYPEDEFS //
+//////////////
+using BarrierListType = std::vector<D3D12_RESOURCE_BARRIER>;
+
+// A resource a pass uses, and the state the pass expects to find it in.
+struct CheckedUseType
+{
+    UINT                  resource = 0u;
+    D3D12_RESOURCE_STATES state    = D3D12_RESOURCE_STATE_COMMON;
+};
+
+
+static UINT CreateTexture(RenderGraphClass &graph, ID3D12Device *device, UINT width, bool depth, D3D12_RESOURCE_FLAGS flags = D3D12_RESOURCE_FLAG_NONE)
+{
+    D3D12_RESOURCE_DESC desc{};
+    desc.Dimension        = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+    desc.Width            = width;
+    desc.Height           = 256u;
+    desc.DepthOrArraySize = 1;
+    desc.MipLevels        = 1;
+    desc.Format           = depth ? DXGI_FORMAT_D32_FLOAT : DXGI_FORMAT_R8G8B8A8_UNORM;
+    desc.SampleDesc.Count = 1;
+    desc.Flags            = flags | (depth ? D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL : D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET);
+    return graph.CreateTexture("Texture", desc, device->GetResourceAllocationInfo(0, 1, &desc));
+}
+
+
+static ComPtr<ID3D12Resource> CreateBuffer(ID3D12Device *device)
+{
+    D3D12_HEAP_PROPERTIES heapProperties{};
+    heapProperties.Type = D3D12_HEAP_TYPE_DEFAULT;
+
+    D3D12_RESOURCE_DESC desc{};
+    desc.Dimension        = D3D12_RESOURCE_DIMENSION_BUFFER;
+    desc.Width            = 256u;
+    desc.Height           = 1u;
+    desc.DepthOrArraySize = 1;
+    desc.MipLevels        = 1;
+    desc.SampleDesc.Count = 1;
+    desc.Layout           = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+    ComPtr<ID3D12Resource> buffer;
+    CHECK(SUCCEEDED(device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(buffer.GetAddressOf()))));
+    return buffer;
+}
+
+
+static UINT AddRecordingPass(RenderGraphClass &graph, BarrierListType *barriers)
+{
+    // The pass keeps the barriers queued for it, which would otherwise go out with its first command.
+    // The graph cannot see that, so it is never culled.
+    return graph.AddPass("Pass", [barriers](PipelineClass *pipeline)
+    {
+        ResourceStateTrackerClass *resourceStates = pipeline->GetResourceStates();
+        barriers->assign(resourceStates->GetBarriers(), resourceStates->GetBarriers() + resourceStates->GetBarrierCount());
+        pipeline->FlushBarriers();
+    }, true);
+}
+
+
+static UINT AddCheckingPass(RenderGraphClass &graph, const std::vector<CheckedUseType> &uses, UINT *mistakes)
+{
+    // The pass counts every resource that is not already in the state it uses it in.  Once the
+    // barriers the graph queued have gone out, moving it there again only queues another barrier
+    // when it was somewhere else.
+    return graph.AddPass("Pass", [&graph, uses, mistakes](PipelineClass *pipeline)
+    {
+        pipeline->FlushBarriers();
+        for (const CheckedUseType &use : uses)
+        {
+            pipeline->Transition(graph.GetResource(use.resource), use.state);
+            *mistakes += pipeline->GetResourceStates()->GetBarrierCount();
+            pipeline->GetResourceStates()->ClearBarriers();
+        }
+    }, true);
+}
+
+
+static UINT GetPosition(const std::vector<UINT> &schedule, UINT pass)
+{
+    const auto found = std::find(schedule.begin(), schedule.end(), pass);
+    CHECK(found != schedule.end());
+    return static_cast<UINT>(found - schedule.begin());
+}
+
+
+static bool Touches(const BarrierListType &barriers, ID3D12Resource *resource)
+{
+    return std::any_of(barriers.begin(), barriers.end(), [resource](const D3D12_RESOURCE_BARRIER &barrier)
+    {
+        return barrier.Type == D3D12_RESOURCE_BARRIER_TYPE_TRANSITION && barrier.Transition.pResource == resource;
+    });
+}
+
+
+TEST(RenderGraphCullsPassesNothingReads)
+{
+    ComPtr<ID3D12Device> device;
+    CHECK(SUCCEEDED(NullDeviceClass::CreateDevice(IID_PPV_ARGS(device.GetAddressOf()))));
+
+    RenderGraphClass graph;
+    const UINT backBuffer = graph.ImportResource("Back buffer", D3D12_RESOURCE_STATE_PRESENT);
+    const UINT used       = CreateTexture(graph, device.Get(), 256u, false);
+    const UINT unread     = CreateTexture(graph, device.Get(), 256u, false);
+    const UINT chained    = CreateTexture(graph, device.Get(), 256u, false);
+    const UINT chainEnd   = CreateTexture(graph, device.Get(), 256u, false);
+
+    // Only the passes leading up to the back buffer, and the one with side effects, are needed.
+    // The chain ending in a texture nobody reads goes as a whole.
+    const UINT draw      = graph.AddPass("Draw", [](PipelineClass *) {});
+    const UINT wasted    = graph.AddPass("Wasted", [](PipelineClass *) {});
+    const UINT chainHead = graph.AddPass("Chain head", [](PipelineClass *) {});
+    const UINT chainTail = graph.AddPass("Chain tail", [](PipelineClass *) {});
+    const UINT compose   = graph.AddPass("Compose", [](PipelineClass *) {});
+    const UINT upload    = graph.AddPass("Upload", [](PipelineClass *) {}, true);
+    graph.Write(draw, used, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    graph.Write(wasted, unread, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    graph.Write(chainHead, chained, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    graph.Read(chainTail, chained, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    graph.Write(chainTail, chainEnd, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    graph.Read(compose, used, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    graph.Write(compose, backBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    graph.Compile();
+
+    CHECK(graph.GetSchedule() == std::vector<UINT>({ draw, compose, upload }));
+    CHECK(graph.GetStatistics().passCount == 6u);
+    CHECK(graph.GetStatistics().culledCount == 3u);
+
+    // The textures only culled passes used need no memory.
+    CHECK(graph.GetStatistics().transientCount == 1u);
+}
+
+
+TEST(RenderGraphSchedulesDependenciesFirst)
+{
+    ComPtr<ID3D12Device> device;
+    CHECK(SUCCEEDED(NullDeviceClass::CreateDevice(IID_PPV_ARGS(device.GetAddressOf()))));
+
+    // Random passes over a handful of textures.  They all have side effects, so none are culled.
+    std::mt19937 generator(5u);
+    std::uniform_int_distribution<UINT> picks(0u, 7u);
+
+    RenderGraphClass graph;
+    std::vector<UINT> textures;
+    for (UINT i = 0u; i < 8u; ++i)
+    {
+        textures.push_back(CreateTexture(graph, device.Get(), 256u, false));
+    }
+
+    struct DeclaredUseType
+    {
+        UINT pass     = 0u;
+        UINT resource = 0u;
+        bool write    = false;
+    };
+    std::vector<DeclaredUseType> uses;
+    for (UINT pass = 0u; pass < 64u; ++pass)
+    {
+        graph.AddPass("Pass", [](PipelineClass *) {}, true);
+
+        DeclaredUseType read;
+        read.pass     = pass;
+        read.resource = textures[picks(generator)];
+        graph.Read(pass, read.resource, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+
+        DeclaredUseType write;
+        write.pass     = pass;
+        write.resource = textures[picks(generator)];
+        write.write    = true;
+        if (write.resource != read.resource)
+        {
+            uses.push_back(read);
+        }
+        if (picks(generator) < 4u)
+        {
+            graph.Write(pass, write.resource, D3D12_RESOURCE_STATE_RENDER_TARGET);
+            uses.push_back(write);
+        }
+        else if (write.resource == read.resource)
+        {
+            uses.push_back(read);
+        }
+    }
+    graph.Compile();
+
+    // Every pass runs once, after each earlier pass that wrote what it uses or read what it writes.
+    const std::vector<UINT> &schedule = graph.GetSchedule();
+    CHECK(schedule.size() == 64u);
+    for (const DeclaredUseType &later : uses)
+    {
+        for (const DeclaredUseType &earlier : uses)
+        {
+            if (earlier.pass < later.pass && earlier.resource == later.resource && (earlier.write || later.write))
+            {
+                CHECK(GetPosition(schedule, earlier.pass) < GetPosition(schedule, later.pass));
+            }
+        }
+    }
+}
+
+
+TEST(RenderGraphRunsReadersOfRecentWritesFirst)
+{
+    ComPtr<ID3D12Device> device;
+    CHECK(SUCCEEDED(NullDeviceClass::CreateDevice(IID_PPV_ARGS(device.GetAddressOf()))));
+
+    // Two independent chains.  Once the first texture is written, its reader runs before the
+    // second chain starts, so the first texture dies sooner.
+    RenderGraphClass graph;
+    const UINT backBuffer = graph.ImportResource("Back buffer", D3D12_RESOURCE_STATE_PRESENT);
+    const UINT first      = CreateTexture(graph, device.Get(), 256u, false);
+    const UINT second     = CreateTexture(graph, device.Get(), 256u, false);
+
+    const UINT writeFirst  = graph.AddPass("Write first", [](PipelineClass *) {});
+    const UINT writeSecond = graph.AddPass("Write second", [](PipelineClass *) {});
+    const UINT readFirst   = graph.AddPass("Read first", [](PipelineClass *) {});
+    const UINT readSecond  = graph.AddPass("Read second", [](PipelineClass *) {});
+    graph.Write(writeFirst, first, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    graph.Write(writeSecond, second, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    graph.Read(readFirst, first, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    graph.Read(readSecond, second, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    graph.Write(readFirst, backBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    graph.Write(readSecond, backBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    graph.Compile();
+
+    CHECK(graph.GetSchedule() == std::vector<UINT>({ writeFirst, readFirst, writeSecond, readSecond }));
+}
+
+
+TEST(RenderGraphPlansBarriersForStateChangesOnly)
+{
+    ComPtr<ID3D12Device> device;
+    CHECK(SUCCEEDED(NullDeviceClass::CreateDevice(IID_PPV_ARGS(device.GetAddressOf()))));
+    ComPtr<ID3D12Resource> buffer = CreateBuffer(device.Get());
+
+    // One pass writes the buffer, the next two read it in different states, and the last writes
+    // it again.
+    RenderGraphClass graph;
+    const UINT resource = graph.ImportResource("Buffer", D3D12_RESOURCE_STATE_COMMON);
+    graph.SetResource(resource, buffer.Get());
+
+    std::vector<BarrierListType> barriers(4u);
+    std::vector<UINT> passes;
+    for (BarrierListType &passBarriers : barriers)
+    {
+        passes.push_back(AddRecordingPass(graph, &passBarriers));
+    }
+    graph.Write(passes[0], resource, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+    graph.Read(passes[1], resource, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+    graph.Read(passes[2], resource, D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT);
+    graph.Write(passes[3], resource, D3D12_RESOURCE_STATE_COPY_DEST);
+    graph.Compile();
+    CHECK(graph.GetStatistics().barrierCount == 3u);
+
+    const UINT frameIndex = 0u;
+    ResourceStateTrackerClass resourceStates;
+    PipelineClass pipeline(device.Get(), frameIndex, &resourceStates);
+    pipeline.Open();
+    graph.Execute(&pipeline);
+    pipeline.Close();
+
+    // The two reads share one barrier into both their states.
+    const D3D12_RESOURCE_STATES readStates = static_cast<D3D12_RESOURCE_STATES>(D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT);
+    CHECK(barriers[0].size() == 1u);
+    CHECK(barriers[0][0].Transition.StateBefore == D3D12_RESOURCE_STATE_COMMON);
+    CHECK(barriers[0][0].Transition.StateAfter == D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+    CHECK(barriers[1].size() == 1u);
+    CHECK(barriers[1][0].Transition.StateBefore == D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+    CHECK(barriers[1][0].Transition.StateAfter == readStates);
+    CHECK(barriers[2].empty());
+    CHECK(barriers[3].size() == 1u);
+    CHECK(barriers[3][0].Transition.StateBefore == readStates);
+    CHECK(barriers[3][0].Transition.StateAfter == D3D12_RESOURCE_STATE_COPY_DEST);
+}
+
+
+TEST(RenderGraphPlacesLiveTransientsApart)
+{
+    ComPtr<ID3D12Device> device;
+    CHECK(SUCCEEDED(NullDeviceClass::CreateDevice(IID_PPV_ARGS(device.GetAddressOf()))));
+
+    // A chain of passes, each writing a texture of a random size and reading a couple of recent ones.
+    std::mt19937 generator(9u);
+    std::uniform_int_distribution<UINT> widths(1u, 16u);
+    std::uniform_int_distribution<UINT> lookbacks(1u, 6u);
+
+    RenderGraphClass graph;
+    const UINT backBuffer = graph.ImportResource("Back buffer", D3D12_RESOURCE_STATE_PRESENT);
+    std::vector<UINT> textures;
+    std::vector<std::vector<UINT>> users;
+    for (UINT pass = 0u; pass < 48u; ++pass)
+    {
+        graph.AddPass("Pass", [](PipelineClass *) {});
+        for (UINT read = 0u; read < 2u && !textures.empty(); ++read)
+        {
+            const size_t lookback = lookbacks(generator);
+            const size_t texture  = textures.size() > lookback ? textures.size() - lookback : 0u;
+            graph.Read(pass, textures[texture], D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+            users[texture].push_back(pass);
+        }
+
+        const bool depth = pass % 3u == 0u;
+        textures.push_back(CreateTexture(graph, device.Get(), widths(generator) * 64u, depth));
+        users.push_back({ pass });
+        graph.Write(pass, textures.back(), depth ? D3D12_RESOURCE_STATE_DEPTH_WRITE : D3D12_RESOURCE_STATE_RENDER_TARGET);
+        graph.Write(pass, backBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    }
+    graph.Compile();
+
+    // Work out where in the schedule each texture lives, and how much room the one placed for it takes.
+    const std::vector<UINT> &schedule = graph.GetSchedule();
+    std::vector<UINT> firstUses(textures.size(), ~0u);
+    std::vector<UINT> lastUses(textures.size(), 0u);
+    std::vector<D3D12_RESOURCE_ALLOCATION_INFO> allocations;
+    UINT64 totalBytes = 0ull;
+    ResourceStateTrackerClass resourceStates;
+    graph.Realize(device.Get(), &resourceStates);
+    for (size_t i = 0; i < textures.size(); ++i)
+    {
+        for (UINT pass : users[i])
+        {
+            const UINT position = GetPosition(schedule, pass);
+            firstUses[i] = position < firstUses[i] ? position : firstUses[i];
+            lastUses[i]  = position > lastUses[i] ? position : lastUses[i];
+        }
+
+        const D3D12_RESOURCE_DESC desc = graph.GetResource(textures[i])->GetDesc();
+        allocations.push_back(device->GetResourceAllocationInfo(0, 1, &desc));
+        totalBytes += allocations.back().SizeInBytes;
+    }
+
+    // Every texture sits aligned inside the heap.
+    const RenderGraphClass::StatisticsType statistics = graph.GetStatistics();
+    for (size_t i = 0; i < textures.size(); ++i)
+    {
+        CHECK(graph.GetHeapOffset(textures[i]) % allocations[i].Alignment == 0ull);
+        CHECK(graph.GetHeapOffset(textures[i]) + allocations[i].SizeInBytes <= statistics.heapBytes);
+    }
+
+    // Textures alive at the same time never share memory, while some of the others do.
+    bool shared = false;
+    for (size_t a = 0; a < textures.size(); ++a)
+    {
+        for (size_t b = a + 1; b < textures.size(); ++b)
+        {
+            const UINT64 offsetA = graph.GetHeapOffset(textures[a]);
+            const UINT64 offsetB = graph.GetHeapOffset(textures[b]);
+            const bool   overlap = offsetA < offsetB + allocations[b].SizeInBytes && offsetB < offsetA + allocations[a].SizeInBytes;
+            const bool   live    = firstUses[a] <= lastUses[b] && firstUses[b] <= lastUses[a];
+            CHECK(!(overlap && live));
+            shared = shared || overlap;
+        }
+    }
+    CHECK(shared);
+    CHECK(statistics.transientCount == textures.size());
+    CHECK(statistics.transientBytes == totalBytes);
+    CHECK(statistics.heapBytes < totalBytes);
+}
+
+
+TEST(RenderGraphDiscardsAliasedTransients)
+{
+    ComPtr<ID3D12Device> device;
+    CHECK(SUCCEEDED(NullDeviceClass::CreateDevice(IID_PPV_ARGS(device.GetAddressOf()))));
+    ComPtr<ID3D12Resource> buffer = CreateBuffer(device.Get());
+
+    // A depth stencil and a render target that are never alive at the same time share their
+    // memory, while a third texture outlives both and gets memory of its own.
+    RenderGraphClass graph;
+    const UINT output = graph.ImportResource("Output", D3D12_RESOURCE_STATE_COMMON);
+    graph.SetResource(output, buffer.Get());
+    const UINT depth  = CreateTexture(graph, device.Get(), 512u, true);
+    const UINT color  = CreateTexture(graph, device.Get(), 512u, false);
+    const UINT keeper = CreateTexture(graph, device.Get(), 256u, false);
+
+    std::vector<BarrierListType> barriers(3u);
+    std::vector<UINT> passes;
+    for (BarrierListType &passBarriers : barriers)
+    {
+        passes.push_back(AddRecordingPass(graph, &passBarriers));
+    }
+    graph.Write(passes[0], depth, D3D12_RESOURCE_STATE_DEPTH_WRITE);
+    graph.Write(passes[0], keeper, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    graph.Read(passes[1], depth, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    graph.Write(passes[1], output, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+    graph.Write(passes[2], color, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    graph.Read(passes[2], keeper, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    graph.Write(passes[2], output, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+    graph.Compile();
+    CHECK(graph.GetHeapOffset(depth) == graph.GetHeapOffset(color));
+    CHECK(graph.GetHeapOffset(keeper) != graph.GetHeapOffset(depth));
+
+    ResourceStateTrackerClass resourceStates;
+    graph.Realize(device.Get(), &resourceStates);
+
+    // The first frame discards every texture just placed, and the frames after it only the two
+    // sharing memory.
+    const UINT frameIndex = 0u;
+    const size_t discards = static_cast<size_t>(CommandStreamClass::CommandType::DiscardResource);
+    CommandStreamClass stream;
+    PipelineClass pipeline(device.Get(), frameIndex, &resourceStates);
+    for (UINT frame = 0u; frame < 2u; ++frame)
+    {
+        stream.Clear();
+        pipeline.Open();
+        pipeline.StartRecording(&stream);
+        graph.Execute(&pipeline);
+        pipeline.StopRecording();
+        pipeline.Close();
+        resourceStates.Commit(pipeline.GetResourceStates());
+        CHECK(stream.GetCommandCounts()[discards] == (frame ? 2u : 3u));
+    }
+
+    // Each discarded texture is left in the state its first pass uses it in, so that pass has no
+    // barrier of its own for it.  The one kept from the previous frame still needs one.
+    CHECK(!Touches(barriers[0], graph.GetResource(depth)));
+    CHECK(Touches(barriers[0], graph.GetResource(keeper)));
+    CHECK(!Touches(barriers[2], graph.GetResource(color)));
+}
+
+
+TEST(RenderGraphMovesTransientsIntoTheirFirstState)
+{
+    ComPtr<ID3D12Device> device;
+    CHECK(SUCCEEDED(NullDeviceClass::CreateDevice(IID_PPV_ARGS(device.GetAddressOf()))));
+
+    // Textures that start and end every frame in a state other than the one they are discarded
+    // in.  Two of them share memory, and are discarded every frame.  The other two live through
+    // the whole frame, and are only discarded on the first one.
+    RenderGraphClass graph;
+    const UINT storage = CreateTexture(graph, device.Get(), 256u, false, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+    const UINT copied  = CreateTexture(graph, device.Get(), 256u, false);
+    const UINT first   = CreateTexture(graph, device.Get(), 256u, false, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+    const UINT second  = CreateTexture(graph, device.Get(), 256u, false, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+
+    UINT mistakes = 0u;
+    const UINT fill     = AddCheckingPass(graph, { { storage, D3D12_RESOURCE_STATE_UNORDERED_ACCESS }, { copied, D3D12_RESOURCE_STATE_COPY_DEST } }, &mistakes);
+    const UINT useFirst = AddCheckingPass(graph, { { first, D3D12_RESOURCE_STATE_UNORDERED_ACCESS }, { copied, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE } }, &mistakes);
+    const UINT useLast  = AddCheckingPass(graph, { { second, D3D12_RESOURCE_STATE_UNORDERED_ACCESS }, { copied, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE } }, &mistakes);
+    const UINT refill   = AddCheckingPass(graph, { { storage, D3D12_RESOURCE_STATE_UNORDERED_ACCESS }, { copied, D3D12_RESOURCE_STATE_COPY_DEST } }, &mistakes);
+    graph.Write(fill, storage, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+    graph.Write(fill, copied, D3D12_RESOURCE_STATE_COPY_DEST);
+    graph.Write(useFirst, first, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+    graph.Read(useFirst, copied, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    graph.Write(useLast, second, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+    graph.Read(useLast, copied, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    graph.Write(refill, storage, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+    graph.Write(refill, copied, D3D12_RESOURCE_STATE_COPY_DEST);
+    graph.Compile();
+    CHECK(graph.GetSchedule() == std::vector<UINT>({ fill, useFirst, useLast, refill }));
+    CHECK(graph.GetHeapOffset(first) == graph.GetHeapOffset(second));
+    CHECK(graph.GetHeapOffset(storage) != graph.GetHeapOffset(first));
+    CHECK(graph.GetHeapOffset(copied) != graph.GetHeapOffset(first));
+
+    // Every frame after the first, the two sharing memory each need a barrier out of the state
+    // they are discarded in, and the copied texture one into the read state and one back.
+    CHECK(graph.GetStatistics().barrierCount == 4u);
+
+    ResourceStateTrackerClass resourceStates;
+    graph.Realize(device.Get(), &resourceStates);
+
+    const UINT frameIndex = 0u;
+    const size_t discards = static_cast<size_t>(CommandStreamClass::CommandType::DiscardResource);
+    CommandStreamClass stream;
+    PipelineClass pipeline(device.Get(), frameIndex, &resourceStates);
+    for (UINT frame = 0u; frame < 3u; ++frame)
+    {
+        stream.Clear();
+        pipeline.Open();
+        pipeline.StartRecording(&stream);
+        graph.Execute(&pipeline);
+        pipeline.StopRecording();
+        pipeline.Close();
+        resourceStates.Commit(pipeline.GetResourceStates());
+
+        // Every pass found every texture in the state it uses it in.
+        CHECK(mistakes == 0u);
+        CHECK(stream.GetCommandCounts()[discards] == (frame ? 2u : 4u));
+    }
+}
@@ -0,0 +1,167 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: renderqueuetests.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "testclass.h"
+#include "renderqueueclass.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <random>
+
+
+static void SubmitKeys(RenderQueueClass &queue, const std::vector<uint64_t> &keys)
+{
+    // Each packet remembers where it was submitted, so the order can be checked after sorting.
+    queue.Reset();
+    for (UINT i = 0u; i < keys.size(); ++i)
+    {
+        RenderQueueClass::DrawPacketType packet;
+        packet.sortKey     = keys[i];
+        packet.objectIndex = i;
+        queue.Submit(packet);
+    }
+}
+
+
+static void CheckSorted(RenderQueueClass &queue, const std::vector<uint64_t> &keys)
+{
+    CHECK(queue.GetPacketCount() == keys.size());
+
+    std::vector<bool> seen(keys.size(), false);
+    for (UINT i = 0u; i < queue.GetPacketCount(); ++i)
+    {
+        // Every packet comes out exactly once, with the key it went in with.
+        const RenderQueueClass::DrawPacketType &packet = queue.GetPacket(i);
+        CHECK(packet.objectIndex < keys.size());
+        CHECK(!seen[packet.objectIndex]);
+        CHECK(packet.sortKey == keys[packet.objectIndex]);
+        seen[packet.objectIndex] = true;
+
+        // In key order, and in submission order among equal keys.
+        if (i)
+        {
+            const RenderQueueClass::DrawPacketType &previous = queue.GetPacket(i - 1u);
+            CHECK(previous.sortKey <= packet.sortKey);
+            CHECK(previous.sortKey != packet.sortKey || previous.objectIndex < packet.objectIndex);
+        }
+    }
+}
+
+
+TEST(RenderQueueSortsStablyByKey)
+{
+    // Few distinct states and quantized depths, so many packets share a key.
+    std::mt19937 generator(7u);
+    std::uniform_int_distribution<UINT> ids(0u, 3u);
+    std::uniform_real_distribution<float> depths(0.0f, 1.0f);
+
+    std::vector<uint64_t> keys(20'000u);
+    for (uint64_t &key : keys)
+    {
+        const UINT  rootSignatureId = ids(generator);
+        const UINT  stateId         = ids(generator);
+        const UINT  bufferId        = ids(generator);
+        const float depth           = ids(generator) ? static_cast<float>(ids(generator)) / 3.0f : depths(generator);
+        key = RenderQueueClass::MakeSortKey(rootSignatureId, stateId, bufferId, depth);
+    }
+
+    RenderQueueClass queue(static_cast<UINT>(keys.size()));
+    SubmitKeys(queue, keys);
+    queue.Sort();
+    CheckSorted(queue, keys);
+}
+
+
+TEST(RenderQueueSortsEveryKeyByte)
+{
+    // Random keys differ in every byte, so no pass is skipped.  Keys that differ only in their
+    // top byte skip all the others.
+    std::mt19937_64 generator(11u);
+    std::vector<uint64_t> keys(5'000u);
+    for (uint64_t &key : keys)
+    {
+        key = generator();
+    }
+
+    RenderQueueClass queue(static_cast<UINT>(keys.size()));
+    SubmitKeys(queue, keys);
+    queue.Sort();
+    CheckSorted(queue, keys);
+
+    for (uint64_t &key : keys)
+    {
+        key = (generator() & 0xFF00000000000000ull) | 0x0123456789ABCDull;
+    }
+    SubmitKeys(queue, keys);
+    queue.Sort();
+    CheckSorted(queue, keys);
+
+    // And the same key everywhere leaves the submission order alone.
+    std::fill(keys.begin(), keys.end(), 42ull);
+    SubmitKeys(queue, keys);
+    queue.Sort();
+    CheckSorted(queue, keys);
+}
+
+
+TEST(RenderQueueSortKeyGroupsCostliestChangesFirst)
+{
+    // A root signature outranks a state, a state a vertex buffer, and a buffer the depth.
+    CHECK(RenderQueueClass::MakeSortKey(0u, 255u, 255u, 1.0f) < RenderQueueClass::MakeSortKey(1u, 0u, 0u, 0.0f));
+    CHECK(RenderQueueClass::MakeSortKey(0u, 0u, 65'535u, 1.0f) < RenderQueueClass::MakeSortKey(0u, 1u, 0u, 0.0f));
+    CHECK(RenderQueueClass::MakeSortKey(0u, 0u, 0u, 1.0f) < RenderQueueClass::MakeSortKey(0u, 0u, 1u, 0.0f));
+
+    // Nearer draws come first, and depths outside the unit range are clamped.
+    CHECK(RenderQueueClass::MakeSortKey(0u, 0u, 0u, 0.25f) < RenderQueueClass::MakeSortKey(0u, 0u, 0u, 0.5f));
+    CHECK(RenderQueueClass::MakeSortKey(0u, 0u, 0u, -1.0f) == RenderQueueClass::MakeSortKey(0u, 0u, 0u, 0.0f));
+    CHECK(RenderQueueClass::MakeSortKey(0u, 0u, 0u, 2.0f) == RenderQueueClass::MakeSortKey(0u, 0u, 0u, 1.0f));
+}
+
+
+TEST(RenderQueueSortGroupsStateChanges)
+{
+    // Two root signatures, each with two states, each with two buffers, submitted interleaved.
+    std::vector<uint64_t> keys;
+    for (UINT i = 0u; i < 64u; ++i)
+    {
+        keys.push_back(RenderQueueClass::MakeSortKey(i & 1u, (i >> 1u) & 1u, (i >> 2u) & 1u, static_cast<float>(i) / 64.0f));
+    }
+
+    RenderQueueClass queue(static_cast<UINT>(keys.size()));
+    SubmitKeys(queue, keys);
+    const RenderQueueClass::StateChangeType before = queue.CountStateChanges();
+    CHECK(before.rootSignatures == 64u);
+
+    // Sorted, each root signature, state and buffer is bound once per group it starts.
+    queue.Sort();
+    const RenderQueueClass::StateChangeType after = queue.CountStateChanges();
+    CHECK(after.rootSignatures == 2u);
+    CHECK(after.states == 4u);
+    CHECK(after.vertexBuffers == 8u);
+}
+
+
+TEST(RenderQueueResetsAndRejectsOverflow)
+{
+    // The default capacity can be constructed without naming it.
+    std::unique_ptr<RenderQueueClass> defaultQueue = std::make_unique<RenderQueueClass>();
+    CHECK(defaultQueue->GetPacketCount() == 0u);
+
+    RenderQueueClass queue(2u);
+    SubmitKeys(queue, { 2ull, 1ull });
+    queue.Sort();
+    CheckSorted(queue, { 2ull, 1ull });
+
+    // Packets past the capacity are refused, without counting the ones that do not fit.
+    CHECK_THROWS(queue.Submit(RenderQueueClass::DrawPacketType()));
+    CHECK(queue.GetPacketCount() == 2u);
+
+    // And a reset queue sorts nothing.
+    queue.Reset();
+    queue.Sort();
+    CHECK(queue.GetPacketCount() == 0u);
+    CHECK(queue.CountStateChanges().states == 0u);
+}
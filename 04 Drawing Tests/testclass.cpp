@@ -0,0 +1,52 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: testclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "testclass.h"
+
+
+TestClass::TestClass(const char *name, FunctionType function)
+    : m_name(name), m_function(function)
+{
+    GetTests().push_back(this);
+}
+
+
+int TestClass::RunAll(const char *filter)
+{
+    // Run every test whose name contains the filter, and keep going past failures so a single run
+    // reports all of them.
+    UINT runCount    = 0u;
+    UINT failedCount = 0u;
+    for (TestClass *test : GetTests())
+    {
+        if (filter && !strstr(test->m_name, filter))
+        {
+            continue;
+        }
+
+        ++runCount;
+        try
+        {
+            test->m_function();
+            printf("[ PASSED ] %s\n", test->m_name);
+        }
+        catch (std::exception &e)
+        {
+            ++failedCount;
+            printf("[ FAILED ] %s\n           %s\n", test->m_name, e.what());
+        }
+    }
+
+    printf("%u of %u tests passed.\n", runCount - failedCount, runCount);
+    return failedCount ? 1 : 0;
+}
+
+
+std::vector<TestClass *> & TestClass::GetTests()
+{
+    // Tests register from static initializers in other files, so the list has to exist before the
+    // first of them runs.
+    static std::vector<TestClass *> tests;
+    return tests;
+}
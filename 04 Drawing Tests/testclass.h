@@ -0,0 +1,53 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: testclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstdio>
+#include <cstring>
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: TestClass
+////////////////////////////////////////////////////////////////////////////////
+class TestClass
+{
+public:
+    using FunctionType = void (*)();
+
+public:
+    TestClass() = delete;
+    TestClass(const TestClass &) = delete;
+    TestClass & operator=(const TestClass &) = delete;
+
+    TestClass(const char *, FunctionType);
+    ~TestClass() = default;
+
+    static int RunAll(const char *);
+
+private:
+    static std::vector<TestClass *> & GetTests();
+
+private:
+    const char   *m_name     = nullptr;
+    FunctionType  m_function = nullptr;
+};
+
+
+/////////////////////
+// MACRO FUNCTIONS //
+/////////////////////
+
+// Defines a test and registers it before main runs.
+#define TEST(name) \
+    static void name(); \
+    static TestClass name##Test(#name, name); \
+    static void name()
+
+// Fails the running test with the expression and where it was checked.
+#define CHECK(cond) if (!(cond)) { throw std::runtime_error(std::string(__FILE__ "(") + std::to_string(__LINE__) + "): " #cond); }
+#define CHECK_THROWS(expr) { bool thrown = false; try { expr; } catch (std::exception &) { thrown = true; } CHECK(thrown && #expr); }
@@ -0,0 +1,204 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: tlsfallocatortests.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "testclass.h"
+#include "tlsfallocatorclass.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <map>
+#include <random>
+
+
+TEST(TlsfAllocatorAllocatesFreesAndMerges)
+{
+    TlsfAllocatorClass allocator(64u * 1024u, 256u);
+
+    // Allocations are laid out one after the other, rounded up to the granularity.
+    const UINT64 first  = allocator.Allocate(1000u);
+    const UINT64 second = allocator.Allocate(1024u);
+    const UINT64 third  = allocator.Allocate(1u);
+    CHECK(first == 0u);
+    CHECK(second == 1024u);
+    CHECK(third == 2048u);
+    CHECK(allocator.Allocate(0u) == 2304u);
+    allocator.Free(2304u);
+    CHECK(allocator.GetStatistics().usedBytes == 2304u);
+    CHECK(allocator.GetStatistics().allocationCount == 3u);
+
+    // Freeing the middle one leaves a hole, which merges with the first once that goes as well.
+    allocator.Free(second);
+    CHECK(allocator.GetStatistics().freeBlockCount == 2u);
+    allocator.Free(first);
+    CHECK(allocator.GetStatistics().freeBlockCount == 2u);
+    CHECK(allocator.GetStatistics().usedBytes == 256u);
+
+    // The merged hole takes an allocation that neither half could.
+    CHECK(allocator.Allocate(2048u) == 0u);
+    allocator.Free(0u);
+
+    // With everything freed, the range is a single block again.
+    allocator.Free(third);
+    const TlsfAllocatorClass::StatisticsType statistics = allocator.GetStatistics();
+    CHECK(allocator.IsEmpty());
+    CHECK(statistics.usedBytes == 0u);
+    CHECK(statistics.freeBlockCount == 1u);
+    CHECK(statistics.largestFreeBlock == 64u * 1024u);
+}
+
+
+TEST(TlsfAllocatorReusesAlignmentPadding)
+{
+    TlsfAllocatorClass allocator(64u * 1024u, 256u);
+
+    // An allocation with a larger alignment skips ahead, and the memory it skipped stays free.
+    CHECK(allocator.Allocate(256u) == 0u);
+    CHECK(allocator.Allocate(256u, 4096u) == 4096u);
+    CHECK(allocator.GetStatistics().usedBytes == 512u);
+    CHECK(allocator.GetStatistics().freeBlockCount == 2u);
+
+    // The padding is just large enough for what fits between the two.
+    CHECK(allocator.Allocate(3840u) == 256u);
+    CHECK(allocator.GetStatistics().freeBlockCount == 1u);
+
+    // An alignment below the granularity still gives granularity aligned offsets.
+    CHECK(allocator.Allocate(100u, 16u) == 4352u);
+
+    allocator.Free(0u);
+    allocator.Free(256u);
+    allocator.Free(4096u);
+    allocator.Free(4352u);
+    CHECK(allocator.GetStatistics().freeBlockCount == 1u);
+}
+
+
+TEST(TlsfAllocatorReportsExhaustion)
+{
+    TlsfAllocatorClass allocator(4096u, 256u);
+
+    // Nothing larger than the range fits, nor anything once it is full, nor anything whose
+    // alignment leaves no room.
+    CHECK(allocator.Allocate(4097u) == TlsfAllocatorClass::INVALID_OFFSET);
+    CHECK(allocator.Allocate(256u, 8192u) == TlsfAllocatorClass::INVALID_OFFSET);
+    CHECK(allocator.Allocate(4096u) == 0u);
+    CHECK(allocator.Allocate(1u) == TlsfAllocatorClass::INVALID_OFFSET);
+    CHECK(allocator.GetStatistics().largestFreeBlock == 0u);
+    CHECK(allocator.GetFragmentation() == 0.0);
+
+    // A failed allocation changes nothing, so the range can be used again once freed.
+    allocator.Free(0u);
+    CHECK(allocator.Allocate(4096u) == 0u);
+}
+
+
+TEST(TlsfAllocatorMeasuresFragmentation)
+{
+    TlsfAllocatorClass allocator(8u * 1024u, 256u);
+
+    std::vector<UINT64> offsets;
+    for (UINT i = 0u; i < 8u; ++i)
+    {
+        offsets.push_back(allocator.Allocate(1024u));
+        CHECK(offsets.back() == i * 1024u);
+    }
+    CHECK(allocator.GetFragmentation() == 0.0);
+
+    // Freeing every other allocation leaves half the range free, but in pieces too small for
+    // anything larger than one of them.
+    for (UINT i = 1u; i < 8u; i += 2u)
+    {
+        allocator.Free(offsets[i]);
+    }
+    CHECK(allocator.GetStatistics().freeBlockCount == 4u);
+    CHECK(allocator.GetStatistics().largestFreeBlock == 1024u);
+    CHECK(allocator.GetFragmentation() == 0.75);
+    CHECK(allocator.Allocate(2048u) == TlsfAllocatorClass::INVALID_OFFSET);
+
+    // Freeing the rest brings all the pieces back together.
+    for (UINT i = 0u; i < 8u; i += 2u)
+    {
+        allocator.Free(offsets[i]);
+    }
+    CHECK(allocator.GetFragmentation() == 0.0);
+    CHECK(allocator.Allocate(8u * 1024u) == 0u);
+}
+
+
+TEST(TlsfAllocatorRejectsMisuse)
+{
+    CHECK_THROWS(TlsfAllocatorClass(4096u, 0u));
+    CHECK_THROWS(TlsfAllocatorClass(4096u, 384u));
+    CHECK_THROWS(TlsfAllocatorClass(128u, 256u));
+
+    // Only offsets handed out can be freed, and only once.
+    TlsfAllocatorClass allocator(4096u, 256u);
+    const UINT64 offset = allocator.Allocate(512u);
+    CHECK_THROWS(allocator.Free(offset + 256u));
+    allocator.Free(offset);
+    CHECK_THROWS(allocator.Free(offset));
+}
+
+
+TEST(TlsfAllocatorKeepsRandomAllocationsApart)
+{
+    const UINT64 size = 1024u * 1024u;
+    TlsfAllocatorClass allocator(size, 256u);
+
+    // Random allocations and frees, checked against a map of everything still allocated.
+    std::mt19937 generator(13u);
+    std::uniform_int_distribution<UINT64> sizes(1u, 16u * 1024u);
+    std::uniform_int_distribution<UINT> picks(0u, 99u);
+    const UINT64 alignments[] = { 1u, 256u, 1024u, 4096u, 65536u };
+
+    std::map<UINT64, UINT64> live;
+    UINT64 usedBytes = 0u;
+    for (UINT step = 0u; step < 4000u; ++step)
+    {
+        if (!live.empty() && picks(generator) < 45u)
+        {
+            auto freed = live.begin();
+            std::advance(freed, picks(generator) % live.size());
+            allocator.Free(freed->first);
+            usedBytes -= freed->second;
+            live.erase(freed);
+            continue;
+        }
+
+        const UINT64 allocationSize = sizes(generator);
+        const UINT64 alignment      = alignments[picks(generator) % 5u];
+        const UINT64 offset         = allocator.Allocate(allocationSize, alignment);
+        if (offset == TlsfAllocatorClass::INVALID_OFFSET)
+        {
+            continue;
+        }
+
+        // The allocation is aligned, inside the range, and clear of its neighbours.
+        const UINT64 roundedSize = (allocationSize + 255u) / 256u * 256u;
+        CHECK(offset % (alignment > 256u ? alignment : 256u) == 0u);
+        CHECK(offset + roundedSize <= size);
+
+        const auto next = live.lower_bound(offset);
+        CHECK(next == live.end() || offset + roundedSize <= next->first);
+        if (next != live.begin())
+        {
+            const auto prev = std::prev(next);
+            CHECK(prev->first + prev->second <= offset);
+        }
+
+        live.emplace(offset, roundedSize);
+        usedBytes += roundedSize;
+        CHECK(allocator.GetStatistics().usedBytes == usedBytes);
+    }
+    CHECK(allocator.GetStatistics().allocationCount == live.size());
+
+    for (const auto &allocation : live)
+    {
+        allocator.Free(allocation.first);
+    }
+    CHECK(allocator.IsEmpty());
+    CHECK(allocator.GetStatistics().freeBlockCount == 1u);
+    CHECK(allocator.GetStatistics().largestFreeBlock == size);
+}
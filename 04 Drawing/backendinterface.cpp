@@ -0,0 +1,141 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: backendinterface.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "backendinterface.h"
+
+
+BackendInterface::~BackendInterface()
+{
+    // Close the object handle to the fence event.
+    if (m_fenceEvent)
+    {
+        CloseHandle(m_fenceEvent);
+    }
+}
+
+
+ID3D12Device * BackendInterface::GetDevice()
+{
+    return m_device.Get();
+}
+
+
+ID3D12CommandQueue * BackendInterface::GetCommandQueue()
+{
+    return m_commandQueue.Get();
+}
+
+
+size_t BackendInterface::GetVideoCardMemory()
+{
+    return m_videoCardMemory;
+}
+
+
+void BackendInterface::WaitForFence(ID3D12Fence *fence, UINT64 fenceValue)
+{
+    // If the current fence value is still less than `fenceValue`, then we know the GPU has not
+    // finished executing the command queue since it has not reached the
+    // `commandQueue->Signal(fence, fenceValue)` command.
+    if (fence->GetCompletedValue() < fenceValue)
+    {
+        // We have the fence signal the fenceEvent once the fence's current value is "fenceValue".
+        THROW_IF_FAILED(
+            fence->SetEventOnCompletion(fenceValue, m_fenceEvent),
+            "Unable to set the fence event."
+        );
+
+        // Wait for the fence event to complete, with no timeout.
+        WaitForSingleObject(m_fenceEvent, INFINITE);
+    }
+}
+
+
+ComPtr<IDXGIFactory4> BackendInterface::CreateFactory()
+{
+    // Set the default DXGI factory flags.
+    UINT dxgiFlags = 0u;
+
+#ifdef DX12_ENABLE_DEBUG_LAYER
+    // Enable debugging our DXGI device.
+    dxgiFlags |= DXGI_CREATE_FACTORY_DEBUG;
+#endif // DX12_ENABLE_DEBUG_LAYER
+
+    // Create a DirectX graphics infrastructure factory.
+    ComPtr<IDXGIFactory4> factory;
+    THROW_IF_FAILED(
+        CreateDXGIFactory2(
+            dxgiFlags,
+            IID_PPV_ARGS(factory.GetAddressOf())),
+        "Unable to create a device factory."
+    );
+
+    return factory;
+}
+
+
+void BackendInterface::InitializeDevice(IDXGIAdapter *adapter)
+{
+#ifdef DX12_ENABLE_DEBUG_LAYER
+    // Requires the optional "graphics tools" Windows feature.
+    {
+        // Acquire Direct3D 12 debug controller and enable debug layer.
+        ComPtr<ID3D12Debug> debugController;
+        if (SUCCEEDED(D3D12GetDebugInterface(IID_PPV_ARGS(debugController.GetAddressOf()))))
+        {
+            debugController->EnableDebugLayer();
+        }
+
+        // Tell the interface to break when it sees errors or corruptions.
+        ComPtr<IDXGIInfoQueue> dxgiInfoQueue;
+        if (SUCCEEDED(DXGIGetDebugInterface1(0, IID_PPV_ARGS(dxgiInfoQueue.GetAddressOf()))))
+        {
+            dxgiInfoQueue->SetBreakOnSeverity(DXGI_DEBUG_ALL, DXGI_INFO_QUEUE_MESSAGE_SEVERITY_ERROR, true);
+            dxgiInfoQueue->SetBreakOnSeverity(DXGI_DEBUG_ALL, DXGI_INFO_QUEUE_MESSAGE_SEVERITY_CORRUPTION, true);
+        }
+    }
+#endif // DX12_ENABLE_DEBUG_LAYER
+
+    // Set the feature level to DirectX 12.1 to enable using all the DirectX 12 features.
+    D3D_FEATURE_LEVEL featureLevel = D3D_FEATURE_LEVEL_12_1;
+
+    // Create the Direct3D 12 device.  A null adapter selects the default video card.
+    THROW_IF_FAILED(
+        D3D12CreateDevice(
+            adapter,
+            featureLevel,
+            IID_PPV_ARGS(m_device.GetAddressOf())),
+        "Unable to create a DirectX 12.1 device.  The selected adapter does not support DirectX 12.1."
+    );
+}
+
+
+void BackendInterface::InitializeCommandQueue()
+{
+    // Set up the description of the command queue.
+    D3D12_COMMAND_QUEUE_DESC commandQueueDesc{};
+    commandQueueDesc.Type     = D3D12_COMMAND_LIST_TYPE_DIRECT;
+    commandQueueDesc.Priority = D3D12_COMMAND_QUEUE_PRIORITY_NORMAL;
+    commandQueueDesc.Flags    = D3D12_COMMAND_QUEUE_FLAG_NONE;
+    commandQueueDesc.NodeMask = 0u;
+
+    // Create the command queue.
+    THROW_IF_FAILED(
+        m_device->CreateCommandQueue(
+            &commandQueueDesc,
+            IID_PPV_ARGS(m_commandQueue.GetAddressOf())),
+        "Unable to create a command queue on the graphics device."
+    );
+}
+
+
+void BackendInterface::InitializeFenceEvent()
+{
+    // Create an event object for the fences.
+    m_fenceEvent = CreateEventEx(NULL, FALSE, FALSE, EVENT_ALL_ACCESS);
+    THROW_IF_TRUE(
+        m_fenceEvent == nullptr,
+        "Unable to create a Windows system event for hardware synchronization."
+    );
+}
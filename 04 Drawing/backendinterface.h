@@ -0,0 +1,46 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: backendinterface.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Interface name: BackendInterface
+////////////////////////////////////////////////////////////////////////////////
+class BackendInterface
+{
+public:
+    BackendInterface(const BackendInterface &) = delete;
+    BackendInterface & operator=(const BackendInterface &) = delete;
+
+    BackendInterface() = default;
+    virtual ~BackendInterface();
+
+    ID3D12Device * GetDevice();
+    ID3D12CommandQueue * GetCommandQueue();
+    size_t GetVideoCardMemory();
+
+    void WaitForFence(ID3D12Fence *, UINT64);
+
+    virtual ID3D12Resource * GetBackBuffer(UINT) = 0;
+    virtual UINT GetCurrentBackBufferIndex() = 0;
+
+    virtual bool WaitForFrameLatency(DWORD) = 0;
+    virtual void Present(bool) = 0;
+
+protected:
+    ComPtr<IDXGIFactory4> CreateFactory();
+
+    void InitializeDevice(IDXGIAdapter *);
+    void InitializeCommandQueue();
+    void InitializeFenceEvent();
+
+    virtual void NameD3DResources() = 0;
+
+protected:
+    size_t m_videoCardMemory = 0ull;
+
+    ComPtr<ID3D12Device>       m_device       = nullptr;
+    ComPtr<ID3D12CommandQueue> m_commandQueue = nullptr;
+    HANDLE                     m_fenceEvent   = nullptr;
+};
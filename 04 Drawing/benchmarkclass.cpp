@@ -0,0 +1,863 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: benchmarkclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "benchmarkclass.h"
+
+
+#ifdef BENCHMARK_COUNT_ALLOCATIONS
+//////////////////////
+// GLOBAL VARIABLES //
+//////////////////////
+
+// Every heap allocation made by any thread of the process.
+static std::atomic<uint64_t> g_allocationCount = { 0ull };
+
+
+// Replace the global allocation functions so that allocations can be counted per frame.  The
+// array forms forward to these, and so do the remaining delete overloads.
+void * operator new(size_t size)
+{
+    g_allocationCount.fetch_add(1ull, std::memory_order_relaxed);
+    if (void *memory = malloc(size ? size : 1u))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+
+void * operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    g_allocationCount.fetch_add(1ull, std::memory_order_relaxed);
+    return malloc(size ? size : 1u);
+}
+
+
+void operator delete(void *memory) noexcept
+{
+    free(memory);
+}
+
+
+void operator delete(void *memory, size_t) noexcept
+{
+    free(memory);
+}
+
+
+void operator delete(void *memory, const std::nothrow_t &) noexcept
+{
+    free(memory);
+}
+
+
+#ifdef __cpp_aligned_new
+// Over-aligned types come from the aligned heap, and have to go back to it.
+void * operator new(size_t size, std::align_val_t alignment)
+{
+    g_allocationCount.fetch_add(1ull, std::memory_order_relaxed);
+    if (void *memory = _aligned_malloc(size ? size : 1u, static_cast<size_t>(alignment)))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+
+void * operator new(size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    g_allocationCount.fetch_add(1ull, std::memory_order_relaxed);
+    return _aligned_malloc(size ? size : 1u, static_cast<size_t>(alignment));
+}
+
+
+void operator delete(void *memory, std::align_val_t) noexcept
+{
+    _aligned_free(memory);
+}
+
+
+void operator delete(void *memory, size_t, std::align_val_t) noexcept
+{
+    _aligned_free(memory);
+}
+
+
+void operator delete(void *memory, std::align_val_t, const std::nothrow_t &) noexcept
+{
+    _aligned_free(memory);
+}
+#endif // __cpp_aligned_new
+#endif // BENCHMARK_COUNT_ALLOCATIONS
+
+
+BenchmarkClass::BenchmarkClass(const SettingsType &settings)
+    : m_settings(settings)
+{
+    THROW_IF_TRUE(
+        m_settings.frameCount == 0u,
+        "The benchmark needs at least one frame to time."
+    );
+}
+
+
+bool BenchmarkClass::ParseCommandLine(SettingsType &settings)
+{
+    int argumentCount = 0;
+    LPWSTR *arguments = CommandLineToArgvW(GetCommandLineW(), &argumentCount);
+    THROW_IF_TRUE(
+        arguments == nullptr,
+        "Unable to read the command line."
+    );
+
+    // Copy the options out, skipping the program name, so the list is freed before anything throws.
+    std::vector<std::wstring> options;
+    for (int i = 1; i < argumentCount; ++i)
+    {
+        options.push_back(arguments[i]);
+    }
+    LocalFree(arguments);
+
+    // Without the benchmark switch, the command line is not ours to read.
+    if (std::find(options.begin(), options.end(), L"--benchmark") == options.end())
+    {
+        return false;
+    }
+
+    // Every other option takes a value, and all but the file names, the device and the culling are
+    // counts.
+    const std::pair<const wchar_t *, UINT *> counts[] =
+    {
+        { L"--frames",           &settings.frameCount },
+        { L"--warmup",           &settings.warmupFrameCount },
+        { L"--width",            &settings.xResolution },
+        { L"--height",           &settings.yResolution },
+        { L"--frames-in-flight", &settings.framesInFlight },
+        { L"--quads",            &settings.scene.quadCount },
+        { L"--triangles",        &settings.scene.triangleCount },
+        { L"--instances",        &settings.scene.instancesPerQuad },
+        { L"--sort-packets",     &settings.sortPacketCount },
+        { L"--cull-instances",   &settings.cullInstanceCount },
+        { L"--graph-passes",     &settings.graphPassCount },
+        { L"--heap-operations",  &settings.heapOperationCount },
+        { L"--mesh-triangles",   &settings.meshTriangleCount },
+    };
+
+    for (size_t i = 0; i < options.size(); ++i)
+    {
+        const std::wstring &option = options[i];
+        if (option == L"--benchmark")
+        {
+            continue;
+        }
+
+        THROW_IF_TRUE(
+            i + 1 >= options.size(),
+            "A benchmark option is missing its value."
+        );
+        const std::wstring &value = options[++i];
+
+        if (option == L"--output")
+        {
+            settings.outputFilename = value;
+            continue;
+        }
+        if (option == L"--capture")
+        {
+            settings.captureFilename = value;
+            continue;
+        }
+        if (option == L"--mesh-asset")
+        {
+            settings.meshFilename = value;
+            continue;
+        }
+        if (option == L"--scene-mesh")
+        {
+            settings.scene.meshFilename = value;
+            continue;
+        }
+        if (option == L"--device")
+        {
+            THROW_IF_TRUE(
+                value != L"warp" && value != L"null",
+                "The benchmark device is neither warp nor null."
+            );
+            settings.device = value == L"null" ? EngineClass::DeviceType::Null : EngineClass::DeviceType::Warp;
+            continue;
+        }
+        if (option == L"--culling")
+        {
+            THROW_IF_TRUE(
+                value != L"gpu" && value != L"cpu",
+                "The benchmark culling is neither gpu nor cpu."
+            );
+            settings.scene.gpuCulling = value == L"gpu";
+            continue;
+        }
+
+        auto count = std::find_if(std::begin(counts), std::end(counts), [&option](const std::pair<const wchar_t *, UINT *> &entry) { return option == entry.first; });
+        THROW_IF_TRUE(
+            count == std::end(counts),
+            "Unknown benchmark option."
+        );
+
+        wchar_t *end = nullptr;
+        const unsigned long number = wcstoul(value.c_str(), &end, 10);
+        THROW_IF_TRUE(
+            value.empty() || *end != L'\0' || number > UINT_MAX,
+            "A benchmark option has a value that is not a count."
+        );
+        *count->second = static_cast<UINT>(number);
+    }
+
+    return true;
+}
+
+
+uint64_t BenchmarkClass::GetAllocationCount()
+{
+#ifdef BENCHMARK_COUNT_ALLOCATIONS
+    return g_allocationCount.load(std::memory_order_relaxed);
+#else
+    return 0ull;
+#endif // BENCHMARK_COUNT_ALLOCATIONS
+}
+
+
+void BenchmarkClass::Run()
+{
+    // Time the pieces that need no device first, so nothing else competes for the workers.
+    RunRenderQueue();
+    RunCuller();
+    RunRenderGraph();
+    RunHeapAllocator();
+    RunMeshOptimizer();
+
+    // Then the whole frame loop, and the commands of one of its frames.  Running the render graph
+    // on its transients and loading the mesh back need the device, so they come last.
+    RunFrames();
+    CountCommands();
+    RunTransients();
+    RunMeshLoader();
+
+    SaveResults();
+}
+
+
+void BenchmarkClass::RunRenderQueue()
+{
+    // Fill the queue with draws whose state is spread the way a large scene's would be: a few root
+    // signatures, more pipeline states, many vertex buffers, and every depth.  The seed is fixed,
+    // so every run sorts the same keys.
+    RenderQueueClass queue(m_settings.sortPacketCount);
+
+    std::mt19937 generator(17u);
+    std::uniform_int_distribution<UINT>   rootSignatures(0u, 3u);
+    std::uniform_int_distribution<UINT>   states(0u, 63u);
+    std::uniform_int_distribution<UINT>   buffers(0u, 1023u);
+    std::uniform_real_distribution<float> depths(0.0f, 1.0f);
+
+    for (UINT i = 0u; i < m_settings.sortPacketCount; ++i)
+    {
+        RenderQueueClass::DrawPacketType packet;
+        packet.sortKey     = RenderQueueClass::MakeSortKey(rootSignatures(generator), states(generator), buffers(generator), depths(generator));
+        packet.objectIndex = i;
+        queue.Submit(packet);
+    }
+    m_unsortedStateChanges = queue.CountStateChanges();
+
+    // Every sort starts again from the submitted order, so each run does the same work.
+    std::vector<double> sortSeconds;
+    for (UINT run = 0u; run < SORT_RUN_COUNT; ++run)
+    {
+        queue.Sort();
+        sortSeconds.push_back(queue.GetSortSeconds());
+    }
+    m_sortSeconds        = GetPercentiles(sortSeconds).p50;
+    m_sortedStateChanges = queue.CountStateChanges();
+}
+
+
+void BenchmarkClass::RunCuller()
+{
+    const UINT workerCount = std::thread::hardware_concurrency();
+    WorkerPoolClass    workers(workerCount ? workerCount : 1u);
+    FrustumCullerClass culler(&workers);
+
+    // Scatter spheres through a cube around the origin, and look into it from one of its faces,
+    // so the frustum keeps some of them and every plane rejects some of the rest.
+    std::mt19937 generator(29u);
+    std::uniform_real_distribution<float> positions(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> radii(0.5f, 2.0f);
+
+    FrustumCullerClass::BoundsType bounds;
+    bounds.Resize(m_settings.cullInstanceCount);
+    for (UINT i = 0u; i < m_settings.cullInstanceCount; ++i)
+    {
+        bounds.x[i]      = positions(generator);
+        bounds.y[i]      = positions(generator);
+        bounds.z[i]      = positions(generator);
+        bounds.radius[i] = radii(generator);
+    }
+    std::vector<UINT> survivors(m_settings.cullInstanceCount);
+
+    CameraClass camera(m_settings.xResolution, m_settings.yResolution, 45.0f);
+    camera.SetPosition(0.0f, 0.0f, -100.0f);
+    camera.Render();
+    const FrustumCullerClass::FrustumType frustum = FrustumCullerClass::ExtractFrustum(XMMatrixMultiply(camera.GetViewMatrix(), camera.GetProjectionMatrix()));
+
+    std::vector<double> cullSeconds;
+    for (UINT run = 0u; run < CULL_RUN_COUNT; ++run)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        m_visibleInstances = culler.Cull(frustum, bounds, survivors.data());
+        cullSeconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    const double seconds = GetPercentiles(cullSeconds).p50;
+    m_instancesPerSecond = seconds > 0.0 ? static_cast<double>(m_settings.cullInstanceCount) / seconds : 0.0;
+}
+
+
+void BenchmarkClass::RunRenderGraph()
+{
+    // Compiling needs no device, so the textures only need their sizes.
+    RenderGraphClass graph;
+    BuildRenderGraph(graph, nullptr);
+
+    // Every compile starts again from the declared passes, so each run does the same work.
+    std::vector<double> compileSeconds;
+    for (UINT run = 0u; run < GRAPH_RUN_COUNT; ++run)
+    {
+        graph.Compile();
+        compileSeconds.push_back(graph.GetStatistics().compileSeconds);
+    }
+    m_graphStatistics                = graph.GetStatistics();
+    m_graphStatistics.compileSeconds = GetPercentiles(compileSeconds).p50;
+}
+
+
+void BenchmarkClass::RunTransients()
+{
+    // Build the same graph with the sizes the device gives its textures, and have the engine run
+    // it once, so the transients are placed, aliased and discarded for real.
+    RenderGraphClass graph;
+    const UINT backBuffer = BuildRenderGraph(graph, m_Engine->GetDevice());
+    graph.Compile();
+
+    const auto start = std::chrono::steady_clock::now();
+    m_Engine->ExecuteRenderGraph(&graph, backBuffer);
+    m_graphExecuteSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+UINT BenchmarkClass::BuildRenderGraph(RenderGraphClass &graph, ID3D12Device *device)
+{
+    // Build a frame the way a deferred renderer's would look: every pass draws into a texture of
+    // its own, at full or half resolution, reading a couple of the textures drawn shortly before.
+    // Some of them are never read and get culled, and the last pass composes into the back buffer.
+    // Without a device, the sizes are those of the pixels alone.
+    std::mt19937 generator(41u);
+    std::uniform_int_distribution<UINT> formats(0u, 2u);
+    std::uniform_int_distribution<UINT> halves(0u, 3u);
+    std::uniform_int_distribution<UINT> lookbacks(1u, 8u);
+
+    const UINT backBuffer = graph.ImportResource("Back buffer", D3D12_RESOURCE_STATE_PRESENT);
+    std::vector<UINT> textures;
+    for (UINT i = 0u; i < m_settings.graphPassCount; ++i)
+    {
+        const UINT pass = graph.AddPass("Pass", [](PipelineClass *) {});
+        for (UINT read = 0u; read < 2u && !textures.empty(); ++read)
+        {
+            const UINT lookback = lookbacks(generator);
+            const UINT texture  = textures[textures.size() > lookback ? textures.size() - lookback : 0u];
+            graph.Read(pass, texture, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+        }
+
+        if (i + 1u == m_settings.graphPassCount)
+        {
+            graph.Write(pass, backBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET);
+            break;
+        }
+
+        // Depth, 8-bit color, or 16-bit float color.
+        const UINT   format        = formats(generator);
+        const UINT   scale         = halves(generator) == 0u ? 2u : 1u;
+        const UINT64 bytesPerPixel = format == 2u ? 8ull : 4ull;
+
+        D3D12_RESOURCE_DESC desc{};
+        desc.Dimension        = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+        desc.Width            = m_settings.xResolution / scale;
+        desc.Height           = m_settings.yResolution / scale;
+        desc.DepthOrArraySize = 1;
+        desc.MipLevels        = 1;
+        desc.Format           = format == 0u ? DXGI_FORMAT_D32_FLOAT : (format == 1u ? DXGI_FORMAT_R8G8B8A8_UNORM : DXGI_FORMAT_R16G16B16A16_FLOAT);
+        desc.SampleDesc.Count = 1;
+        desc.Layout           = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+        desc.Flags            = format == 0u ? D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL : D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
+
+        D3D12_RESOURCE_ALLOCATION_INFO allocation{};
+        if (device)
+        {
+            allocation = device->GetResourceAllocationInfo(0, 1, &desc);
+        }
+        else
+        {
+            allocation.Alignment   = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+            allocation.SizeInBytes = (desc.Width * desc.Height * bytesPerPixel + allocation.Alignment - 1ull) / allocation.Alignment * allocation.Alignment;
+        }
+
+        const UINT texture = graph.CreateTexture("Texture", desc, allocation);
+        graph.Write(pass, texture, format == 0u ? D3D12_RESOURCE_STATE_DEPTH_WRITE : D3D12_RESOURCE_STATE_RENDER_TARGET);
+        textures.push_back(texture);
+    }
+
+    return backBuffer;
+}
+
+
+void BenchmarkClass::RunHeapAllocator()
+{
+    // Churn a heap the size of one of the allocator's blocks with buffers from 64KB to 4MB, evenly
+    // spread over the powers of two in between, holding it around three quarters full.  The seed
+    // is fixed, so every run places and frees the same buffers.
+    const UINT64 heapSize = 64ull * 1024ull * 1024ull;
+    TlsfAllocatorClass heap(heapSize, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+
+    std::mt19937 generator(53u);
+    std::uniform_int_distribution<UINT>    powers(16u, 21u);
+    std::uniform_real_distribution<double> fractions(1.0, 2.0);
+    std::uniform_int_distribution<size_t>  choices;
+
+    std::vector<std::pair<UINT64, UINT64>> allocations;
+    UINT64 usedBytes = 0ull;
+
+    std::vector<double> fragmentation;
+    double seconds = 0.0;
+    for (UINT i = 0u; i < m_settings.heapOperationCount; ++i)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        if (allocations.empty() || usedBytes < heapSize / 4ull * 3ull)
+        {
+            const UINT64 size   = static_cast<UINT64>(static_cast<double>(1ull << powers(generator)) * fractions(generator));
+            const UINT64 offset = heap.Allocate(size);
+            seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            // Only count the failures where there was enough memory free, just not in one piece.
+            if (offset == TlsfAllocatorClass::INVALID_OFFSET)
+            {
+                m_heapFailures += heapSize - usedBytes >= size ? 1u : 0u;
+                continue;
+            }
+
+            const UINT64 placedSize = (size + D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1ull) & ~(D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1ull);
+            allocations.emplace_back(offset, placedSize);
+            usedBytes += placedSize;
+        }
+        else
+        {
+            const size_t index = choices(generator) % allocations.size();
+            heap.Free(allocations[index].first);
+            seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            usedBytes          -= allocations[index].second;
+            allocations[index]  = allocations.back();
+            allocations.pop_back();
+        }
+
+        // Sample how scattered the free memory is every so often, outside the timing.
+        if (i % 1024u == 1023u)
+        {
+            fragmentation.push_back(heap.GetFragmentation());
+        }
+    }
+
+    m_heapOperationSeconds = m_settings.heapOperationCount ? seconds / static_cast<double>(m_settings.heapOperationCount) : 0.0;
+    if (!fragmentation.empty())
+    {
+        const PercentileType percentiles = GetPercentiles(fragmentation);
+        m_heapFragmentation     = percentiles.p50;
+        m_heapPeakFragmentation = percentiles.max;
+    }
+}
+
+
+void BenchmarkClass::RunMeshOptimizer()
+{
+    // Build a gently rolling grid with about as many triangles as asked for, and shuffle them, the
+    // way content exported without any care for the GPU might come out.  The seed is fixed, so
+    // every run starts from the same order.
+    const UINT side = static_cast<UINT>(std::ceil(std::sqrt(static_cast<double>(m_settings.meshTriangleCount) / 2.0))) + 1u;
+
+    std::vector<MeshPackerClass::VertexType> vertices(side * side);
+    for (UINT y = 0u; y < side; ++y)
+    {
+        for (UINT x = 0u; x < side; ++x)
+        {
+            MeshPackerClass::VertexType &vertex = vertices[y * side + x];
+            vertex.position = { static_cast<float>(x), static_cast<float>(y), 4.0f * std::sin(0.1f * static_cast<float>(x)) * std::cos(0.1f * static_cast<float>(y)) };
+            vertex.color    = { 1.0f, 1.0f, 1.0f, 1.0f };
+        }
+    }
+
+    std::vector<UINT> triangles((side - 1u) * (side - 1u) * 2u);
+    for (UINT i = 0u; i < triangles.size(); ++i)
+    {
+        triangles[i] = i;
+    }
+    std::mt19937 generator(61u);
+    std::shuffle(triangles.begin(), triangles.end(), generator);
+
+    std::vector<uint32_t> indices;
+    indices.reserve(triangles.size() * 3u);
+    for (UINT triangle : triangles)
+    {
+        // Each cell of the grid is split into two triangles along the same diagonal.
+        const UINT cell   = triangle / 2u;
+        const UINT corner = (cell / (side - 1u)) * side + cell % (side - 1u);
+        if (triangle % 2u == 0u)
+        {
+            indices.insert(indices.end(), { corner, corner + 1u, corner + side });
+        }
+        else
+        {
+            indices.insert(indices.end(), { corner + 1u, corner + side + 1u, corner + side });
+        }
+    }
+
+    m_meshTriangles   = static_cast<UINT>(triangles.size());
+    m_meshCacheBefore = MeshOptimizerClass::AnalyzeVertexCache(indices, static_cast<UINT>(vertices.size()));
+
+    // Time each step on its own.  The mesh is large enough that a single run of each is steady.
+    auto start = std::chrono::steady_clock::now();
+    MeshOptimizerClass::OptimizeVertexCache(indices, static_cast<UINT>(vertices.size()));
+    auto end = std::chrono::steady_clock::now();
+    m_vertexCacheSeconds = std::chrono::duration<double>(end - start).count();
+
+    start = end;
+    MeshOptimizerClass::OptimizeOverdraw(indices, vertices);
+    end = std::chrono::steady_clock::now();
+    m_overdrawSeconds = std::chrono::duration<double>(end - start).count();
+
+    start = end;
+    MeshOptimizerClass::OptimizeVertexFetch(vertices, indices);
+    end = std::chrono::steady_clock::now();
+    m_vertexFetchSeconds = std::chrono::duration<double>(end - start).count();
+
+    m_meshVertices   = static_cast<UINT>(vertices.size());
+    m_meshCacheAfter = MeshOptimizerClass::AnalyzeVertexCache(indices, m_meshVertices);
+
+    // Save the optimized mesh as an asset, for the loader to map back in later.
+    MeshAssetClass::Save(m_settings.meshFilename, MeshPackerClass::Pack(vertices, indices));
+}
+
+
+void BenchmarkClass::RunFrames()
+{
+    m_Engine = std::make_unique<EngineClass>(m_settings.xResolution, m_settings.yResolution, m_settings.framesInFlight, m_settings.scene, m_settings.device);
+
+    // Show the loading screen until startup is done, then give the scene some frames to finish its
+    // uploads and settle before anything is timed.
+    UINT warmupFrames = 0u;
+    while (!m_Engine->IsSceneReady() || warmupFrames < m_settings.warmupFrameCount)
+    {
+        MoveCamera(0u);
+        m_Engine->Frame();
+        warmupFrames += m_Engine->IsSceneReady() ? 1u : 0u;
+    }
+
+    m_frameSeconds.reserve(m_settings.frameCount);
+    m_cpuSeconds.reserve(m_settings.frameCount);
+    m_frameAllocations.reserve(m_settings.frameCount);
+
+    // Time every frame on its own.  The CPU time leaves out the wait for the swap chain and the
+    // GPU at the start of the frame, and the allocations count those of every thread.
+    const auto start = std::chrono::steady_clock::now();
+    for (UINT frame = 0u; frame < m_settings.frameCount; ++frame)
+    {
+        MoveCamera(frame);
+
+        const uint64_t allocations = GetAllocationCount();
+        const auto     frameStart  = std::chrono::steady_clock::now();
+        m_Engine->Frame();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - frameStart).count();
+
+        m_frameSeconds.push_back(seconds);
+        m_cpuSeconds.push_back(seconds - m_Engine->GetWaitSeconds());
+        m_frameAllocations.push_back(static_cast<double>(GetAllocationCount() - allocations));
+
+#ifdef _DEBUG
+        // Once warmed up, a frame is expected to run entirely out of memory it already owns.
+        THROW_IF_TRUE(
+            m_frameAllocations.back() != 0.0,
+            "A frame allocated from the heap after the warm-up."
+        );
+#endif // _DEBUG
+    }
+    m_totalSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    m_statistics = m_Engine->GetStatistics();
+}
+
+
+void BenchmarkClass::CountCommands()
+{
+    // Record one more frame into a capture and count the commands in it.  Capturing records the
+    // workers one after another, so this frame is kept out of the timings.
+    m_Engine->CaptureFrame(m_settings.captureFilename);
+    m_Engine->Frame();
+
+    CommandStreamClass stream;
+    stream.Load(m_settings.captureFilename);
+    m_commandCounts = stream.GetCommandCounts();
+}
+
+
+void BenchmarkClass::RunMeshLoader()
+{
+    // Give the loads a ring and a pool of their own, each with room for two copies of the mesh, so
+    // neither ever has to wait on the GPU or search for space in the middle of a load.
+    UINT64                     assetSize = 0ull;
+    MeshAssetClass::HeaderType header;
+    {
+        MeshAssetClass asset(m_settings.meshFilename);
+        assetSize = asset.GetSize();
+        header    = asset.GetHeader();
+    }
+    const UINT64 vertexBytes = static_cast<UINT64>(header.vertexCount) * header.vertexStride;
+    const UINT64 indexBytes  = static_cast<UINT64>(header.indexCount) * MeshPackerClass::GetIndexSize(static_cast<DXGI_FORMAT>(header.indexFormat));
+
+    UploadRingClass   uploader(m_Engine->GetAllocator(), 2ull * assetSize);
+    GeometryPoolClass pool(m_Engine->GetAllocator(), &uploader, 2u * header.vertexCount, static_cast<UINT>(2ull * indexBytes));
+
+    // Time mapping the asset and copying it into the upload ring, which is everything a load does
+    // on the CPU.  The file was just written, so it comes from the system's cache rather than the
+    // disk.  Sending the copies and waiting for them are left out.
+    std::vector<double> loadSeconds;
+    for (UINT run = 0u; run < MESH_LOAD_RUN_COUNT; ++run)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        GeometryPoolClass::MeshType mesh;
+        {
+            MeshAssetClass asset(m_settings.meshFilename);
+            mesh = pool.AddMesh(asset.GetMeshData());
+        }
+        loadSeconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+        uploader.Flush();
+        uploader.WaitForIdle();
+        pool.RemoveMesh(mesh);
+    }
+
+    m_meshLoadBytes   = vertexBytes + indexBytes;
+    m_meshLoadSeconds = GetPercentiles(loadSeconds).p50;
+}
+
+
+void BenchmarkClass::MoveCamera(UINT frame)
+{
+    // Sweep across the scene and back once over the run while moving in and out, so the visible
+    // set and the order of the draws change every frame, the same way on every run.
+    const float phase    = 6.28318531f * static_cast<float>(frame) / static_cast<float>(m_settings.frameCount);
+    const float extent   = m_Engine->GetSceneExtent();
+    const float x        = 0.5f * extent * std::sin(phase);
+    const float y        = 0.25f * extent * std::sin(2.0f * phase);
+    const float distance = 10.0f + extent * (2.0f + 0.5f * std::cos(phase));
+
+    CameraClass *camera = m_Engine->GetCamera();
+    camera->SetPosition(x, y, -distance);
+    camera->SetLookDirection(-x, -y, distance);
+}
+
+
+void BenchmarkClass::SaveResults()
+{
+    const PercentileType frameMs     = GetPercentiles(m_frameSeconds);
+    const PercentileType cpuMs       = GetPercentiles(m_cpuSeconds);
+
+    auto appendPercentiles = [](std::string &json, const char *name, const PercentileType &percentiles, double scale)
+    {
+        AppendFormat(json, "    \"%s\": { \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"mean\": %.4f, \"max\": %.4f },\n",
+                     name,
+                     percentiles.p50 * scale, percentiles.p95 * scale, percentiles.p99 * scale,
+                     percentiles.mean * scale, percentiles.max * scale);
+    };
+    auto appendStateChanges = [](std::string &json, const char *name, const RenderQueueClass::StateChangeType &changes)
+    {
+        AppendFormat(json, "    \"%s\": { \"rootSignatures\": %u, \"states\": %u, \"vertexBuffers\": %u },\n",
+                     name, changes.rootSignatures, changes.states, changes.vertexBuffers);
+    };
+
+    std::string json = "{\n";
+
+    AppendFormat(json, "  \"settings\": {\n");
+    AppendFormat(json, "    \"device\": \"%s\",\n", m_settings.device == EngineClass::DeviceType::Null ? "null" : "warp");
+    AppendFormat(json, "    \"frames\": %u,\n", m_settings.frameCount);
+    AppendFormat(json, "    \"warmupFrames\": %u,\n", m_settings.warmupFrameCount);
+    AppendFormat(json, "    \"width\": %u,\n", m_settings.xResolution);
+    AppendFormat(json, "    \"height\": %u,\n", m_settings.yResolution);
+    AppendFormat(json, "    \"framesInFlight\": %u,\n", m_settings.framesInFlight);
+    AppendFormat(json, "    \"quads\": %u,\n", m_settings.scene.quadCount);
+    AppendFormat(json, "    \"triangles\": %u,\n", m_settings.scene.triangleCount);
+    AppendFormat(json, "    \"instancesPerQuad\": %u,\n", m_settings.scene.instancesPerQuad);
+    AppendFormat(json, "    \"culling\": \"%s\"\n", m_settings.scene.gpuCulling ? "gpu" : "cpu");
+    AppendFormat(json, "  },\n");
+
+    AppendFormat(json, "  \"frames\": {\n");
+    AppendFormat(json, "    \"count\": %u,\n", m_settings.frameCount);
+    AppendFormat(json, "    \"seconds\": %.4f,\n", m_totalSeconds);
+    AppendFormat(json, "    \"framesPerSecond\": %.2f,\n", m_totalSeconds > 0.0 ? m_settings.frameCount / m_totalSeconds : 0.0);
+    appendPercentiles(json, "frameMs", frameMs, 1000.0);
+    appendPercentiles(json, "cpuMs", cpuMs, 1000.0);
+#ifdef BENCHMARK_COUNT_ALLOCATIONS
+    appendPercentiles(json, "allocations", GetPercentiles(m_frameAllocations), 1.0);
+#endif // BENCHMARK_COUNT_ALLOCATIONS
+    AppendFormat(json, "    \"timeToFirstFrameMs\": %.3f,\n", m_Engine->GetTimeToFirstFrame() * 1000.0);
+    AppendFormat(json, "    \"timeToFirstSceneFrameMs\": %.3f\n", m_Engine->GetTimeToFirstSceneFrame() * 1000.0);
+    AppendFormat(json, "  },\n");
+
+    AppendFormat(json, "  \"draws\": {\n");
+    AppendFormat(json, "    \"packets\": %u,\n", m_statistics.packetCount);
+    appendStateChanges(json, "stateChanges", m_statistics.stateChanges);
+    AppendFormat(json, "    \"binds\": %u,\n", m_statistics.bindCount);
+    AppendFormat(json, "    \"elidedBinds\": %u,\n", m_statistics.elidedCount);
+    AppendFormat(json, "    \"sortMs\": %.4f\n", m_statistics.sortSeconds * 1000.0);
+    AppendFormat(json, "  },\n");
+
+    AppendFormat(json, "  \"commands\": {\n");
+    for (size_t i = 0; i < m_commandCounts.size(); ++i)
+    {
+        AppendFormat(json, "    \"%s\": %llu%s\n",
+                     CommandStreamClass::GetCommandName(static_cast<CommandStreamClass::CommandType>(i)),
+                     static_cast<unsigned long long>(m_commandCounts[i]),
+                     i + 1 < m_commandCounts.size() ? "," : "");
+    }
+    AppendFormat(json, "  },\n");
+
+    AppendFormat(json, "  \"profile\": [\n");
+    const std::vector<ProfilerClass::SummaryType> summary = m_Engine->GetProfiler()->GetSummary();
+    for (size_t i = 0; i < summary.size(); ++i)
+    {
+        AppendFormat(json, "    { \"name\": \"%s\", \"track\": \"%s\", \"samples\": %u, \"p50Ms\": %.4f, \"p95Ms\": %.4f, \"p99Ms\": %.4f }%s\n",
+                     summary[i].name.c_str(),
+                     summary[i].track == ProfilerClass::TrackType::Gpu ? "gpu" : "cpu",
+                     summary[i].count,
+                     summary[i].p50, summary[i].p95, summary[i].p99,
+                     i + 1 < summary.size() ? "," : "");
+    }
+    AppendFormat(json, "  ],\n");
+
+    AppendFormat(json, "  \"renderQueue\": {\n");
+    AppendFormat(json, "    \"packets\": %u,\n", m_settings.sortPacketCount);
+    appendStateChanges(json, "unsortedStateChanges", m_unsortedStateChanges);
+    appendStateChanges(json, "sortedStateChanges", m_sortedStateChanges);
+    AppendFormat(json, "    \"sortMs\": %.4f\n", m_sortSeconds * 1000.0);
+    AppendFormat(json, "  },\n");
+
+    AppendFormat(json, "  \"culler\": {\n");
+    AppendFormat(json, "    \"instances\": %u,\n", m_settings.cullInstanceCount);
+    AppendFormat(json, "    \"visible\": %u,\n", m_visibleInstances);
+    AppendFormat(json, "    \"instancesPerSecond\": %.0f\n", m_instancesPerSecond);
+    AppendFormat(json, "  },\n");
+
+    AppendFormat(json, "  \"renderGraph\": {\n");
+    AppendFormat(json, "    \"passes\": %u,\n", m_graphStatistics.passCount);
+    AppendFormat(json, "    \"culledPasses\": %u,\n", m_graphStatistics.culledCount);
+    AppendFormat(json, "    \"barriers\": %u,\n", m_graphStatistics.barrierCount);
+    AppendFormat(json, "    \"transients\": %u,\n", m_graphStatistics.transientCount);
+    AppendFormat(json, "    \"transientMB\": %.1f,\n", static_cast<double>(m_graphStatistics.transientBytes) / (1024.0 * 1024.0));
+    AppendFormat(json, "    \"aliasedHeapMB\": %.1f,\n", static_cast<double>(m_graphStatistics.heapBytes) / (1024.0 * 1024.0));
+    AppendFormat(json, "    \"compileMs\": %.4f,\n", m_graphStatistics.compileSeconds * 1000.0);
+    AppendFormat(json, "    \"executeMs\": %.4f\n", m_graphExecuteSeconds * 1000.0);
+    AppendFormat(json, "  },\n");
+
+    AppendFormat(json, "  \"heapAllocator\": {\n");
+    AppendFormat(json, "    \"operations\": %u,\n", m_settings.heapOperationCount);
+    AppendFormat(json, "    \"nsPerOperation\": %.1f,\n", m_heapOperationSeconds * 1'000'000'000.0);
+    AppendFormat(json, "    \"fragmentation\": %.4f,\n", m_heapFragmentation);
+    AppendFormat(json, "    \"peakFragmentation\": %.4f,\n", m_heapPeakFragmentation);
+    AppendFormat(json, "    \"fragmentedFailures\": %u\n", m_heapFailures);
+    AppendFormat(json, "  },\n");
+
+    AppendFormat(json, "  \"meshOptimizer\": {\n");
+    AppendFormat(json, "    \"triangles\": %u,\n", m_meshTriangles);
+    AppendFormat(json, "    \"vertices\": %u,\n", m_meshVertices);
+    AppendFormat(json, "    \"acmrBefore\": %.3f,\n", m_meshCacheBefore.acmr);
+    AppendFormat(json, "    \"atvrBefore\": %.3f,\n", m_meshCacheBefore.atvr);
+    AppendFormat(json, "    \"acmrAfter\": %.3f,\n", m_meshCacheAfter.acmr);
+    AppendFormat(json, "    \"atvrAfter\": %.3f,\n", m_meshCacheAfter.atvr);
+    AppendFormat(json, "    \"vertexCacheMs\": %.1f,\n", m_vertexCacheSeconds * 1000.0);
+    AppendFormat(json, "    \"overdrawMs\": %.1f,\n", m_overdrawSeconds * 1000.0);
+    AppendFormat(json, "    \"vertexFetchMs\": %.1f\n", m_vertexFetchSeconds * 1000.0);
+    AppendFormat(json, "  },\n");
+
+    AppendFormat(json, "  \"meshLoad\": {\n");
+    AppendFormat(json, "    \"bytes\": %llu,\n", static_cast<unsigned long long>(m_meshLoadBytes));
+    AppendFormat(json, "    \"loadMs\": %.3f,\n", m_meshLoadSeconds * 1000.0);
+    AppendFormat(json, "    \"gbPerSecond\": %.2f\n", m_meshLoadSeconds > 0.0 ? static_cast<double>(m_meshLoadBytes) / m_meshLoadSeconds / 1'000'000'000.0 : 0.0);
+    AppendFormat(json, "  }\n");
+
+    json += "}\n";
+
+    // Open the file for writing, replacing the results of any earlier run.
+    HANDLE file = CreateFileW(m_settings.outputFilename.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    THROW_IF_TRUE(
+        file == INVALID_HANDLE_VALUE,
+        "Unable to create the benchmark results file."
+    );
+
+    DWORD written = 0u;
+    const BOOL result = WriteFile(file, json.data(), static_cast<DWORD>(json.size()), &written, nullptr);
+    CloseHandle(file);
+
+    THROW_IF_FALSE(
+        result,
+        "Unable to write the benchmark results file."
+    );
+}
+
+
+BenchmarkClass::PercentileType BenchmarkClass::GetPercentiles(std::vector<double> samples)
+{
+    PercentileType percentiles;
+    if (samples.empty())
+    {
+        return percentiles;
+    }
+
+    // Take each percentile by its nearest rank in the sorted samples.
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](double fraction)
+    {
+        const size_t rank = static_cast<size_t>(std::ceil(fraction * static_cast<double>(samples.size())));
+        return samples[rank ? rank - 1u : 0u];
+    };
+
+    double total = 0.0;
+    for (double sample : samples)
+    {
+        total += sample;
+    }
+
+    percentiles.p50  = percentile(0.50);
+    percentiles.p95  = percentile(0.95);
+    percentiles.p99  = percentile(0.99);
+    percentiles.mean = total / static_cast<double>(samples.size());
+    percentiles.max  = samples.back();
+    return percentiles;
+}
+
+
+void BenchmarkClass::AppendFormat(std::string &text, const char *format, ...)
+{
+    char line[512];
+
+    va_list arguments;
+    va_start(arguments, format);
+    vsnprintf(line, sizeof(line), format, arguments);
+    va_end(arguments);
+
+    text += line;
+}
@@ -0,0 +1,135 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: benchmarkclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <shellapi.h>
+#include <climits>
+#include <cstdarg>
+#include <random>
+#include "engineclass.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: BenchmarkClass
+////////////////////////////////////////////////////////////////////////////////
+class BenchmarkClass
+{
+public:
+    struct SettingsType
+    {
+        UINT                    frameCount         = 600u;
+        UINT                    warmupFrameCount   = 60u;
+        UINT                    xResolution        = 1280u;
+        UINT                    yResolution        = 720u;
+        UINT                    framesInFlight     = 2u;
+        EngineClass::SceneType  scene              = {};
+        EngineClass::DeviceType device             = EngineClass::DeviceType::Warp;
+        UINT                    sortPacketCount    = 100'000u;
+        UINT                    cullInstanceCount  = 1'000'000u;
+        UINT                    graphPassCount     = 500u;
+        UINT                    heapOperationCount = 1'000'000u;
+        UINT                    meshTriangleCount  = 1'000'000u;
+        std::wstring            outputFilename     = L"benchmark.json";
+        std::wstring            captureFilename    = L"benchmark.dccs";
+        std::wstring            meshFilename       = L"benchmark.dxmesh";
+    };
+
+private:
+    struct PercentileType
+    {
+        double p50  = 0.0;
+        double p95  = 0.0;
+        double p99  = 0.0;
+        double mean = 0.0;
+        double max  = 0.0;
+    };
+
+public:
+    BenchmarkClass() = delete;
+    BenchmarkClass(const BenchmarkClass &) = delete;
+    BenchmarkClass & operator=(const BenchmarkClass &) = delete;
+
+    BenchmarkClass(const SettingsType &);
+    ~BenchmarkClass() = default;
+
+    static bool ParseCommandLine(SettingsType &);
+    static uint64_t GetAllocationCount();
+
+    void Run();
+
+private:
+    void RunRenderQueue();
+    void RunCuller();
+    void RunRenderGraph();
+    void RunTransients();
+    UINT BuildRenderGraph(RenderGraphClass &, ID3D12Device *);
+    void RunHeapAllocator();
+    void RunMeshOptimizer();
+    void RunFrames();
+    void CountCommands();
+    void RunMeshLoader();
+
+    void MoveCamera(UINT);
+
+    void SaveResults();
+
+    static PercentileType GetPercentiles(std::vector<double>);
+    static void AppendFormat(std::string &, const char *, ...);
+
+private:
+    // The render queue and the culler are run this many times, and the median run is reported.
+    static constexpr UINT SORT_RUN_COUNT = 11u;
+    static constexpr UINT CULL_RUN_COUNT = 11u;
+    static constexpr UINT GRAPH_RUN_COUNT = 11u;
+    static constexpr UINT MESH_LOAD_RUN_COUNT = 11u;
+
+    const SettingsType m_settings = {};
+
+    std::unique_ptr<EngineClass> m_Engine = nullptr;
+
+    // The frame loop.
+    std::vector<double>         m_frameSeconds     = {};
+    std::vector<double>         m_cpuSeconds       = {};
+    std::vector<double>         m_frameAllocations = {};
+    double                      m_totalSeconds     = 0.0;
+    EngineClass::StatisticsType m_statistics       = {};
+
+    std::array<uint64_t, static_cast<size_t>(CommandStreamClass::CommandType::Count)> m_commandCounts = {};
+
+    // The render queue on its own.
+    double                            m_sortSeconds          = 0.0;
+    RenderQueueClass::StateChangeType m_unsortedStateChanges = {};
+    RenderQueueClass::StateChangeType m_sortedStateChanges   = {};
+
+    // The culler on its own.
+    double m_instancesPerSecond = 0.0;
+    UINT   m_visibleInstances   = 0u;
+
+    // Compiling a large render graph, and running it once on the device.
+    RenderGraphClass::StatisticsType m_graphStatistics     = {};
+    double                           m_graphExecuteSeconds = 0.0;
+
+    // Placing and freeing buffers in a heap at random.
+    double m_heapOperationSeconds  = 0.0;
+    double m_heapFragmentation     = 0.0;
+    double m_heapPeakFragmentation = 0.0;
+    UINT   m_heapFailures          = 0u;
+
+    // Optimizing one large mesh.
+    UINT                                    m_meshTriangles      = 0u;
+    UINT                                    m_meshVertices       = 0u;
+    MeshOptimizerClass::CacheStatisticsType m_meshCacheBefore    = {};
+    MeshOptimizerClass::CacheStatisticsType m_meshCacheAfter     = {};
+    double                                  m_vertexCacheSeconds = 0.0;
+    double                                  m_overdrawSeconds    = 0.0;
+    double                                  m_vertexFetchSeconds = 0.0;
+
+    // Loading that mesh back from its asset into the upload ring.
+    UINT64 m_meshLoadBytes   = 0ull;
+    double m_meshLoadSeconds = 0.0;
+};
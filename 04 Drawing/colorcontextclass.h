@@ -8,6 +8,7 @@
 // INCLUDES //
 //////////////
 #include "rendercontextinterface.h"
+#include "meshpackerclass.h"
 
 
 /////////////
@@ -27,10 +28,11 @@ public:
     ColorContextClass(const ColorContextClass &) = delete;
     ColorContextClass& operator=(const ColorContextClass &) = delete;
 
-    ColorContextClass(ID3D12Device *, const UINT &, const XMMATRIX &, const XMMATRIX &, UINT, UINT);
+    ColorContextClass(ID3D12Device *, ConstantArenaClass *, PipelineCacheClass *, const XMMATRIX &, const XMMATRIX &, UINT, UINT);
     ~ColorContextClass() = default;
 
-    void SetShaderParameters(ID3D12GraphicsCommandList *) override;
+    void UpdateShaderParameters() override;
+    void SetShaderParameters(PipelineClass *) override;
 
 protected:
     void InitializeRootSignature(ID3D12Device *) override;
@@ -38,9 +40,4 @@ protected:
     void SetInputLayoutDesc() override;
 
     void NameD3DResources() override;
-
-private:
-    ConstantBufferType m_matrixBuffer = {};
-
-    XMMATRIX m_worldMatrix = XMMatrixIdentity();
 };
@@ -0,0 +1,1334 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: commandstreamclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "commandstreamclass.h"
+
+
+const GUID CommandStreamClass::RECIPE_GUID = { 0x6d1a4c3eu, 0x92b7u, 0x4f0eu, { 0xa5u, 0x1cu, 0x3bu, 0x8eu, 0x27u, 0xd4u, 0x90u, 0x6fu } };
+
+
+const BYTE * CommandStreamClass::RecipeReaderType::Read(size_t bytes)
+{
+    THROW_IF_TRUE(
+        bytes > size - offset,
+        "An object recipe in the command stream is truncated."
+    );
+
+    const BYTE *piece = data + offset;
+    offset += bytes;
+    return piece;
+}
+
+
+const BYTE * CommandStreamClass::RecipeReaderType::ReadBytes(size_t &bytes)
+{
+    // Byte ranges are stored with their size in front.
+    bytes = static_cast<size_t>(Read<uint64_t>());
+    return bytes ? Read(bytes) : nullptr;
+}
+
+
+const char * CommandStreamClass::RecipeReaderType::ReadString()
+{
+    // Strings keep their terminator, so they can be pointed at where they are.  A missing string
+    // is stored empty.
+    size_t bytes = 0ull;
+    const BYTE *string = ReadBytes(bytes);
+    THROW_IF_TRUE(
+        bytes && string[bytes - 1ull] != '\0',
+        "An object recipe in the command stream has an unterminated string."
+    );
+    return reinterpret_cast<const char *>(string);
+}
+
+
+D3D12_SHADER_BYTECODE CommandStreamClass::RecipeReaderType::ReadShader()
+{
+    D3D12_SHADER_BYTECODE shader{};
+    shader.pShaderBytecode = ReadBytes(shader.BytecodeLength);
+    return shader;
+}
+
+
+CommandStreamClass::~CommandStreamClass()
+{
+    // Release the file mapping if we were replaying from disk.
+    Unmap();
+}
+
+
+void CommandStreamClass::Clear()
+{
+    // Drop everything recorded or loaded so far, but keep the memory around for the next frame.
+    Unmap();
+    m_commands.clear();
+    m_objects.clear();
+    m_commandCount = 0ull;
+
+    // Objects created for a loaded stream go with it.
+    m_replayObjects.clear();
+    m_renderTargetViewHeap.Reset();
+    m_depthStencilViewHeap.Reset();
+}
+
+
+void CommandStreamClass::RecordSetPipelineState(ID3D12PipelineState *state)
+{
+    Record(CommandType::SetPipelineState, AddObject(ObjectKindType::PipelineState, state));
+}
+
+
+void CommandStreamClass::RecordSetRootSignature(ID3D12RootSignature *rootSignature)
+{
+    Record(CommandType::SetRootSignature, AddObject(ObjectKindType::RootSignature, rootSignature));
+}
+
+
+void CommandStreamClass::RecordSetRootConstantBufferView(UINT index, D3D12_GPU_VIRTUAL_ADDRESS address)
+{
+    RootConstantBufferViewType payload;
+    payload.index   = index;
+    payload.address = address;
+    Record(CommandType::SetRootConstantBufferView, payload);
+}
+
+
+void CommandStreamClass::RecordSetRootShaderResourceView(UINT index, D3D12_GPU_VIRTUAL_ADDRESS address)
+{
+    // A root shader resource view has the same arguments as a root constant buffer view.
+    RootConstantBufferViewType payload;
+    payload.index   = index;
+    payload.address = address;
+    Record(CommandType::SetRootShaderResourceView, payload);
+}
+
+
+void CommandStreamClass::RecordSetRoot32BitConstant(UINT index, UINT value, UINT offset)
+{
+    RootConstantType payload;
+    payload.index  = index;
+    payload.value  = value;
+    payload.offset = offset;
+    Record(CommandType::SetRoot32BitConstant, payload);
+}
+
+
+void CommandStreamClass::RecordResourceBarrier(UINT count, const D3D12_RESOURCE_BARRIER *barriers)
+{
+    // Barriers name their resources by index in the object table, so they are rewritten first.  A
+    // transition also tells us the state its resource was in before this frame.
+    m_barriers.resize(count);
+    for (UINT i = 0u; i < count; ++i)
+    {
+        const D3D12_RESOURCE_BARRIER &barrier = barriers[i];
+
+        BarrierType &entry = m_barriers[i];
+        entry               = BarrierType();
+        entry.type          = barrier.Type;
+        entry.flags         = barrier.Flags;
+        entry.resourceAfter = NO_OBJECT;
+
+        switch (barrier.Type)
+        {
+        case D3D12_RESOURCE_BARRIER_TYPE_TRANSITION:
+            entry.resource    = AddResource(barrier.Transition.pResource, &barrier.Transition.StateBefore);
+            entry.subresource = barrier.Transition.Subresource;
+            entry.stateBefore = barrier.Transition.StateBefore;
+            entry.stateAfter  = barrier.Transition.StateAfter;
+            break;
+
+        case D3D12_RESOURCE_BARRIER_TYPE_ALIASING:
+            entry.resource      = AddResource(barrier.Aliasing.pResourceBefore, nullptr);
+            entry.resourceAfter = AddResource(barrier.Aliasing.pResourceAfter, nullptr);
+            break;
+
+        case D3D12_RESOURCE_BARRIER_TYPE_UAV:
+            entry.resource = AddResource(barrier.UAV.pResource, nullptr);
+            break;
+        }
+    }
+
+    // The barrier count is followed by the barriers themselves.
+    Record(CommandType::ResourceBarrier, &count, sizeof(UINT), m_barriers.data(), count * sizeof(BarrierType));
+}
+
+
+void CommandStreamClass::RecordSetViewport(const D3D12_VIEWPORT &viewport, const D3D12_RECT &scissorRect)
+{
+    ViewportType payload;
+    payload.viewport    = viewport;
+    payload.scissorRect = scissorRect;
+    Record(CommandType::SetViewport, payload);
+}
+
+
+void CommandStreamClass::RecordSetRenderTargets(D3D12_CPU_DESCRIPTOR_HANDLE renderTarget, D3D12_CPU_DESCRIPTOR_HANDLE depthStencil)
+{
+    RenderTargetsType payload;
+    payload.renderTarget = renderTarget;
+    payload.depthStencil = depthStencil;
+    Record(CommandType::SetRenderTargets, payload);
+}
+
+
+void CommandStreamClass::RecordClearRenderTarget(D3D12_CPU_DESCRIPTOR_HANDLE renderTarget, const float *color)
+{
+    ClearRenderTargetType payload;
+    payload.renderTarget = renderTarget;
+    memcpy(payload.color, color, sizeof(payload.color));
+    Record(CommandType::ClearRenderTarget, payload);
+}
+
+
+void CommandStreamClass::RecordClearDepthStencil(D3D12_CPU_DESCRIPTOR_HANDLE depthStencil)
+{
+    Record(CommandType::ClearDepthStencil, depthStencil);
+}
+
+
+void CommandStreamClass::RecordSetVertexBuffers(UINT startSlot, UINT count, const D3D12_VERTEX_BUFFER_VIEW *views)
+{
+    // The slot range is followed by the views themselves.
+    VertexBuffersType payload;
+    payload.startSlot = startSlot;
+    payload.count     = count;
+    Record(CommandType::SetVertexBuffers, &payload, sizeof(payload), views, count * sizeof(D3D12_VERTEX_BUFFER_VIEW));
+}
+
+
+void CommandStreamClass::RecordSetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW &view)
+{
+    Record(CommandType::SetIndexBuffer, view);
+}
+
+
+void CommandStreamClass::RecordSetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY topology)
+{
+    Record(CommandType::SetPrimitiveTopology, topology);
+}
+
+
+void CommandStreamClass::RecordDrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, INT baseVertex, UINT startInstance)
+{
+    DrawIndexedInstancedType payload;
+    payload.indexCount    = indexCount;
+    payload.instanceCount = instanceCount;
+    payload.startIndex    = startIndex;
+    payload.baseVertex    = baseVertex;
+    payload.startInstance = startInstance;
+    Record(CommandType::DrawIndexedInstanced, payload);
+}
+
+
+void CommandStreamClass::RecordSetComputeRootSignature(ID3D12RootSignature *rootSignature)
+{
+    Record(CommandType::SetComputeRootSignature, AddObject(ObjectKindType::RootSignature, rootSignature));
+}
+
+
+void CommandStreamClass::RecordSetComputeRootConstantBufferView(UINT index, D3D12_GPU_VIRTUAL_ADDRESS address)
+{
+    RootConstantBufferViewType payload;
+    payload.index   = index;
+    payload.address = address;
+    Record(CommandType::SetComputeRootConstantBufferView, payload);
+}
+
+
+void CommandStreamClass::RecordSetComputeRootShaderResourceView(UINT index, D3D12_GPU_VIRTUAL_ADDRESS address)
+{
+    RootConstantBufferViewType payload;
+    payload.index   = index;
+    payload.address = address;
+    Record(CommandType::SetComputeRootShaderResourceView, payload);
+}
+
+
+void CommandStreamClass::RecordSetComputeRootUnorderedAccessView(UINT index, D3D12_GPU_VIRTUAL_ADDRESS address)
+{
+    RootConstantBufferViewType payload;
+    payload.index   = index;
+    payload.address = address;
+    Record(CommandType::SetComputeRootUnorderedAccessView, payload);
+}
+
+
+void CommandStreamClass::RecordDispatch(UINT x, UINT y, UINT z)
+{
+    DispatchType payload;
+    payload.x = x;
+    payload.y = y;
+    payload.z = z;
+    Record(CommandType::Dispatch, payload);
+}
+
+
+void CommandStreamClass::RecordCopyBufferRegion(ID3D12Resource *destination, UINT64 destinationOffset, ID3D12Resource *source, UINT64 sourceOffset, UINT64 size)
+{
+    CopyBufferRegionType payload;
+    payload.destination       = AddResource(destination, nullptr);
+    payload.source            = AddResource(source, nullptr);
+    payload.destinationOffset = destinationOffset;
+    payload.sourceOffset      = sourceOffset;
+    payload.size              = size;
+    Record(CommandType::CopyBufferRegion, payload);
+}
+
+
+void CommandStreamClass::RecordExecuteIndirect(ID3D12CommandSignature *signature, UINT maxCount, ID3D12Resource *argumentBuffer, UINT64 argumentOffset)
+{
+    ExecuteIndirectType payload;
+    payload.signature      = AddObject(ObjectKindType::CommandSignature, signature);
+    payload.maxCount       = maxCount;
+    payload.argumentBuffer = AddResource(argumentBuffer, nullptr);
+    payload.argumentOffset = argumentOffset;
+    Record(CommandType::ExecuteIndirect, payload);
+}
+
+
+void CommandStreamClass::RecordDiscardResource(ID3D12Resource *resource)
+{
+    Record(CommandType::DiscardResource, AddResource(resource, nullptr));
+}
+
+
+void CommandStreamClass::AddResource(ID3D12Resource *resource)
+{
+    // Buffers the commands only reach by address have to be in the table for replay to find them.
+    AddResource(resource, nullptr);
+}
+
+
+void CommandStreamClass::AddRenderTargetView(D3D12_CPU_DESCRIPTOR_HANDLE handle, ID3D12Resource *resource)
+{
+    AddView(ObjectKindType::RenderTargetView, handle, resource);
+}
+
+
+void CommandStreamClass::AddDepthStencilView(D3D12_CPU_DESCRIPTOR_HANDLE handle, ID3D12Resource *resource)
+{
+    AddView(ObjectKindType::DepthStencilView, handle, resource);
+}
+
+
+void CommandStreamClass::Save(const std::wstring &filename)
+{
+    // Open the file for writing, replacing any earlier capture.
+    HANDLE file = CreateFileW(filename.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    THROW_IF_TRUE(
+        file == INVALID_HANDLE_VALUE,
+        "Unable to create the command stream file."
+    );
+
+    // Write down how each object of the table is created again.  Resources are described by what
+    // they are and where they were, views by their resource and descriptor, and the rest carry a
+    // recipe of their own.
+    std::vector<BYTE> objects;
+    for (const ObjectType &entry : m_objects)
+    {
+        std::vector<BYTE> recipe;
+        switch (entry.kind)
+        {
+        case ObjectKindType::Resource:
+        {
+            ID3D12Resource *resource = static_cast<ID3D12Resource *>(entry.object);
+
+            ResourceRecipeType resourceRecipe;
+            resourceRecipe.desc = resource->GetDesc();
+            if (FAILED(resource->GetHeapProperties(&resourceRecipe.heapProperties, nullptr)))
+            {
+                resourceRecipe.heapProperties.Type = D3D12_HEAP_TYPE_DEFAULT;
+            }
+
+            // Upload and readback resources never leave the state they have to be created in.
+            // Anything else starts where the first barrier found it, or where it decays to.
+            resourceRecipe.state = resourceRecipe.heapProperties.Type == D3D12_HEAP_TYPE_UPLOAD   ? D3D12_RESOURCE_STATE_GENERIC_READ :
+                                   resourceRecipe.heapProperties.Type == D3D12_HEAP_TYPE_READBACK ? D3D12_RESOURCE_STATE_COPY_DEST :
+                                   entry.stateKnown                                               ? entry.state : D3D12_RESOURCE_STATE_COMMON;
+
+            if (resourceRecipe.desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+            {
+                resourceRecipe.address = resource->GetGPUVirtualAddress();
+            }
+            Append(recipe, resourceRecipe);
+            break;
+        }
+
+        case ObjectKindType::RenderTargetView:
+        case ObjectKindType::DepthStencilView:
+        {
+            ViewRecipeType view;
+            view.resource = entry.resource;
+            view.handle   = static_cast<uint64_t>(entry.handle.ptr);
+            Append(recipe, view);
+            break;
+        }
+
+        default:
+            recipe = GetRecipe(entry.object);
+            break;
+        }
+
+        ObjectHeaderType objectHeader;
+        objectHeader.kind = entry.kind;
+        objectHeader.size = static_cast<uint32_t>((recipe.size() + COMMAND_ALIGNMENT - 1ull) & ~(COMMAND_ALIGNMENT - 1ull));
+
+        const size_t offset = objects.size();
+        Append(objects, objectHeader);
+        Append(objects, recipe.data(), recipe.size());
+        objects.resize(offset + sizeof(ObjectHeaderType) + objectHeader.size, 0u);
+    }
+
+    // Describe the stream so the loader can validate it before mapping the commands.
+    StreamHeaderType header;
+    header.magic        = STREAM_MAGIC;
+    header.version      = STREAM_VERSION;
+    header.commandCount = m_commandCount;
+    header.byteCount    = GetCommandBytes();
+    header.objectCount  = m_objects.size();
+    header.objectBytes  = objects.size();
+
+    // Write the header, then the commands exactly as they sit in memory, then the object table.
+    DWORD written = 0u;
+    BOOL result = WriteFile(file, &header, sizeof(header), &written, nullptr);
+    if (result && header.byteCount)
+    {
+        result = WriteFile(file, GetCommands(), static_cast<DWORD>(header.byteCount), &written, nullptr);
+    }
+    if (result && header.objectBytes)
+    {
+        result = WriteFile(file, objects.data(), static_cast<DWORD>(header.objectBytes), &written, nullptr);
+    }
+    CloseHandle(file);
+
+    THROW_IF_FALSE(
+        result,
+        "Unable to write the command stream file."
+    );
+}
+
+
+void CommandStreamClass::Load(const std::wstring &filename)
+{
+    // Throw away anything we are currently holding.
+    Clear();
+
+    // Open the capture for reading.
+    m_file = CreateFileW(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    THROW_IF_TRUE(
+        m_file == INVALID_HANDLE_VALUE,
+        "Unable to open the command stream file."
+    );
+
+    // Map the whole file into our address space; the commands are replayed straight from the
+    // mapped pages without being copied.
+    LARGE_INTEGER fileSize{};
+    THROW_IF_FALSE(
+        GetFileSizeEx(m_file, &fileSize),
+        "Unable to read the size of the command stream file."
+    );
+    THROW_IF_TRUE(
+        static_cast<size_t>(fileSize.QuadPart) < sizeof(StreamHeaderType),
+        "The command stream file is too small to contain a header."
+    );
+
+    m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    THROW_IF_TRUE(
+        m_mapping == NULL,
+        "Unable to create a mapping of the command stream file."
+    );
+
+    m_mappedView = static_cast<const BYTE *>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    THROW_IF_TRUE(
+        m_mappedView == nullptr,
+        "Unable to map the command stream file into memory."
+    );
+    m_mappedBytes = static_cast<size_t>(fileSize.QuadPart);
+
+    // Validate the header before trusting any of the commands.
+    const StreamHeaderType *header = reinterpret_cast<const StreamHeaderType *>(m_mappedView);
+    THROW_IF_TRUE(
+        header->magic != STREAM_MAGIC || header->version != STREAM_VERSION,
+        "The command stream file was recorded with an incompatible format."
+    );
+    THROW_IF_TRUE(
+        header->byteCount > m_mappedBytes - sizeof(StreamHeaderType) ||
+        header->objectBytes > m_mappedBytes - sizeof(StreamHeaderType) - header->byteCount,
+        "The command stream file is truncated."
+    );
+
+    m_commandCount = header->commandCount;
+}
+
+
+void CommandStreamClass::Replay(ID3D12GraphicsCommandList *commandList)
+{
+    // A recorded stream replays on the objects it was recorded with.  A loaded one first creates
+    // its objects again on the replaying device, and its addresses and descriptors are moved over
+    // to them as they are replayed.
+    if (m_mappedView && m_replayObjects.size() != reinterpret_cast<const StreamHeaderType *>(m_mappedView)->objectCount)
+    {
+        CreateObjects(commandList);
+    }
+
+    const BYTE *command = GetCommands();
+    const BYTE *end     = command + GetCommandBytes();
+    while (command < end)
+    {
+        const CommandHeaderType *header  = reinterpret_cast<const CommandHeaderType *>(command);
+        const BYTE              *payload = command + sizeof(CommandHeaderType);
+
+        switch (header->type)
+        {
+        case CommandType::SetPipelineState:
+            commandList->SetPipelineState(GetObject<ID3D12PipelineState>(*reinterpret_cast<const uint32_t *>(payload)));
+            break;
+
+        case CommandType::SetRootSignature:
+            commandList->SetGraphicsRootSignature(GetObject<ID3D12RootSignature>(*reinterpret_cast<const uint32_t *>(payload)));
+            break;
+
+        case CommandType::SetRootConstantBufferView:
+        {
+            const RootConstantBufferViewType *args = reinterpret_cast<const RootConstantBufferViewType *>(payload);
+            commandList->SetGraphicsRootConstantBufferView(args->index, GetAddress(args->address));
+            break;
+        }
+
+        case CommandType::SetRootShaderResourceView:
+        {
+            const RootConstantBufferViewType *args = reinterpret_cast<const RootConstantBufferViewType *>(payload);
+            commandList->SetGraphicsRootShaderResourceView(args->index, GetAddress(args->address));
+            break;
+        }
+
+        case CommandType::SetRoot32BitConstant:
+        {
+            const RootConstantType *args = reinterpret_cast<const RootConstantType *>(payload);
+            commandList->SetGraphicsRoot32BitConstant(args->index, args->value, args->offset);
+            break;
+        }
+
+        case CommandType::ResourceBarrier:
+        {
+            // Turn the barriers back into ones naming the objects they stand for.
+            const UINT         count = *reinterpret_cast<const UINT *>(payload);
+            const BarrierType *args  = reinterpret_cast<const BarrierType *>(payload + sizeof(UINT));
+
+            m_replayBarriers.resize(count);
+            for (UINT i = 0u; i < count; ++i)
+            {
+                D3D12_RESOURCE_BARRIER &barrier = m_replayBarriers[i];
+                barrier       = D3D12_RESOURCE_BARRIER{};
+                barrier.Type  = args[i].type;
+                barrier.Flags = args[i].flags;
+
+                switch (args[i].type)
+                {
+                case D3D12_RESOURCE_BARRIER_TYPE_TRANSITION:
+                    barrier.Transition.pResource   = GetObject<ID3D12Resource>(args[i].resource);
+                    barrier.Transition.Subresource = args[i].subresource;
+                    barrier.Transition.StateBefore = args[i].stateBefore;
+                    barrier.Transition.StateAfter  = args[i].stateAfter;
+                    break;
+
+                case D3D12_RESOURCE_BARRIER_TYPE_ALIASING:
+                    barrier.Aliasing.pResourceBefore = GetObject<ID3D12Resource>(args[i].resource);
+                    barrier.Aliasing.pResourceAfter  = GetObject<ID3D12Resource>(args[i].resourceAfter);
+                    break;
+
+                case D3D12_RESOURCE_BARRIER_TYPE_UAV:
+                    barrier.UAV.pResource = GetObject<ID3D12Resource>(args[i].resource);
+                    break;
+                }
+            }
+            commandList->ResourceBarrier(count, m_replayBarriers.data());
+            break;
+        }
+
+        case CommandType::SetViewport:
+        {
+            const ViewportType *args = reinterpret_cast<const ViewportType *>(payload);
+            commandList->RSSetViewports(1, &args->viewport);
+            commandList->RSSetScissorRects(1, &args->scissorRect);
+            break;
+        }
+
+        case CommandType::SetRenderTargets:
+        {
+            const RenderTargetsType          *args         = reinterpret_cast<const RenderTargetsType *>(payload);
+            const D3D12_CPU_DESCRIPTOR_HANDLE renderTarget = GetDescriptor(args->renderTarget);
+            const D3D12_CPU_DESCRIPTOR_HANDLE depthStencil = GetDescriptor(args->depthStencil);
+            commandList->OMSetRenderTargets(1, &renderTarget, FALSE, &depthStencil);
+            break;
+        }
+
+        case CommandType::ClearRenderTarget:
+        {
+            const ClearRenderTargetType *args = reinterpret_cast<const ClearRenderTargetType *>(payload);
+            commandList->ClearRenderTargetView(GetDescriptor(args->renderTarget), args->color, 0u, nullptr);
+            break;
+        }
+
+        case CommandType::ClearDepthStencil:
+            commandList->ClearDepthStencilView(GetDescriptor(*reinterpret_cast<const D3D12_CPU_DESCRIPTOR_HANDLE *>(payload)), D3D12_CLEAR_FLAG_DEPTH, 1.0f, 0u, 0u, nullptr);
+            break;
+
+        case CommandType::SetVertexBuffers:
+        {
+            const VertexBuffersType        *args  = reinterpret_cast<const VertexBuffersType *>(payload);
+            const D3D12_VERTEX_BUFFER_VIEW *views = reinterpret_cast<const D3D12_VERTEX_BUFFER_VIEW *>(payload + sizeof(VertexBuffersType));
+            THROW_IF_TRUE(
+                args->count > D3D12_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT,
+                "The command stream sets more vertex buffers than there are slots."
+            );
+
+            std::array<D3D12_VERTEX_BUFFER_VIEW, D3D12_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT> moved;
+            for (UINT i = 0u; i < args->count; ++i)
+            {
+                moved[i]                = views[i];
+                moved[i].BufferLocation = GetAddress(views[i].BufferLocation);
+            }
+            commandList->IASetVertexBuffers(args->startSlot, args->count, moved.data());
+            break;
+        }
+
+        case CommandType::SetIndexBuffer:
+        {
+            D3D12_INDEX_BUFFER_VIEW view = *reinterpret_cast<const D3D12_INDEX_BUFFER_VIEW *>(payload);
+            view.BufferLocation = GetAddress(view.BufferLocation);
+            commandList->IASetIndexBuffer(&view);
+            break;
+        }
+
+        case CommandType::SetPrimitiveTopology:
+            commandList->IASetPrimitiveTopology(*reinterpret_cast<const D3D12_PRIMITIVE_TOPOLOGY *>(payload));
+            break;
+
+        case CommandType::DrawIndexedInstanced:
+        {
+            const DrawIndexedInstancedType *args = reinterpret_cast<const DrawIndexedInstancedType *>(payload);
+            commandList->DrawIndexedInstanced(args->indexCount, args->instanceCount, args->startIndex, args->baseVertex, args->startInstance);
+            break;
+        }
+
+        case CommandType::SetComputeRootSignature:
+            commandList->SetComputeRootSignature(GetObject<ID3D12RootSignature>(*reinterpret_cast<const uint32_t *>(payload)));
+            break;
+
+        case CommandType::SetComputeRootConstantBufferView:
+        {
+            const RootConstantBufferViewType *args = reinterpret_cast<const RootConstantBufferViewType *>(payload);
+            commandList->SetComputeRootConstantBufferView(args->index, GetAddress(args->address));
+            break;
+        }
+
+        case CommandType::SetComputeRootShaderResourceView:
+        {
+            const RootConstantBufferViewType *args = reinterpret_cast<const RootConstantBufferViewType *>(payload);
+            commandList->SetComputeRootShaderResourceView(args->index, GetAddress(args->address));
+            break;
+        }
+
+        case CommandType::SetComputeRootUnorderedAccessView:
+        {
+            const RootConstantBufferViewType *args = reinterpret_cast<const RootConstantBufferViewType *>(payload);
+            commandList->SetComputeRootUnorderedAccessView(args->index, GetAddress(args->address));
+            break;
+        }
+
+        case CommandType::Dispatch:
+        {
+            const DispatchType *args = reinterpret_cast<const DispatchType *>(payload);
+            commandList->Dispatch(args->x, args->y, args->z);
+            break;
+        }
+
+        case CommandType::CopyBufferRegion:
+        {
+            const CopyBufferRegionType *args = reinterpret_cast<const CopyBufferRegionType *>(payload);
+            commandList->CopyBufferRegion(GetObject<ID3D12Resource>(args->destination), args->destinationOffset, GetObject<ID3D12Resource>(args->source), args->sourceOffset, args->size);
+            break;
+        }
+
+        case CommandType::ExecuteIndirect:
+        {
+            const ExecuteIndirectType *args = reinterpret_cast<const ExecuteIndirectType *>(payload);
+            commandList->ExecuteIndirect(GetObject<ID3D12CommandSignature>(args->signature), args->maxCount, GetObject<ID3D12Resource>(args->argumentBuffer), args->argumentOffset, nullptr, 0ull);
+            break;
+        }
+
+        case CommandType::DiscardResource:
+            commandList->DiscardResource(GetObject<ID3D12Resource>(*reinterpret_cast<const uint32_t *>(payload)), nullptr);
+            break;
+
+        default:
+            throw std::runtime_error("The command stream contains an unknown command.");
+        }
+
+        // Step over the header and the padded payload to reach the next command.
+        command = payload + header->size;
+    }
+}
+
+
+uint64_t CommandStreamClass::GetCommandCount()
+{
+    return m_commandCount;
+}
+
+
+std::array<uint64_t, static_cast<size_t>(CommandStreamClass::CommandType::Count)> CommandStreamClass::GetCommandCounts()
+{
+    // Walk the stream without touching the payloads; this works on any capture, with or without a
+    // device, which lets us diff command counts between builds.
+    std::array<uint64_t, static_cast<size_t>(CommandType::Count)> counts = {};
+
+    const BYTE *command = GetCommands();
+    const BYTE *end     = command + GetCommandBytes();
+    while (command < end)
+    {
+        const CommandHeaderType *header = reinterpret_cast<const CommandHeaderType *>(command);
+        THROW_IF_TRUE(
+            header->type >= CommandType::Count,
+            "The command stream contains an unknown command."
+        );
+
+        ++counts[static_cast<size_t>(header->type)];
+        command += sizeof(CommandHeaderType) + header->size;
+    }
+
+    return counts;
+}
+
+
+const char * CommandStreamClass::GetCommandName(CommandType type)
+{
+    // The names match the ID3D12GraphicsCommandList methods the commands replay through.
+    switch (type)
+    {
+    case CommandType::SetPipelineState:                  return "SetPipelineState";
+    case CommandType::SetRootSignature:                  return "SetRootSignature";
+    case CommandType::SetRootConstantBufferView:         return "SetRootConstantBufferView";
+    case CommandType::SetRootShaderResourceView:         return "SetRootShaderResourceView";
+    case CommandType::SetRoot32BitConstant:              return "SetRoot32BitConstant";
+    case CommandType::ResourceBarrier:                   return "ResourceBarrier";
+    case CommandType::SetViewport:                       return "SetViewport";
+    case CommandType::SetRenderTargets:                  return "SetRenderTargets";
+    case CommandType::ClearRenderTarget:                 return "ClearRenderTarget";
+    case CommandType::ClearDepthStencil:                 return "ClearDepthStencil";
+    case CommandType::SetVertexBuffers:                  return "SetVertexBuffers";
+    case CommandType::SetIndexBuffer:                    return "SetIndexBuffer";
+    case CommandType::SetPrimitiveTopology:              return "SetPrimitiveTopology";
+    case CommandType::DrawIndexedInstanced:              return "DrawIndexedInstanced";
+    case CommandType::SetComputeRootSignature:           return "SetComputeRootSignature";
+    case CommandType::SetComputeRootConstantBufferView:  return "SetComputeRootConstantBufferView";
+    case CommandType::SetComputeRootShaderResourceView:  return "SetComputeRootShaderResourceView";
+    case CommandType::SetComputeRootUnorderedAccessView: return "SetComputeRootUnorderedAccessView";
+    case CommandType::Dispatch:                          return "Dispatch";
+    case CommandType::CopyBufferRegion:                  return "CopyBufferRegion";
+    case CommandType::ExecuteIndirect:                   return "ExecuteIndirect";
+    case CommandType::DiscardResource:                   return "DiscardResource";
+    default:                                             return "Unknown";
+    }
+}
+
+
+void CommandStreamClass::SetRecipe(ID3D12RootSignature *rootSignature, const void *blob, size_t size)
+{
+    // A root signature is created again straight from its serialized form.
+    THROW_IF_FAILED(
+        rootSignature->SetPrivateData(RECIPE_GUID, static_cast<UINT>(size), blob),
+        "Unable to attach the recipe of a root signature."
+    );
+}
+
+
+void CommandStreamClass::SetRecipe(ID3D12PipelineState *state, const D3D12_GRAPHICS_PIPELINE_STATE_DESC &desc)
+{
+    // The description is written out whole, followed by everything it points to, in the order the
+    // pointers appear.  The root signature goes in first, serialized, so the recipe stands alone.
+    std::vector<BYTE> recipe;
+    const std::vector<BYTE> rootSignature = GetRecipe(desc.pRootSignature);
+    Append(recipe, 0u);
+    AppendBytes(recipe, rootSignature.data(), rootSignature.size());
+    Append(recipe, desc);
+
+    const D3D12_SHADER_BYTECODE shaders[] = { desc.VS, desc.PS, desc.DS, desc.HS, desc.GS };
+    for (const D3D12_SHADER_BYTECODE &shader : shaders)
+    {
+        AppendBytes(recipe, shader.pShaderBytecode, shader.BytecodeLength);
+    }
+
+    for (UINT i = 0u; i < desc.StreamOutput.NumEntries; ++i)
+    {
+        AppendString(recipe, desc.StreamOutput.pSODeclaration[i].SemanticName);
+        Append(recipe, desc.StreamOutput.pSODeclaration[i]);
+    }
+    for (UINT i = 0u; i < desc.StreamOutput.NumStrides; ++i)
+    {
+        Append(recipe, desc.StreamOutput.pBufferStrides[i]);
+    }
+
+    for (UINT i = 0u; i < desc.InputLayout.NumElements; ++i)
+    {
+        AppendString(recipe, desc.InputLayout.pInputElementDescs[i].SemanticName);
+        Append(recipe, desc.InputLayout.pInputElementDescs[i]);
+    }
+
+    THROW_IF_FAILED(
+        state->SetPrivateData(RECIPE_GUID, static_cast<UINT>(recipe.size()), recipe.data()),
+        "Unable to attach the recipe of a pipeline state."
+    );
+}
+
+
+void CommandStreamClass::SetRecipe(ID3D12PipelineState *state, const D3D12_COMPUTE_PIPELINE_STATE_DESC &desc)
+{
+    // Laid out like a graphics state, with a nonzero first word to tell them apart.
+    std::vector<BYTE> recipe;
+    const std::vector<BYTE> rootSignature = GetRecipe(desc.pRootSignature);
+    Append(recipe, 1u);
+    AppendBytes(recipe, rootSignature.data(), rootSignature.size());
+    Append(recipe, desc);
+    AppendBytes(recipe, desc.CS.pShaderBytecode, desc.CS.BytecodeLength);
+
+    THROW_IF_FAILED(
+        state->SetPrivateData(RECIPE_GUID, static_cast<UINT>(recipe.size()), recipe.data()),
+        "Unable to attach the recipe of a pipeline state."
+    );
+}
+
+
+void CommandStreamClass::SetRecipe(ID3D12CommandSignature *signature, const D3D12_COMMAND_SIGNATURE_DESC &desc, ID3D12RootSignature *rootSignature)
+{
+    // The root signature, which only signatures that change root arguments need, then the
+    // description and its arguments.
+    std::vector<BYTE> recipe;
+    const std::vector<BYTE> rootSignatureRecipe = rootSignature ? GetRecipe(rootSignature) : std::vector<BYTE>();
+    AppendBytes(recipe, rootSignatureRecipe.data(), rootSignatureRecipe.size());
+    Append(recipe, desc);
+    for (UINT i = 0u; i < desc.NumArgumentDescs; ++i)
+    {
+        Append(recipe, desc.pArgumentDescs[i]);
+    }
+
+    THROW_IF_FAILED(
+        signature->SetPrivateData(RECIPE_GUID, static_cast<UINT>(recipe.size()), recipe.data()),
+        "Unable to attach the recipe of a command signature."
+    );
+}
+
+
+void CommandStreamClass::Record(CommandType type, const void *head, size_t headSize, const void *tail, size_t tailSize)
+{
+    // Recording into a stream that was loaded from disk starts a fresh stream.
+    if (m_mappedView)
+    {
+        Clear();
+    }
+
+    // Pad the payload so the next command header stays aligned.
+    const size_t payloadSize = (headSize + tailSize + COMMAND_ALIGNMENT - 1ull) & ~(COMMAND_ALIGNMENT - 1ull);
+
+    CommandHeaderType header;
+    header.type = type;
+    header.size = static_cast<uint32_t>(payloadSize);
+
+    // Grow the stream once, then copy the header and both pieces of the payload into place.
+    const size_t offset = m_commands.size();
+    m_commands.resize(offset + sizeof(CommandHeaderType) + payloadSize, 0u);
+
+    BYTE *destination = m_commands.data() + offset;
+    memcpy(destination, &header, sizeof(CommandHeaderType));
+    destination += sizeof(CommandHeaderType);
+    memcpy(destination, head, headSize);
+    if (tailSize)
+    {
+        memcpy(destination + headSize, tail, tailSize);
+    }
+
+    ++m_commandCount;
+}
+
+
+uint32_t CommandStreamClass::AddObject(ObjectKindType kind, ID3D12DeviceChild *object)
+{
+    if (!object)
+    {
+        return NO_OBJECT;
+    }
+
+    // Recording into a stream that was loaded from disk starts a fresh stream.
+    if (m_mappedView)
+    {
+        Clear();
+    }
+
+    // A frame refers to few objects, and mostly to the ones it used last, so we search from the
+    // back.  The table keeps its memory from frame to frame, so adding to it rarely allocates.
+    for (size_t i = m_objects.size(); i-- > 0ull;)
+    {
+        if (m_objects[i].object == object && m_objects[i].kind == kind)
+        {
+            return static_cast<uint32_t>(i);
+        }
+    }
+
+    ObjectType entry;
+    entry.kind   = kind;
+    entry.object = object;
+    m_objects.push_back(entry);
+    return static_cast<uint32_t>(m_objects.size() - 1ull);
+}
+
+
+uint32_t CommandStreamClass::AddResource(ID3D12Resource *resource, const D3D12_RESOURCE_STATES *state)
+{
+    // The first state we learn of is the one the resource was in when the stream began.
+    const uint32_t id = AddObject(ObjectKindType::Resource, resource);
+    if (id != NO_OBJECT && state && !m_objects[id].stateKnown)
+    {
+        m_objects[id].stateKnown = true;
+        m_objects[id].state      = *state;
+    }
+    return id;
+}
+
+
+void CommandStreamClass::AddView(ObjectKindType kind, D3D12_CPU_DESCRIPTOR_HANDLE handle, ID3D12Resource *resource)
+{
+    const uint32_t id = AddObject(ObjectKindType::Resource, resource);
+    if (id == NO_OBJECT)
+    {
+        return;
+    }
+
+    // Views are told apart by their descriptor, since one resource can have several.
+    for (const ObjectType &entry : m_objects)
+    {
+        if (entry.kind == kind && entry.handle.ptr == handle.ptr)
+        {
+            return;
+        }
+    }
+
+    ObjectType entry;
+    entry.kind     = kind;
+    entry.resource = id;
+    entry.handle   = handle;
+    m_objects.push_back(entry);
+}
+
+
+const BYTE * CommandStreamClass::GetCommands()
+{
+    // Loaded streams live in the mapped file just past the header, recorded ones in our vector.
+    if (m_mappedView)
+    {
+        return m_mappedView + sizeof(StreamHeaderType);
+    }
+    return m_commands.data();
+}
+
+
+size_t CommandStreamClass::GetCommandBytes()
+{
+    if (m_mappedView)
+    {
+        return static_cast<size_t>(reinterpret_cast<const StreamHeaderType *>(m_mappedView)->byteCount);
+    }
+    return m_commands.size();
+}
+
+
+void CommandStreamClass::CreateObjects(ID3D12GraphicsCommandList *commandList)
+{
+    ComPtr<ID3D12Device> device;
+    THROW_IF_FAILED(
+        commandList->GetDevice(IID_PPV_ARGS(device.GetAddressOf())),
+        "Unable to get the device of the replaying command list."
+    );
+
+    // The object table follows the commands in the mapped file.
+    const StreamHeaderType *header = reinterpret_cast<const StreamHeaderType *>(m_mappedView);
+    const BYTE             *begin  = GetCommands() + header->byteCount;
+    const BYTE             *end    = begin + header->objectBytes;
+
+    // Views go into one heap for each kind, so count them first, checking every entry fits.
+    UINT renderTargetViewCount = 0u;
+    UINT depthStencilViewCount = 0u;
+    for (const BYTE *object = begin; object < end;)
+    {
+        const ObjectHeaderType *objectHeader = reinterpret_cast<const ObjectHeaderType *>(object);
+        THROW_IF_TRUE(
+            static_cast<size_t>(end - object) < sizeof(ObjectHeaderType) ||
+            objectHeader->size > static_cast<size_t>(end - object) - sizeof(ObjectHeaderType),
+            "The object table of the command stream is truncated."
+        );
+
+        renderTargetViewCount += objectHeader->kind == ObjectKindType::RenderTargetView ? 1u : 0u;
+        depthStencilViewCount += objectHeader->kind == ObjectKindType::DepthStencilView ? 1u : 0u;
+        object += sizeof(ObjectHeaderType) + objectHeader->size;
+    }
+
+    D3D12_DESCRIPTOR_HEAP_DESC heapDesc{};
+    heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+    if (renderTargetViewCount)
+    {
+        heapDesc.Type           = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
+        heapDesc.NumDescriptors = renderTargetViewCount;
+        THROW_IF_FAILED(
+            device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(m_renderTargetViewHeap.ReleaseAndGetAddressOf())),
+            "Unable to create the render target views of the command stream."
+        );
+    }
+    if (depthStencilViewCount)
+    {
+        heapDesc.Type           = D3D12_DESCRIPTOR_HEAP_TYPE_DSV;
+        heapDesc.NumDescriptors = depthStencilViewCount;
+        THROW_IF_FAILED(
+            device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(m_depthStencilViewHeap.ReleaseAndGetAddressOf())),
+            "Unable to create the depth stencil views of the command stream."
+        );
+    }
+    renderTargetViewCount = 0u;
+    depthStencilViewCount = 0u;
+
+    // Then create every object again, in table order, so a view always finds its resource.
+    m_replayObjects.clear();
+    m_replayObjects.reserve(static_cast<size_t>(header->objectCount));
+    for (const BYTE *object = begin; object < end;)
+    {
+        const ObjectHeaderType *objectHeader = reinterpret_cast<const ObjectHeaderType *>(object);
+        const BYTE             *recipe       = object + sizeof(ObjectHeaderType);
+        RecipeReaderType        reader       = { recipe, objectHeader->size, 0ull };
+
+        ReplayObjectType entry;
+        switch (objectHeader->kind)
+        {
+        case ObjectKindType::Resource:
+        {
+            // The contents are not part of the capture, so a committed resource of the same
+            // description will do, and buffers remember where they moved to.
+            const ResourceRecipeType resourceRecipe = reader.Read<ResourceRecipeType>();
+
+            ComPtr<ID3D12Resource> resource;
+            THROW_IF_FAILED(
+                device->CreateCommittedResource(
+                    &resourceRecipe.heapProperties,
+                    D3D12_HEAP_FLAG_NONE,
+                    &resourceRecipe.desc,
+                    resourceRecipe.state,
+                    nullptr,
+                    IID_PPV_ARGS(resource.GetAddressOf())),
+                "Unable to create a resource of the command stream."
+            );
+
+            if (resourceRecipe.desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+            {
+                entry.recordedAddress = resourceRecipe.address;
+                entry.address         = resource->GetGPUVirtualAddress();
+                entry.size            = resourceRecipe.desc.Width;
+            }
+            entry.object = resource.Get();
+            break;
+        }
+
+        case ObjectKindType::PipelineState:
+            entry.object = CreatePipelineState(device.Get(), recipe, objectHeader->size).Get();
+            break;
+
+        case ObjectKindType::RootSignature:
+            entry.object = CreateRootSignature(device.Get(), recipe, objectHeader->size).Get();
+            break;
+
+        case ObjectKindType::CommandSignature:
+            entry.object = CreateCommandSignature(device.Get(), recipe, objectHeader->size).Get();
+            break;
+
+        case ObjectKindType::RenderTargetView:
+        case ObjectKindType::DepthStencilView:
+        {
+            const ViewRecipeType view = reader.Read<ViewRecipeType>();
+            THROW_IF_TRUE(
+                view.resource >= m_replayObjects.size(),
+                "A view of the command stream refers to a resource that is not before it."
+            );
+            ID3D12Resource *resource = static_cast<ID3D12Resource *>(m_replayObjects[view.resource].object.Get());
+
+            // Each view takes the next descriptor of its heap, and gets the default view of its
+            // resource.
+            entry.recordedHandle = view.handle;
+            if (objectHeader->kind == ObjectKindType::RenderTargetView)
+            {
+                entry.handle      = m_renderTargetViewHeap->GetCPUDescriptorHandleForHeapStart();
+                entry.handle.ptr += static_cast<SIZE_T>(renderTargetViewCount++) * device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
+                device->CreateRenderTargetView(resource, nullptr, entry.handle);
+            }
+            else
+            {
+                entry.handle      = m_depthStencilViewHeap->GetCPUDescriptorHandleForHeapStart();
+                entry.handle.ptr += static_cast<SIZE_T>(depthStencilViewCount++) * device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
+                device->CreateDepthStencilView(resource, nullptr, entry.handle);
+            }
+            break;
+        }
+
+        default:
+            throw std::runtime_error("The command stream contains an unknown kind of object.");
+        }
+
+        m_replayObjects.push_back(std::move(entry));
+        object = recipe + objectHeader->size;
+    }
+
+    THROW_IF_TRUE(
+        m_replayObjects.size() != header->objectCount,
+        "The object table of the command stream does not hold as many objects as it says."
+    );
+}
+
+
+ID3D12DeviceChild * CommandStreamClass::GetObject(uint32_t id)
+{
+    if (id == NO_OBJECT)
+    {
+        return nullptr;
+    }
+
+    // Loaded streams refer to the objects created for them, and recorded ones to their own.
+    if (m_mappedView)
+    {
+        THROW_IF_TRUE(
+            id >= m_replayObjects.size(),
+            "The command stream refers to an object outside its table."
+        );
+        return m_replayObjects[id].object.Get();
+    }
+    return m_objects[id].object;
+}
+
+
+D3D12_GPU_VIRTUAL_ADDRESS CommandStreamClass::GetAddress(D3D12_GPU_VIRTUAL_ADDRESS address)
+{
+    // A recorded stream's addresses are still good.  A loaded one's move along with the buffer
+    // they fall in.
+    if (!m_mappedView || address == 0ull)
+    {
+        return address;
+    }
+
+    for (const ReplayObjectType &entry : m_replayObjects)
+    {
+        if (address >= entry.recordedAddress && address - entry.recordedAddress < entry.size)
+        {
+            return entry.address + (address - entry.recordedAddress);
+        }
+    }
+    throw std::runtime_error("The command stream uses an address outside every buffer it captured.");
+}
+
+
+D3D12_CPU_DESCRIPTOR_HANDLE CommandStreamClass::GetDescriptor(D3D12_CPU_DESCRIPTOR_HANDLE handle)
+{
+    // Descriptors move over to the views created again for a loaded stream, like addresses do.
+    if (!m_mappedView || handle.ptr == 0u)
+    {
+        return handle;
+    }
+
+    for (const ReplayObjectType &entry : m_replayObjects)
+    {
+        if (entry.recordedHandle && entry.recordedHandle == static_cast<uint64_t>(handle.ptr))
+        {
+            return entry.handle;
+        }
+    }
+    throw std::runtime_error("The command stream uses a descriptor outside every view it captured.");
+}
+
+
+void CommandStreamClass::Unmap()
+{
+    // Unmap the view, then close the mapping and file handles in reverse order of creation.
+    if (m_mappedView)
+    {
+        UnmapViewOfFile(m_mappedView);
+        m_mappedView  = nullptr;
+        m_mappedBytes = 0ull;
+    }
+    if (m_mapping)
+    {
+        CloseHandle(m_mapping);
+        m_mapping = NULL;
+    }
+    if (m_file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_file);
+        m_file = INVALID_HANDLE_VALUE;
+    }
+}
+
+
+std::vector<BYTE> CommandStreamClass::GetRecipe(ID3D12Object *object)
+{
+    // Objects created without a recipe give an empty one, which only fails once it is replayed.
+    std::vector<BYTE> recipe;
+    UINT size = 0u;
+    if (SUCCEEDED(object->GetPrivateData(RECIPE_GUID, &size, nullptr)) && size)
+    {
+        recipe.resize(size);
+        if (FAILED(object->GetPrivateData(RECIPE_GUID, &size, recipe.data())))
+        {
+            recipe.clear();
+        }
+    }
+    return recipe;
+}
+
+
+ComPtr<ID3D12RootSignature> CommandStreamClass::CreateRootSignature(ID3D12Device *device, const BYTE *recipe, size_t size)
+{
+    THROW_IF_TRUE(
+        size == 0ull,
+        "A root signature of the command stream was captured without a recipe."
+    );
+
+    ComPtr<ID3D12RootSignature> rootSignature;
+    THROW_IF_FAILED(
+        device->CreateRootSignature(0, recipe, size, IID_PPV_ARGS(rootSignature.GetAddressOf())),
+        "Unable to create a root signature of the command stream."
+    );
+    return rootSignature;
+}
+
+
+ComPtr<ID3D12PipelineState> CommandStreamClass::CreatePipelineState(ID3D12Device *device, const BYTE *recipe, size_t size)
+{
+    RecipeReaderType reader = { recipe, size, 0ull };
+    const uint32_t compute = reader.Read<uint32_t>();
+
+    size_t rootSignatureSize = 0ull;
+    const BYTE *rootSignatureRecipe = reader.ReadBytes(rootSignatureSize);
+    ComPtr<ID3D12RootSignature> rootSignature = CreateRootSignature(device, rootSignatureRecipe, rootSignatureSize);
+
+    ComPtr<ID3D12PipelineState> state;
+    if (compute)
+    {
+        D3D12_COMPUTE_PIPELINE_STATE_DESC desc = reader.Read<D3D12_COMPUTE_PIPELINE_STATE_DESC>();
+        desc.pRootSignature = rootSignature.Get();
+        desc.CS             = reader.ReadShader();
+        desc.CachedPSO      = {};
+
+        THROW_IF_FAILED(
+            device->CreateComputePipelineState(&desc, IID_PPV_ARGS(state.GetAddressOf())),
+            "Unable to create a pipeline state of the command stream."
+        );
+        return state;
+    }
+
+    // Point the description at its pieces, which are read back in the order they were written.
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC desc = reader.Read<D3D12_GRAPHICS_PIPELINE_STATE_DESC>();
+    desc.pRootSignature = rootSignature.Get();
+    desc.VS             = reader.ReadShader();
+    desc.PS             = reader.ReadShader();
+    desc.DS             = reader.ReadShader();
+    desc.HS             = reader.ReadShader();
+    desc.GS             = reader.ReadShader();
+    desc.CachedPSO      = {};
+
+    THROW_IF_TRUE(
+        desc.StreamOutput.NumEntries > size || desc.StreamOutput.NumStrides > size || desc.InputLayout.NumElements > size,
+        "A pipeline state recipe of the command stream is corrupt."
+    );
+
+    std::vector<D3D12_SO_DECLARATION_ENTRY> entries(desc.StreamOutput.NumEntries);
+    for (D3D12_SO_DECLARATION_ENTRY &entry : entries)
+    {
+        const char *semanticName = reader.ReadString();
+        entry              = reader.Read<D3D12_SO_DECLARATION_ENTRY>();
+        entry.SemanticName = semanticName;
+    }
+    std::vector<UINT> strides(desc.StreamOutput.NumStrides);
+    for (UINT &stride : strides)
+    {
+        stride = reader.Read<UINT>();
+    }
+    desc.StreamOutput.pSODeclaration = entries.empty() ? nullptr : entries.data();
+    desc.StreamOutput.pBufferStrides = strides.empty() ? nullptr : strides.data();
+
+    std::vector<D3D12_INPUT_ELEMENT_DESC> elements(desc.InputLayout.NumElements);
+    for (D3D12_INPUT_ELEMENT_DESC &element : elements)
+    {
+        const char *semanticName = reader.ReadString();
+        element              = reader.Read<D3D12_INPUT_ELEMENT_DESC>();
+        element.SemanticName = semanticName;
+    }
+    desc.InputLayout.pInputElementDescs = elements.empty() ? nullptr : elements.data();
+
+    THROW_IF_FAILED(
+        device->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(state.GetAddressOf())),
+        "Unable to create a pipeline state of the command stream."
+    );
+    return state;
+}
+
+
+ComPtr<ID3D12CommandSignature> CommandStreamClass::CreateCommandSignature(ID3D12Device *device, const BYTE *recipe, size_t size)
+{
+    RecipeReaderType reader = { recipe, size, 0ull };
+
+    size_t rootSignatureSize = 0ull;
+    const BYTE *rootSignatureRecipe = reader.ReadBytes(rootSignatureSize);
+    ComPtr<ID3D12RootSignature> rootSignature;
+    if (rootSignatureSize)
+    {
+        rootSignature = CreateRootSignature(device, rootSignatureRecipe, rootSignatureSize);
+    }
+
+    D3D12_COMMAND_SIGNATURE_DESC desc = reader.Read<D3D12_COMMAND_SIGNATURE_DESC>();
+    THROW_IF_TRUE(
+        desc.NumArgumentDescs > size,
+        "A command signature recipe of the command stream is corrupt."
+    );
+
+    std::vector<D3D12_INDIRECT_ARGUMENT_DESC> arguments(desc.NumArgumentDescs);
+    for (D3D12_INDIRECT_ARGUMENT_DESC &argument : arguments)
+    {
+        argument = reader.Read<D3D12_INDIRECT_ARGUMENT_DESC>();
+    }
+    desc.pArgumentDescs = arguments.empty() ? nullptr : arguments.data();
+
+    ComPtr<ID3D12CommandSignature> signature;
+    THROW_IF_FAILED(
+        device->CreateCommandSignature(&desc, rootSignature.Get(), IID_PPV_ARGS(signature.GetAddressOf())),
+        "Unable to create a command signature of the command stream."
+    );
+    return signature;
+}
+
+
+void CommandStreamClass::Append(std::vector<BYTE> &recipe, const void *data, size_t size)
+{
+    if (size)
+    {
+        const BYTE *bytes = static_cast<const BYTE *>(data);
+        recipe.insert(recipe.end(), bytes, bytes + size);
+    }
+}
+
+
+void CommandStreamClass::AppendBytes(std::vector<BYTE> &recipe, const void *data, size_t size)
+{
+    Append(recipe, static_cast<uint64_t>(size));
+    Append(recipe, data, size);
+}
+
+
+void CommandStreamClass::AppendString(std::vector<BYTE> &recipe, const char *string)
+{
+    // Keep the terminator, so the string can be used where it lands when read back.
+    AppendBytes(recipe, string, string ? strlen(string) + 1ull : 0ull);
+}
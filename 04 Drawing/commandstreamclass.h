@@ -0,0 +1,361 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: commandstreamclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: CommandStreamClass
+////////////////////////////////////////////////////////////////////////////////
+class CommandStreamClass
+{
+public:
+    enum class CommandType : uint32_t
+    {
+        SetPipelineState,
+        SetRootSignature,
+        SetRootConstantBufferView,
+        SetRootShaderResourceView,
+        SetRoot32BitConstant,
+        ResourceBarrier,
+        SetViewport,
+        SetRenderTargets,
+        ClearRenderTarget,
+        ClearDepthStencil,
+        SetVertexBuffers,
+        SetIndexBuffer,
+        SetPrimitiveTopology,
+        DrawIndexedInstanced,
+        SetComputeRootSignature,
+        SetComputeRootConstantBufferView,
+        SetComputeRootShaderResourceView,
+        SetComputeRootUnorderedAccessView,
+        Dispatch,
+        CopyBufferRegion,
+        ExecuteIndirect,
+        DiscardResource,
+        Count
+    };
+
+private:
+    // What an entry of the object table stands for.
+    enum class ObjectKindType : uint32_t
+    {
+        Resource,
+        PipelineState,
+        RootSignature,
+        CommandSignature,
+        RenderTargetView,
+        DepthStencilView,
+    };
+
+    // The stream's commands are followed by its object table.
+    struct StreamHeaderType
+    {
+        uint32_t magic        = 0u;
+        uint32_t version      = 0u;
+        uint64_t commandCount = 0ull;
+        uint64_t byteCount    = 0ull;
+        uint64_t objectCount  = 0ull;
+        uint64_t objectBytes  = 0ull;
+    };
+
+    struct ObjectHeaderType
+    {
+        ObjectKindType kind = ObjectKindType::Resource;
+        uint32_t       size = 0u;
+    };
+
+    // An object the commands refer to by its index in the table.  Resources remember the state the
+    // stream first found them in, and views the resource and descriptor they were written to.
+    struct ObjectType
+    {
+        ObjectKindType              kind       = ObjectKindType::Resource;
+        ID3D12DeviceChild          *object     = nullptr;
+        bool                        stateKnown = false;
+        D3D12_RESOURCE_STATES       state      = D3D12_RESOURCE_STATE_COMMON;
+        uint32_t                    resource   = 0u;
+        D3D12_CPU_DESCRIPTOR_HANDLE handle     = {};
+    };
+
+    // How a resource of the table is created again, and where its memory was when recorded.
+    struct ResourceRecipeType
+    {
+        D3D12_RESOURCE_DESC       desc           = {};
+        D3D12_HEAP_PROPERTIES     heapProperties = {};
+        D3D12_RESOURCE_STATES     state          = D3D12_RESOURCE_STATE_COMMON;
+        D3D12_GPU_VIRTUAL_ADDRESS address        = 0ull;
+    };
+
+    struct ViewRecipeType
+    {
+        uint32_t resource = 0u;
+        uint64_t handle   = 0ull;
+    };
+
+    // An object of a loaded stream, created again from its recipe, with where its memory or
+    // descriptor was when recorded and where it is now.
+    struct ReplayObjectType
+    {
+        ComPtr<ID3D12DeviceChild>   object          = nullptr;
+        D3D12_GPU_VIRTUAL_ADDRESS   recordedAddress = 0ull;
+        D3D12_GPU_VIRTUAL_ADDRESS   address         = 0ull;
+        UINT64                      size            = 0ull;
+        uint64_t                    recordedHandle  = 0ull;
+        D3D12_CPU_DESCRIPTOR_HANDLE handle          = {};
+    };
+
+    // Reads the pieces of a recipe back in order, refusing to run past its end.
+    struct RecipeReaderType
+    {
+        const BYTE *data   = nullptr;
+        size_t      size   = 0ull;
+        size_t      offset = 0ull;
+
+        const BYTE * Read(size_t);
+        const BYTE * ReadBytes(size_t &);
+        const char * ReadString();
+        D3D12_SHADER_BYTECODE ReadShader();
+        template<typename Type>
+        Type Read();
+    };
+
+    struct CommandHeaderType
+    {
+        CommandType type = CommandType::Count;
+        uint32_t    size = 0u;
+    };
+
+    struct RootConstantBufferViewType
+    {
+        UINT                      index   = 0u;
+        D3D12_GPU_VIRTUAL_ADDRESS address = 0ull;
+    };
+
+    struct RootConstantType
+    {
+        UINT index  = 0u;
+        UINT value  = 0u;
+        UINT offset = 0u;
+    };
+
+    struct ViewportType
+    {
+        D3D12_VIEWPORT viewport    = {};
+        D3D12_RECT     scissorRect = {};
+    };
+
+    // Barriers name their resources by index in the object table.
+    struct BarrierType
+    {
+        D3D12_RESOURCE_BARRIER_TYPE  type          = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+        D3D12_RESOURCE_BARRIER_FLAGS flags         = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+        uint32_t                     resource      = 0u;
+        uint32_t                     resourceAfter = 0u;
+        UINT                         subresource   = 0u;
+        D3D12_RESOURCE_STATES        stateBefore   = D3D12_RESOURCE_STATE_COMMON;
+        D3D12_RESOURCE_STATES        stateAfter    = D3D12_RESOURCE_STATE_COMMON;
+    };
+
+    struct RenderTargetsType
+    {
+        D3D12_CPU_DESCRIPTOR_HANDLE renderTarget = {};
+        D3D12_CPU_DESCRIPTOR_HANDLE depthStencil = {};
+    };
+
+    struct ClearRenderTargetType
+    {
+        D3D12_CPU_DESCRIPTOR_HANDLE renderTarget = {};
+        float                       color[4]     = {};
+    };
+
+    struct VertexBuffersType
+    {
+        UINT startSlot = 0u;
+        UINT count     = 0u;
+    };
+
+    struct DrawIndexedInstancedType
+    {
+        UINT indexCount    = 0u;
+        UINT instanceCount = 0u;
+        UINT startIndex    = 0u;
+        INT  baseVertex    = 0;
+        UINT startInstance = 0u;
+    };
+
+    struct DispatchType
+    {
+        UINT x = 0u;
+        UINT y = 0u;
+        UINT z = 0u;
+    };
+
+    struct CopyBufferRegionType
+    {
+        uint32_t destination       = 0u;
+        uint32_t source            = 0u;
+        UINT64   destinationOffset = 0ull;
+        UINT64   sourceOffset      = 0ull;
+        UINT64   size              = 0ull;
+    };
+
+    struct ExecuteIndirectType
+    {
+        uint32_t signature      = 0u;
+        UINT     maxCount       = 0u;
+        uint32_t argumentBuffer = 0u;
+        UINT64   argumentOffset = 0ull;
+    };
+
+public:
+    CommandStreamClass(const CommandStreamClass &) = delete;
+    CommandStreamClass & operator=(const CommandStreamClass &) = delete;
+
+    CommandStreamClass() = default;
+    ~CommandStreamClass();
+
+    void Clear();
+
+    void RecordSetPipelineState(ID3D12PipelineState *);
+    void RecordSetRootSignature(ID3D12RootSignature *);
+    void RecordSetRootConstantBufferView(UINT, D3D12_GPU_VIRTUAL_ADDRESS);
+    void RecordSetRootShaderResourceView(UINT, D3D12_GPU_VIRTUAL_ADDRESS);
+    void RecordSetRoot32BitConstant(UINT, UINT, UINT);
+    void RecordResourceBarrier(UINT, const D3D12_RESOURCE_BARRIER *);
+    void RecordSetViewport(const D3D12_VIEWPORT &, const D3D12_RECT &);
+    void RecordSetRenderTargets(D3D12_CPU_DESCRIPTOR_HANDLE, D3D12_CPU_DESCRIPTOR_HANDLE);
+    void RecordClearRenderTarget(D3D12_CPU_DESCRIPTOR_HANDLE, const float *);
+    void RecordClearDepthStencil(D3D12_CPU_DESCRIPTOR_HANDLE);
+    void RecordSetVertexBuffers(UINT, UINT, const D3D12_VERTEX_BUFFER_VIEW *);
+    void RecordSetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW &);
+    void RecordSetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY);
+    void RecordDrawIndexedInstanced(UINT, UINT, UINT, INT, UINT);
+    void RecordSetComputeRootSignature(ID3D12RootSignature *);
+    void RecordSetComputeRootConstantBufferView(UINT, D3D12_GPU_VIRTUAL_ADDRESS);
+    void RecordSetComputeRootShaderResourceView(UINT, D3D12_GPU_VIRTUAL_ADDRESS);
+    void RecordSetComputeRootUnorderedAccessView(UINT, D3D12_GPU_VIRTUAL_ADDRESS);
+    void RecordDispatch(UINT, UINT, UINT);
+    void RecordCopyBufferRegion(ID3D12Resource *, UINT64, ID3D12Resource *, UINT64, UINT64);
+    void RecordExecuteIndirect(ID3D12CommandSignature *, UINT, ID3D12Resource *, UINT64);
+    void RecordDiscardResource(ID3D12Resource *);
+
+    void AddResource(ID3D12Resource *);
+    void AddRenderTargetView(D3D12_CPU_DESCRIPTOR_HANDLE, ID3D12Resource *);
+    void AddDepthStencilView(D3D12_CPU_DESCRIPTOR_HANDLE, ID3D12Resource *);
+
+    void Save(const std::wstring &);
+    void Load(const std::wstring &);
+
+    void Replay(ID3D12GraphicsCommandList *);
+
+    uint64_t GetCommandCount();
+    std::array<uint64_t, static_cast<size_t>(CommandType::Count)> GetCommandCounts();
+
+    static const char * GetCommandName(CommandType);
+
+    static void SetRecipe(ID3D12RootSignature *, const void *, size_t);
+    static void SetRecipe(ID3D12PipelineState *, const D3D12_GRAPHICS_PIPELINE_STATE_DESC &);
+    static void SetRecipe(ID3D12PipelineState *, const D3D12_COMPUTE_PIPELINE_STATE_DESC &);
+    static void SetRecipe(ID3D12CommandSignature *, const D3D12_COMMAND_SIGNATURE_DESC &, ID3D12RootSignature *);
+
+private:
+    template<typename Type>
+    void Record(CommandType, const Type &);
+    void Record(CommandType, const void *, size_t, const void * = nullptr, size_t = 0ull);
+
+    uint32_t AddObject(ObjectKindType, ID3D12DeviceChild *);
+    uint32_t AddResource(ID3D12Resource *, const D3D12_RESOURCE_STATES *);
+    void AddView(ObjectKindType, D3D12_CPU_DESCRIPTOR_HANDLE, ID3D12Resource *);
+
+    const BYTE * GetCommands();
+    size_t GetCommandBytes();
+
+    void CreateObjects(ID3D12GraphicsCommandList *);
+    ID3D12DeviceChild * GetObject(uint32_t);
+    template<typename Interface>
+    Interface * GetObject(uint32_t);
+    D3D12_GPU_VIRTUAL_ADDRESS GetAddress(D3D12_GPU_VIRTUAL_ADDRESS);
+    D3D12_CPU_DESCRIPTOR_HANDLE GetDescriptor(D3D12_CPU_DESCRIPTOR_HANDLE);
+
+    void Unmap();
+
+    static std::vector<BYTE> GetRecipe(ID3D12Object *);
+    static ComPtr<ID3D12RootSignature> CreateRootSignature(ID3D12Device *, const BYTE *, size_t);
+    static ComPtr<ID3D12PipelineState> CreatePipelineState(ID3D12Device *, const BYTE *, size_t);
+    static ComPtr<ID3D12CommandSignature> CreateCommandSignature(ID3D12Device *, const BYTE *, size_t);
+
+    static void Append(std::vector<BYTE> &, const void *, size_t);
+    template<typename Type>
+    static void Append(std::vector<BYTE> &, const Type &);
+    static void AppendBytes(std::vector<BYTE> &, const void *, size_t);
+    static void AppendString(std::vector<BYTE> &, const char *);
+
+private:
+    // Identifies the file as a command stream, and which layout its commands use.
+    static constexpr uint32_t STREAM_MAGIC   = 0x53434344u; // "DCCS"
+    static constexpr uint32_t STREAM_VERSION = 4u;
+
+    // Every command and every object is padded so the next header starts on this boundary.
+    static constexpr size_t COMMAND_ALIGNMENT = 8ull;
+
+    // Stands in for a missing object, such as the resource of a barrier on all UAVs.
+    static constexpr uint32_t NO_OBJECT = ~0u;
+
+    // Pipeline states, root signatures and command signatures carry the recipe they are created
+    // again from as private data under this GUID.
+    static const GUID RECIPE_GUID;
+
+    uint64_t          m_commandCount = 0ull;
+    std::vector<BYTE> m_commands     = {};
+
+    // The objects the recorded commands refer to.  The table only points at them, so they have to
+    // outlive the recording, up to Save.  Clearing keeps its memory for the next frame.
+    std::vector<ObjectType>  m_objects  = {};
+    std::vector<BarrierType> m_barriers = {};
+
+    // A loaded stream's objects, created again on the replaying device, and the heaps of its views.
+    std::vector<ReplayObjectType>       m_replayObjects        = {};
+    std::vector<D3D12_RESOURCE_BARRIER> m_replayBarriers       = {};
+    ComPtr<ID3D12DescriptorHeap>        m_renderTargetViewHeap = nullptr;
+    ComPtr<ID3D12DescriptorHeap>        m_depthStencilViewHeap = nullptr;
+
+    HANDLE       m_file        = INVALID_HANDLE_VALUE;
+    HANDLE       m_mapping     = NULL;
+    const BYTE * m_mappedView  = nullptr;
+    size_t       m_mappedBytes = 0ull;
+};
+
+
+///////////////////////////////
+// INLINE TEMPLATE FUNCTIONS //
+///////////////////////////////
+template<typename Type>
+void CommandStreamClass::Record(CommandType type, const Type &payload)
+{
+    Record(type, &payload, sizeof(Type));
+}
+
+
+template<typename Type>
+Type CommandStreamClass::RecipeReaderType::Read()
+{
+    // Recipes are packed without padding, so the value is copied out rather than pointed at.
+    Type value;
+    memcpy(&value, Read(sizeof(Type)), sizeof(Type));
+    return value;
+}
+
+
+template<typename Interface>
+Interface * CommandStreamClass::GetObject(uint32_t id)
+{
+    return static_cast<Interface *>(GetObject(id));
+}
+
+
+template<typename Type>
+void CommandStreamClass::Append(std::vector<BYTE> &recipe, const Type &value)
+{
+    Append(recipe, &value, sizeof(Type));
+}
@@ -0,0 +1,77 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: constantarenaclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "constantarenaclass.h"
+
+
+ConstantArenaClass::ConstantArenaClass(GpuAllocatorClass *allocator, UINT frameCount, UINT64 frameCapacity)
+    : m_frameCapacity((frameCapacity + CONSTANT_ALIGNMENT - 1ull) & ~(CONSTANT_ALIGNMENT - 1ull))
+{
+    // Place the arena in an upload heap.  Because CPU and GPU are asynchronus, it holds a separate
+    // region for every frame.
+    m_buffer = allocator->CreateBuffer(
+        GpuAllocatorClass::CategoryType::Constants,
+        D3D12_HEAP_TYPE_UPLOAD,
+        m_frameCapacity * frameCount,
+        D3D12_RESOURCE_FLAG_NONE,
+        D3D12_RESOURCE_STATE_GENERIC_READ,
+        L"CAC constant arena"
+    );
+
+    // Map the arena once and leave it mapped for its whole life, so updates are a plain copy.
+    D3D12_RANGE readRange{};
+    THROW_IF_FAILED(
+        m_buffer->Map(0, &readRange, reinterpret_cast<void**>(&m_mappedData)),
+        "Unable to map the constant arena."
+    );
+
+    NameD3DResources();
+}
+
+
+ID3D12Resource * ConstantArenaClass::GetResource()
+{
+    return m_buffer.Get();
+}
+
+
+void ConstantArenaClass::Reset(UINT frameIndex)
+{
+    // The GPU is done with this frame's region, so start handing it out again from the beginning.
+    m_frameStart = m_frameCapacity * frameIndex;
+    m_frameOffset.store(0ull);
+}
+
+
+D3D12_GPU_VIRTUAL_ADDRESS ConstantArenaClass::Allocate(const BYTE *data, SIZE_T size)
+{
+    // Copy the data into a fresh slice, and return where the GPU will find it.
+    BYTE *mappedData = nullptr;
+    const D3D12_GPU_VIRTUAL_ADDRESS address = Allocate(size, &mappedData);
+    memcpy(mappedData, data, size);
+    return address;
+}
+
+
+D3D12_GPU_VIRTUAL_ADDRESS ConstantArenaClass::Allocate(SIZE_T size, BYTE **mappedData)
+{
+    // Claim an aligned slice of this frame's region; this is safe to do from several threads.
+    const UINT64 alignedSize = (static_cast<UINT64>(size) + CONSTANT_ALIGNMENT - 1ull) & ~(CONSTANT_ALIGNMENT - 1ull);
+    const UINT64 offset      = m_frameOffset.fetch_add(alignedSize);
+    THROW_IF_TRUE(
+        offset + alignedSize > m_frameCapacity,
+        "The constant arena ran out of space for this frame."
+    );
+
+    // Hand back the slice for the caller to write into directly, and where the GPU will find it.
+    *mappedData = m_mappedData + m_frameStart + offset;
+    return m_buffer->GetGPUVirtualAddress() + m_frameStart + offset;
+}
+
+
+void ConstantArenaClass::NameD3DResources()
+{
+    // Name all DirectX objects.
+    m_buffer->SetName(L"CAC constant arena");
+}
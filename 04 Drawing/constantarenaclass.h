@@ -0,0 +1,46 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: constantarenaclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include "gpuallocatorclass.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: ConstantArenaClass
+////////////////////////////////////////////////////////////////////////////////
+class ConstantArenaClass
+{
+public:
+    ConstantArenaClass() = delete;
+    ConstantArenaClass(const ConstantArenaClass &) = delete;
+    ConstantArenaClass & operator=(const ConstantArenaClass &) = delete;
+
+    ConstantArenaClass(GpuAllocatorClass *, UINT, UINT64 = 8ull * 1024ull * 1024ull);
+    ~ConstantArenaClass() = default;
+
+    ID3D12Resource * GetResource();
+
+    void Reset(UINT);
+
+    D3D12_GPU_VIRTUAL_ADDRESS Allocate(const BYTE *, SIZE_T);
+    D3D12_GPU_VIRTUAL_ADDRESS Allocate(SIZE_T, BYTE **);
+
+private:
+    void NameD3DResources();
+
+private:
+    // Constant buffer views have to start on this boundary.
+    static constexpr UINT64 CONSTANT_ALIGNMENT = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT;
+
+    const UINT64        m_frameCapacity = 0ull;
+    UINT64              m_frameStart    = 0ull;
+    std::atomic<UINT64> m_frameOffset   = { 0ull };
+    BYTE               *m_mappedData    = nullptr;
+
+    GpuAllocatorClass::AllocationType m_buffer = {};
+};
@@ -0,0 +1,267 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: cullcontextclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "cullcontextclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+// Every indirect draw is a single indexed, instanced draw.
+static const D3D12_INDIRECT_ARGUMENT_DESC g_drawArgumentDesc = { D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED };
+
+
+CullContextClass::CullContextClass(ID3D12Device *device, ConstantArenaClass *constantArena, PipelineCacheClass *pipelineCache)
+    : ContextInterface(constantArena, pipelineCache)
+{
+    // We need to set up the root signature before creating the pipeline state object.
+    InitializeRootSignature(device);
+
+    // Then we can initialize the pipeline state and the command signature.
+    InitializeContext(device);
+
+    // After all the resources are initialized, we will name all of our objects for graphics debugging.
+    NameD3DResources();
+}
+
+
+ID3D12CommandSignature * CullContextClass::GetCommandSignature()
+{
+    return m_commandSignature.Get();
+}
+
+
+void CullContextClass::UpdateShaderParameters()
+{
+    // Every dispatch carries its own parameters, so there is nothing to update once per frame.
+}
+
+
+void CullContextClass::SetShaderParameters(PipelineClass *pipeline)
+{
+    // Switch the pipeline over to the cull kernel.
+    pipeline->SetState(m_state.Get());
+    pipeline->SetComputeRootSignature(m_rootSignature.Get());
+}
+
+
+void CullContextClass::Dispatch(PipelineClass                         *pipeline,
+                                const FrustumCullerClass::FrustumType &frustum,
+                                float                                  radius,
+                                UINT                                   instanceCount,
+                                D3D12_GPU_VIRTUAL_ADDRESS              instances,
+                                D3D12_GPU_VIRTUAL_ADDRESS              visibleInstances,
+                                D3D12_GPU_VIRTUAL_ADDRESS              drawArguments)
+{
+    // Copy the frustum and the size of the set into this frame's constant arena.
+    CullBufferType cull{};
+    for (UINT i = 0u; i < 6u; ++i)
+    {
+        cull.planes[i] = frustum.planes[i];
+    }
+    cull.instanceCount = instanceCount;
+    cull.radius        = radius;
+
+    // Point the kernel at its parameters, its input, and its two outputs.
+    pipeline->SetComputeRootConstantBufferView(CULL_BUFFER_PARAMETER, p_constantArena->Allocate(reinterpret_cast<BYTE*>(&cull), sizeof(cull)));
+    pipeline->SetComputeRootShaderResourceView(INSTANCE_BUFFER_PARAMETER, instances);
+    pipeline->SetComputeRootUnorderedAccessView(VISIBLE_BUFFER_PARAMETER, visibleInstances);
+    pipeline->SetComputeRootUnorderedAccessView(ARGUMENT_BUFFER_PARAMETER, drawArguments);
+
+    // Launch one thread per instance.
+    pipeline->Dispatch((instanceCount + THREAD_GROUP_SIZE - 1u) / THREAD_GROUP_SIZE, 1u, 1u);
+}
+
+
+D3D12_COMMAND_SIGNATURE_DESC CullContextClass::GetCommandSignatureDesc()
+{
+    // The argument buffer holds nothing but tightly packed indexed draw arguments.
+    D3D12_COMMAND_SIGNATURE_DESC commandSignatureDesc{};
+    commandSignatureDesc.ByteStride       = sizeof(D3D12_DRAW_INDEXED_ARGUMENTS);
+    commandSignatureDesc.NumArgumentDescs = 1;
+    commandSignatureDesc.pArgumentDescs   = &g_drawArgumentDesc;
+    commandSignatureDesc.NodeMask         = 0;
+    return commandSignatureDesc;
+}
+
+
+D3D12_DRAW_INDEXED_ARGUMENTS CullContextClass::PackDrawArguments(UINT indexCount, UINT instanceCount, UINT startIndex, INT baseVertex)
+{
+    // The kernel only ever adds to the instance count; everything else is set up front, including
+    // where the mesh sits in the shared vertex and index buffers.
+    D3D12_DRAW_INDEXED_ARGUMENTS arguments{};
+    arguments.IndexCountPerInstance = indexCount;
+    arguments.InstanceCount         = instanceCount;
+    arguments.StartIndexLocation    = startIndex;
+    arguments.BaseVertexLocation    = baseVertex;
+    arguments.StartInstanceLocation = 0u;
+    return arguments;
+}
+
+
+void CullContextClass::CullReference(WorkerPoolClass                       *workers,
+                                     const FrustumCullerClass::FrustumType &frustum,
+                                     float                                  radius,
+                                     UINT                                   instanceCount,
+                                     const BYTE                            *instances,
+                                     UINT                                   instanceStride,
+                                     BYTE                                  *visibleInstances,
+                                     D3D12_DRAW_INDEXED_ARGUMENTS          *drawArguments)
+{
+    // Fill in the same constants a dispatch would.
+    CullBufferType cull{};
+    for (UINT i = 0u; i < 6u; ++i)
+    {
+        cull.planes[i] = frustum.planes[i];
+    }
+    cull.instanceCount = instanceCount;
+    cull.radius        = radius;
+
+    // Run the kernel's thread groups as jobs on the workers, so they finish in no particular
+    // order and race for slots like the GPU's do.  The instance count of the arguments stands in
+    // for the word the kernel adds to, so whatever it held before is appended after.
+    std::atomic<UINT> visibleCount(drawArguments->InstanceCount);
+    workers->Dispatch((instanceCount + THREAD_GROUP_SIZE - 1u) / THREAD_GROUP_SIZE, [&](UINT group)
+    {
+        CullReferenceGroup(cull, group, instances, instanceStride, visibleInstances, visibleCount);
+    });
+    drawArguments->InstanceCount = visibleCount.load();
+}
+
+
+void CullContextClass::CullReferenceGroup(const CullBufferType &cull,
+                                          UINT                  group,
+                                          const BYTE           *instances,
+                                          UINT                  instanceStride,
+                                          BYTE                 *visibleInstances,
+                                          std::atomic<UINT>    &visibleCount)
+{
+    for (UINT thread = 0u; thread < THREAD_GROUP_SIZE; ++thread)
+    {
+        // The last group may run past the end of the instances.
+        const UINT instance = group * THREAD_GROUP_SIZE + thread;
+        if (instance >= cull.instanceCount)
+        {
+            return;
+        }
+
+        // Test the sphere the way the kernel does, adding the plane's distance after the dot
+        // product, and keep the instance unless it is entirely behind one of the planes.
+        const BYTE *source = instances + static_cast<size_t>(instance) * instanceStride;
+        XMFLOAT3 position;
+        memcpy(&position, source, sizeof(position));
+
+        bool visible = true;
+        for (UINT i = 0u; i < 6u && visible; ++i)
+        {
+            XMFLOAT4 plane;
+            XMStoreFloat4(&plane, cull.planes[i]);
+            const float distance = (plane.x * position.x + plane.y * position.y + plane.z * position.z) + plane.w;
+            visible = !(distance < -cull.radius);
+        }
+
+        // Claim the next slot and copy the whole instance into it.
+        if (visible)
+        {
+            const UINT slot = visibleCount.fetch_add(1u);
+            memcpy(visibleInstances + static_cast<size_t>(slot) * instanceStride, source, instanceStride);
+        }
+    }
+}
+
+
+void CullContextClass::InitializeRootSignature(ID3D12Device *device)
+{
+    // Create descriptors for the cull buffer, the instances to cull, and the two outputs.
+    D3D12_ROOT_PARAMETER parameterDescs[4]{};
+    parameterDescs[CULL_BUFFER_PARAMETER].ParameterType             = D3D12_ROOT_PARAMETER_TYPE_CBV;
+    parameterDescs[CULL_BUFFER_PARAMETER].Descriptor.ShaderRegister = 0;
+    parameterDescs[CULL_BUFFER_PARAMETER].Descriptor.RegisterSpace  = 0;
+    parameterDescs[CULL_BUFFER_PARAMETER].ShaderVisibility          = D3D12_SHADER_VISIBILITY_ALL;
+
+    parameterDescs[INSTANCE_BUFFER_PARAMETER].ParameterType             = D3D12_ROOT_PARAMETER_TYPE_SRV;
+    parameterDescs[INSTANCE_BUFFER_PARAMETER].Descriptor.ShaderRegister = 0;
+    parameterDescs[INSTANCE_BUFFER_PARAMETER].Descriptor.RegisterSpace  = 0;
+    parameterDescs[INSTANCE_BUFFER_PARAMETER].ShaderVisibility          = D3D12_SHADER_VISIBILITY_ALL;
+
+    parameterDescs[VISIBLE_BUFFER_PARAMETER].ParameterType             = D3D12_ROOT_PARAMETER_TYPE_UAV;
+    parameterDescs[VISIBLE_BUFFER_PARAMETER].Descriptor.ShaderRegister = 0;
+    parameterDescs[VISIBLE_BUFFER_PARAMETER].Descriptor.RegisterSpace  = 0;
+    parameterDescs[VISIBLE_BUFFER_PARAMETER].ShaderVisibility          = D3D12_SHADER_VISIBILITY_ALL;
+
+    parameterDescs[ARGUMENT_BUFFER_PARAMETER].ParameterType             = D3D12_ROOT_PARAMETER_TYPE_UAV;
+    parameterDescs[ARGUMENT_BUFFER_PARAMETER].Descriptor.ShaderRegister = 1;
+    parameterDescs[ARGUMENT_BUFFER_PARAMETER].Descriptor.RegisterSpace  = 0;
+    parameterDescs[ARGUMENT_BUFFER_PARAMETER].ShaderVisibility          = D3D12_SHADER_VISIBILITY_ALL;
+
+    // Fill out the root signature layout description; compute has no input assembler.
+    D3D12_ROOT_SIGNATURE_DESC rootSignatureDesc{};
+    rootSignatureDesc.NumParameters     = _countof(parameterDescs);
+    rootSignatureDesc.pParameters       = parameterDescs;
+    rootSignatureDesc.NumStaticSamplers = 0;
+    rootSignatureDesc.pStaticSamplers   = nullptr;
+    rootSignatureDesc.Flags             = D3D12_ROOT_SIGNATURE_FLAG_NONE;
+
+    // Fetch the root signature from the cache, which shares it with every context using the same
+    // layout and only serializes it if no earlier run already did.
+    m_rootSignature = p_pipelineCache->GetRootSignature(device, rootSignatureDesc);
+}
+
+
+void CullContextClass::InitializeContext(ID3D12Device *device)
+{
+    // Check that the root signature is properly set up before using.
+    THROW_IF_FALSE(
+        m_rootSignature,
+        "Interface failed to initialize root signature correctly."
+    );
+
+    // Load the kernel, then build the pipeline state around it.
+    SetShaderBytecode();
+    InitializeState(device);
+
+    // Create the command signature that lets the GPU feed our draws their arguments.  It only
+    // holds draw arguments, so it does not need a root signature.
+    const D3D12_COMMAND_SIGNATURE_DESC commandSignatureDesc = GetCommandSignatureDesc();
+    THROW_IF_FAILED(
+        device->CreateCommandSignature(
+            &commandSignatureDesc,
+            nullptr,
+            IID_PPV_ARGS(m_commandSignature.ReleaseAndGetAddressOf())),
+        "Unable to create the command signature for indirect draws."
+    );
+    CommandStreamClass::SetRecipe(m_commandSignature.Get(), commandSignatureDesc, nullptr);
+}
+
+
+void CullContextClass::InitializeState(ID3D12Device *device)
+{
+    // Set up the Pipeline State for the cull kernel.
+    D3D12_COMPUTE_PIPELINE_STATE_DESC pipelineStateDesc{};
+    pipelineStateDesc.pRootSignature = m_rootSignature.Get();
+    pipelineStateDesc.CS             = m_csBytecode;
+    pipelineStateDesc.NodeMask       = 0;
+    pipelineStateDesc.CachedPSO      = {};
+    pipelineStateDesc.Flags          = D3D12_PIPELINE_STATE_FLAG_NONE;
+
+    // Fetch the pipeline state object from the cache, compiling it only if it is not already there.
+    m_state = p_pipelineCache->GetComputeState(device, pipelineStateDesc);
+}
+
+
+void CullContextClass::SetShaderBytecode()
+{
+    // Create the descriptor for the compute shader bytecode.
+    m_csBytecode.pShaderBytecode = g_cullcs;
+    m_csBytecode.BytecodeLength  = sizeof(g_cullcs);
+}
+
+
+void CullContextClass::NameD3DResources()
+{
+    // Name all DirectX objects.
+    m_rootSignature->SetName(L"CuCC root signature");
+    m_state->SetName(L"CuCC pipeline state");
+    m_commandSignature->SetName(L"CuCC command signature");
+}
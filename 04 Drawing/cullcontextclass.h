@@ -0,0 +1,77 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: cullcontextclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include "contextinterface.h"
+#include "frustumcullerclass.h"
+
+
+/////////////
+// SHADERS //
+/////////////
+#include "cull.cs.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: CullContextClass
+////////////////////////////////////////////////////////////////////////////////
+class CullContextClass : public ContextInterface
+{
+private:
+    struct CullBufferType
+    {
+        XMVECTOR planes[6];
+        UINT     instanceCount;
+        float    radius;
+    };
+
+    // The root parameters of the cull kernel.
+    static constexpr UINT CULL_BUFFER_PARAMETER     = 0u;
+    static constexpr UINT INSTANCE_BUFFER_PARAMETER = 1u;
+    static constexpr UINT VISIBLE_BUFFER_PARAMETER  = 2u;
+    static constexpr UINT ARGUMENT_BUFFER_PARAMETER = 3u;
+
+    // Instances each thread group of the kernel culls; this has to match the kernel.
+    static constexpr UINT THREAD_GROUP_SIZE = 64u;
+
+public:
+    CullContextClass() = delete;
+    CullContextClass(const CullContextClass &) = delete;
+    CullContextClass& operator=(const CullContextClass &) = delete;
+
+    CullContextClass(ID3D12Device *, ConstantArenaClass *, PipelineCacheClass *);
+    ~CullContextClass() = default;
+
+    ID3D12CommandSignature * GetCommandSignature();
+
+    void UpdateShaderParameters() override;
+    void SetShaderParameters(PipelineClass *) override;
+
+    void Dispatch(PipelineClass *, const FrustumCullerClass::FrustumType &, float, UINT, D3D12_GPU_VIRTUAL_ADDRESS, D3D12_GPU_VIRTUAL_ADDRESS, D3D12_GPU_VIRTUAL_ADDRESS);
+
+    static D3D12_COMMAND_SIGNATURE_DESC GetCommandSignatureDesc();
+    static D3D12_DRAW_INDEXED_ARGUMENTS PackDrawArguments(UINT, UINT = 0u, UINT = 0u, INT = 0);
+    static void CullReference(WorkerPoolClass *, const FrustumCullerClass::FrustumType &, float, UINT, const BYTE *, UINT, BYTE *, D3D12_DRAW_INDEXED_ARGUMENTS *);
+
+private:
+    static void CullReferenceGroup(const CullBufferType &, UINT, const BYTE *, UINT, BYTE *, std::atomic<UINT> &);
+
+protected:
+    void InitializeRootSignature(ID3D12Device *) override;
+    void InitializeContext(ID3D12Device *) override;
+    void InitializeState(ID3D12Device *) override;
+
+    void SetShaderBytecode() override;
+
+    void NameD3DResources() override;
+
+private:
+    D3D12_SHADER_BYTECODE m_csBytecode = {};
+
+    ComPtr<ID3D12CommandSignature> m_commandSignature = nullptr;
+};
@@ -1,65 +1,93 @@
-////////////////////////////////////////////////////////////////////////////////
-// Filename: d3dclass.h
-////////////////////////////////////////////////////////////////////////////////
-#pragma once
-
-
-////////////////////////////////////////////////////////////////////////////////
-// Class name: D3DClass
-////////////////////////////////////////////////////////////////////////////////
-class D3DClass
-{
-public:
-    D3DClass() = delete;
-    D3DClass(const D3DClass &) = delete;
-    D3DClass & operator=(const D3DClass &) = delete;
-
-protected:
-    D3DClass(HWND, UINT, UINT, bool, bool);
-    ~D3DClass();
-
-    ID3D12Device * GetDevice();
-    uint32_t & GetBufferIndex();
-
-    void SetClearColor(float, float, float, float);
-
-    void SubmitToQueue(std::vector<ID3D12CommandList *>, bool);
-
-    void WaitForNextAvailableFrame();
-    void WaitForAllFrames();
-
-    void ResetViews(ID3D12GraphicsCommandList *);
-
-    D3D12_RESOURCE_BARRIER StartBarrier();
-    D3D12_RESOURCE_BARRIER FinishBarrier();
-
-private:
-    void WaitForFrameIndex(const uint32_t);
-
-    void InitializeDevice();
-    void InitializeCommandQueue();
-    void InitializeSwapChain(HWND, UINT, UINT, bool, bool);
-    void InitializeRenderTargets();
-    void InitializeDepthStencil(UINT, UINT);
-    void InitializeFences();
-
-    void NameResources();
-
-private:
-    uint32_t m_bufferIndex     = 0u;
-    size_t   m_videoCardMemory = 0ull;
-    float    m_clearColor[4]   = { 0.0f, 0.0f, 0.0f, 1.0f };
-
-    ComPtr<IDXGISwapChain3>    m_swapChain    = nullptr;
-    ComPtr<ID3D12Device>       m_device       = nullptr;
-    ComPtr<ID3D12CommandQueue> m_commandQueue = nullptr;
-
-    ComPtr<ID3D12DescriptorHeap>                           m_renderTargetViewHeap   = nullptr;
-    std::array<ComPtr<ID3D12Resource>, FRAME_BUFFER_COUNT> m_backBufferRenderTarget = {};
-    ComPtr<ID3D12DescriptorHeap>                           m_depthStencilViewHeap   = nullptr;
-    ComPtr<ID3D12Resource>                                 m_depthStencil           = nullptr;
-
-    std::array<ComPtr<ID3D12Fence>, FRAME_BUFFER_COUNT> m_fence      = {};
-    std::array<UINT64, FRAME_BUFFER_COUNT>              m_fenceValue = {};
-    HANDLE                                              m_fenceEvent = nullptr;
-};
+////////////////////////////////////////////////////////////////////////////////
+// Filename: d3dclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include "windowbackendclass.h"
+#include "headlessbackendclass.h"
+#include "pipelineclass.h"
+#include "constantarenaclass.h"
+#include "pipelinecacheclass.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: D3DClass
+////////////////////////////////////////////////////////////////////////////////
+class D3DClass
+{
+public:
+    D3DClass() = delete;
+    D3DClass(const D3DClass &) = delete;
+    D3DClass & operator=(const D3DClass &) = delete;
+
+protected:
+    D3DClass(HWND, UINT, UINT, bool, bool, UINT);
+    D3DClass(UINT, UINT, UINT, HeadlessBackendClass::DeviceType);
+    ~D3DClass();
+
+    ID3D12Device * GetDevice();
+    ID3D12CommandQueue * GetCommandQueue();
+    const uint32_t & GetFrameIndex();
+    UINT GetFramesInFlight();
+    GpuAllocatorClass * GetAllocator();
+    ConstantArenaClass * GetConstantArena();
+    PipelineCacheClass * GetPipelineCache();
+    ResourceStateTrackerClass * GetResourceStates();
+    ID3D12Resource * GetBackBuffer();
+    ID3D12Resource * GetDepthBuffer();
+
+    void SetClearColor(float, float, float, float);
+
+    void SubmitToQueue(const std::vector<ID3D12CommandList *> &, bool);
+
+    bool IsNextFrameAvailable();
+    void WaitForNextAvailableFrame();
+    void WaitForAllFrames();
+
+    void SetViews(PipelineClass *);
+    void ResetViews(PipelineClass *);
+    void CaptureViews(CommandStreamClass *);
+
+private:
+    void WaitForFenceValue(UINT64);
+
+    D3D12_CPU_DESCRIPTOR_HANDLE GetRenderTargetView();
+    D3D12_CPU_DESCRIPTOR_HANDLE GetDepthStencilView();
+
+    void InitializeResources(UINT, UINT, UINT);
+    void InitializeRenderTargets();
+    void InitializeDepthStencil(UINT, UINT);
+    void InitializeFences();
+
+    void NameResources();
+
+private:
+    uint32_t m_bufferIndex    = 0u;
+    uint32_t m_frameIndex     = 0u;
+    UINT     m_framesInFlight = 0u;
+    float    m_clearColor[4]  = { 0.0f, 0.0f, 0.0f, 1.0f };
+
+    std::unique_ptr<BackendInterface>   m_backend       = nullptr;
+    std::unique_ptr<GpuAllocatorClass>  m_allocator     = nullptr;
+    std::unique_ptr<ConstantArenaClass> m_constantArena = nullptr;
+    std::unique_ptr<PipelineCacheClass> m_pipelineCache = nullptr;
+
+    // The state every resource is left in by the lists submitted so far.
+    std::unique_ptr<ResourceStateTrackerClass> m_resourceStates = nullptr;
+
+    ComPtr<ID3D12DescriptorHeap>                           m_renderTargetViewHeap   = nullptr;
+    std::array<ComPtr<ID3D12Resource>, FRAME_BUFFER_COUNT> m_backBufferRenderTarget = {};
+    ComPtr<ID3D12DescriptorHeap>                           m_depthStencilViewHeap   = nullptr;
+    GpuAllocatorClass::AllocationType                      m_depthStencil           = {};
+
+    // One fence for the direct queue whose value only ever goes up.  Every submitted frame signals
+    // the next value, and each set of per-frame resources remembers the value of the last frame
+    // that used it.
+    ComPtr<ID3D12Fence>                      m_fence            = nullptr;
+    UINT64                                   m_fenceValue       = 0ull;
+    std::array<UINT64, MAX_FRAMES_IN_FLIGHT> m_frameFenceValues = {};
+};
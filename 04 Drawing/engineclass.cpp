@@ -1,69 +1,532 @@
-////////////////////////////////////////////////////////////////////////////////
-// Filename: engineclass.cpp
-////////////////////////////////////////////////////////////////////////////////
-#include "pch.h"
-#include "engineclass.h"
-
-
-EngineClass::EngineClass(HWND hWnd, UINT xResolution, UINT yResolution, bool fullscreen)
-    : D3DClass(hWnd, xResolution, yResolution, fullscreen, m_vsyncEnabled)
-    , m_Camera(std::make_unique<CameraClass>(xResolution, yResolution, 45.0f))
-    , m_Pipeline(std::make_unique<PipelineClass>(GetDevice(), GetBufferIndex()))
-    , m_Context(std::make_unique<InstanceContextClass>(GetDevice(),
-                                                       GetBufferIndex(),
-                                                       m_Camera->GetViewMatrix(),
-                                                       m_Camera->GetProjectionMatrix(),
-                                                       xResolution, yResolution))
-    , m_Geometry(std::make_unique<QuadClass>(GetDevice()))
-{
-    // Move the camera back so we can see our scene.
-    m_Camera->SetPosition(0.0f, 0.0f, -10.0f);
-
-    // Set the backdground to a neutral gray color.
-    SetClearColor(0.2f, 0.2f, 0.2f, 1.0f);
-}
-
-
-EngineClass::~EngineClass()
-{
-    // Wait for all frames to finish before the unique_ptrs can release.
-    WaitForAllFrames();
-}
-
-
-void EngineClass::Frame()
-{
-    // Generate the view matrix based on the camera's position.
-    m_Camera->Render();
-
-    // Render the graphics scene.
-    Render();
-
-    // Collect all one of our command lists to be drawn this frame, (only one for now).
-    std::vector<ID3D12CommandList*> lists;
-    lists.push_back(m_Pipeline->GetCommandList());
-
-    // Finish the scene and submit our lists for drawing.
-    SubmitToQueue(lists, m_vsyncEnabled);
-}
-
-
-void EngineClass::Render()
-{
-    // Advance the buffer index and wait for the corresponding buffer to be available.
-    WaitForNextAvailableFrame();
-
-    // Open our pipeline, set a transition barrier, then reset the RTV and DSV.
-    m_Pipeline->Open();
-    m_Pipeline->SetState(m_Context->GetState());
-    m_Pipeline->AddBarrier(StartBarrier());
-    ResetViews(m_Pipeline->GetCommandList());
-
-    // Communicate the matrices to the vertex shader and submit the geometry to the pipeline.
-    m_Context->SetShaderParameters(m_Pipeline->GetCommandList());
-    m_Geometry->Render(m_Pipeline->GetCommandList());
-
-    // Add a final transition barrier and close the pipeline.
-    m_Pipeline->AddBarrier(FinishBarrier());
-    m_Pipeline->Close();
-}
+////////////////////////////////////////////////////////////////////////////////
+// Filename: engineclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "engineclass.h"
+
+
+EngineClass::EngineClass(HWND hWnd, UINT xResolution, UINT yResolution, bool fullscreen, UINT framesInFlight, const SceneType &scene)
+    : D3DClass(hWnd, xResolution, yResolution, fullscreen, m_vsyncEnabled, framesInFlight),
+      m_gpuCulling(scene.gpuCulling)
+{
+    InitializeScene(xResolution, yResolution, scene);
+}
+
+
+EngineClass::EngineClass(UINT xResolution, UINT yResolution, UINT framesInFlight, const SceneType &scene, DeviceType deviceType)
+    : D3DClass(xResolution, yResolution, framesInFlight, deviceType),
+      m_gpuCulling(scene.gpuCulling)
+{
+    // Without a window, we render into offscreen back buffers on the software adapter or the null
+    // device.
+    InitializeScene(xResolution, yResolution, scene);
+}
+
+
+EngineClass::~EngineClass()
+{
+    // Wait for all frames and uploads to finish before the unique_ptrs can release.
+    WaitForAllFrames();
+    m_Uploader->WaitForIdle();
+}
+
+
+bool EngineClass::IsFrameAvailable()
+{
+    // Frame would not have to wait on the GPU before it could start recording.
+    return IsNextFrameAvailable();
+}
+
+
+bool EngineClass::IsSceneReady()
+{
+    return m_sceneReady;
+}
+
+
+void EngineClass::Frame()
+{
+    ProfilerClass::ScopeType frameScope(m_Profiler.get(), "Frame");
+
+    // Wait for the swap chain and the next frame's resources before doing any work, so the camera
+    // and the scene are sampled as late as possible and reach the screen with the least delay.
+    {
+        ProfilerClass::ScopeType scope(m_Profiler.get(), "WaitForNextAvailableFrame");
+        const auto waitStart = std::chrono::steady_clock::now();
+        WaitForNextAvailableFrame();
+        m_waitSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - waitStart).count();
+    }
+
+    // The GPU is done with the last frame that used these resources, so its timestamps are ready.
+    m_GpuTimer->Collect();
+
+    // Generate the view matrix based on the camera's position.
+    m_Camera->Render();
+
+    // The scene can be drawn once startup has compiled every context.  The first frame to find
+    // startup complete also surfaces anything that went wrong during it.
+    if (!m_sceneReady && m_Startup->IsComplete())
+    {
+        m_Startup->Wait();
+        m_sceneReady = true;
+    }
+
+    // Render the graphics scene, or the loading screen until it is ready.
+    if (m_sceneReady)
+    {
+        Render();
+    }
+    else
+    {
+        RenderLoading();
+    }
+
+    // Collect our command lists in the order they were meant to execute: the frame setup first,
+    // followed by each worker's draws.  The loading screen only has the setup list.
+    m_commandLists.clear();
+    m_commandLists.push_back(m_Pipeline->GetCommandList());
+    if (m_sceneReady)
+    {
+        for (std::unique_ptr<PipelineClass> &pipeline : m_WorkerPipelines)
+        {
+            m_commandLists.push_back(pipeline->GetCommandList());
+        }
+    }
+
+    // Finish the scene and submit our lists for drawing.
+    {
+        ProfilerClass::ScopeType scope(m_Profiler.get(), "SubmitToQueue");
+        SubmitToQueue(m_commandLists, m_vsyncEnabled);
+    }
+
+    // Note how long it took to get the first frame, and the first frame of the scene, on screen.
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_startTime).count();
+    if (m_timeToFirstFrame == 0.0)
+    {
+        m_timeToFirstFrame = elapsed;
+    }
+    if (m_sceneReady && m_timeToFirstSceneFrame == 0.0)
+    {
+        m_timeToFirstSceneFrame = elapsed;
+    }
+
+    // Fold this frame's timings into the rolling percentiles.
+    m_Profiler->EndFrame();
+}
+
+
+void EngineClass::CaptureFrame(const std::wstring &filename)
+{
+    // The next frame we render will be recorded and saved to this file.
+    m_captureFilename = filename;
+}
+
+
+void EngineClass::ExecuteRenderGraph(RenderGraphClass *graph, UINT backBufferResource)
+{
+    // Run a graph other than the frame's once, between frames, so its transient textures are
+    // placed, aliased and discarded on the device for real.  It gets a pipeline and resource
+    // states of its own, which go away before the textures do.
+    WaitForAllFrames();
+
+    ResourceStateTrackerClass resourceStates;
+    graph->Realize(GetDevice(), &resourceStates);
+    graph->SetResource(backBufferResource, GetBackBuffer());
+
+    PipelineClass pipeline(GetDevice(), GetFrameIndex(), &resourceStates);
+    pipeline.Open();
+    graph->Execute(&pipeline);
+
+    // The frames expect the back buffer back where they present it from.
+    pipeline.Transition(GetBackBuffer(), D3D12_RESOURCE_STATE_PRESENT);
+    pipeline.Close();
+
+    ID3D12CommandList *commandList = pipeline.GetCommandList();
+    GetCommandQueue()->ExecuteCommandLists(1u, &commandList);
+    WaitForAllFrames();
+}
+
+
+CameraClass * EngineClass::GetCamera()
+{
+    return m_Camera.get();
+}
+
+
+float EngineClass::GetSceneExtent()
+{
+    return m_sceneExtent;
+}
+
+
+double EngineClass::GetWaitSeconds()
+{
+    return m_waitSeconds;
+}
+
+
+double EngineClass::GetTimeToFirstFrame()
+{
+    return m_timeToFirstFrame;
+}
+
+
+double EngineClass::GetTimeToFirstSceneFrame()
+{
+    return m_timeToFirstSceneFrame;
+}
+
+
+ProfilerClass * EngineClass::GetProfiler()
+{
+    return m_Profiler.get();
+}
+
+
+EngineClass::StatisticsType EngineClass::GetStatistics()
+{
+    StatisticsType statistics;
+    statistics.packetCount  = m_RenderQueue->GetPacketCount();
+    statistics.stateChanges = m_RenderQueue->CountStateChanges();
+    statistics.sortSeconds  = m_RenderQueue->GetSortSeconds();
+
+    // Add up the binds of every list the frame was recorded into.
+    statistics.bindCount   = m_Pipeline->GetBindCount();
+    statistics.elidedCount = m_Pipeline->GetElidedCount();
+    for (std::unique_ptr<PipelineClass> &pipeline : m_WorkerPipelines)
+    {
+        statistics.bindCount   += pipeline->GetBindCount();
+        statistics.elidedCount += pipeline->GetElidedCount();
+    }
+
+    return statistics;
+}
+
+
+void EngineClass::Render()
+{
+    ProfilerClass::ScopeType scope(m_Profiler.get(), "Render");
+
+    // Send any uploads queued since the last frame to the copy queue; they stream in alongside
+    // rendering instead of stalling it.
+    m_Uploader->Flush();
+
+    // If a capture was requested, record every command of this frame into the capture stream.
+    const bool capturing = !m_captureFilename.empty();
+    if (capturing)
+    {
+        m_Capture->Clear();
+        m_Pipeline->StartRecording(m_Capture.get());
+        for (std::unique_ptr<PipelineClass> &pipeline : m_WorkerPipelines)
+        {
+            pipeline->StartRecording(m_Capture.get());
+        }
+    }
+
+    // Communicate the matrices to the vertex shader once, before any worker binds them.  Every
+    // object's world matrix and the unpacking of its mesh go into one structured buffer, which
+    // each list binds only once.
+    m_Context->UpdateShaderParameters();
+    RenderContextInterface::ObjectType *objects = m_Context->UpdateObjectTransforms(static_cast<UINT>(m_Geometry.size()));
+    for (size_t i = 0; i < m_Geometry.size(); ++i)
+    {
+        const GeometryPoolClass::MeshType &mesh = m_Geometry[i]->GetMesh();
+        objects[i].world         = XMMatrixTranspose(m_Geometry[i]->GetWorldMatrix());
+        objects[i].positionScale = mesh.positionScale;
+        objects[i].positionBias  = mesh.positionBias;
+    }
+
+    // The other contexts index the same transforms.
+    if (m_ColorContext)
+    {
+        m_ColorContext->UpdateShaderParameters();
+        m_ColorContext->SetObjectTransforms(m_Context->GetObjectTransforms());
+    }
+
+    // Open our setup pipeline and run the render graph on it, which moves the back buffer over to
+    // be drawn to, resets the RTV and DSV, and culls the geometry.
+    m_Pipeline->Open();
+    const UINT setupScope = m_GpuTimer->Begin(m_Pipeline.get(), "Setup");
+    m_RenderGraph->SetResource(m_backBufferResource, GetBackBuffer());
+    m_RenderGraph->Execute(m_Pipeline.get());
+    m_GpuTimer->End(m_Pipeline.get(), setupScope);
+    m_Pipeline->Close();
+
+    // The workers' lists pick up every resource where the setup list leaves it.
+    GetResourceStates()->Commit(m_Pipeline->GetResourceStates());
+
+    // Queue a draw for every piece of geometry that has arrived on the GPU, and sort them so that
+    // draws sharing state end up next to each other, nearest first.
+    const XMMATRIX viewProjection = XMMatrixMultiply(m_Camera->GetViewMatrix(), m_Camera->GetProjectionMatrix());
+    m_RenderQueue->Reset();
+    for (size_t i = 0; i < m_Geometry.size(); ++i)
+    {
+        GeometryInterface *geometry = m_Geometry[i].get();
+        if (!geometry->IsResident())
+        {
+            continue;
+        }
+
+        const XMVECTOR position = XMVector3TransformCoord(geometry->GetWorldMatrix().r[3], viewProjection);
+
+        RenderContextInterface *context = GetContext(m_GeometryContexts[i]);
+
+        RenderQueueClass::DrawPacketType packet;
+        packet.sortKey     = m_RenderQueue->MakeSortKey(context, geometry, XMVectorGetZ(position));
+        packet.context     = context;
+        packet.geometry    = geometry;
+        packet.objectIndex = static_cast<UINT>(i);
+        m_RenderQueue->Submit(packet);
+    }
+    m_RenderQueue->Sort();
+
+    // Record the draws on every worker at once.  A capture shares one stream between all the
+    // pipelines, so in that case we record them one after another to keep the stream in order.
+    const UINT listCount = static_cast<UINT>(m_WorkerPipelines.size());
+    if (capturing)
+    {
+        for (UINT i = 0u; i < listCount; ++i)
+        {
+            RecordDraws(i);
+        }
+    }
+    else
+    {
+        m_Workers->Dispatch(listCount, m_recordDraws);
+    }
+
+    // The lists execute in order, so their states are passed on in that order as well.
+    for (std::unique_ptr<PipelineClass> &pipeline : m_WorkerPipelines)
+    {
+        GetResourceStates()->Commit(pipeline->GetResourceStates());
+    }
+
+    // Write out the captured frame, if there was one.
+    if (capturing)
+    {
+        m_Pipeline->StopRecording();
+        for (std::unique_ptr<PipelineClass> &pipeline : m_WorkerPipelines)
+        {
+            pipeline->StopRecording();
+        }
+        GetAllocator()->CaptureBuffers(m_Capture.get());
+        CaptureViews(m_Capture.get());
+        m_Capture->Save(m_captureFilename);
+        m_captureFilename.clear();
+    }
+}
+
+
+void EngineClass::RenderLoading()
+{
+    // Keep streaming the scene's geometry in while the contexts compile.
+    m_Uploader->Flush();
+
+    // The loading screen is just the cleared back buffer, so the setup list transitions it, clears
+    // it, and hands it straight back for presenting.
+    m_Pipeline->Open();
+    m_Pipeline->Transition(GetBackBuffer(), D3D12_RESOURCE_STATE_RENDER_TARGET);
+    ResetViews(m_Pipeline.get());
+    m_Pipeline->Transition(GetBackBuffer(), D3D12_RESOURCE_STATE_PRESENT);
+    m_Pipeline->Close();
+    GetResourceStates()->Commit(m_Pipeline->GetResourceStates());
+}
+
+
+void EngineClass::CullGeometry(PipelineClass *pipeline)
+{
+    // Cull every piece of geometry against the camera before any of it is drawn.  On the GPU, the
+    // cull kernel runs at the end of the setup list and leaves the draw arguments behind for the
+    // workers' lists.  On the CPU, the culler spreads large sets of instances across the workers.
+    const XMMATRIX viewProjection = XMMatrixMultiply(m_Camera->GetViewMatrix(), m_Camera->GetProjectionMatrix());
+    if (m_gpuCulling)
+    {
+        m_CullContext->SetShaderParameters(pipeline);
+        for (std::unique_ptr<GeometryInterface> &geometry : m_Geometry)
+        {
+            if (geometry->IsResident())
+            {
+                geometry->CullIndirect(pipeline, m_CullContext.get(), GetConstantArena(), viewProjection);
+            }
+        }
+    }
+    else
+    {
+        for (std::unique_ptr<GeometryInterface> &geometry : m_Geometry)
+        {
+            geometry->Cull(m_Culler.get(), GetConstantArena(), viewProjection);
+        }
+    }
+}
+
+
+void EngineClass::RecordDraws(UINT listIndex)
+{
+    PipelineClass *pipeline = m_WorkerPipelines[listIndex].get();
+    const UINT listCount = static_cast<UINT>(m_WorkerPipelines.size());
+
+    // Open this worker's pipeline and restore the render targets every list has to set for itself.
+    pipeline->Open();
+    const UINT drawScope = m_GpuTimer->Begin(pipeline, "Draws");
+    SetViews(pipeline);
+
+    // Every mesh lives in the same vertex and index buffers, so they are bound once for the list.
+    m_GeometryPool->Bind(pipeline);
+
+    // Record this worker's even share of the sorted draws.  The queue binds each context as its
+    // draws come up, so every list sets the state it needs on its own.
+    const UINT packetCount = m_RenderQueue->GetPacketCount();
+    const UINT first       = packetCount * listIndex / listCount;
+    const UINT last        = packetCount * (listIndex + 1u) / listCount;
+    m_RenderQueue->Record(pipeline, first, last, m_Profiler.get());
+
+    // The last list to execute hands the back buffer back for presenting.
+    if (listIndex + 1u == listCount)
+    {
+        pipeline->Transition(GetBackBuffer(), D3D12_RESOURCE_STATE_PRESENT);
+    }
+
+    m_GpuTimer->End(pipeline, drawScope);
+    pipeline->Close();
+}
+
+
+RenderContextInterface * EngineClass::GetContext(ContextType type)
+{
+    switch (type)
+    {
+    case ContextType::Color:
+        return m_ColorContext.get();
+
+    case ContextType::Instance:
+    default:
+        return m_Context.get();
+    }
+}
+
+
+void EngineClass::InitializeScene(UINT xResolution, UINT yResolution, const SceneType &scene)
+{
+    // Use one worker per hardware thread; the count may be unknown, in which case we use one.
+    const UINT workerCount = std::thread::hardware_concurrency();
+
+    // Create the camera, workers, pipelines, and everything else the main thread needs right away.
+    m_Camera       = std::make_unique<CameraClass>(xResolution, yResolution, 45.0f);
+    m_Workers      = std::make_unique<WorkerPoolClass>(workerCount ? workerCount : 1u);
+    m_Pipeline     = std::make_unique<PipelineClass>(GetDevice(), GetFrameIndex(), GetResourceStates());
+    m_Uploader     = std::make_unique<UploadRingClass>(GetAllocator());
+    m_GeometryPool = std::make_unique<GeometryPoolClass>(GetAllocator(), m_Uploader.get());
+    m_Culler       = std::make_unique<FrustumCullerClass>(m_Workers.get());
+    m_RenderQueue  = std::make_unique<RenderQueueClass>();
+    m_Profiler     = std::make_unique<ProfilerClass>();
+    m_GpuTimer     = std::make_unique<GpuTimerClass>(GetAllocator(), GetCommandQueue(), m_Profiler.get(), GetFrameIndex());
+    m_Capture      = std::make_unique<CommandStreamClass>();
+
+    // Give every worker its own pipeline, so each records into its own allocators and list.
+    for (UINT i = 0u; i < m_Workers->GetWorkerCount(); ++i)
+    {
+        m_WorkerPipelines.push_back(std::make_unique<PipelineClass>(GetDevice(), GetFrameIndex(), GetResourceStates()));
+    }
+    m_commandLists.reserve(m_WorkerPipelines.size() + 1u);
+    m_recordDraws = [this](UINT listIndex) { RecordDraws(listIndex); };
+    InitializeRenderGraph();
+
+    // Build the scene, quads first, then triangles, then the mesh asset if there is one, on a grid
+    // centered in front of the camera and spaced so that the instances of neighbouring quads never
+    // overlap.  Its uploads are sent to the copy queue with the first frame, and each piece of
+    // geometry shows up as soon as its own copies are done.
+    const UINT  meshCount       = scene.meshFilename.empty() ? 0u : 1u;
+    const UINT  objectCount     = scene.quadCount + scene.triangleCount + meshCount;
+    const UINT  columns         = static_cast<UINT>(std::ceil(std::sqrt(static_cast<float>(objectCount))));
+    const UINT  rows            = columns ? (objectCount + columns - 1u) / columns : 0u;
+    const float instanceColumns = std::ceil(std::sqrt(static_cast<float>(scene.instancesPerQuad)));
+    const float spacing         = 4.0f * instanceColumns + 2.0f;
+    for (UINT i = 0u; i < objectCount; ++i)
+    {
+        if (i < scene.quadCount)
+        {
+            m_Geometry.push_back(std::make_unique<QuadClass>(m_GeometryPool.get(), GetAllocator(), m_Uploader.get(), scene.instancesPerQuad));
+            m_GeometryContexts.push_back(ContextType::Instance);
+        }
+        else if (i < scene.quadCount + scene.triangleCount)
+        {
+            m_Geometry.push_back(std::make_unique<TriangleClass>(m_GeometryPool.get()));
+            m_GeometryContexts.push_back(ContextType::Color);
+        }
+        else
+        {
+            std::unique_ptr<MeshClass> mesh = std::make_unique<MeshClass>(m_GeometryPool.get(), GetAllocator(), m_Uploader.get(), scene.meshFilename);
+            m_GeometryContexts.push_back(mesh->IsInstanced() ? ContextType::Instance : ContextType::Color);
+            m_Geometry.push_back(std::move(mesh));
+        }
+
+        const float x = spacing * (static_cast<float>(i % columns) - 0.5f * static_cast<float>(columns - 1u));
+        const float y = spacing * (0.5f * static_cast<float>(rows - 1u) - static_cast<float>(i / columns));
+        m_Geometry.back()->SetWorldMatrix(XMMatrixTranslation(x, y, 0.0f));
+    }
+    m_sceneExtent = 0.5f * spacing * static_cast<float>(columns);
+
+    // Serializing root signatures and compiling pipeline states is the slow part of startup, so
+    // every context is built on its own thread while the main loop shows the loading screen.  Once
+    // they all exist, the pipeline cache is written out with anything it did not have.
+    m_Startup = std::make_unique<StartupSchedulerClass>(workerCount);
+
+    const UINT instanceContext = m_Startup->AddTask("InstanceContextClass", [this, xResolution, yResolution]
+    {
+        m_Context = std::make_unique<InstanceContextClass>(GetDevice(),
+                                                           GetConstantArena(),
+                                                           GetPipelineCache(),
+                                                           m_Camera->GetViewMatrix(),
+                                                           m_Camera->GetProjectionMatrix(),
+                                                           xResolution, yResolution);
+    });
+    const UINT cullContext = m_Startup->AddTask("CullContextClass", [this]
+    {
+        m_CullContext = std::make_unique<CullContextClass>(GetDevice(), GetConstantArena(), GetPipelineCache());
+    });
+    std::vector<UINT> contexts = { instanceContext, cullContext };
+    if (std::find(m_GeometryContexts.begin(), m_GeometryContexts.end(), ContextType::Color) != m_GeometryContexts.end())
+    {
+        contexts.push_back(m_Startup->AddTask("ColorContextClass", [this, xResolution, yResolution]
+        {
+            m_ColorContext = std::make_unique<ColorContextClass>(GetDevice(),
+                                                                 GetConstantArena(),
+                                                                 GetPipelineCache(),
+                                                                 m_Camera->GetViewMatrix(),
+                                                                 m_Camera->GetProjectionMatrix(),
+                                                                 xResolution, yResolution);
+        }));
+    }
+    m_Startup->AddTask("PipelineCacheClass", [this] { GetPipelineCache()->Save(); }, contexts);
+
+    m_Startup->Start();
+
+    // Move the camera back so we can see our scene.
+    m_Camera->SetPosition(0.0f, 0.0f, -10.0f);
+
+    // Set the backdground to a neutral gray color.
+    SetClearColor(0.2f, 0.2f, 0.2f, 1.0f);
+}
+
+
+void EngineClass::InitializeRenderGraph()
+{
+    // The frame's setup, declared as passes and the resources they use.  The graph works out the
+    // barriers between them.  The draws are recorded across the workers' lists afterwards, and
+    // pick every resource up where the graph leaves it.
+    m_RenderGraph        = std::make_unique<RenderGraphClass>();
+    m_backBufferResource = m_RenderGraph->ImportResource("Back buffer", D3D12_RESOURCE_STATE_PRESENT);
+    const UINT depthBufferResource = m_RenderGraph->ImportResource("Depth buffer", D3D12_RESOURCE_STATE_DEPTH_WRITE);
+    m_RenderGraph->SetResource(depthBufferResource, GetDepthBuffer());
+
+    const UINT clearPass = m_RenderGraph->AddPass("Clear", [this](PipelineClass *pipeline) { ResetViews(pipeline); });
+    m_RenderGraph->Write(clearPass, m_backBufferResource, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    m_RenderGraph->Write(clearPass, depthBufferResource, D3D12_RESOURCE_STATE_DEPTH_WRITE);
+
+    // Culling writes buffers each piece of geometry keeps to itself, which the graph cannot see, so
+    // it has to keep the pass regardless.
+    m_RenderGraph->AddPass("Cull", [this](PipelineClass *pipeline) { CullGeometry(pipeline); }, true);
+
+    m_RenderGraph->Compile();
+    m_RenderGraph->Realize(GetDevice(), GetResourceStates());
+}
@@ -1,38 +1,146 @@
-////////////////////////////////////////////////////////////////////////////////
-// Filename: engineclass.h
-////////////////////////////////////////////////////////////////////////////////
-#pragma once
-
-
-//////////////
-// INCLUDES //
-//////////////
-#include "cameraclass.h"
-#include "d3dclass.h"
-#include "pipelineclass.h"
-#include "instancecontextclass.h"
-#include "quadclass.h"
-
-
-////////////////////////////////////////////////////////////////////////////////
-// Class name: EngineClass
-////////////////////////////////////////////////////////////////////////////////
-class EngineClass : private D3DClass
-{
-public:
-    EngineClass(HWND, UINT, UINT, bool);
-    ~EngineClass();
-
-    void Frame();
-
-private:
-    void Render();
-
-private:
-    const bool m_vsyncEnabled = true;
-
-    std::unique_ptr<CameraClass>          m_Camera   = nullptr;
-    std::unique_ptr<PipelineClass>        m_Pipeline = nullptr;
-    std::unique_ptr<InstanceContextClass> m_Context  = nullptr;
-    std::unique_ptr<GeometryInterface>    m_Geometry = nullptr;
-};
+////////////////////////////////////////////////////////////////////////////////
+// Filename: engineclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include "cameraclass.h"
+#include "d3dclass.h"
+#include "pipelineclass.h"
+#include "instancecontextclass.h"
+#include "colorcontextclass.h"
+#include "quadclass.h"
+#include "triangleclass.h"
+#include "meshclass.h"
+#include "workerpoolclass.h"
+#include "frustumcullerclass.h"
+#include "startupschedulerclass.h"
+#include "renderqueueclass.h"
+#include "profilerclass.h"
+#include "gputimerclass.h"
+#include "rendergraphclass.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: EngineClass
+////////////////////////////////////////////////////////////////////////////////
+class EngineClass : private D3DClass
+{
+public:
+    // What the scene is built from.  Quads are drawn instanced, and triangles with plain colors.
+    // A mesh asset, if named, is drawn instanced when it carries instances of its own.  Instances
+    // are culled by a compute kernel, or by the workers on the CPU.
+    struct SceneType
+    {
+        UINT         quadCount        = 1u;
+        UINT         triangleCount    = 0u;
+        UINT         instancesPerQuad = 4u;
+        std::wstring meshFilename     = L"";
+        bool         gpuCulling       = true;
+    };
+
+    // How the draws of the last frame were recorded.
+    struct StatisticsType
+    {
+        UINT                              packetCount  = 0u;
+        RenderQueueClass::StateChangeType stateChanges = {};
+        UINT                              bindCount    = 0u;
+        UINT                              elidedCount  = 0u;
+        double                            sortSeconds  = 0.0;
+    };
+
+    // Which device renders without a window.
+    using DeviceType = HeadlessBackendClass::DeviceType;
+
+private:
+    // Which of our contexts draws a piece of geometry.
+    enum class ContextType : uint32_t
+    {
+        Instance,
+        Color,
+    };
+
+public:
+    EngineClass(HWND, UINT, UINT, bool, UINT, const SceneType & = SceneType());
+    EngineClass(UINT, UINT, UINT, const SceneType & = SceneType(), DeviceType = DeviceType::Warp);
+    ~EngineClass();
+
+    using D3DClass::GetDevice;
+    using D3DClass::GetAllocator;
+
+    bool IsFrameAvailable();
+    bool IsSceneReady();
+    void Frame();
+
+    void CaptureFrame(const std::wstring &);
+    void ExecuteRenderGraph(RenderGraphClass *, UINT);
+
+    CameraClass * GetCamera();
+    float GetSceneExtent();
+    double GetWaitSeconds();
+    double GetTimeToFirstFrame();
+    double GetTimeToFirstSceneFrame();
+    ProfilerClass * GetProfiler();
+    StatisticsType GetStatistics();
+
+private:
+    void InitializeScene(UINT, UINT, const SceneType &);
+    void InitializeRenderGraph();
+
+    RenderContextInterface * GetContext(ContextType);
+
+    void Render();
+    void RenderLoading();
+    void CullGeometry(PipelineClass *);
+    void RecordDraws(UINT);
+
+private:
+    const bool m_vsyncEnabled = true;
+    const bool m_gpuCulling   = true;
+
+    std::unique_ptr<CameraClass>          m_Camera       = nullptr;
+    std::unique_ptr<WorkerPoolClass>      m_Workers      = nullptr;
+    std::unique_ptr<PipelineClass>        m_Pipeline     = nullptr;
+    std::unique_ptr<InstanceContextClass> m_Context      = nullptr;
+    std::unique_ptr<ColorContextClass>    m_ColorContext = nullptr;
+    std::unique_ptr<UploadRingClass>      m_Uploader     = nullptr;
+    std::unique_ptr<GeometryPoolClass>    m_GeometryPool = nullptr;
+    std::unique_ptr<FrustumCullerClass>   m_Culler       = nullptr;
+    std::unique_ptr<CullContextClass>     m_CullContext  = nullptr;
+    std::unique_ptr<RenderQueueClass>     m_RenderQueue  = nullptr;
+    std::unique_ptr<ProfilerClass>        m_Profiler     = nullptr;
+    std::unique_ptr<GpuTimerClass>        m_GpuTimer     = nullptr;
+
+    // The frame's setup as a render graph, and the back buffer it draws to.
+    std::unique_ptr<RenderGraphClass> m_RenderGraph        = nullptr;
+    UINT                              m_backBufferResource = 0u;
+
+    std::vector<std::unique_ptr<PipelineClass>>     m_WorkerPipelines  = {};
+    std::vector<std::unique_ptr<GeometryInterface>> m_Geometry         = {};
+    std::vector<ContextType>                        m_GeometryContexts = {};
+
+    // Built once, so that a frame neither grows the list batch nor wraps a new job for the workers.
+    std::vector<ID3D12CommandList *> m_commandLists = {};
+    WorkerPoolClass::JobType         m_recordDraws  = nullptr;
+
+    // How far the scene reaches from the origin along either axis.
+    float m_sceneExtent = 0.0f;
+
+    std::unique_ptr<CommandStreamClass> m_Capture         = nullptr;
+    std::wstring                        m_captureFilename = L"";
+
+    // How long the last frame waited for the swap chain and the GPU before it could start.
+    double m_waitSeconds = 0.0;
+
+    // Startup is timed from the moment the device is up.
+    std::chrono::steady_clock::time_point m_startTime             = std::chrono::steady_clock::now();
+    double                                m_timeToFirstFrame      = 0.0;
+    double                                m_timeToFirstSceneFrame = 0.0;
+    bool                                  m_sceneReady            = false;
+
+    // Declared last so it is released first, letting its tasks finish before what they build goes away.
+    std::unique_ptr<StartupSchedulerClass> m_Startup = nullptr;
+};
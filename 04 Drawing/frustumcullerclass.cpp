@@ -0,0 +1,167 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: frustumcullerclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "frustumcullerclass.h"
+
+
+void FrustumCullerClass::BoundsType::Resize(size_t count)
+{
+    x.resize(count);
+    y.resize(count);
+    z.resize(count);
+    radius.resize(count);
+}
+
+
+FrustumCullerClass::FrustumCullerClass(WorkerPoolClass *workers)
+    : p_workers(workers)
+{
+    m_cullChunk = [this](UINT chunk) { CullChunk(chunk); };
+}
+
+
+FrustumCullerClass::FrustumType FrustumCullerClass::ExtractFrustum(const XMMATRIX &matrix)
+{
+    // With row vectors, each clip plane is a sum of the matrix columns, which are the rows of its
+    // transpose.  The planes face inwards, and the near plane sits at z = 0 in Direct3D.
+    const XMMATRIX columns = XMMatrixTranspose(matrix);
+
+    FrustumType frustum;
+    frustum.planes[0] = XMVectorAdd(columns.r[3], columns.r[0]);       // Left.
+    frustum.planes[1] = XMVectorSubtract(columns.r[3], columns.r[0]);  // Right.
+    frustum.planes[2] = XMVectorAdd(columns.r[3], columns.r[1]);       // Bottom.
+    frustum.planes[3] = XMVectorSubtract(columns.r[3], columns.r[1]);  // Top.
+    frustum.planes[4] = columns.r[2];                                  // Near.
+    frustum.planes[5] = XMVectorSubtract(columns.r[3], columns.r[2]);  // Far.
+
+    // Normalize the planes so their distances can be compared against a radius.
+    for (XMVECTOR &plane : frustum.planes)
+    {
+        plane = XMPlaneNormalize(plane);
+    }
+
+    return frustum;
+}
+
+
+UINT FrustumCullerClass::Cull(const FrustumType &frustum, const BoundsType &bounds, UINT *survivors)
+{
+    const auto start = std::chrono::steady_clock::now();
+    const UINT count = static_cast<UINT>(bounds.x.size());
+
+    // Splat every component of every plane once, so the inner loop tests four spheres at a time.
+    XMVECTOR planes[6 * 4];
+    for (UINT i = 0u; i < 6u; ++i)
+    {
+        planes[i * 4u + 0u] = XMVectorSplatX(frustum.planes[i]);
+        planes[i * 4u + 1u] = XMVectorSplatY(frustum.planes[i]);
+        planes[i * 4u + 2u] = XMVectorSplatZ(frustum.planes[i]);
+        planes[i * 4u + 3u] = XMVectorSplatW(frustum.planes[i]);
+    }
+
+    // Split the instances into chunks and cull them across the workers.  Each chunk compacts its
+    // survivors to the front of its own part of the output.
+    const UINT chunkCount = (count + CHUNK_SIZE - 1u) / CHUNK_SIZE;
+    m_chunkCounts.resize(chunkCount);
+    p_planes    = planes;
+    p_bounds    = &bounds;
+    p_survivors = survivors;
+    m_count     = count;
+    p_workers->Dispatch(chunkCount, m_cullChunk);
+
+    // Pull every chunk's survivors together, keeping them in their original order.
+    UINT survivorCount = 0u;
+    for (UINT chunk = 0u; chunk < chunkCount; ++chunk)
+    {
+        if (survivorCount != chunk * CHUNK_SIZE)
+        {
+            memmove(survivors + survivorCount, survivors + chunk * CHUNK_SIZE, m_chunkCounts[chunk] * sizeof(UINT));
+        }
+        survivorCount += m_chunkCounts[chunk];
+    }
+
+    // Keep track of how fast we are culling.
+    m_testedCount += count;
+    m_cullSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    return survivorCount;
+}
+
+
+uint64_t FrustumCullerClass::GetTestedCount()
+{
+    return m_testedCount;
+}
+
+
+double FrustumCullerClass::GetInstancesPerSecond()
+{
+    return (m_cullSeconds > 0.0) ? static_cast<double>(m_testedCount) / m_cullSeconds : 0.0;
+}
+
+
+void FrustumCullerClass::CullChunk(UINT chunk)
+{
+    const UINT first = chunk * CHUNK_SIZE;
+    const UINT last  = (first + CHUNK_SIZE < m_count) ? first + CHUNK_SIZE : m_count;
+    m_chunkCounts[chunk] = CullRange(p_planes, *p_bounds, first, last, p_survivors + first);
+}
+
+
+UINT FrustumCullerClass::CullRange(const XMVECTOR *planes, const BoundsType &bounds, UINT first, UINT last, UINT *survivors)
+{
+    UINT survivorCount = 0u;
+
+    // Test four spheres at a time: a sphere is visible unless it is entirely behind some plane.
+    UINT i = first;
+    for (; i + 4u <= last; i += 4u)
+    {
+        const XMVECTOR x      = XMLoadFloat4(reinterpret_cast<const XMFLOAT4 *>(&bounds.x[i]));
+        const XMVECTOR y      = XMLoadFloat4(reinterpret_cast<const XMFLOAT4 *>(&bounds.y[i]));
+        const XMVECTOR z      = XMLoadFloat4(reinterpret_cast<const XMFLOAT4 *>(&bounds.z[i]));
+        const XMVECTOR radius = XMVectorNegate(XMLoadFloat4(reinterpret_cast<const XMFLOAT4 *>(&bounds.radius[i])));
+
+        XMVECTOR visible = XMVectorTrueInt();
+        for (UINT p = 0u; p < 6u; ++p)
+        {
+            XMVECTOR distance = XMVectorMultiplyAdd(planes[p * 4u + 0u], x, planes[p * 4u + 3u]);
+            distance = XMVectorMultiplyAdd(planes[p * 4u + 1u], y, distance);
+            distance = XMVectorMultiplyAdd(planes[p * 4u + 2u], z, distance);
+            visible  = XMVectorAndInt(visible, XMVectorGreaterOrEqual(distance, radius));
+        }
+
+        // Append the survivors of this group without branching on each one.
+        XMUINT4 mask;
+        XMStoreUInt4(&mask, visible);
+        survivors[survivorCount] = i;
+        survivorCount += mask.x & 1u;
+        survivors[survivorCount] = i + 1u;
+        survivorCount += mask.y & 1u;
+        survivors[survivorCount] = i + 2u;
+        survivorCount += mask.z & 1u;
+        survivors[survivorCount] = i + 3u;
+        survivorCount += mask.w & 1u;
+    }
+
+    // Finish off whatever does not fill a group of four one sphere at a time.  The distance adds up
+    // in the same order as above, so a sphere right on a plane gets the same answer either way.
+    for (; i < last; ++i)
+    {
+        bool visible = true;
+        for (UINT p = 0u; p < 6u && visible; ++p)
+        {
+            float distance = XMVectorGetX(planes[p * 4u + 0u]) * bounds.x[i] + XMVectorGetX(planes[p * 4u + 3u]);
+            distance = XMVectorGetX(planes[p * 4u + 1u]) * bounds.y[i] + distance;
+            distance = XMVectorGetX(planes[p * 4u + 2u]) * bounds.z[i] + distance;
+            visible  = distance >= -bounds.radius[i];
+        }
+
+        if (visible)
+        {
+            survivors[survivorCount++] = i;
+        }
+    }
+
+    return survivorCount;
+}
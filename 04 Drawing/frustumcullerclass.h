@@ -0,0 +1,72 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: frustumcullerclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include "workerpoolclass.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: FrustumCullerClass
+////////////////////////////////////////////////////////////////////////////////
+class FrustumCullerClass
+{
+public:
+    struct FrustumType
+    {
+        XMVECTOR planes[6];
+    };
+
+    // Bounding spheres are kept as separate arrays so four of them load into one register each.
+    struct BoundsType
+    {
+        std::vector<float> x      = {};
+        std::vector<float> y      = {};
+        std::vector<float> z      = {};
+        std::vector<float> radius = {};
+
+        void Resize(size_t);
+    };
+
+public:
+    FrustumCullerClass() = delete;
+    FrustumCullerClass(const FrustumCullerClass &) = delete;
+    FrustumCullerClass & operator=(const FrustumCullerClass &) = delete;
+
+    FrustumCullerClass(WorkerPoolClass *);
+    ~FrustumCullerClass() = default;
+
+    static FrustumType ExtractFrustum(const XMMATRIX &);
+
+    UINT Cull(const FrustumType &, const BoundsType &, UINT *);
+
+    uint64_t GetTestedCount();
+    double GetInstancesPerSecond();
+
+private:
+    void CullChunk(UINT);
+    UINT CullRange(const XMVECTOR *, const BoundsType &, UINT, UINT, UINT *);
+
+private:
+    // Each job culls this many instances; smaller sets are culled on the calling thread alone.
+    static constexpr UINT CHUNK_SIZE = 16'384u;
+
+    WorkerPoolClass *p_workers = nullptr;
+
+    std::vector<UINT> m_chunkCounts = {};
+
+    // The job is built once and reads the call it belongs to from here, so culling never has to
+    // wrap a new one.
+    WorkerPoolClass::JobType m_cullChunk = nullptr;
+    const XMVECTOR          *p_planes    = nullptr;
+    const BoundsType        *p_bounds    = nullptr;
+    UINT                    *p_survivors = nullptr;
+    UINT                     m_count     = 0u;
+
+    uint64_t m_testedCount = 0ull;
+    double   m_cullSeconds = 0.0;
+};
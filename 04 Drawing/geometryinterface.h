@@ -1,58 +1,77 @@
-////////////////////////////////////////////////////////////////////////////////
-// Filename: geometryinterface.h
-////////////////////////////////////////////////////////////////////////////////
-#pragma once
-
-
-////////////////////////////////////////////////////////////////////////////////
-// Interface name: GeometryInterface
-////////////////////////////////////////////////////////////////////////////////
-class GeometryInterface
-{
-protected:
-    struct BufferType
-    {
-        SIZE_T                 count  = 0ull;
-        ComPtr<ID3D12Resource> buffer = nullptr;
-        union
-        {
-            D3D12_VERTEX_BUFFER_VIEW vertexView;
-            D3D12_INDEX_BUFFER_VIEW  indexView = {};
-        };
-
-        BufferType() = default;
-        BufferType(ID3D12Device *, std::vector<uint32_t> &, const std::wstring = L"GI index buffer");
-        template<typename Type>
-        BufferType(ID3D12Device *, std::vector<Type> &, const std::wstring = L"GI vertex buffer");
-
-    private:
-        static ComPtr<ID3D12Resource> InitializeBuffer(ID3D12Device *, BYTE *, SIZE_T, D3D12_RESOURCE_STATES, const std::wstring);
-    };
-
-public:
-    GeometryInterface(const GeometryInterface &) = delete;
-    GeometryInterface & operator=(const GeometryInterface &) = delete;
-
-    GeometryInterface() = default;
-    virtual ~GeometryInterface() = default;
-
-    virtual void Render(ID3D12GraphicsCommandList *) = 0;
-};
-
-
-///////////////////////////////
-// INLINE TEMPLATE FUNCTIONS //
-///////////////////////////////
-template<typename Type>
-GeometryInterface::BufferType::BufferType(ID3D12Device *device, std::vector<Type> &data, const std::wstring name)
-    : count(data.size())
-    , buffer(InitializeBuffer(device,
-                              reinterpret_cast<BYTE*>(data.data()),
-                              count * sizeof(Type),
-                              D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER,
-                              name))
-    , vertexView{ buffer->GetGPUVirtualAddress(),
-                  static_cast<UINT>(count * sizeof(Type)),
-                  static_cast<UINT>(sizeof(Type)) }
-{
-}
+////////////////////////////////////////////////////////////////////////////////
+// Filename: geometryinterface.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include "geometrypoolclass.h"
+#include "meshoptimizerclass.h"
+#include "constantarenaclass.h"
+#include "cullcontextclass.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Interface name: GeometryInterface
+////////////////////////////////////////////////////////////////////////////////
+class GeometryInterface
+{
+protected:
+    struct BufferType
+    {
+        SIZE_T                             count       = 0ull;
+        GpuAllocatorClass::AllocationType  buffer      = {};
+        UploadRingClass                   *uploader    = nullptr;
+        UINT64                             uploadFence = 0ull;
+        D3D12_VERTEX_BUFFER_VIEW           vertexView  = {};
+
+        BufferType() = default;
+        template<typename Type>
+        BufferType(GpuAllocatorClass *, UploadRingClass *, std::vector<Type> &, const std::wstring = L"GI vertex buffer");
+        BufferType(GpuAllocatorClass *, UploadRingClass *, const BYTE *, SIZE_T, SIZE_T, const std::wstring = L"GI vertex buffer");
+        BufferType(GpuAllocatorClass *, SIZE_T, SIZE_T, const std::wstring = L"GI unordered buffer");
+
+        bool IsResident();
+
+    private:
+        static GpuAllocatorClass::AllocationType InitializeBuffer(GpuAllocatorClass *, SIZE_T, D3D12_RESOURCE_FLAGS, const std::wstring);
+    };
+
+public:
+    GeometryInterface(const GeometryInterface &) = delete;
+    GeometryInterface & operator=(const GeometryInterface &) = delete;
+
+    GeometryInterface() = default;
+    virtual ~GeometryInterface();
+
+    XMMATRIX & GetWorldMatrix();
+    void SetWorldMatrix(const XMMATRIX &);
+
+    virtual void Cull(FrustumCullerClass *, ConstantArenaClass *, const XMMATRIX &);
+    virtual void CullIndirect(PipelineClass *, CullContextClass *, ConstantArenaClass *, const XMMATRIX &);
+
+    const GeometryPoolClass::MeshType & GetMesh();
+
+    virtual bool IsResident() = 0;
+    virtual ID3D12Resource * GetVertexBuffer();
+    virtual void Render(PipelineClass *) = 0;
+
+protected:
+    XMMATRIX m_worldMatrix = XMMatrixIdentity();
+
+    // Our vertices and indices live in the pool's shared buffers, in the ranges of this mesh.
+    GeometryPoolClass           *p_geometryPool = nullptr;
+    GeometryPoolClass::MeshType  m_mesh         = {};
+};
+
+
+///////////////////////////////
+// INLINE TEMPLATE FUNCTIONS //
+///////////////////////////////
+template<typename Type>
+GeometryInterface::BufferType::BufferType(GpuAllocatorClass *allocator, UploadRingClass *uploader, std::vector<Type> &data, const std::wstring name)
+    : BufferType(allocator, uploader, reinterpret_cast<const BYTE*>(data.data()), data.size(), sizeof(Type), name)
+{
+}
@@ -0,0 +1,141 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: geometrypoolclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "geometrypoolclass.h"
+
+
+GeometryPoolClass::GeometryPoolClass(GpuAllocatorClass *allocator, UploadRingClass *uploader, UINT vertexCapacity, UINT indexBytes)
+    : p_uploader(uploader)
+    , m_vertexRanges(vertexCapacity)
+    , m_indexRanges(indexBytes, 2ull)
+{
+    // Place both buffers in the default heap.  Buffers may be read by one queue while another
+    // writes to a different part of them, so new meshes stream in through the copy queue while
+    // the meshes already there are drawn.
+    m_vertexBuffer = allocator->CreateBuffer(
+        GpuAllocatorClass::CategoryType::Geometry,
+        D3D12_HEAP_TYPE_DEFAULT,
+        static_cast<UINT64>(vertexCapacity) * sizeof(MeshPackerClass::PackedVertexType),
+        D3D12_RESOURCE_FLAG_NONE,
+        D3D12_RESOURCE_STATE_COMMON,
+        L"GPC vertex buffer"
+    );
+    m_indexBuffer = allocator->CreateBuffer(
+        GpuAllocatorClass::CategoryType::Geometry,
+        D3D12_HEAP_TYPE_DEFAULT,
+        indexBytes,
+        D3D12_RESOURCE_FLAG_NONE,
+        D3D12_RESOURCE_STATE_COMMON,
+        L"GPC index buffer"
+    );
+
+    // Every mesh is drawn through the same vertex view, and one of two index views over the whole
+    // index buffer.  A start index counts in the format of the view, so each mesh's indices start
+    // on a multiple of their own size.
+    m_vertexView.BufferLocation = m_vertexBuffer->GetGPUVirtualAddress();
+    m_vertexView.SizeInBytes    = vertexCapacity * static_cast<UINT>(sizeof(MeshPackerClass::PackedVertexType));
+    m_vertexView.StrideInBytes  = static_cast<UINT>(sizeof(MeshPackerClass::PackedVertexType));
+
+    m_shortIndexView.BufferLocation = m_indexBuffer->GetGPUVirtualAddress();
+    m_shortIndexView.SizeInBytes    = indexBytes;
+    m_shortIndexView.Format         = DXGI_FORMAT_R16_UINT;
+
+    m_longIndexView        = m_shortIndexView;
+    m_longIndexView.Format = DXGI_FORMAT_R32_UINT;
+}
+
+
+GeometryPoolClass::MeshType GeometryPoolClass::AddMesh(const MeshDataType &meshData)
+{
+    // Claim a range of each buffer.  The indices stay relative to the mesh's first vertex, which
+    // the draw passes along as its base vertex.
+    const UINT   indexSize   = MeshPackerClass::GetIndexSize(meshData.indexFormat);
+    const UINT64 vertexBytes = static_cast<UINT64>(meshData.vertexCount) * sizeof(MeshPackerClass::PackedVertexType);
+    const UINT64 indexBytes  = static_cast<UINT64>(meshData.indexCount) * indexSize;
+    const UINT64 baseVertex  = m_vertexRanges.Allocate(meshData.vertexCount);
+    THROW_IF_TRUE(
+        baseVertex == TlsfAllocatorClass::INVALID_OFFSET,
+        "The geometry pool is out of room for vertices."
+    );
+
+    const UINT64 indexOffset = m_indexRanges.Allocate(indexBytes, indexSize);
+    if (indexOffset == TlsfAllocatorClass::INVALID_OFFSET)
+    {
+        m_vertexRanges.Free(baseVertex);
+        throw std::runtime_error("The geometry pool is out of room for indices.");
+    }
+
+    MeshType mesh;
+    mesh.baseVertex    = static_cast<UINT>(baseVertex);
+    mesh.vertexCount   = meshData.vertexCount;
+    mesh.startIndex    = static_cast<UINT>(indexOffset / indexSize);
+    mesh.indexCount    = meshData.indexCount;
+    mesh.indexFormat   = meshData.indexFormat;
+    mesh.positionScale = meshData.positionScale;
+    mesh.positionBias  = meshData.positionBias;
+
+    // Stage both copies in the upload ring, which is the only copy the CPU makes.  They go out
+    // with the next flush, so the mesh is resident once that flush is done.
+    p_uploader->Upload(m_vertexBuffer.Get(),
+                       reinterpret_cast<const BYTE*>(meshData.vertices),
+                       vertexBytes,
+                       baseVertex * sizeof(MeshPackerClass::PackedVertexType));
+    mesh.uploadFence = p_uploader->Upload(m_indexBuffer.Get(),
+                                          meshData.indexData,
+                                          indexBytes,
+                                          indexOffset);
+    return mesh;
+}
+
+
+GeometryPoolClass::MeshType GeometryPoolClass::AddMesh(const MeshPackerClass::PackedMeshType &packedMesh)
+{
+    MeshDataType meshData;
+    meshData.vertices      = packedMesh.vertices.data();
+    meshData.vertexCount   = static_cast<UINT>(packedMesh.vertices.size());
+    meshData.indexData     = packedMesh.indexData.data();
+    meshData.indexCount    = packedMesh.indexCount;
+    meshData.indexFormat   = packedMesh.indexFormat;
+    meshData.positionScale = packedMesh.positionScale;
+    meshData.positionBias  = packedMesh.positionBias;
+    return AddMesh(meshData);
+}
+
+
+void GeometryPoolClass::RemoveMesh(const MeshType &mesh)
+{
+    // The ranges are handed out again right away, so the GPU has to be done drawing the mesh.
+    m_vertexRanges.Free(mesh.baseVertex);
+    m_indexRanges.Free(static_cast<UINT64>(mesh.startIndex) * MeshPackerClass::GetIndexSize(mesh.indexFormat));
+}
+
+
+bool GeometryPoolClass::IsResident(const MeshType &mesh)
+{
+    // The mesh can be drawn from once the copy queue has finished copying into its ranges.
+    return p_uploader->IsComplete(mesh.uploadFence);
+}
+
+
+ID3D12Resource * GeometryPoolClass::GetVertexBuffer()
+{
+    return m_vertexBuffer.Get();
+}
+
+
+void GeometryPoolClass::Bind(PipelineClass *pipeline)
+{
+    // Set the shared buffers once, for every draw the list records after this.  Most meshes are
+    // small enough for 16-bit indices, so that view goes first.
+    pipeline->SetVertexBuffers(0, 1, &m_vertexView);
+    pipeline->SetIndexBuffer(m_shortIndexView);
+}
+
+
+void GeometryPoolClass::SetIndexBuffer(PipelineClass *pipeline, const MeshType &mesh)
+{
+    // Switch views only when the mesh's format differs from the last; the pipeline skips setting
+    // the view that is already bound.
+    pipeline->SetIndexBuffer(mesh.indexFormat == DXGI_FORMAT_R16_UINT ? m_shortIndexView : m_longIndexView);
+}
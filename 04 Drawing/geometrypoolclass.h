@@ -0,0 +1,79 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: geometrypoolclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include "gpuallocatorclass.h"
+#include "uploadringclass.h"
+#include "meshpackerclass.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: GeometryPoolClass
+////////////////////////////////////////////////////////////////////////////////
+class GeometryPoolClass
+{
+public:
+    // Where a mesh lives in the shared buffers, and when its data arrives there.  The start index
+    // counts indices of the mesh's own format, and the scale and bias undo the packing of its
+    // positions.
+    struct MeshType
+    {
+        UINT        baseVertex    = 0u;
+        UINT        vertexCount   = 0u;
+        UINT        startIndex    = 0u;
+        UINT        indexCount    = 0u;
+        DXGI_FORMAT indexFormat   = DXGI_FORMAT_R32_UINT;
+        XMFLOAT4    positionScale = { 1.0f, 1.0f, 1.0f, 1.0f };
+        XMFLOAT4    positionBias  = { 0.0f, 0.0f, 0.0f, 0.0f };
+        UINT64      uploadFence   = 0ull;
+    };
+
+    // A packed mesh wherever its bytes happen to be, so a mesh mapped straight from a file goes
+    // into the upload ring without being copied anywhere first.
+    struct MeshDataType
+    {
+        const MeshPackerClass::PackedVertexType *vertices      = nullptr;
+        UINT                                     vertexCount   = 0u;
+        const BYTE                              *indexData     = nullptr;
+        UINT                                     indexCount    = 0u;
+        DXGI_FORMAT                              indexFormat   = DXGI_FORMAT_R32_UINT;
+        XMFLOAT4                                 positionScale = { 1.0f, 1.0f, 1.0f, 1.0f };
+        XMFLOAT4                                 positionBias  = { 0.0f, 0.0f, 0.0f, 0.0f };
+    };
+
+public:
+    GeometryPoolClass() = delete;
+    GeometryPoolClass(const GeometryPoolClass &) = delete;
+    GeometryPoolClass & operator=(const GeometryPoolClass &) = delete;
+
+    GeometryPoolClass(GpuAllocatorClass *, UploadRingClass *, UINT = 1024u * 1024u, UINT = 8u * 1024u * 1024u);
+    ~GeometryPoolClass() = default;
+
+    MeshType AddMesh(const MeshDataType &);
+    MeshType AddMesh(const MeshPackerClass::PackedMeshType &);
+    void RemoveMesh(const MeshType &);
+    bool IsResident(const MeshType &);
+
+    ID3D12Resource * GetVertexBuffer();
+    void Bind(PipelineClass *);
+    void SetIndexBuffer(PipelineClass *, const MeshType &);
+
+private:
+    UploadRingClass *p_uploader = nullptr;
+
+    // The ranges of the buffers handed out, counted in vertices and in bytes.  16 and 32-bit
+    // indices share the one buffer, through a view for each format.
+    TlsfAllocatorClass m_vertexRanges;
+    TlsfAllocatorClass m_indexRanges;
+
+    GpuAllocatorClass::AllocationType m_vertexBuffer    = {};
+    GpuAllocatorClass::AllocationType m_indexBuffer     = {};
+    D3D12_VERTEX_BUFFER_VIEW          m_vertexView      = {};
+    D3D12_INDEX_BUFFER_VIEW           m_shortIndexView  = {};
+    D3D12_INDEX_BUFFER_VIEW           m_longIndexView   = {};
+};
@@ -0,0 +1,548 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: gpuallocatorclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "gpuallocatorclass.h"
+
+
+GpuAllocatorClass::AllocationType::AllocationType(GpuAllocatorClass *allocator, UINT record)
+    : p_allocator(allocator)
+    , m_record(record)
+{
+}
+
+
+GpuAllocatorClass::AllocationType::AllocationType(AllocationType &&other)
+    : p_allocator(other.p_allocator)
+    , m_record(other.m_record)
+{
+    other.p_allocator = nullptr;
+}
+
+
+GpuAllocatorClass::AllocationType & GpuAllocatorClass::AllocationType::operator=(AllocationType &&other)
+{
+    if (this != &other)
+    {
+        if (p_allocator)
+        {
+            p_allocator->Release(m_record);
+        }
+
+        p_allocator       = other.p_allocator;
+        m_record          = other.m_record;
+        other.p_allocator = nullptr;
+    }
+    return *this;
+}
+
+
+GpuAllocatorClass::AllocationType::~AllocationType()
+{
+    if (p_allocator)
+    {
+        p_allocator->Release(m_record);
+    }
+}
+
+
+ID3D12Resource * GpuAllocatorClass::AllocationType::Get() const
+{
+    // Always look the resource up, since defragmenting may have moved it.
+    return p_allocator ? p_allocator->m_records[m_record].resource.Get() : nullptr;
+}
+
+
+ID3D12Resource * GpuAllocatorClass::AllocationType::operator->() const
+{
+    return Get();
+}
+
+
+void GpuAllocatorClass::AllocationType::SetRelocation(RelocateType relocate)
+{
+    // Only allocations whose owner can follow them to a new resource may be moved.
+    p_allocator->m_records[m_record].relocate = std::move(relocate);
+}
+
+
+GpuAllocatorClass::GpuAllocatorClass(ID3D12Device *device,
+                                     ID3D12Fence  *fence,
+                                     const UINT64 &fenceValue,
+                                     UINT64        videoCardMemory,
+                                     UINT64        blockSize)
+    : p_device(device)
+    , p_fence(fence)
+    , r_fenceValue(fenceValue)
+    , m_blockSize(blockSize)
+{
+    // Split the video card's own memory between geometry and render targets.  Constants, uploads
+    // and readback live in system memory and are only tracked.  A card that reports no memory of
+    // its own, like the software adapter, gets no budgets at all.
+    SetBudget(CategoryType::Geometry, videoCardMemory / 4ull * 3ull);
+    SetBudget(CategoryType::RenderTargets, videoCardMemory / 4ull);
+}
+
+
+ID3D12Device * GpuAllocatorClass::GetDevice()
+{
+    return p_device;
+}
+
+
+GpuAllocatorClass::AllocationType GpuAllocatorClass::CreateBuffer(CategoryType          category,
+                                                                  D3D12_HEAP_TYPE       heapType,
+                                                                  UINT64                size,
+                                                                  D3D12_RESOURCE_FLAGS  flags,
+                                                                  D3D12_RESOURCE_STATES state,
+                                                                  const std::wstring   &name)
+{
+    // Fill out a resource description for the buffer.
+    D3D12_RESOURCE_DESC resourceDesc{};
+    resourceDesc.Dimension          = D3D12_RESOURCE_DIMENSION_BUFFER;
+    resourceDesc.Alignment          = 0;
+    resourceDesc.Width              = size;
+    resourceDesc.Height             = 1;
+    resourceDesc.DepthOrArraySize   = 1;
+    resourceDesc.MipLevels          = 1;
+    resourceDesc.Format             = DXGI_FORMAT_UNKNOWN;
+    resourceDesc.SampleDesc.Count   = 1;
+    resourceDesc.SampleDesc.Quality = 0;
+    resourceDesc.Layout             = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+    resourceDesc.Flags              = flags;
+
+    return CreateResource(category, heapType, resourceDesc, state, nullptr, name);
+}
+
+
+GpuAllocatorClass::AllocationType GpuAllocatorClass::CreateResource(CategoryType               category,
+                                                                    D3D12_HEAP_TYPE            heapType,
+                                                                    const D3D12_RESOURCE_DESC &resourceDesc,
+                                                                    D3D12_RESOURCE_STATES      state,
+                                                                    const D3D12_CLEAR_VALUE   *clearValue,
+                                                                    const std::wstring        &name)
+{
+    // Hand back whatever memory the GPU has finished with before looking for room.
+    Collect();
+
+    const D3D12_RESOURCE_ALLOCATION_INFO allocationInfo = p_device->GetResourceAllocationInfo(0u, 1u, &resourceDesc);
+    THROW_IF_TRUE(
+        allocationInfo.SizeInBytes == ~0ull,
+        "The resource description is not valid on this device."
+    );
+
+    CategoryStatisticsType &statistics = m_categories[static_cast<size_t>(category)];
+    THROW_IF_TRUE(
+        statistics.budget && statistics.usedBytes + allocationInfo.SizeInBytes > statistics.budget,
+        "The allocation does not fit in the memory budget of its category."
+    );
+
+    UINT64 offset = 0ull;
+    const UINT block = Place(heapType, GetKind(resourceDesc), allocationInfo, offset, NO_BLOCK);
+
+    // Take an empty record if one was left behind.
+    UINT record = static_cast<UINT>(m_records.size());
+    if (m_freeRecords.empty())
+    {
+        m_records.emplace_back();
+    }
+    else
+    {
+        record = m_freeRecords.back();
+        m_freeRecords.pop_back();
+    }
+
+    // Give the memory and the record back if the device will not place the resource, so a
+    // failed allocation leaves nothing behind.
+    RecordType &entry = m_records[record];
+    try
+    {
+        entry.resource = CreatePlacedResource(block, offset, resourceDesc, state, clearValue, name);
+    }
+    catch (...)
+    {
+        FreeRange(block, offset);
+        m_freeRecords.push_back(record);
+        throw;
+    }
+    entry.block    = block;
+    entry.offset   = offset;
+    entry.size     = allocationInfo.SizeInBytes;
+    entry.category = category;
+    entry.name     = name;
+    entry.relocate = nullptr;
+
+    statistics.usedBytes += entry.size;
+    statistics.peakBytes  = statistics.usedBytes > statistics.peakBytes ? statistics.usedBytes : statistics.peakBytes;
+    ++statistics.allocationCount;
+
+    return AllocationType(this, record);
+}
+
+
+void GpuAllocatorClass::SetBudget(CategoryType category, UINT64 budget)
+{
+    // A budget of zero leaves the category unlimited.
+    m_categories[static_cast<size_t>(category)].budget = budget;
+}
+
+
+void GpuAllocatorClass::AddCopyQueue(ID3D12Fence *fence, const UINT64 &fenceValue)
+{
+    // Memory given back from now on also waits for everything recorded on this queue so far.
+    CopyQueueType queue;
+    queue.fence      = fence;
+    queue.fenceValue = &fenceValue;
+    m_copyQueues.push_back(queue);
+}
+
+
+void GpuAllocatorClass::RemoveCopyQueue(ID3D12Fence *fence)
+{
+    // The queue has to be idle by now, so nothing needs to wait for it any more.
+    m_copyQueues.erase(std::remove_if(m_copyQueues.begin(), m_copyQueues.end(), [fence](const CopyQueueType &queue) { return queue.fence == fence; }), m_copyQueues.end());
+    for (ReleaseType &release : m_releases)
+    {
+        std::vector<FenceValueType> &values = release.copyFenceValues;
+        values.erase(std::remove_if(values.begin(), values.end(), [fence](const FenceValueType &value) { return value.fence == fence; }), values.end());
+    }
+}
+
+
+void GpuAllocatorClass::Collect()
+{
+    // Give back the memory of every release the GPU has caught up with on every queue, and the
+    // heaps that no longer hold anything.
+    const UINT64 completedValue = p_fence->GetCompletedValue();
+    for (size_t i = 0; i < m_releases.size();)
+    {
+        ReleaseType &release = m_releases[i];
+        bool completed = release.fenceValue <= completedValue;
+        for (const FenceValueType &copyFenceValue : release.copyFenceValues)
+        {
+            completed = completed && copyFenceValue.fence->GetCompletedValue() >= copyFenceValue.value;
+        }
+        if (!completed)
+        {
+            ++i;
+            continue;
+        }
+
+        release.resource = nullptr;
+        FreeRange(release.block, release.offset);
+
+        m_releases[i] = std::move(m_releases.back());
+        m_releases.pop_back();
+    }
+}
+
+
+UINT64 GpuAllocatorClass::Defragment(PipelineClass *pipeline, UINT64 maxBytes)
+{
+    Collect();
+
+    // Find the least used of the blocks that buffers in the default heap share, as long as there
+    // is another one its buffers could move into.
+    UINT   source     = NO_BLOCK;
+    UINT   blockCount = 0u;
+    UINT64 leastUsed  = ~0ull;
+    for (UINT i = 0u; i < m_blocks.size(); ++i)
+    {
+        const BlockType &block = m_blocks[i];
+        if (!block.heap || block.dedicated || block.type != D3D12_HEAP_TYPE_DEFAULT || block.kind != KindType::Buffers)
+        {
+            continue;
+        }
+
+        ++blockCount;
+        const UINT64 usedBytes = block.ranges->GetStatistics().usedBytes;
+        if (usedBytes < leastUsed)
+        {
+            leastUsed = usedBytes;
+            source    = i;
+        }
+    }
+    if (blockCount < 2u)
+    {
+        return 0ull;
+    }
+
+    // Copy its movable buffers over to the other blocks, one at a time, until the block is empty,
+    // the others are full, or we moved as much as we were allowed to this time.  The old copies
+    // stay alive until the GPU is done with both the copy and any draws recorded before it.
+    UINT64 movedBytes = 0ull;
+    for (UINT i = 0u; i < m_records.size() && movedBytes < maxBytes; ++i)
+    {
+        RecordType &record = m_records[i];
+        if (!record.resource || record.block != source || !record.relocate)
+        {
+            continue;
+        }
+
+        const D3D12_RESOURCE_DESC resourceDesc = record.resource->GetDesc();
+        D3D12_RESOURCE_ALLOCATION_INFO allocationInfo{};
+        allocationInfo.SizeInBytes = record.size;
+        allocationInfo.Alignment   = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+
+        UINT64 offset = 0ull;
+        const UINT target = Place(D3D12_HEAP_TYPE_DEFAULT, KindType::Buffers, allocationInfo, offset, source);
+        if (target == NO_BLOCK)
+        {
+            break;
+        }
+
+        ComPtr<ID3D12Resource> resource;
+        try
+        {
+            resource = CreatePlacedResource(target, offset, resourceDesc, D3D12_RESOURCE_STATE_COMMON, nullptr, record.name);
+        }
+        catch (...)
+        {
+            FreeRange(target, offset);
+            throw;
+        }
+        // The new buffer may take the address of one released earlier, so tell the list where it
+        // really starts.  After the copy it goes back to the common state, where buffers are
+        // promoted from on their first use, just like a buffer that was never moved.
+        pipeline->GetResourceStates()->Register(resource.Get(), D3D12_RESOURCE_STATE_COMMON);
+        pipeline->Transition(record.resource.Get(), D3D12_RESOURCE_STATE_COPY_SOURCE);
+        pipeline->Transition(resource.Get(), D3D12_RESOURCE_STATE_COPY_DEST);
+        pipeline->CopyBufferRegion(resource.Get(), 0ull, record.resource.Get(), 0ull, resourceDesc.Width);
+        pipeline->Transition(resource.Get(), D3D12_RESOURCE_STATE_COMMON);
+
+        DeferRelease(std::move(record.resource), record.block, record.offset);
+        record.resource = std::move(resource);
+        record.block    = target;
+        record.offset   = offset;
+        record.relocate(record.resource.Get());
+
+        movedBytes += record.size;
+    }
+    return movedBytes;
+}
+
+
+GpuAllocatorClass::StatisticsType GpuAllocatorClass::GetStatistics()
+{
+    StatisticsType statistics;
+    statistics.categories = m_categories;
+
+    // Weigh every heap's fragmentation by how much free memory it has.
+    UINT64 freeBytes       = 0ull;
+    double fragmentedBytes = 0.0;
+    for (const BlockType &block : m_blocks)
+    {
+        if (!block.heap)
+        {
+            continue;
+        }
+
+        const TlsfAllocatorClass::StatisticsType ranges = block.ranges->GetStatistics();
+        statistics.heapBytes += ranges.size;
+        ++statistics.heapCount;
+
+        freeBytes       += ranges.size - ranges.usedBytes;
+        fragmentedBytes += block.ranges->GetFragmentation() * static_cast<double>(ranges.size - ranges.usedBytes);
+    }
+    statistics.fragmentation = freeBytes ? fragmentedBytes / static_cast<double>(freeBytes) : 0.0;
+    return statistics;
+}
+
+
+void GpuAllocatorClass::CaptureBuffers(CommandStreamClass *stream)
+{
+    // Root views and buffer views only carry addresses, so hand the stream every live buffer for
+    // it to find them in.
+    for (const RecordType &record : m_records)
+    {
+        if (record.resource && record.resource->GetDesc().Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+        {
+            stream->AddResource(record.resource.Get());
+        }
+    }
+}
+
+
+void GpuAllocatorClass::Release(UINT index)
+{
+    RecordType &record = m_records[index];
+
+    CategoryStatisticsType &statistics = m_categories[static_cast<size_t>(record.category)];
+    statistics.usedBytes -= record.size;
+    --statistics.allocationCount;
+
+    DeferRelease(std::move(record.resource), record.block, record.offset);
+
+    record = RecordType();
+    m_freeRecords.push_back(index);
+}
+
+
+void GpuAllocatorClass::DeferRelease(ComPtr<ID3D12Resource> &&resource, UINT block, UINT64 offset)
+{
+    // The GPU may still be reading the resource, or copying into it, so its memory is only handed
+    // back once the direct queue passes the value of its next submission, and every copy queue
+    // finishes what was recorded on it so far.
+    ReleaseType release;
+    release.resource   = std::move(resource);
+    release.block      = block;
+    release.offset     = offset;
+    release.fenceValue = r_fenceValue + 1ull;
+    for (const CopyQueueType &queue : m_copyQueues)
+    {
+        FenceValueType copyFenceValue;
+        copyFenceValue.fence = queue.fence;
+        copyFenceValue.value = *queue.fenceValue;
+        release.copyFenceValues.push_back(copyFenceValue);
+    }
+    m_releases.push_back(std::move(release));
+}
+
+
+UINT GpuAllocatorClass::Place(D3D12_HEAP_TYPE                       heapType,
+                              KindType                              kind,
+                              const D3D12_RESOURCE_ALLOCATION_INFO &allocationInfo,
+                              UINT64                               &offset,
+                              UINT                                  skippedBlock)
+{
+    // Large resources get a heap sized to fit them exactly, which goes away again with them.
+    const bool dedicated = allocationInfo.SizeInBytes * 2ull >= m_blockSize;
+    if (dedicated && skippedBlock == NO_BLOCK)
+    {
+        offset = 0ull;
+        return AddBlock(heapType, kind, allocationInfo.SizeInBytes, true);
+    }
+
+    // Otherwise, take the first shared block of the same kind with room for it.
+    for (UINT i = 0u; i < m_blocks.size(); ++i)
+    {
+        BlockType &block = m_blocks[i];
+        if (i == skippedBlock || !block.heap || block.dedicated || block.type != heapType || block.kind != kind)
+        {
+            continue;
+        }
+
+        offset = block.ranges->Allocate(allocationInfo.SizeInBytes, allocationInfo.Alignment);
+        if (offset != TlsfAllocatorClass::INVALID_OFFSET)
+        {
+            return i;
+        }
+    }
+
+    // Defragmenting only moves memory into the blocks we already have.
+    if (skippedBlock != NO_BLOCK)
+    {
+        return NO_BLOCK;
+    }
+
+    const UINT block = AddBlock(heapType, kind, m_blockSize, false);
+    offset = m_blocks[block].ranges->Allocate(allocationInfo.SizeInBytes, allocationInfo.Alignment);
+    return block;
+}
+
+
+UINT GpuAllocatorClass::AddBlock(D3D12_HEAP_TYPE heapType, KindType kind, UINT64 size, bool dedicated)
+{
+    // Resources are placed on 64KB boundaries, so that is as fine as the heap has to be split.
+    static const D3D12_HEAP_FLAGS kindFlags[] =
+    {
+        D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS,
+        D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES,
+        D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES
+    };
+    size = (size + D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1ull) & ~(D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1ull);
+
+    D3D12_HEAP_DESC heapDesc{};
+    heapDesc.SizeInBytes                     = size;
+    heapDesc.Properties.Type                 = heapType;
+    heapDesc.Properties.CPUPageProperty      = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+    heapDesc.Properties.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+    heapDesc.Properties.CreationNodeMask     = 1;
+    heapDesc.Properties.VisibleNodeMask      = 1;
+    heapDesc.Alignment                       = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+    heapDesc.Flags                           = kindFlags[static_cast<UINT>(kind)];
+
+    // Take over the slot of a heap released earlier if there is one.
+    UINT index = 0u;
+    while (index < m_blocks.size() && m_blocks[index].heap)
+    {
+        ++index;
+    }
+    if (index == m_blocks.size())
+    {
+        m_blocks.emplace_back();
+    }
+
+    BlockType &block = m_blocks[index];
+    THROW_IF_FAILED(
+        p_device->CreateHeap(
+            &heapDesc,
+            IID_PPV_ARGS(block.heap.ReleaseAndGetAddressOf())),
+        "Unable to create a memory heap on the graphics device."
+    );
+    block.ranges    = std::make_unique<TlsfAllocatorClass>(size, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+    block.type      = heapType;
+    block.kind      = kind;
+    block.dedicated = dedicated;
+
+    std::wstring name = L"GAC heap " + std::to_wstring(index);
+    block.heap->SetName(name.c_str());
+
+    // A dedicated heap holds its one resource right at the start.
+    if (dedicated)
+    {
+        block.ranges->Allocate(size);
+    }
+    return index;
+}
+
+
+void GpuAllocatorClass::FreeRange(UINT index, UINT64 offset)
+{
+    // A heap goes away with the last range in it, leaving its slot for the next one.
+    BlockType &block = m_blocks[index];
+    block.ranges->Free(offset);
+    if (block.ranges->IsEmpty())
+    {
+        block = BlockType();
+    }
+}
+
+
+ComPtr<ID3D12Resource> GpuAllocatorClass::CreatePlacedResource(UINT                       block,
+                                                               UINT64                     offset,
+                                                               const D3D12_RESOURCE_DESC &resourceDesc,
+                                                               D3D12_RESOURCE_STATES      state,
+                                                               const D3D12_CLEAR_VALUE   *clearValue,
+                                                               const std::wstring        &name)
+{
+    ComPtr<ID3D12Resource> resource;
+    THROW_IF_FAILED(
+        p_device->CreatePlacedResource(
+            m_blocks[block].heap.Get(),
+            offset,
+            &resourceDesc,
+            state,
+            clearValue,
+            IID_PPV_ARGS(resource.ReleaseAndGetAddressOf())),
+        "Unable to place a resource in a memory heap."
+    );
+
+    // Set the name of the resource for use in debugging.
+    resource->SetName(name.c_str());
+    return resource;
+}
+
+
+GpuAllocatorClass::KindType GpuAllocatorClass::GetKind(const D3D12_RESOURCE_DESC &resourceDesc)
+{
+    if (resourceDesc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+    {
+        return KindType::Buffers;
+    }
+    if (resourceDesc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL))
+    {
+        return KindType::RenderTargets;
+    }
+    return KindType::Textures;
+}
@@ -0,0 +1,184 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: gpuallocatorclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include "tlsfallocatorclass.h"
+#include "pipelineclass.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: GpuAllocatorClass
+////////////////////////////////////////////////////////////////////////////////
+class GpuAllocatorClass
+{
+public:
+    // What the memory is for.  Each category is tracked against a budget of its own.
+    enum class CategoryType : UINT
+    {
+        Geometry,
+        RenderTargets,
+        Constants,
+        Uploads,
+        Readback,
+        Count
+    };
+
+    // Called with the new resource after defragmenting moved an allocation.
+    using RelocateType = std::function<void(ID3D12Resource *)>;
+
+    // Owns one placed resource, and gives its memory back once the GPU is done with it.
+    struct AllocationType
+    {
+        AllocationType() = default;
+        AllocationType(GpuAllocatorClass *, UINT);
+        AllocationType(AllocationType &&);
+        AllocationType & operator=(AllocationType &&);
+        ~AllocationType();
+
+        ID3D12Resource * Get() const;
+        ID3D12Resource * operator->() const;
+
+        void SetRelocation(RelocateType);
+
+    private:
+        GpuAllocatorClass *p_allocator = nullptr;
+        UINT               m_record    = 0u;
+    };
+
+    struct CategoryStatisticsType
+    {
+        UINT64 usedBytes       = 0ull;
+        UINT64 peakBytes       = 0ull;
+        UINT64 budget          = 0ull;
+        UINT   allocationCount = 0u;
+    };
+
+    struct StatisticsType
+    {
+        std::array<CategoryStatisticsType, static_cast<size_t>(CategoryType::Count)> categories = {};
+
+        UINT64 heapBytes     = 0ull;
+        UINT   heapCount     = 0u;
+        double fragmentation = 0.0;
+    };
+
+private:
+    // Tier 1 hardware keeps buffers, render target and depth textures, and all other textures in
+    // heaps of their own.
+    enum class KindType : UINT
+    {
+        Buffers,
+        RenderTargets,
+        Textures
+    };
+
+    struct BlockType
+    {
+        ComPtr<ID3D12Heap>                  heap      = nullptr;
+        std::unique_ptr<TlsfAllocatorClass> ranges    = nullptr;
+        D3D12_HEAP_TYPE                     type      = D3D12_HEAP_TYPE_DEFAULT;
+        KindType                            kind      = KindType::Buffers;
+        bool                                dedicated = false;
+    };
+
+    struct RecordType
+    {
+        ComPtr<ID3D12Resource> resource = nullptr;
+        UINT                   block    = 0u;
+        UINT64                 offset   = 0ull;
+        UINT64                 size     = 0ull;
+        CategoryType           category = CategoryType::Geometry;
+        std::wstring           name     = {};
+        RelocateType           relocate = nullptr;
+    };
+
+    // A queue besides the direct one that writes into our resources, like the copy queue of an
+    // upload ring, and where its fence will be once everything recorded for it so far is done.
+    struct CopyQueueType
+    {
+        ID3D12Fence  *fence      = nullptr;
+        const UINT64 *fenceValue = nullptr;
+    };
+
+    struct FenceValueType
+    {
+        ID3D12Fence *fence = nullptr;
+        UINT64       value = 0ull;
+    };
+
+    // Memory given back while the GPU may still be using it, kept until the direct queue's fence
+    // and the fence of every copy queue pass the values they had.
+    struct ReleaseType
+    {
+        ComPtr<ID3D12Resource>      resource        = nullptr;
+        UINT                        block           = 0u;
+        UINT64                      offset          = 0ull;
+        UINT64                      fenceValue      = 0ull;
+        std::vector<FenceValueType> copyFenceValues = {};
+    };
+
+public:
+    GpuAllocatorClass() = delete;
+    GpuAllocatorClass(const GpuAllocatorClass &) = delete;
+    GpuAllocatorClass & operator=(const GpuAllocatorClass &) = delete;
+
+    GpuAllocatorClass(ID3D12Device *, ID3D12Fence *, const UINT64 &, UINT64, UINT64 = 64ull * 1024ull * 1024ull);
+    ~GpuAllocatorClass() = default;
+
+    ID3D12Device * GetDevice();
+
+    AllocationType CreateBuffer(CategoryType, D3D12_HEAP_TYPE, UINT64, D3D12_RESOURCE_FLAGS, D3D12_RESOURCE_STATES, const std::wstring &);
+    AllocationType CreateResource(CategoryType, D3D12_HEAP_TYPE, const D3D12_RESOURCE_DESC &, D3D12_RESOURCE_STATES, const D3D12_CLEAR_VALUE *, const std::wstring &);
+
+    void SetBudget(CategoryType, UINT64);
+
+    void AddCopyQueue(ID3D12Fence *, const UINT64 &);
+    void RemoveCopyQueue(ID3D12Fence *);
+
+    void Collect();
+    UINT64 Defragment(PipelineClass *, UINT64);
+
+    StatisticsType GetStatistics();
+
+    void CaptureBuffers(CommandStreamClass *);
+
+private:
+    void Release(UINT);
+    void DeferRelease(ComPtr<ID3D12Resource> &&, UINT, UINT64);
+
+    UINT Place(D3D12_HEAP_TYPE, KindType, const D3D12_RESOURCE_ALLOCATION_INFO &, UINT64 &, UINT);
+    UINT AddBlock(D3D12_HEAP_TYPE, KindType, UINT64, bool);
+    void FreeRange(UINT, UINT64);
+    ComPtr<ID3D12Resource> CreatePlacedResource(UINT, UINT64, const D3D12_RESOURCE_DESC &, D3D12_RESOURCE_STATES, const D3D12_CLEAR_VALUE *, const std::wstring &);
+
+    static KindType GetKind(const D3D12_RESOURCE_DESC &);
+
+private:
+    // Marks no block at all.
+    static constexpr UINT NO_BLOCK = ~0u;
+
+    ID3D12Device *p_device = nullptr;
+
+    // Memory is handed back once the direct queue's fence passes the value it will be signaled
+    // with next.
+    ID3D12Fence  *p_fence      = nullptr;
+    const UINT64 &r_fenceValue;
+
+    std::vector<CopyQueueType> m_copyQueues = {};
+
+    // Allocations at least half this size get a heap of their own.
+    const UINT64 m_blockSize = 0ull;
+
+    // Released blocks and records leave empty slots behind, which new ones take over first.
+    std::vector<BlockType>   m_blocks      = {};
+    std::vector<RecordType>  m_records     = {};
+    std::vector<UINT>        m_freeRecords = {};
+    std::vector<ReleaseType> m_releases    = {};
+
+    std::array<CategoryStatisticsType, static_cast<size_t>(CategoryType::Count)> m_categories = {};
+};
@@ -0,0 +1,154 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: gputimerclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "gputimerclass.h"
+
+
+GpuTimerClass::GpuTimerClass(GpuAllocatorClass  *allocator,
+                             ID3D12CommandQueue *commandQueue,
+                             ProfilerClass *profiler,
+                             const UINT &frameIndex,
+                             UINT scopeCapacity)
+    : p_commandQueue(commandQueue)
+    , p_profiler(profiler)
+    , r_frameIndex(frameIndex)
+    , m_scopeCapacity(scopeCapacity)
+    , m_names(static_cast<size_t>(scopeCapacity) * MAX_FRAMES_IN_FLIGHT, nullptr)
+{
+    const UINT queryCount = m_scopeCapacity * 2u * MAX_FRAMES_IN_FLIGHT;
+
+    // Create the heap the timestamps are written into.
+    D3D12_QUERY_HEAP_DESC queryHeapDesc{};
+    queryHeapDesc.Type     = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+    queryHeapDesc.Count    = queryCount;
+    queryHeapDesc.NodeMask = 0;
+
+    THROW_IF_FAILED(
+        allocator->GetDevice()->CreateQueryHeap(
+            &queryHeapDesc,
+            IID_PPV_ARGS(m_queryHeap.ReleaseAndGetAddressOf())),
+        "Unable to create the timestamp query heap."
+    );
+
+    // The timestamps are resolved into a buffer the CPU can read back.
+    m_readback = allocator->CreateBuffer(
+        GpuAllocatorClass::CategoryType::Readback,
+        D3D12_HEAP_TYPE_READBACK,
+        sizeof(UINT64) * queryCount,
+        D3D12_RESOURCE_FLAG_NONE,
+        D3D12_RESOURCE_STATE_COPY_DEST,
+        L"GTC timestamp readback buffer"
+    );
+
+    // Find out how fast the queue's timestamps tick, and where they sit on the CPU timeline.
+    THROW_IF_FAILED(
+        p_commandQueue->GetTimestampFrequency(&m_frequency),
+        "Unable to query the timestamp frequency of the command queue."
+    );
+    Calibrate();
+
+    NameD3DResources();
+}
+
+
+UINT GpuTimerClass::Begin(PipelineClass *pipeline, const char *name)
+{
+    // Claim a scope in this frame's slice.  Workers may begin scopes at the same time.
+    const UINT scope = m_scopeCounts[r_frameIndex].fetch_add(1u);
+    if (scope >= m_scopeCapacity)
+    {
+        return INVALID_SCOPE;
+    }
+
+    const UINT index = r_frameIndex * m_scopeCapacity + scope;
+    m_names[index] = name;
+    pipeline->EndQuery(m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, index * 2u);
+    return scope;
+}
+
+
+void GpuTimerClass::End(PipelineClass *pipeline, UINT scope)
+{
+    if (scope == INVALID_SCOPE)
+    {
+        return;
+    }
+
+    // Take the second timestamp, then resolve the pair on the same list, which is then free to
+    // execute in any order relative to the frame's other lists.
+    const UINT index = r_frameIndex * m_scopeCapacity + scope;
+    pipeline->EndQuery(m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, index * 2u + 1u);
+    pipeline->ResolveQueryData(m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, index * 2u, 2u,
+                               m_readback.Get(), sizeof(UINT64) * index * 2u);
+}
+
+
+void GpuTimerClass::Collect()
+{
+    // This is called once the current frame index is free again, so the GPU has finished the
+    // last frame that used it and its timestamps are ready to read.
+    const UINT count = m_scopeCounts[r_frameIndex].load();
+    const UINT scopeCount = count < m_scopeCapacity ? count : m_scopeCapacity;
+    m_scopeCounts[r_frameIndex].store(0u);
+    if (scopeCount == 0u)
+    {
+        return;
+    }
+
+    const UINT first = r_frameIndex * m_scopeCapacity;
+    D3D12_RANGE readRange{};
+    readRange.Begin = sizeof(UINT64) * first * 2u;
+    readRange.End   = sizeof(UINT64) * (first + scopeCount) * 2u;
+
+    UINT64 *timestamps = nullptr;
+    THROW_IF_FAILED(
+        m_readback->Map(0, &readRange, reinterpret_cast<void**>(&timestamps)),
+        "Unable to map the timestamp readback buffer."
+    );
+
+    // Move every scope onto the CPU timeline and hand it to the profiler.
+    const double nanosecondsPerTick = 1'000'000'000.0 / static_cast<double>(m_frequency);
+    for (UINT i = first; i < first + scopeCount; ++i)
+    {
+        const UINT64 begin = timestamps[i * 2u];
+        const UINT64 end   = timestamps[i * 2u + 1u];
+        if (end < begin)
+        {
+            continue;
+        }
+
+        const double offset = static_cast<double>(static_cast<int64_t>(begin - m_calibrationTimestamp));
+        p_profiler->AddEvent(m_names[i],
+                             m_calibrationTime + static_cast<int64_t>(offset * nanosecondsPerTick),
+                             static_cast<int64_t>(static_cast<double>(end - begin) * nanosecondsPerTick),
+                             ProfilerClass::TrackType::Gpu);
+    }
+
+    D3D12_RANGE writeRange{};
+    m_readback->Unmap(0, &writeRange);
+
+    // The GPU and CPU clocks drift apart over time, so line them up again for the next frame.
+    Calibrate();
+}
+
+
+void GpuTimerClass::Calibrate()
+{
+    // The queue samples its timestamp together with the performance counter.  The profiler keeps
+    // its own clock, so we read that right after, which is close enough for a trace.
+    UINT64 cpuTimestamp = 0ull;
+    THROW_IF_FAILED(
+        p_commandQueue->GetClockCalibration(&m_calibrationTimestamp, &cpuTimestamp),
+        "Unable to calibrate the GPU clock against the CPU clock."
+    );
+    m_calibrationTime = p_profiler->Now();
+}
+
+
+void GpuTimerClass::NameD3DResources()
+{
+    // Name all DirectX objects.
+    m_queryHeap->SetName(L"GTC timestamp query heap");
+    m_readback->SetName(L"GTC timestamp readback buffer");
+}
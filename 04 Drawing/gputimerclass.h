@@ -0,0 +1,62 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: gputimerclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include "gpuallocatorclass.h"
+#include "profilerclass.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: GpuTimerClass
+////////////////////////////////////////////////////////////////////////////////
+class GpuTimerClass
+{
+public:
+    // Returned for scopes that did not fit into this frame; ending them does nothing.
+    static constexpr UINT INVALID_SCOPE = ~0u;
+
+public:
+    GpuTimerClass() = delete;
+    GpuTimerClass(const GpuTimerClass &) = delete;
+    GpuTimerClass & operator=(const GpuTimerClass &) = delete;
+
+    GpuTimerClass(GpuAllocatorClass *, ID3D12CommandQueue *, ProfilerClass *, const UINT &, UINT = 256u);
+    ~GpuTimerClass() = default;
+
+    UINT Begin(PipelineClass *, const char *);
+    void End(PipelineClass *, UINT);
+
+    void Collect();
+
+private:
+    void Calibrate();
+
+    void NameD3DResources();
+
+private:
+    ID3D12CommandQueue *p_commandQueue = nullptr;
+    ProfilerClass      *p_profiler     = nullptr;
+
+    const UINT &r_frameIndex;
+    const UINT  m_scopeCapacity = 0u;
+
+    // Every frame in flight owns a slice of the heap and of the readback buffer, with a pair of
+    // timestamps for each scope.
+    ComPtr<ID3D12QueryHeap>           m_queryHeap = nullptr;
+    GpuAllocatorClass::AllocationType m_readback  = {};
+
+    // The names of the scopes begun in each frame, and how many were begun.
+    std::vector<const char *>                           m_names       = {};
+    std::array<std::atomic<UINT>, MAX_FRAMES_IN_FLIGHT> m_scopeCounts = {};
+
+    // A GPU timestamp and the profiler's time at the same moment, which places GPU ticks on the
+    // CPU timeline.
+    UINT64  m_frequency            = 0ull;
+    UINT64  m_calibrationTimestamp = 0ull;
+    int64_t m_calibrationTime      = 0ll;
+};
@@ -0,0 +1,216 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: headlessbackendclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "headlessbackendclass.h"
+#include "nulldeviceclass.h"
+
+
+HeadlessBackendClass::HeadlessBackendClass(UINT screenWidth, UINT screenHeight, UINT maximumFrameLatency, DeviceType deviceType)
+    : m_maximumFrameLatency(maximumFrameLatency)
+{
+    // Create the device and queue, then our offscreen back buffers.
+    switch (deviceType)
+    {
+    case DeviceType::Warp:
+        InitializeWarpDevice();
+        break;
+    case DeviceType::Null:
+        InitializeNullDevice();
+        break;
+    }
+    InitializeCommandQueue();
+    InitializeBackBuffers(screenWidth, screenHeight);
+    InitializeFenceEvent();
+    InitializePresentFence();
+
+    NameD3DResources();
+}
+
+
+HeadlessBackendClass::~HeadlessBackendClass()
+{
+    // Close the object handle to the present event.
+    if (m_presentEvent)
+    {
+        CloseHandle(m_presentEvent);
+    }
+}
+
+
+ID3D12Resource * HeadlessBackendClass::GetBackBuffer(UINT index)
+{
+    return m_backBuffers[index].Get();
+}
+
+
+UINT HeadlessBackendClass::GetCurrentBackBufferIndex()
+{
+    return m_backBufferIndex;
+}
+
+
+bool HeadlessBackendClass::WaitForFrameLatency(DWORD timeout)
+{
+    // Like the waitable object, a successful wait lets exactly one frame through.
+    if (m_frameLatencyWaited)
+    {
+        return true;
+    }
+
+    // Until the GPU has finished all but the maximum latency of our presents, the next frame
+    // would only queue up behind them.
+    if (m_presentCount > m_maximumFrameLatency)
+    {
+        const UINT64 presentValue = m_presentCount - m_maximumFrameLatency;
+
+        // An earlier wait that timed out may still set the event for an older present, so check
+        // the fence again after every wake.
+        while (m_presentFence->GetCompletedValue() < presentValue)
+        {
+            // A poll only looks at the fence.  Registering the event would leave it to be set
+            // long after we stopped waiting for it.
+            if (!timeout)
+            {
+                return false;
+            }
+
+            THROW_IF_FAILED(
+                m_presentFence->SetEventOnCompletion(presentValue, m_presentEvent),
+                "Unable to set the present event."
+            );
+
+            if (WaitForSingleObject(m_presentEvent, timeout) != WAIT_OBJECT_0)
+            {
+                return false;
+            }
+        }
+    }
+
+    m_frameLatencyWaited = true;
+    return true;
+}
+
+
+void HeadlessBackendClass::Present(bool)
+{
+    // There is no display to present to, so we only rotate through the back buffers the same way
+    // a flip model swap chain would.
+    m_backBufferIndex = (m_backBufferIndex + 1u) % FRAME_BUFFER_COUNT;
+
+    // Mark where this present sits in the queue, for the latency wait of the frames after it.
+    THROW_IF_FAILED(
+        m_commandQueue->Signal(m_presentFence.Get(), ++m_presentCount),
+        "Unable to signal the present fence."
+    );
+    m_frameLatencyWaited = false;
+}
+
+
+void HeadlessBackendClass::InitializeWarpDevice()
+{
+    // Use the factory to get the Windows Advanced Rasterization Platform (WARP) adapter.  This is
+    // the software rasterizer, so no video card or display is needed to run the engine.
+    ComPtr<IDXGIFactory4> factory = CreateFactory();
+    ComPtr<IDXGIAdapter> adapter;
+    THROW_IF_FAILED(
+        factory->EnumWarpAdapter(IID_PPV_ARGS(adapter.GetAddressOf())),
+        "Unable to enumerate the software adapter."
+    );
+
+    // Get the adapter description so we can report how much memory it has.
+    DXGI_ADAPTER_DESC adapterDesc;
+    THROW_IF_FAILED(
+        adapter->GetDesc(&adapterDesc),
+        "Unable to communicate with the software adapter."
+    );
+    m_videoCardMemory = adapterDesc.DedicatedVideoMemory;
+
+    InitializeDevice(adapter.Get());
+}
+
+
+void HeadlessBackendClass::InitializeNullDevice()
+{
+    // The null device records every command list into a command stream and completes its work
+    // the moment it is submitted.  It has no adapter, and so no video memory to report.
+    THROW_IF_FAILED(
+        NullDeviceClass::CreateDevice(IID_PPV_ARGS(m_device.GetAddressOf())),
+        "Unable to create the null device."
+    );
+    m_videoCardMemory = 0ull;
+}
+
+
+void HeadlessBackendClass::InitializeBackBuffers(UINT screenWidth, UINT screenHeight)
+{
+    // The back buffers live in the default heap, just like the ones a swap chain would hand us.
+    D3D12_HEAP_PROPERTIES heapProps{};
+    heapProps.Type                 = D3D12_HEAP_TYPE_DEFAULT;
+    heapProps.CPUPageProperty      = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+    heapProps.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+    heapProps.CreationNodeMask     = 1u;
+    heapProps.VisibleNodeMask      = 1u;
+
+    // Describe a render target matching the format the swap chain would have used.
+    D3D12_RESOURCE_DESC resourceDesc{};
+    resourceDesc.Dimension          = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+    resourceDesc.Alignment          = 0ull;
+    resourceDesc.Width              = screenWidth;
+    resourceDesc.Height             = screenHeight;
+    resourceDesc.DepthOrArraySize   = 1u;
+    resourceDesc.MipLevels          = 1u;
+    resourceDesc.Format             = DXGI_FORMAT_R8G8B8A8_UNORM;
+    resourceDesc.SampleDesc.Count   = 1u;
+    resourceDesc.SampleDesc.Quality = 0u;
+    resourceDesc.Layout             = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+    resourceDesc.Flags              = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
+
+    for (UINT i = 0u; i < FRAME_BUFFER_COUNT; ++i)
+    {
+        // Create each back buffer in the present state, since that is what our barriers expect.
+        THROW_IF_FAILED(
+            m_device->CreateCommittedResource(
+                &heapProps,
+                D3D12_HEAP_FLAG_NONE,
+                &resourceDesc,
+                D3D12_RESOURCE_STATE_PRESENT,
+                nullptr,
+                IID_PPV_ARGS(m_backBuffers[i].ReleaseAndGetAddressOf())),
+            "Unable to allocate the offscreen back buffers on the graphics device."
+        );
+    }
+}
+
+
+void HeadlessBackendClass::InitializePresentFence()
+{
+    // Create the fence that tracks how far the GPU has come through our presents.
+    THROW_IF_FAILED(
+        m_device->CreateFence(
+            0ull,
+            D3D12_FENCE_FLAG_NONE,
+            IID_PPV_ARGS(m_presentFence.ReleaseAndGetAddressOf())),
+        "Unable to create the present fence on the graphics device."
+    );
+
+    m_presentEvent = CreateEventEx(NULL, FALSE, FALSE, EVENT_ALL_ACCESS);
+    THROW_IF_TRUE(
+        m_presentEvent == nullptr,
+        "Unable to create a Windows system event for the frame latency wait."
+    );
+}
+
+
+void HeadlessBackendClass::NameD3DResources()
+{
+    // Name all DirectX objects.
+    m_device->SetName(L"HBC device");
+    m_commandQueue->SetName(L"HBC command queue");
+    m_presentFence->SetName(L"HBC present fence");
+    for (UINT i = 0u; i < FRAME_BUFFER_COUNT; ++i)
+    {
+        std::wstring name = L"HBC back buffer " + std::to_wstring(i);
+        m_backBuffers[i]->SetName(name.c_str());
+    }
+}
@@ -0,0 +1,63 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: headlessbackendclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include "backendinterface.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: HeadlessBackendClass
+////////////////////////////////////////////////////////////////////////////////
+class HeadlessBackendClass : public BackendInterface
+{
+public:
+    // The software rasterizer renders every frame for real.  The null device does no work at all
+    // and needs neither DXGI nor the Direct3D 12 runtime, so it measures only the CPU side.
+    enum class DeviceType : uint32_t
+    {
+        Warp,
+        Null,
+    };
+
+public:
+    HeadlessBackendClass() = delete;
+    HeadlessBackendClass(const HeadlessBackendClass &) = delete;
+    HeadlessBackendClass & operator=(const HeadlessBackendClass &) = delete;
+
+    HeadlessBackendClass(UINT, UINT, UINT, DeviceType);
+    ~HeadlessBackendClass();
+
+    ID3D12Resource * GetBackBuffer(UINT) override;
+    UINT GetCurrentBackBufferIndex() override;
+
+    bool WaitForFrameLatency(DWORD) override;
+    void Present(bool) override;
+
+private:
+    void InitializeWarpDevice();
+    void InitializeNullDevice();
+    void InitializeBackBuffers(UINT, UINT);
+    void InitializePresentFence();
+
+    void NameD3DResources() override;
+
+private:
+    UINT m_backBufferIndex = 0u;
+
+    // Stands in for the swap chain's frame latency waitable object.  Every present signals the
+    // next fence value, and a new frame may start once the GPU is within the maximum latency of
+    // the last one presented.  The fence has an event of its own, since a wait that times out
+    // leaves its event registered with the fence.
+    const UINT          m_maximumFrameLatency = 0u;
+    ComPtr<ID3D12Fence> m_presentFence        = nullptr;
+    HANDLE              m_presentEvent        = nullptr;
+    UINT64              m_presentCount        = 0ull;
+    bool                m_frameLatencyWaited  = false;
+
+    std::array<ComPtr<ID3D12Resource>, FRAME_BUFFER_COUNT> m_backBuffers = {};
+};
@@ -1,26 +1,26 @@
-////////////////////////////////////////////////////////////////////////////////
-// Filename: inputclass.h
-////////////////////////////////////////////////////////////////////////////////
-#pragma once
-
-
-////////////////////////////////////////////////////////////////////////////////
-// Class name: InputClass
-////////////////////////////////////////////////////////////////////////////////
-class InputClass
-{
-public:
-    InputClass(const InputClass&) = delete;
-    InputClass& operator=(const InputClass&) = delete;
-
-    InputClass() = default;
-    ~InputClass() = default;
-
-    void KeyDown(UINT);
-    void KeyUp(UINT);
-
-    bool IsKeyDown(UINT);
-
-private:
-    std::array<bool, 256> m_keys = {};
-};
+////////////////////////////////////////////////////////////////////////////////
+// Filename: inputclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: InputClass
+////////////////////////////////////////////////////////////////////////////////
+class InputClass
+{
+public:
+    InputClass(const InputClass&) = delete;
+    InputClass& operator=(const InputClass&) = delete;
+
+    InputClass() = default;
+    ~InputClass() = default;
+
+    void KeyDown(UINT);
+    void KeyUp(UINT);
+
+    bool IsKeyDown(UINT);
+
+private:
+    std::array<bool, 256> m_keys = {};
+};
@@ -1,50 +1,74 @@
-////////////////////////////////////////////////////////////////////////////////
-// Filename: main.cpp
-////////////////////////////////////////////////////////////////////////////////
-#include "pch.h"
-#include "systemclass.h"
-
-
-int WINAPI WinMain(__in HINSTANCE hInstance,
-                   __in_opt HINSTANCE hPrevInstance,
-                   __in PSTR pScmdline,
-                   __in int iCmdshow)
-{
-    // Create and initialize the system object.
-    std::unique_ptr<SystemClass> System;
-    try
-    {
-        System = std::make_unique<SystemClass>();
-    }
-    catch (std::exception& e)
-    {
-        ShowCursor(true);
-        MessageBoxA(NULL, e.what(), "Initialization Error", MB_OK | MB_ICONERROR);
-        return 1;
-    }
-
-    // Run the system
-    try
-    {
-        System->Run();
-    }
-    catch (std::exception& e)
-    {
-        ShowCursor(true);
-        MessageBoxA(NULL, e.what(), "Runtime Error", MB_OK | MB_ICONERROR);
-        return 2;
-    }
-
-#ifdef DX12_ENABLE_DEBUG_LAYER
-    {
-        // Acquire DXGI debug controller.
-        ComPtr<IDXGIDebug1> debugInterface;
-        if (SUCCEEDED(DXGIGetDebugInterface1(0, IID_PPV_ARGS(debugInterface.GetAddressOf()))))
-        {
-            debugInterface->ReportLiveObjects(DXGI_DEBUG_ALL, DXGI_DEBUG_RLO_FLAGS(DXGI_DEBUG_RLO_DETAIL | DXGI_DEBUG_RLO_IGNORE_INTERNAL));
-        }
-    }
-#endif // DX12_ENABLE_DEBUG_LAYER
-
-    return 0;
-}
+////////////////////////////////////////////////////////////////////////////////
+// Filename: main.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "systemclass.h"
+#include "benchmarkclass.h"
+
+
+int WINAPI WinMain(__in HINSTANCE hInstance,
+                   __in_opt HINSTANCE hPrevInstance,
+                   __in PSTR pScmdline,
+                   __in int iCmdshow)
+{
+    // With --benchmark on the command line, drive the engine without a window for a fixed number
+    // of frames and write the results to a file instead.  Benchmarks run unattended, so errors go
+    // to the console that started us rather than into a message box.
+    try
+    {
+        BenchmarkClass::SettingsType settings;
+        if (BenchmarkClass::ParseCommandLine(settings))
+        {
+            BenchmarkClass Benchmark(settings);
+            Benchmark.Run();
+            return 0;
+        }
+    }
+    catch (std::exception& e)
+    {
+        FILE *console = nullptr;
+        if (AttachConsole(ATTACH_PARENT_PROCESS) && freopen_s(&console, "CONOUT$", "w", stderr) == 0)
+        {
+            fprintf(stderr, "Benchmark Error: %s\n", e.what());
+        }
+        return 3;
+    }
+
+    // Create and initialize the system object.
+    std::unique_ptr<SystemClass> System;
+    try
+    {
+        System = std::make_unique<SystemClass>();
+    }
+    catch (std::exception& e)
+    {
+        ShowCursor(true);
+        MessageBoxA(NULL, e.what(), "Initialization Error", MB_OK | MB_ICONERROR);
+        return 1;
+    }
+
+    // Run the system
+    try
+    {
+        System->Run();
+    }
+    catch (std::exception& e)
+    {
+        ShowCursor(true);
+        MessageBoxA(NULL, e.what(), "Runtime Error", MB_OK | MB_ICONERROR);
+        return 2;
+    }
+
+#ifdef DX12_ENABLE_DEBUG_LAYER
+    {
+        // Acquire DXGI debug controller.
+        ComPtr<IDXGIDebug1> debugInterface;
+        if (SUCCEEDED(DXGIGetDebugInterface1(0, IID_PPV_ARGS(debugInterface.GetAddressOf()))))
+        {
+            debugInterface->ReportLiveObjects(DXGI_DEBUG_ALL, DXGI_DEBUG_RLO_FLAGS(DXGI_DEBUG_RLO_DETAIL | DXGI_DEBUG_RLO_IGNORE_INTERNAL));
+        }
+    }
+#endif // DX12_ENABLE_DEBUG_LAYER
+
+    return 0;
+}
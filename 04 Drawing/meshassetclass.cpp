@@ -0,0 +1,231 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: meshassetclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "meshassetclass.h"
+
+
+MeshAssetClass::MeshAssetClass(const std::wstring &filename)
+{
+    // Open the file for reading only, and tell the system we will read it front to back.
+    HANDLE file = CreateFileW(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    THROW_IF_TRUE(
+        file == INVALID_HANDLE_VALUE,
+        "Unable to open the mesh asset."
+    );
+
+    // Check the header before mapping anything, so a file that is not ours is never mapped.
+    LARGE_INTEGER size{};
+    HeaderType    header;
+    DWORD         read = 0u;
+    const bool readable = GetFileSizeEx(file, &size) &&
+                          static_cast<UINT64>(size.QuadPart) >= sizeof(HeaderType) &&
+                          ReadFile(file, &header, sizeof(HeaderType), &read, nullptr) &&
+                          read == sizeof(HeaderType);
+    const char *error = readable ? CheckHeader(header, static_cast<UINT64>(size.QuadPart)) : "The mesh asset is too short to hold its header.";
+
+    // Map the whole file.  Its pages are read in as they are first touched, which is when they
+    // are copied into the upload ring, so the bytes go from the page cache to the GPU's upload
+    // heap without another copy in between.  The view keeps the file open on its own.
+    if (!error)
+    {
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping)
+        {
+            m_data = static_cast<const BYTE*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            CloseHandle(mapping);
+        }
+        m_size = static_cast<UINT64>(size.QuadPart);
+        error  = m_data ? nullptr : "Unable to map the mesh asset.";
+    }
+    CloseHandle(file);
+
+    // Every level of detail has to stay within the mesh's indices.
+    for (UINT32 i = 0u; !error && i < header.lodCount; ++i)
+    {
+        const LodType &lod = GetLods()[i];
+        error = lod.startIndex > header.indexCount || lod.indexCount > header.indexCount - lod.startIndex ? "A level of detail reaches past the mesh asset's indices." : nullptr;
+    }
+
+    // The destructor will not run if we throw, so let go of the view here.
+    if (error && m_data)
+    {
+        UnmapViewOfFile(m_data);
+        m_data = nullptr;
+    }
+
+    THROW_IF_TRUE(
+        error,
+        error
+    );
+}
+
+
+MeshAssetClass::~MeshAssetClass()
+{
+    if (m_data)
+    {
+        UnmapViewOfFile(m_data);
+    }
+}
+
+
+const MeshAssetClass::HeaderType & MeshAssetClass::GetHeader()
+{
+    return *reinterpret_cast<const HeaderType*>(m_data);
+}
+
+
+GeometryPoolClass::MeshDataType MeshAssetClass::GetMeshData()
+{
+    // Point the pool straight at the mapped vertices and indices.
+    const HeaderType &header = GetHeader();
+
+    GeometryPoolClass::MeshDataType meshData;
+    meshData.vertices      = reinterpret_cast<const MeshPackerClass::PackedVertexType*>(m_data + header.vertexOffset);
+    meshData.vertexCount   = header.vertexCount;
+    meshData.indexData     = m_data + header.indexOffset;
+    meshData.indexCount    = header.indexCount;
+    meshData.indexFormat   = static_cast<DXGI_FORMAT>(header.indexFormat);
+    meshData.positionScale = header.positionScale;
+    meshData.positionBias  = header.positionBias;
+    return meshData;
+}
+
+
+const BYTE * MeshAssetClass::GetInstanceData()
+{
+    return GetHeader().instanceCount ? m_data + GetHeader().instanceOffset : nullptr;
+}
+
+
+const MeshAssetClass::LodType * MeshAssetClass::GetLods()
+{
+    return reinterpret_cast<const LodType*>(m_data + GetHeader().lodOffset);
+}
+
+
+UINT64 MeshAssetClass::GetSize()
+{
+    return m_size;
+}
+
+
+void MeshAssetClass::Save(const std::wstring                     &filename,
+                          const MeshPackerClass::PackedMeshType &mesh,
+                          const BYTE                             *instanceData,
+                          UINT                                    instanceCount,
+                          UINT                                    instanceStride,
+                          const std::vector<LodType>             &lods)
+{
+    // Without a table of its own, the mesh has a single level of detail: all of it.
+    std::vector<LodType> lodTable(lods);
+    if (lodTable.empty())
+    {
+        lodTable.emplace_back();
+        lodTable.back().indexCount = mesh.indexCount;
+    }
+
+    // Lay the sections out one after the other.  The bounds are the sphere around the box the
+    // positions were packed into.
+    auto align = [](UINT64 offset) { return (offset + SECTION_ALIGNMENT - 1ull) & ~(SECTION_ALIGNMENT - 1ull); };
+
+    HeaderType header;
+    header.vertexCount    = static_cast<UINT32>(mesh.vertices.size());
+    header.vertexStride   = static_cast<UINT32>(sizeof(MeshPackerClass::PackedVertexType));
+    header.indexCount     = mesh.indexCount;
+    header.indexFormat    = static_cast<UINT32>(mesh.indexFormat);
+    header.instanceCount  = instanceData ? instanceCount : 0u;
+    header.instanceStride = instanceData ? instanceStride : 0u;
+    header.lodCount       = static_cast<UINT32>(lodTable.size());
+    header.positionScale  = mesh.positionScale;
+    header.positionBias   = mesh.positionBias;
+    header.bounds         = { mesh.positionBias.x,
+                              mesh.positionBias.y,
+                              mesh.positionBias.z,
+                              std::sqrt(mesh.positionScale.x * mesh.positionScale.x + mesh.positionScale.y * mesh.positionScale.y + mesh.positionScale.z * mesh.positionScale.z) };
+    header.vertexOffset   = align(sizeof(HeaderType));
+    header.indexOffset    = align(header.vertexOffset + static_cast<UINT64>(header.vertexCount) * header.vertexStride);
+    header.instanceOffset = align(header.indexOffset + mesh.indexData.size());
+    header.lodOffset      = align(header.instanceOffset + static_cast<UINT64>(header.instanceCount) * header.instanceStride);
+
+    const std::pair<const void *, UINT64> sections[] =
+    {
+        { &header,               sizeof(HeaderType) },
+        { mesh.vertices.data(),  static_cast<UINT64>(header.vertexCount) * header.vertexStride },
+        { mesh.indexData.data(), mesh.indexData.size() },
+        { instanceData,          static_cast<UINT64>(header.instanceCount) * header.instanceStride },
+        { lodTable.data(),       lodTable.size() * sizeof(LodType) },
+    };
+
+    // Open the file for writing, replacing any earlier asset of the same name.
+    HANDLE file = CreateFileW(filename.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    THROW_IF_TRUE(
+        file == INVALID_HANDLE_VALUE,
+        "Unable to create the mesh asset."
+    );
+
+    // Write each section, padded out to where the next one starts.
+    const BYTE padding[SECTION_ALIGNMENT] = {};
+    UINT64 offset  = 0ull;
+    bool   written = true;
+    for (const std::pair<const void *, UINT64> &section : sections)
+    {
+        const UINT64 start = align(offset);
+        DWORD count = 0u;
+        written = written && (start == offset || WriteFile(file, padding, static_cast<DWORD>(start - offset), &count, nullptr));
+        written = written && (section.second == 0ull || WriteFile(file, section.first, static_cast<DWORD>(section.second), &count, nullptr));
+        written = written && count == static_cast<DWORD>(section.second ? section.second : start - offset);
+        offset  = start + section.second;
+    }
+    CloseHandle(file);
+
+    THROW_IF_FALSE(
+        written,
+        "Unable to write the mesh asset."
+    );
+}
+
+
+const char * MeshAssetClass::CheckHeader(const HeaderType &header, UINT64 size)
+{
+    // Make sure the file is a mesh asset this code can read, with every section inside it, before
+    // anything is read out of them.
+    if (header.magic != MAGIC)
+    {
+        return "The file is not a mesh asset.";
+    }
+    if (header.version != VERSION)
+    {
+        return "The mesh asset is from an unsupported version.";
+    }
+    if (header.vertexStride != sizeof(MeshPackerClass::PackedVertexType))
+    {
+        return "The mesh asset's vertices are not in the packed format.";
+    }
+    if (header.indexFormat != DXGI_FORMAT_R16_UINT && header.indexFormat != DXGI_FORMAT_R32_UINT)
+    {
+        return "The mesh asset's indices are neither 16 nor 32 bits.";
+    }
+    if (header.lodCount == 0u)
+    {
+        return "The mesh asset has no levels of detail.";
+    }
+
+    const std::pair<UINT64, UINT64> sections[] =
+    {
+        { header.vertexOffset,   static_cast<UINT64>(header.vertexCount) * header.vertexStride },
+        { header.indexOffset,    static_cast<UINT64>(header.indexCount) * MeshPackerClass::GetIndexSize(static_cast<DXGI_FORMAT>(header.indexFormat)) },
+        { header.instanceOffset, static_cast<UINT64>(header.instanceCount) * header.instanceStride },
+        { header.lodOffset,      static_cast<UINT64>(header.lodCount) * sizeof(LodType) },
+    };
+    for (const std::pair<UINT64, UINT64> &section : sections)
+    {
+        if (section.first % SECTION_ALIGNMENT != 0ull || section.first > size || section.second > size - section.first)
+        {
+            return "The mesh asset is shorter than its header says.";
+        }
+    }
+
+    return nullptr;
+}
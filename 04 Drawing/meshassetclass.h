@@ -0,0 +1,81 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: meshassetclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include "geometrypoolclass.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: MeshAssetClass
+////////////////////////////////////////////////////////////////////////////////
+class MeshAssetClass
+{
+public:
+    // "DMSH", read as a little-endian number.
+    static constexpr UINT32 MAGIC   = 0x48534d44u;
+    static constexpr UINT32 VERSION = 1u;
+
+    // The start of every file.  The offsets count from the start of the file, and every section is
+    // aligned to 16 bytes, so the data can be read in place.
+    struct HeaderType
+    {
+        UINT32   magic          = MAGIC;
+        UINT32   version        = VERSION;
+        UINT32   vertexCount    = 0u;
+        UINT32   vertexStride   = 0u;
+        UINT32   indexCount     = 0u;
+        UINT32   indexFormat    = DXGI_FORMAT_UNKNOWN;
+        UINT32   instanceCount  = 0u;
+        UINT32   instanceStride = 0u;
+        UINT32   lodCount       = 0u;
+        UINT32   reserved       = 0u;
+        XMFLOAT4 positionScale  = {};
+        XMFLOAT4 positionBias   = {};
+        XMFLOAT4 bounds         = {};
+        UINT64   vertexOffset   = 0ull;
+        UINT64   indexOffset    = 0ull;
+        UINT64   instanceOffset = 0ull;
+        UINT64   lodOffset      = 0ull;
+    };
+
+    // One level of detail: a range of the mesh's indices, and how far its surface may stray from
+    // the full mesh.  The first level is the full mesh.
+    struct LodType
+    {
+        UINT32 startIndex = 0u;
+        UINT32 indexCount = 0u;
+        float  error      = 0.0f;
+        UINT32 reserved   = 0u;
+    };
+
+public:
+    MeshAssetClass() = delete;
+    MeshAssetClass(const MeshAssetClass &) = delete;
+    MeshAssetClass & operator=(const MeshAssetClass &) = delete;
+
+    MeshAssetClass(const std::wstring &);
+    ~MeshAssetClass();
+
+    const HeaderType & GetHeader();
+    GeometryPoolClass::MeshDataType GetMeshData();
+    const BYTE * GetInstanceData();
+    const LodType * GetLods();
+    UINT64 GetSize();
+
+    static void Save(const std::wstring &, const MeshPackerClass::PackedMeshType &, const BYTE * = nullptr, UINT = 0u, UINT = 0u, const std::vector<LodType> & = {});
+
+private:
+    static const char * CheckHeader(const HeaderType &, UINT64);
+
+private:
+    // Sections start on this boundary.
+    static constexpr UINT64 SECTION_ALIGNMENT = 16ull;
+
+    const BYTE *m_data = nullptr;
+    UINT64      m_size = 0ull;
+};
@@ -0,0 +1,64 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: meshclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "meshclass.h"
+
+
+MeshClass::MeshClass(GeometryPoolClass *geometryPool, GpuAllocatorClass *allocator, UploadRingClass *uploader, const std::wstring &filename)
+{
+    // Map the asset.  It was optimized and packed when it was saved, so its vertices and indices
+    // are copied from the mapped file into the upload ring as they are, and the file is unmapped
+    // again as soon as we are done here.
+    MeshAssetClass asset(filename);
+    const MeshAssetClass::HeaderType &header = asset.GetHeader();
+
+    THROW_IF_TRUE(
+        header.instanceCount && header.instanceStride != INSTANCE_STRIDE,
+        "The mesh asset's instances are not laid out the way the instance context reads them."
+    );
+
+    m_mesh         = geometryPool->AddMesh(asset.GetMeshData());
+    p_geometryPool = geometryPool;
+
+    if (header.instanceCount)
+    {
+        m_instanceBuffer = BufferType(allocator, uploader, asset.GetInstanceData(), header.instanceCount, header.instanceStride, L"MC instance buffer");
+    }
+
+    // Keep the levels of detail; they are small, and the mapping is not.
+    m_lods.assign(asset.GetLods(), asset.GetLods() + header.lodCount);
+}
+
+
+bool MeshClass::IsInstanced()
+{
+    return m_instanceBuffer.count != 0ull;
+}
+
+
+bool MeshClass::IsResident()
+{
+    // We can only draw once our mesh and any instances have arrived on the GPU.
+    return p_geometryPool->IsResident(m_mesh) && (!IsInstanced() || m_instanceBuffer.IsResident());
+}
+
+
+void MeshClass::Render(PipelineClass *pipeline)
+{
+    // Set the type of primitive that the input assembler will try to assemble next.
+    pipeline->SetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    p_geometryPool->SetIndexBuffer(pipeline, m_mesh);
+
+    // The shared vertex and index buffers are already bound, so only our instances are left to
+    // set, in the second slot.
+    if (IsInstanced())
+    {
+        pipeline->SetVertexBuffers(1, 1, &m_instanceBuffer.vertexView);
+    }
+
+    // Draw the most detailed level, which is the first.  Its range is relative to our own indices.
+    const MeshAssetClass::LodType &lod = m_lods[0];
+    const UINT instanceCount = IsInstanced() ? static_cast<UINT>(m_instanceBuffer.count) : 1u;
+    pipeline->DrawIndexedInstanced(lod.indexCount, instanceCount, m_mesh.startIndex + lod.startIndex, static_cast<INT>(m_mesh.baseVertex), 0u);
+}
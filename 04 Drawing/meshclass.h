@@ -0,0 +1,41 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: meshclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include "geometryinterface.h"
+#include "meshassetclass.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: MeshClass
+////////////////////////////////////////////////////////////////////////////////
+class MeshClass : public GeometryInterface
+{
+private:
+    // Instances are drawn by the instance context, so they must be laid out the way it reads them:
+    // a position, then a hue, saturation and value.
+    static constexpr UINT INSTANCE_STRIDE = 6u * sizeof(float);
+
+public:
+    MeshClass() = delete;
+    MeshClass(const MeshClass &) = delete;
+    MeshClass & operator=(const MeshClass &) = delete;
+
+    MeshClass(GeometryPoolClass *, GpuAllocatorClass *, UploadRingClass *, const std::wstring &);
+    ~MeshClass() = default;
+
+    bool IsInstanced();
+
+    bool IsResident() override;
+    void Render(PipelineClass *) override;
+
+private:
+    BufferType m_instanceBuffer = {};
+
+    std::vector<MeshAssetClass::LodType> m_lods = {};
+};
@@ -0,0 +1,366 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: meshoptimizerclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "meshoptimizerclass.h"
+
+
+void MeshOptimizerClass::Optimize(std::vector<MeshPackerClass::VertexType> &vertices, std::vector<uint32_t> &indices)
+{
+    // Order the triangles for the vertex cache first, then move whole runs of them around to draw
+    // the outside of the mesh first without losing much of that, and finally lay the vertices out
+    // in the order the triangles now read them.
+    OptimizeVertexCache(indices, static_cast<UINT>(vertices.size()));
+    OptimizeOverdraw(indices, vertices);
+    OptimizeVertexFetch(vertices, indices);
+}
+
+
+void MeshOptimizerClass::OptimizeVertexCache(std::vector<uint32_t> &indices, UINT vertexCount)
+{
+    const UINT triangleCount = static_cast<UINT>(indices.size() / 3u);
+    if (triangleCount == 0u)
+    {
+        return;
+    }
+
+    // Score a vertex by how recently it went through the cache, and by how few triangles still
+    // need it, so lone vertices get finished off and leave the cache for good.  The three vertices
+    // of the last triangle score a little less than the next few, to avoid drawing the same edge
+    // again straight away.  This is Tom Forsyth's linear-speed vertex cache optimization.
+    float cacheScores[CACHE_SIZE];
+    for (UINT i = 0u; i < CACHE_SIZE; ++i)
+    {
+        cacheScores[i] = i < 3u ? 0.75f : std::pow(1.0f - static_cast<float>(i - 3u) / static_cast<float>(CACHE_SIZE - 3u), 1.5f);
+    }
+
+    float valenceScores[VALENCE_COUNT + 1u];
+    valenceScores[0] = 0.0f;
+    for (UINT i = 1u; i <= VALENCE_COUNT; ++i)
+    {
+        valenceScores[i] = 2.0f / std::sqrt(static_cast<float>(i));
+    }
+
+    auto getVertexScore = [&](UINT cachePosition, UINT liveTriangles)
+    {
+        const float valenceScore = valenceScores[liveTriangles < VALENCE_COUNT ? liveTriangles : VALENCE_COUNT];
+        return cachePosition < CACHE_SIZE ? cacheScores[cachePosition] + valenceScore : valenceScore;
+    };
+
+    // List the triangles each vertex is used by, one vertex after the other.  The lists shrink as
+    // triangles are drawn, so they only ever hold the live ones.
+    std::vector<UINT> liveCounts(vertexCount, 0u);
+    for (uint32_t index : indices)
+    {
+        ++liveCounts[index];
+    }
+
+    std::vector<UINT> offsets(vertexCount, 0u);
+    for (UINT vertex = 1u; vertex < vertexCount; ++vertex)
+    {
+        offsets[vertex] = offsets[vertex - 1u] + liveCounts[vertex - 1u];
+    }
+
+    std::vector<UINT> adjacency(indices.size());
+    std::vector<UINT> fill(offsets);
+    for (UINT triangle = 0u; triangle < triangleCount; ++triangle)
+    {
+        for (UINT corner = 0u; corner < 3u; ++corner)
+        {
+            adjacency[fill[indices[triangle * 3u + corner]]++] = triangle;
+        }
+    }
+
+    // Score everything as if the cache were empty.
+    std::vector<float> vertexScores(vertexCount);
+    for (UINT vertex = 0u; vertex < vertexCount; ++vertex)
+    {
+        vertexScores[vertex] = getVertexScore(CACHE_SIZE, liveCounts[vertex]);
+    }
+
+    std::vector<float> triangleScores(triangleCount);
+    for (UINT triangle = 0u; triangle < triangleCount; ++triangle)
+    {
+        const uint32_t *corners = &indices[triangle * 3u];
+        triangleScores[triangle] = vertexScores[corners[0]] + vertexScores[corners[1]] + vertexScores[corners[2]];
+    }
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    std::vector<bool> emitted(triangleCount, false);
+
+    UINT cache[CACHE_SIZE + 3u];
+    UINT cacheCount = 0u;
+    UINT cursor     = 0u;
+    UINT best       = 0u;
+    while (best != NO_TRIANGLE)
+    {
+        const uint32_t *corners = &indices[best * 3u];
+        result.insert(result.end(), corners, corners + 3);
+        emitted[best] = true;
+
+        // The triangle's vertices move to the front of the cache, and push the rest back.
+        UINT newCache[CACHE_SIZE + 3u] = { corners[0], corners[1], corners[2] };
+        UINT newCount = 3u;
+        for (UINT i = 0u; i < cacheCount; ++i)
+        {
+            if (cache[i] != corners[0] && cache[i] != corners[1] && cache[i] != corners[2])
+            {
+                newCache[newCount++] = cache[i];
+            }
+        }
+
+        // Drop the triangle from the lists of its vertices.
+        for (UINT corner = 0u; corner < 3u; ++corner)
+        {
+            const uint32_t vertex = corners[corner];
+            UINT *list = &adjacency[offsets[vertex]];
+            for (UINT i = 0u; i < liveCounts[vertex]; ++i)
+            {
+                if (list[i] == best)
+                {
+                    list[i] = list[--liveCounts[vertex]];
+                    break;
+                }
+            }
+        }
+
+        // Rescore the vertices that moved, including the ones pushed out of the cache, and pass the
+        // change on to their triangles.
+        for (UINT i = 0u; i < newCount; ++i)
+        {
+            const UINT  vertex = newCache[i];
+            const float score  = getVertexScore(i, liveCounts[vertex]);
+            const float delta  = score - vertexScores[vertex];
+            vertexScores[vertex] = score;
+
+            const UINT *list = &adjacency[offsets[vertex]];
+            for (UINT j = 0u; j < liveCounts[vertex]; ++j)
+            {
+                triangleScores[list[j]] += delta;
+            }
+        }
+
+        // Draw the best triangle that uses a vertex still in the cache next.
+        best = NO_TRIANGLE;
+        float bestScore = -1.0f;
+        cacheCount = newCount < CACHE_SIZE ? newCount : CACHE_SIZE;
+        for (UINT i = 0u; i < cacheCount; ++i)
+        {
+            cache[i] = newCache[i];
+
+            const UINT *list = &adjacency[offsets[cache[i]]];
+            for (UINT j = 0u; j < liveCounts[cache[i]]; ++j)
+            {
+                if (triangleScores[list[j]] > bestScore)
+                {
+                    bestScore = triangleScores[list[j]];
+                    best      = list[j];
+                }
+            }
+        }
+
+        // When the cache has nothing left to offer, start again at the first triangle not drawn.
+        if (best == NO_TRIANGLE)
+        {
+            while (cursor < triangleCount && emitted[cursor])
+            {
+                ++cursor;
+            }
+            best = cursor < triangleCount ? cursor : NO_TRIANGLE;
+        }
+    }
+
+    indices.swap(result);
+}
+
+
+void MeshOptimizerClass::OptimizeOverdraw(std::vector<uint32_t> &indices, const std::vector<MeshPackerClass::VertexType> &vertices, float threshold)
+{
+    const UINT triangleCount = static_cast<UINT>(indices.size() / 3u);
+    if (triangleCount == 0u)
+    {
+        return;
+    }
+
+    // Cut the cache-ordered triangles into clusters wherever the cache starts over anyway, where
+    // none of a triangle's vertices are still in it.
+    std::vector<UINT> cacheTimes(vertices.size(), 0u);
+    UINT time = CACHE_SIZE + 1u;
+
+    std::vector<UINT> hardStarts;
+    for (UINT triangle = 0u; triangle < triangleCount; ++triangle)
+    {
+        if (CountMisses(&indices[triangle * 3u], cacheTimes, time) == 3u || triangle == 0u)
+        {
+            hardStarts.push_back(triangle);
+        }
+    }
+    hardStarts.push_back(triangleCount);
+
+    // Cut those further wherever a cluster started from an empty cache would still do within the
+    // threshold of its whole cluster, so there are more pieces to move around.  Moving time on by
+    // the size of the cache empties it.
+    std::vector<UINT> clusterStarts;
+    for (size_t cluster = 0; cluster + 1 < hardStarts.size(); ++cluster)
+    {
+        const UINT start = hardStarts[cluster];
+        const UINT end   = hardStarts[cluster + 1];
+
+        time += CACHE_SIZE + 1u;
+        UINT clusterMisses = 0u;
+        for (UINT triangle = start; triangle < end; ++triangle)
+        {
+            clusterMisses += CountMisses(&indices[triangle * 3u], cacheTimes, time);
+        }
+        const float clusterAcmr = static_cast<float>(clusterMisses) / static_cast<float>(end - start);
+
+        time += CACHE_SIZE + 1u;
+        clusterStarts.push_back(start);
+        UINT subStart = start;
+        UINT misses   = 0u;
+        for (UINT triangle = start; triangle + 1u < end; ++triangle)
+        {
+            misses += CountMisses(&indices[triangle * 3u], cacheTimes, time);
+            if (static_cast<float>(misses) <= threshold * clusterAcmr * static_cast<float>(triangle + 1u - subStart))
+            {
+                clusterStarts.push_back(triangle + 1u);
+                subStart = triangle + 1u;
+                misses   = 0u;
+                time    += CACHE_SIZE + 1u;
+            }
+        }
+    }
+    clusterStarts.push_back(triangleCount);
+
+    // Find the middle of the mesh.
+    float meshCentroid[3] = {};
+    for (const MeshPackerClass::VertexType &vertex : vertices)
+    {
+        meshCentroid[0] += vertex.position.x;
+        meshCentroid[1] += vertex.position.y;
+        meshCentroid[2] += vertex.position.z;
+    }
+    const float vertexScale = vertices.empty() ? 0.0f : 1.0f / static_cast<float>(vertices.size());
+    meshCentroid[0] *= vertexScale;
+    meshCentroid[1] *= vertexScale;
+    meshCentroid[2] *= vertexScale;
+
+    // Sort the clusters by how far out they face: the distance of their center from the middle of
+    // the mesh, along their average normal.  Clusters facing out from the edge of the mesh are
+    // drawn first, and hide much of what comes after them.
+    const UINT clusterCount = static_cast<UINT>(clusterStarts.size() - 1u);
+    std::vector<float> sortKeys(clusterCount);
+    for (UINT cluster = 0u; cluster < clusterCount; ++cluster)
+    {
+        float centroid[3] = {};
+        float normal[3]   = {};
+        float totalArea   = 0.0f;
+        for (UINT triangle = clusterStarts[cluster]; triangle < clusterStarts[cluster + 1u]; ++triangle)
+        {
+            const XMFLOAT3 &p0 = vertices[indices[triangle * 3u + 0u]].position;
+            const XMFLOAT3 &p1 = vertices[indices[triangle * 3u + 1u]].position;
+            const XMFLOAT3 &p2 = vertices[indices[triangle * 3u + 2u]].position;
+
+            const float e1[3] = { p1.x - p0.x, p1.y - p0.y, p1.z - p0.z };
+            const float e2[3] = { p2.x - p0.x, p2.y - p0.y, p2.z - p0.z };
+            const float n[3]  = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+            const float area  = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+            // Weight each triangle's center by its area, so slivers count for little.
+            centroid[0] += (p0.x + p1.x + p2.x) / 3.0f * area;
+            centroid[1] += (p0.y + p1.y + p2.y) / 3.0f * area;
+            centroid[2] += (p0.z + p1.z + p2.z) / 3.0f * area;
+            normal[0]   += n[0];
+            normal[1]   += n[1];
+            normal[2]   += n[2];
+            totalArea   += area;
+        }
+
+        const float areaScale   = totalArea > 0.0f ? 1.0f / totalArea : 0.0f;
+        const float normalScale = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        const float normalInv   = normalScale > 0.0f ? 1.0f / normalScale : 0.0f;
+        sortKeys[cluster] = (centroid[0] * areaScale - meshCentroid[0]) * normal[0] * normalInv
+                          + (centroid[1] * areaScale - meshCentroid[1]) * normal[1] * normalInv
+                          + (centroid[2] * areaScale - meshCentroid[2]) * normal[2] * normalInv;
+    }
+
+    std::vector<UINT> order(clusterCount);
+    for (UINT cluster = 0u; cluster < clusterCount; ++cluster)
+    {
+        order[cluster] = cluster;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](UINT a, UINT b) { return sortKeys[a] > sortKeys[b]; });
+
+    // Lay the clusters out again in their new order, keeping the order within each.
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    for (UINT cluster : order)
+    {
+        result.insert(result.end(), indices.begin() + clusterStarts[cluster] * 3u, indices.begin() + clusterStarts[cluster + 1u] * 3u);
+    }
+    indices.swap(result);
+}
+
+
+void MeshOptimizerClass::OptimizeVertexFetch(std::vector<MeshPackerClass::VertexType> &vertices, std::vector<uint32_t> &indices)
+{
+    // Number the vertices in the order the triangles first use them, so fetching them walks
+    // through memory instead of jumping around it.  Vertices no triangle uses are dropped.
+    std::vector<uint32_t> remap(vertices.size(), ~0u);
+    std::vector<MeshPackerClass::VertexType> result;
+    result.reserve(vertices.size());
+    for (uint32_t &index : indices)
+    {
+        if (remap[index] == ~0u)
+        {
+            remap[index] = static_cast<uint32_t>(result.size());
+            result.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+    vertices.swap(result);
+}
+
+
+MeshOptimizerClass::CacheStatisticsType MeshOptimizerClass::AnalyzeVertexCache(const std::vector<uint32_t> &indices, UINT vertexCount)
+{
+    // Run the indices through a first in, first out cache, the way most GPUs reuse vertices.
+    std::vector<UINT> cacheTimes(vertexCount, 0u);
+    UINT time = CACHE_SIZE + 1u;
+
+    const UINT triangleCount = static_cast<UINT>(indices.size() / 3u);
+    UINT misses = 0u;
+    for (UINT triangle = 0u; triangle < triangleCount; ++triangle)
+    {
+        misses += CountMisses(&indices[triangle * 3u], cacheTimes, time);
+    }
+
+    // Every vertex used misses at least once, which leaves its time behind.
+    UINT usedCount = 0u;
+    for (UINT cacheTime : cacheTimes)
+    {
+        usedCount += cacheTime ? 1u : 0u;
+    }
+
+    CacheStatisticsType statistics;
+    statistics.acmr = triangleCount ? static_cast<double>(misses) / static_cast<double>(triangleCount) : 0.0;
+    statistics.atvr = usedCount ? static_cast<double>(misses) / static_cast<double>(usedCount) : 0.0;
+    return statistics;
+}
+
+
+UINT MeshOptimizerClass::CountMisses(const uint32_t *corners, std::vector<UINT> &cacheTimes, UINT &time)
+{
+    // A vertex is still in the cache if fewer vertices than fit in it have gone in since it did.
+    UINT misses = 0u;
+    for (UINT corner = 0u; corner < 3u; ++corner)
+    {
+        if (time - cacheTimes[corners[corner]] > CACHE_SIZE)
+        {
+            cacheTimes[corners[corner]] = time++;
+            ++misses;
+        }
+    }
+    return misses;
+}
@@ -0,0 +1,53 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: meshoptimizerclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include "meshpackerclass.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: MeshOptimizerClass
+////////////////////////////////////////////////////////////////////////////////
+class MeshOptimizerClass
+{
+public:
+    // How well the vertex cache does on a mesh: vertices transformed per triangle, and per vertex.
+    // A perfect strip of triangles gets an ACMR near 0.5, and every mesh an ATVR of at least 1.
+    struct CacheStatisticsType
+    {
+        double acmr = 0.0;
+        double atvr = 0.0;
+    };
+
+public:
+    MeshOptimizerClass() = delete;
+    MeshOptimizerClass(const MeshOptimizerClass &) = delete;
+    MeshOptimizerClass & operator=(const MeshOptimizerClass &) = delete;
+
+    static void Optimize(std::vector<MeshPackerClass::VertexType> &, std::vector<uint32_t> &);
+
+    static void OptimizeVertexCache(std::vector<uint32_t> &, UINT);
+    static void OptimizeOverdraw(std::vector<uint32_t> &, const std::vector<MeshPackerClass::VertexType> &, float = 1.05f);
+    static void OptimizeVertexFetch(std::vector<MeshPackerClass::VertexType> &, std::vector<uint32_t> &);
+
+    static CacheStatisticsType AnalyzeVertexCache(const std::vector<uint32_t> &, UINT);
+
+private:
+    static UINT CountMisses(const uint32_t *, std::vector<UINT> &, UINT &);
+
+private:
+    // The number of transformed vertices the GPU is assumed to keep around.
+    static constexpr UINT CACHE_SIZE = 16u;
+
+    // Vertices used by more live triangles than this all score the same.
+    static constexpr UINT VALENCE_COUNT = 32u;
+
+    // Marks no triangle at all.
+    static constexpr UINT NO_TRIANGLE = ~0u;
+};
@@ -0,0 +1,114 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: meshpackerclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "meshpackerclass.h"
+
+
+MeshPackerClass::PackedMeshType MeshPackerClass::Pack(const std::vector<VertexType> &vertices, const std::vector<uint32_t> &indices)
+{
+    PackedMeshType mesh;
+
+    // Bound the mesh, so its positions can be stored relative to the center of the bounds.  An
+    // axis the mesh is flat along keeps a scale of one, since every offset along it is zero.
+    XMFLOAT3 lower = vertices.empty() ? XMFLOAT3() : vertices[0].position;
+    XMFLOAT3 upper = lower;
+    for (const VertexType &vertex : vertices)
+    {
+        lower.x = vertex.position.x < lower.x ? vertex.position.x : lower.x;
+        lower.y = vertex.position.y < lower.y ? vertex.position.y : lower.y;
+        lower.z = vertex.position.z < lower.z ? vertex.position.z : lower.z;
+        upper.x = vertex.position.x > upper.x ? vertex.position.x : upper.x;
+        upper.y = vertex.position.y > upper.y ? vertex.position.y : upper.y;
+        upper.z = vertex.position.z > upper.z ? vertex.position.z : upper.z;
+    }
+
+    const float halfExtents[3] = { 0.5f * (upper.x - lower.x), 0.5f * (upper.y - lower.y), 0.5f * (upper.z - lower.z) };
+    mesh.positionScale = { halfExtents[0] > 0.0f ? halfExtents[0] : 1.0f,
+                           halfExtents[1] > 0.0f ? halfExtents[1] : 1.0f,
+                           halfExtents[2] > 0.0f ? halfExtents[2] : 1.0f,
+                           1.0f };
+    mesh.positionBias  = { lower.x + halfExtents[0], lower.y + halfExtents[1], lower.z + halfExtents[2], 0.0f };
+
+    // Quantize every vertex.  The vertex shader undoes the scale and bias again, so the positions
+    // come out where they were, give or take half a step of the bounds.
+    mesh.vertices.resize(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        const VertexType &vertex = vertices[i];
+        PackedVertexType &packed = mesh.vertices[i];
+
+        packed.position[0] = QuantizeSnorm((vertex.position.x - mesh.positionBias.x) / mesh.positionScale.x);
+        packed.position[1] = QuantizeSnorm((vertex.position.y - mesh.positionBias.y) / mesh.positionScale.y);
+        packed.position[2] = QuantizeSnorm((vertex.position.z - mesh.positionBias.z) / mesh.positionScale.z);
+        packed.position[3] = 0;
+
+        packed.color = QuantizeUnorm(vertex.color.x)
+                     | QuantizeUnorm(vertex.color.y) << 8
+                     | QuantizeUnorm(vertex.color.z) << 16
+                     | QuantizeUnorm(vertex.color.w) << 24;
+    }
+
+    // Draws offset the indices by the mesh's base vertex, so they only have to reach across the
+    // mesh itself.  Use 16 bits whenever they do, leaving the strip cut value unused.
+    mesh.indexCount  = static_cast<UINT>(indices.size());
+    mesh.indexFormat = vertices.size() <= 0xffffu ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+    mesh.indexData.resize(indices.size() * GetIndexSize(mesh.indexFormat));
+    if (mesh.indexFormat == DXGI_FORMAT_R16_UINT)
+    {
+        uint16_t *shortIndices = reinterpret_cast<uint16_t*>(mesh.indexData.data());
+        for (size_t i = 0; i < indices.size(); ++i)
+        {
+            shortIndices[i] = static_cast<uint16_t>(indices[i]);
+        }
+    }
+    else if (!indices.empty())
+    {
+        memcpy(mesh.indexData.data(), indices.data(), mesh.indexData.size());
+    }
+
+    return mesh;
+}
+
+
+void MeshPackerClass::SetInputElements(D3D12_INPUT_ELEMENT_DESC *elements)
+{
+    // Describe the packed vertex.  The input assembler turns both elements back into floats, so the
+    // shaders read them the same way as before, only scaled.
+    elements[0].SemanticName         = "POSITION";
+    elements[0].SemanticIndex        = 0;
+    elements[0].Format               = DXGI_FORMAT_R16G16B16A16_SNORM;
+    elements[0].InputSlot            = 0;
+    elements[0].AlignedByteOffset    = 0;
+    elements[0].InputSlotClass       = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA;
+    elements[0].InstanceDataStepRate = 0;
+
+    elements[1].SemanticName         = "COLOR";
+    elements[1].SemanticIndex        = 0;
+    elements[1].Format               = DXGI_FORMAT_R8G8B8A8_UNORM;
+    elements[1].InputSlot            = 0;
+    elements[1].AlignedByteOffset    = D3D12_APPEND_ALIGNED_ELEMENT;
+    elements[1].InputSlotClass       = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA;
+    elements[1].InstanceDataStepRate = 0;
+}
+
+
+UINT MeshPackerClass::GetIndexSize(DXGI_FORMAT format)
+{
+    return format == DXGI_FORMAT_R16_UINT ? 2u : 4u;
+}
+
+
+int16_t MeshPackerClass::QuantizeSnorm(float value)
+{
+    // Map [-1, 1] onto [-32767, 32767], which is the range the GPU maps back.
+    value = value < -1.0f ? -1.0f : value > 1.0f ? 1.0f : value;
+    return static_cast<int16_t>(std::lround(value * 32767.0f));
+}
+
+
+UINT32 MeshPackerClass::QuantizeUnorm(float value)
+{
+    value = value < 0.0f ? 0.0f : value > 1.0f ? 1.0f : value;
+    return static_cast<UINT32>(std::lround(value * 255.0f));
+}
@@ -0,0 +1,58 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: meshpackerclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cmath>
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: MeshPackerClass
+////////////////////////////////////////////////////////////////////////////////
+class MeshPackerClass
+{
+public:
+    // The vertices meshes are built from on the CPU.
+    struct VertexType
+    {
+        XMFLOAT3 position = {};
+        XMFLOAT4 color    = {};
+    };
+
+    // The vertices as the GPU reads them, in 12 bytes instead of 28.  Positions are offsets from
+    // the center of the mesh's bounds, normalized to its half extents, and colors are 8 bits per
+    // channel.  The fourth position component only pads the color out to its alignment.
+    struct PackedVertexType
+    {
+        int16_t position[4] = {};
+        UINT32  color       = 0u;
+    };
+
+    // A mesh ready to be copied to the GPU as is, together with what it takes to draw it.
+    struct PackedMeshType
+    {
+        std::vector<PackedVertexType> vertices      = {};
+        std::vector<BYTE>             indexData     = {};
+        UINT                          indexCount    = 0u;
+        DXGI_FORMAT                   indexFormat   = DXGI_FORMAT_R32_UINT;
+        XMFLOAT4                      positionScale = { 1.0f, 1.0f, 1.0f, 1.0f };
+        XMFLOAT4                      positionBias  = { 0.0f, 0.0f, 0.0f, 0.0f };
+    };
+
+public:
+    MeshPackerClass() = delete;
+    MeshPackerClass(const MeshPackerClass &) = delete;
+    MeshPackerClass & operator=(const MeshPackerClass &) = delete;
+
+    static PackedMeshType Pack(const std::vector<VertexType> &, const std::vector<uint32_t> &);
+    static void SetInputElements(D3D12_INPUT_ELEMENT_DESC *);
+    static UINT GetIndexSize(DXGI_FORMAT);
+
+private:
+    static int16_t QuantizeSnorm(float);
+    static UINT32 QuantizeUnorm(float);
+};
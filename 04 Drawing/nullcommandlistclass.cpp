@@ -0,0 +1,330 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: nullcommandlistclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "nullcommandlistclass.h"
+
+
+NullCommandListClass::NullCommandListClass(ID3D12Device *device, D3D12_COMMAND_LIST_TYPE type, ID3D12PipelineState *initialState)
+    : NullDeviceChildClass(device)
+    , m_type(type)
+{
+    // A new list is open for recording, just as it is after a reset.
+    Reset(nullptr, initialState);
+}
+
+
+D3D12_COMMAND_LIST_TYPE STDMETHODCALLTYPE NullCommandListClass::GetType()
+{
+    return m_type;
+}
+
+
+HRESULT STDMETHODCALLTYPE NullCommandListClass::Close()
+{
+    return S_OK;
+}
+
+
+HRESULT STDMETHODCALLTYPE NullCommandListClass::Reset(ID3D12CommandAllocator *, ID3D12PipelineState *pInitialState)
+{
+    // Start the stream over, keeping its memory for this recording.
+    m_stream.Clear();
+    if (pInitialState)
+    {
+        m_stream.RecordSetPipelineState(pInitialState);
+    }
+    return S_OK;
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::ClearState(ID3D12PipelineState *)
+{
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::DrawInstanced(UINT, UINT, UINT, UINT)
+{
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::DrawIndexedInstanced(UINT IndexCountPerInstance, UINT InstanceCount, UINT StartIndexLocation, INT BaseVertexLocation, UINT StartInstanceLocation)
+{
+    m_stream.RecordDrawIndexedInstanced(IndexCountPerInstance, InstanceCount, StartIndexLocation, BaseVertexLocation, StartInstanceLocation);
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::Dispatch(UINT ThreadGroupCountX, UINT ThreadGroupCountY, UINT ThreadGroupCountZ)
+{
+    m_stream.RecordDispatch(ThreadGroupCountX, ThreadGroupCountY, ThreadGroupCountZ);
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::CopyBufferRegion(ID3D12Resource *pDstBuffer, UINT64 DstOffset, ID3D12Resource *pSrcBuffer, UINT64 SrcOffset, UINT64 NumBytes)
+{
+    m_stream.RecordCopyBufferRegion(pDstBuffer, DstOffset, pSrcBuffer, SrcOffset, NumBytes);
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::CopyTextureRegion(const D3D12_TEXTURE_COPY_LOCATION *, UINT, UINT, UINT, const D3D12_TEXTURE_COPY_LOCATION *, const D3D12_BOX *)
+{
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::CopyResource(ID3D12Resource *, ID3D12Resource *)
+{
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::CopyTiles(ID3D12Resource *, const D3D12_TILED_RESOURCE_COORDINATE *, const D3D12_TILE_REGION_SIZE *, ID3D12Resource *, UINT64, D3D12_TILE_COPY_FLAGS)
+{
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::ResolveSubresource(ID3D12Resource *, UINT, ID3D12Resource *, UINT, DXGI_FORMAT)
+{
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::IASetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY PrimitiveTopology)
+{
+    m_stream.RecordSetPrimitiveTopology(PrimitiveTopology);
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::RSSetViewports(UINT NumViewports, const D3D12_VIEWPORT *pViewports)
+{
+    // Only the first viewport is kept, which is the only one the stream has room for.
+    if (NumViewports)
+    {
+        m_viewport = pViewports[0];
+    }
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::RSSetScissorRects(UINT NumRects, const D3D12_RECT *pRects)
+{
+    if (NumRects)
+    {
+        m_stream.RecordSetViewport(m_viewport, pRects[0]);
+    }
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::OMSetBlendFactor(const FLOAT[4])
+{
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::OMSetStencilRef(UINT)
+{
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::SetPipelineState(ID3D12PipelineState *pPipelineState)
+{
+    m_stream.RecordSetPipelineState(pPipelineState);
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::ResourceBarrier(UINT NumBarriers, const D3D12_RESOURCE_BARRIER *pBarriers)
+{
+    m_stream.RecordResourceBarrier(NumBarriers, pBarriers);
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::ExecuteBundle(ID3D12GraphicsCommandList *)
+{
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::SetDescriptorHeaps(UINT, ID3D12DescriptorHeap * const *)
+{
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::SetComputeRootSignature(ID3D12RootSignature *pRootSignature)
+{
+    m_stream.RecordSetComputeRootSignature(pRootSignature);
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::SetGraphicsRootSignature(ID3D12RootSignature *pRootSignature)
+{
+    m_stream.RecordSetRootSignature(pRootSignature);
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::SetComputeRootDescriptorTable(UINT, D3D12_GPU_DESCRIPTOR_HANDLE)
+{
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::SetGraphicsRootDescriptorTable(UINT, D3D12_GPU_DESCRIPTOR_HANDLE)
+{
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::SetComputeRoot32BitConstant(UINT, UINT, UINT)
+{
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::SetGraphicsRoot32BitConstant(UINT RootParameterIndex, UINT SrcData, UINT DestOffsetIn32BitValues)
+{
+    m_stream.RecordSetRoot32BitConstant(RootParameterIndex, SrcData, DestOffsetIn32BitValues);
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::SetComputeRoot32BitConstants(UINT, UINT, const void *, UINT)
+{
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::SetGraphicsRoot32BitConstants(UINT RootParameterIndex, UINT Num32BitValuesToSet, const void *pSrcData, UINT DestOffsetIn32BitValues)
+{
+    // The stream sets constants one at a time.
+    for (UINT i = 0u; i < Num32BitValuesToSet; ++i)
+    {
+        m_stream.RecordSetRoot32BitConstant(RootParameterIndex, static_cast<const UINT *>(pSrcData)[i], DestOffsetIn32BitValues + i);
+    }
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::SetComputeRootConstantBufferView(UINT RootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS BufferLocation)
+{
+    m_stream.RecordSetComputeRootConstantBufferView(RootParameterIndex, BufferLocation);
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::SetGraphicsRootConstantBufferView(UINT RootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS BufferLocation)
+{
+    m_stream.RecordSetRootConstantBufferView(RootParameterIndex, BufferLocation);
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::SetComputeRootShaderResourceView(UINT RootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS BufferLocation)
+{
+    m_stream.RecordSetComputeRootShaderResourceView(RootParameterIndex, BufferLocation);
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::SetGraphicsRootShaderResourceView(UINT RootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS BufferLocation)
+{
+    m_stream.RecordSetRootShaderResourceView(RootParameterIndex, BufferLocation);
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::SetComputeRootUnorderedAccessView(UINT RootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS BufferLocation)
+{
+    m_stream.RecordSetComputeRootUnorderedAccessView(RootParameterIndex, BufferLocation);
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::SetGraphicsRootUnorderedAccessView(UINT, D3D12_GPU_VIRTUAL_ADDRESS)
+{
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW *pView)
+{
+    // Unbinding the index buffer is recorded as an empty view.
+    m_stream.RecordSetIndexBuffer(pView ? *pView : D3D12_INDEX_BUFFER_VIEW{});
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::IASetVertexBuffers(UINT StartSlot, UINT NumViews, const D3D12_VERTEX_BUFFER_VIEW *pViews)
+{
+    if (pViews)
+    {
+        m_stream.RecordSetVertexBuffers(StartSlot, NumViews, pViews);
+    }
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::SOSetTargets(UINT, UINT, const D3D12_STREAM_OUTPUT_BUFFER_VIEW *)
+{
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::OMSetRenderTargets(UINT NumRenderTargetDescriptors, const D3D12_CPU_DESCRIPTOR_HANDLE *pRenderTargetDescriptors, BOOL, const D3D12_CPU_DESCRIPTOR_HANDLE *pDepthStencilDescriptor)
+{
+    // The stream holds one render target and the depth stencil, either of which may be empty.
+    m_stream.RecordSetRenderTargets(NumRenderTargetDescriptors ? pRenderTargetDescriptors[0] : D3D12_CPU_DESCRIPTOR_HANDLE{},
+                                    pDepthStencilDescriptor ? *pDepthStencilDescriptor : D3D12_CPU_DESCRIPTOR_HANDLE{});
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::ClearDepthStencilView(D3D12_CPU_DESCRIPTOR_HANDLE DepthStencilView, D3D12_CLEAR_FLAGS, FLOAT, UINT8, UINT, const D3D12_RECT *)
+{
+    m_stream.RecordClearDepthStencil(DepthStencilView);
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::ClearRenderTargetView(D3D12_CPU_DESCRIPTOR_HANDLE RenderTargetView, const FLOAT ColorRGBA[4], UINT, const D3D12_RECT *)
+{
+    m_stream.RecordClearRenderTarget(RenderTargetView, ColorRGBA);
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::ClearUnorderedAccessViewUint(D3D12_GPU_DESCRIPTOR_HANDLE, D3D12_CPU_DESCRIPTOR_HANDLE, ID3D12Resource *, const UINT[4], UINT, const D3D12_RECT *)
+{
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::ClearUnorderedAccessViewFloat(D3D12_GPU_DESCRIPTOR_HANDLE, D3D12_CPU_DESCRIPTOR_HANDLE, ID3D12Resource *, const FLOAT[4], UINT, const D3D12_RECT *)
+{
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::DiscardResource(ID3D12Resource *pResource, const D3D12_DISCARD_REGION *)
+{
+    m_stream.RecordDiscardResource(pResource);
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::BeginQuery(ID3D12QueryHeap *, D3D12_QUERY_TYPE, UINT)
+{
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::EndQuery(ID3D12QueryHeap *, D3D12_QUERY_TYPE, UINT)
+{
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::ResolveQueryData(ID3D12QueryHeap *, D3D12_QUERY_TYPE, UINT, UINT, ID3D12Resource *, UINT64)
+{
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::SetPredication(ID3D12Resource *, UINT64, D3D12_PREDICATION_OP)
+{
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::SetMarker(UINT, const void *, UINT)
+{
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::BeginEvent(UINT, const void *, UINT)
+{
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::EndEvent()
+{
+}
+
+
+void STDMETHODCALLTYPE NullCommandListClass::ExecuteIndirect(ID3D12CommandSignature *pCommandSignature, UINT MaxCommandCount, ID3D12Resource *pArgumentBuffer, UINT64 ArgumentBufferOffset, ID3D12Resource *, UINT64)
+{
+    m_stream.RecordExecuteIndirect(pCommandSignature, MaxCommandCount, pArgumentBuffer, ArgumentBufferOffset);
+}
+
+
+CommandStreamClass * NullCommandListClass::GetCommandStream()
+{
+    return &m_stream;
+}
@@ -0,0 +1,100 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: nullcommandqueueclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "nullcommandqueueclass.h"
+#include "nullcommandlistclass.h"
+
+
+NullCommandQueueClass::NullCommandQueueClass(ID3D12Device *device, const D3D12_COMMAND_QUEUE_DESC &desc)
+    : NullDeviceChildClass(device)
+    , m_desc(desc)
+{
+}
+
+
+void STDMETHODCALLTYPE NullCommandQueueClass::UpdateTileMappings(ID3D12Resource *, UINT, const D3D12_TILED_RESOURCE_COORDINATE *, const D3D12_TILE_REGION_SIZE *, ID3D12Heap *, UINT, const D3D12_TILE_RANGE_FLAGS *, const UINT *, const UINT *, D3D12_TILE_MAPPING_FLAGS)
+{
+}
+
+
+void STDMETHODCALLTYPE NullCommandQueueClass::CopyTileMappings(ID3D12Resource *, const D3D12_TILED_RESOURCE_COORDINATE *, ID3D12Resource *, const D3D12_TILED_RESOURCE_COORDINATE *, const D3D12_TILE_REGION_SIZE *, D3D12_TILE_MAPPING_FLAGS)
+{
+}
+
+
+void STDMETHODCALLTYPE NullCommandQueueClass::ExecuteCommandLists(UINT NumCommandLists, ID3D12CommandList * const *ppCommandLists)
+{
+    // Every list on this queue came from the null device, so it is one of ours.
+    for (UINT i = 0u; i < NumCommandLists; ++i)
+    {
+        const std::array<uint64_t, static_cast<size_t>(CommandStreamClass::CommandType::Count)> counts =
+            static_cast<NullCommandListClass *>(ppCommandLists[i])->GetCommandStream()->GetCommandCounts();
+        for (size_t type = 0; type < counts.size(); ++type)
+        {
+            m_commandCounts[type] += counts[type];
+        }
+    }
+}
+
+
+void STDMETHODCALLTYPE NullCommandQueueClass::SetMarker(UINT, const void *, UINT)
+{
+}
+
+
+void STDMETHODCALLTYPE NullCommandQueueClass::BeginEvent(UINT, const void *, UINT)
+{
+}
+
+
+void STDMETHODCALLTYPE NullCommandQueueClass::EndEvent()
+{
+}
+
+
+HRESULT STDMETHODCALLTYPE NullCommandQueueClass::Signal(ID3D12Fence *pFence, UINT64 Value)
+{
+    // Everything submitted before this is already done.
+    return pFence->Signal(Value);
+}
+
+
+HRESULT STDMETHODCALLTYPE NullCommandQueueClass::Wait(ID3D12Fence *, UINT64)
+{
+    // The work being waited for finished when it was submitted, so there is nothing to wait on.
+    return S_OK;
+}
+
+
+HRESULT STDMETHODCALLTYPE NullCommandQueueClass::GetTimestampFrequency(UINT64 *pFrequency)
+{
+    // Timestamps tick with the performance counter, so they line up with the CPU's.
+    LARGE_INTEGER frequency{};
+    QueryPerformanceFrequency(&frequency);
+    *pFrequency = static_cast<UINT64>(frequency.QuadPart);
+    return S_OK;
+}
+
+
+HRESULT STDMETHODCALLTYPE NullCommandQueueClass::GetClockCalibration(UINT64 *pGpuTimestamp, UINT64 *pCpuTimestamp)
+{
+    // No timestamp is ever written, so resolved ones read as zero, which is where the clock starts.
+    LARGE_INTEGER counter{};
+    QueryPerformanceCounter(&counter);
+    *pGpuTimestamp = 0ull;
+    *pCpuTimestamp = static_cast<UINT64>(counter.QuadPart);
+    return S_OK;
+}
+
+
+D3D12_COMMAND_QUEUE_DESC STDMETHODCALLTYPE NullCommandQueueClass::GetDesc()
+{
+    return m_desc;
+}
+
+
+std::array<uint64_t, static_cast<size_t>(CommandStreamClass::CommandType::Count)> NullCommandQueueClass::GetCommandCounts()
+{
+    return m_commandCounts;
+}
@@ -0,0 +1,48 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: nullcommandqueueclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include "nullobjectclass.h"
+#include "commandstreamclass.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: NullCommandQueueClass
+////////////////////////////////////////////////////////////////////////////////
+// A queue of the null device.  Work is done the moment it is submitted, so fences are signaled
+// straight away, and the commands of every list executed are tallied by type.
+class NullCommandQueueClass : public NullDeviceChildClass<ID3D12CommandQueue>
+{
+public:
+    NullCommandQueueClass() = delete;
+    NullCommandQueueClass(const NullCommandQueueClass &) = delete;
+    NullCommandQueueClass & operator=(const NullCommandQueueClass &) = delete;
+
+    NullCommandQueueClass(ID3D12Device *, const D3D12_COMMAND_QUEUE_DESC &);
+    ~NullCommandQueueClass() = default;
+
+    void STDMETHODCALLTYPE UpdateTileMappings(ID3D12Resource *, UINT, const D3D12_TILED_RESOURCE_COORDINATE *, const D3D12_TILE_REGION_SIZE *, ID3D12Heap *, UINT, const D3D12_TILE_RANGE_FLAGS *, const UINT *, const UINT *, D3D12_TILE_MAPPING_FLAGS) override;
+    void STDMETHODCALLTYPE CopyTileMappings(ID3D12Resource *, const D3D12_TILED_RESOURCE_COORDINATE *, ID3D12Resource *, const D3D12_TILED_RESOURCE_COORDINATE *, const D3D12_TILE_REGION_SIZE *, D3D12_TILE_MAPPING_FLAGS) override;
+    void STDMETHODCALLTYPE ExecuteCommandLists(UINT, ID3D12CommandList * const *) override;
+    void STDMETHODCALLTYPE SetMarker(UINT, const void *, UINT) override;
+    void STDMETHODCALLTYPE BeginEvent(UINT, const void *, UINT) override;
+    void STDMETHODCALLTYPE EndEvent() override;
+    HRESULT STDMETHODCALLTYPE Signal(ID3D12Fence *, UINT64) override;
+    HRESULT STDMETHODCALLTYPE Wait(ID3D12Fence *, UINT64) override;
+    HRESULT STDMETHODCALLTYPE GetTimestampFrequency(UINT64 *) override;
+    HRESULT STDMETHODCALLTYPE GetClockCalibration(UINT64 *, UINT64 *) override;
+    D3D12_COMMAND_QUEUE_DESC STDMETHODCALLTYPE GetDesc() override;
+
+    std::array<uint64_t, static_cast<size_t>(CommandStreamClass::CommandType::Count)> GetCommandCounts();
+
+private:
+    const D3D12_COMMAND_QUEUE_DESC m_desc = {};
+
+    // Lists are only ever executed from one thread at a time, like on any queue.
+    std::array<uint64_t, static_cast<size_t>(CommandStreamClass::CommandType::Count)> m_commandCounts = {};
+};
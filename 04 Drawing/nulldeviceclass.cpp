@@ -0,0 +1,649 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: nulldeviceclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "nulldeviceclass.h"
+
+
+NullDeviceClass::HeapType::HeapType(ID3D12Device *device, const D3D12_HEAP_DESC &desc, D3D12_GPU_VIRTUAL_ADDRESS address)
+    : NullDeviceChildClass(device)
+    , m_desc(desc)
+    , m_address(address)
+{
+    // Upload and readback heaps, and custom heaps the CPU can reach, are the ones that get mapped.
+    // Nothing is ever written back, so readbacks such as resolved timestamps read as zero.
+    const bool cpuVisible = desc.Properties.Type == D3D12_HEAP_TYPE_UPLOAD ||
+                            desc.Properties.Type == D3D12_HEAP_TYPE_READBACK ||
+                            (desc.Properties.Type == D3D12_HEAP_TYPE_CUSTOM && desc.Properties.CPUPageProperty != D3D12_CPU_PAGE_PROPERTY_NOT_AVAILABLE);
+    if (cpuVisible)
+    {
+        m_memory.reset(new BYTE[static_cast<size_t>(desc.SizeInBytes)]());
+    }
+}
+
+
+D3D12_HEAP_DESC STDMETHODCALLTYPE NullDeviceClass::HeapType::GetDesc()
+{
+    return m_desc;
+}
+
+
+BYTE * NullDeviceClass::HeapType::GetMemory()
+{
+    return m_memory.get();
+}
+
+
+D3D12_GPU_VIRTUAL_ADDRESS NullDeviceClass::HeapType::GetGPUVirtualAddress()
+{
+    return m_address;
+}
+
+
+NullDeviceClass::ResourceType::ResourceType(ID3D12Device *device, HeapType *heap, UINT64 offset, const D3D12_RESOURCE_DESC &desc)
+    : NullDeviceChildClass(device)
+    , m_heap(heap)
+    , m_offset(offset)
+    , m_desc(desc)
+{
+}
+
+
+HRESULT STDMETHODCALLTYPE NullDeviceClass::ResourceType::Map(UINT, const D3D12_RANGE *, void **ppData)
+{
+    // Resources in heaps the CPU cannot see have nothing to map.
+    if (!m_heap->GetMemory())
+    {
+        return E_INVALIDARG;
+    }
+    if (ppData)
+    {
+        *ppData = m_heap->GetMemory() + m_offset;
+    }
+    return S_OK;
+}
+
+
+void STDMETHODCALLTYPE NullDeviceClass::ResourceType::Unmap(UINT, const D3D12_RANGE *)
+{
+}
+
+
+D3D12_RESOURCE_DESC STDMETHODCALLTYPE NullDeviceClass::ResourceType::GetDesc()
+{
+    return m_desc;
+}
+
+
+D3D12_GPU_VIRTUAL_ADDRESS STDMETHODCALLTYPE NullDeviceClass::ResourceType::GetGPUVirtualAddress()
+{
+    // Only buffers have an address, which is where they were placed in their heap.
+    if (m_desc.Dimension != D3D12_RESOURCE_DIMENSION_BUFFER)
+    {
+        return 0ull;
+    }
+    return m_heap->GetGPUVirtualAddress() + m_offset;
+}
+
+
+HRESULT STDMETHODCALLTYPE NullDeviceClass::ResourceType::WriteToSubresource(UINT, const D3D12_BOX *, const void *, UINT, UINT)
+{
+    return E_NOTIMPL;
+}
+
+
+HRESULT STDMETHODCALLTYPE NullDeviceClass::ResourceType::ReadFromSubresource(void *, UINT, UINT, UINT, const D3D12_BOX *)
+{
+    return E_NOTIMPL;
+}
+
+
+HRESULT STDMETHODCALLTYPE NullDeviceClass::ResourceType::GetHeapProperties(D3D12_HEAP_PROPERTIES *pHeapProperties, D3D12_HEAP_FLAGS *pHeapFlags)
+{
+    const D3D12_HEAP_DESC heapDesc = m_heap->GetDesc();
+    if (pHeapProperties)
+    {
+        *pHeapProperties = heapDesc.Properties;
+    }
+    if (pHeapFlags)
+    {
+        *pHeapFlags = heapDesc.Flags;
+    }
+    return S_OK;
+}
+
+
+NullDeviceClass::FenceType::FenceType(ID3D12Device *device, UINT64 initialValue)
+    : NullDeviceChildClass(device)
+    , m_completedValue(initialValue)
+{
+}
+
+
+UINT64 STDMETHODCALLTYPE NullDeviceClass::FenceType::GetCompletedValue()
+{
+    return m_completedValue.load();
+}
+
+
+HRESULT STDMETHODCALLTYPE NullDeviceClass::FenceType::SetEventOnCompletion(UINT64 Value, HANDLE hEvent)
+{
+    std::lock_guard<std::mutex> lock(m_eventMutex);
+
+    // A value already reached sets the event straight away.
+    if (m_completedValue.load() >= Value)
+    {
+        if (hEvent)
+        {
+            SetEvent(hEvent);
+        }
+        return S_OK;
+    }
+
+    // Without an event the runtime would block until the value is reached, which only another
+    // thread signaling the fence could end.  Nothing of ours waits that way.
+    if (!hEvent)
+    {
+        return E_NOTIMPL;
+    }
+
+    m_pendingEvents.emplace_back(Value, hEvent);
+    return S_OK;
+}
+
+
+HRESULT STDMETHODCALLTYPE NullDeviceClass::FenceType::Signal(UINT64 Value)
+{
+    std::lock_guard<std::mutex> lock(m_eventMutex);
+    m_completedValue.store(Value);
+
+    // Set and forget every event waiting on a value that has now been reached.
+    for (size_t i = 0; i < m_pendingEvents.size();)
+    {
+        if (m_pendingEvents[i].first <= Value)
+        {
+            SetEvent(m_pendingEvents[i].second);
+            m_pendingEvents[i] = m_pendingEvents.back();
+            m_pendingEvents.pop_back();
+        }
+        else
+        {
+            ++i;
+        }
+    }
+    return S_OK;
+}
+
+
+NullDeviceClass::DescriptorHeapType::DescriptorHeapType(ID3D12Device *device, const D3D12_DESCRIPTOR_HEAP_DESC &desc, SIZE_T start)
+    : NullDeviceChildClass(device)
+    , m_desc(desc)
+    , m_start(start)
+{
+}
+
+
+D3D12_DESCRIPTOR_HEAP_DESC STDMETHODCALLTYPE NullDeviceClass::DescriptorHeapType::GetDesc()
+{
+    return m_desc;
+}
+
+
+D3D12_CPU_DESCRIPTOR_HANDLE STDMETHODCALLTYPE NullDeviceClass::DescriptorHeapType::GetCPUDescriptorHandleForHeapStart()
+{
+    return D3D12_CPU_DESCRIPTOR_HANDLE{ m_start };
+}
+
+
+D3D12_GPU_DESCRIPTOR_HANDLE STDMETHODCALLTYPE NullDeviceClass::DescriptorHeapType::GetGPUDescriptorHandleForHeapStart()
+{
+    // Only heaps the shaders can see have a GPU handle.
+    const bool shaderVisible = (m_desc.Flags & D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE) != 0;
+    return D3D12_GPU_DESCRIPTOR_HANDLE{ shaderVisible ? static_cast<UINT64>(m_start) : 0ull };
+}
+
+
+HRESULT STDMETHODCALLTYPE NullDeviceClass::CommandAllocatorType::Reset()
+{
+    return S_OK;
+}
+
+
+HRESULT STDMETHODCALLTYPE NullDeviceClass::PipelineStateType::GetCachedBlob(ID3DBlob **)
+{
+    // No driver compiled the state, so there is nothing worth caching for the next run.
+    return E_NOTIMPL;
+}
+
+
+HRESULT NullDeviceClass::CreateDevice(REFIID riid, void **ppDevice)
+{
+    return ReturnObject(new NullDeviceClass(), riid, ppDevice);
+}
+
+
+UINT STDMETHODCALLTYPE NullDeviceClass::GetNodeCount()
+{
+    return 1u;
+}
+
+
+HRESULT STDMETHODCALLTYPE NullDeviceClass::CreateCommandQueue(const D3D12_COMMAND_QUEUE_DESC *pDesc, REFIID riid, void **ppCommandQueue)
+{
+    if (!pDesc)
+    {
+        return E_INVALIDARG;
+    }
+    return ReturnObject(new NullCommandQueueClass(this, *pDesc), riid, ppCommandQueue);
+}
+
+
+HRESULT STDMETHODCALLTYPE NullDeviceClass::CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE, REFIID riid, void **ppCommandAllocator)
+{
+    return ReturnObject(new CommandAllocatorType(this), riid, ppCommandAllocator);
+}
+
+
+HRESULT STDMETHODCALLTYPE NullDeviceClass::CreateGraphicsPipelineState(const D3D12_GRAPHICS_PIPELINE_STATE_DESC *pDesc, REFIID riid, void **ppPipelineState)
+{
+    if (!pDesc)
+    {
+        return E_INVALIDARG;
+    }
+    return ReturnObject(new PipelineStateType(this), riid, ppPipelineState);
+}
+
+
+HRESULT STDMETHODCALLTYPE NullDeviceClass::CreateComputePipelineState(const D3D12_COMPUTE_PIPELINE_STATE_DESC *pDesc, REFIID riid, void **ppPipelineState)
+{
+    if (!pDesc)
+    {
+        return E_INVALIDARG;
+    }
+    return ReturnObject(new PipelineStateType(this), riid, ppPipelineState);
+}
+
+
+HRESULT STDMETHODCALLTYPE NullDeviceClass::CreateCommandList(UINT, D3D12_COMMAND_LIST_TYPE type, ID3D12CommandAllocator *pCommandAllocator, ID3D12PipelineState *pInitialState, REFIID riid, void **ppCommandList)
+{
+    if (!pCommandAllocator)
+    {
+        return E_INVALIDARG;
+    }
+    return ReturnObject(new NullCommandListClass(this, type, pInitialState), riid, ppCommandList);
+}
+
+
+HRESULT STDMETHODCALLTYPE NullDeviceClass::CheckFeatureSupport(D3D12_FEATURE, void *, UINT)
+{
+    return E_NOTIMPL;
+}
+
+
+HRESULT STDMETHODCALLTYPE NullDeviceClass::CreateDescriptorHeap(const D3D12_DESCRIPTOR_HEAP_DESC *pDescriptorHeapDesc, REFIID riid, void **ppvHeap)
+{
+    if (!pDescriptorHeapDesc || pDescriptorHeapDesc->NumDescriptors == 0u)
+    {
+        return E_INVALIDARG;
+    }
+
+    const SIZE_T start = m_nextDescriptorAddress.fetch_add(static_cast<SIZE_T>(pDescriptorHeapDesc->NumDescriptors) * DESCRIPTOR_SIZE);
+    return ReturnObject(new DescriptorHeapType(this, *pDescriptorHeapDesc, start), riid, ppvHeap);
+}
+
+
+UINT STDMETHODCALLTYPE NullDeviceClass::GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE)
+{
+    return DESCRIPTOR_SIZE;
+}
+
+
+HRESULT STDMETHODCALLTYPE NullDeviceClass::CreateRootSignature(UINT, const void *pBlobWithRootSignature, SIZE_T blobLengthInBytes, REFIID riid, void **ppvRootSignature)
+{
+    if (!pBlobWithRootSignature || blobLengthInBytes == 0u)
+    {
+        return E_INVALIDARG;
+    }
+    return ReturnObject(new RootSignatureType(this), riid, ppvRootSignature);
+}
+
+
+void STDMETHODCALLTYPE NullDeviceClass::CreateConstantBufferView(const D3D12_CONSTANT_BUFFER_VIEW_DESC *, D3D12_CPU_DESCRIPTOR_HANDLE)
+{
+}
+
+
+void STDMETHODCALLTYPE NullDeviceClass::CreateShaderResourceView(ID3D12Resource *, const D3D12_SHADER_RESOURCE_VIEW_DESC *, D3D12_CPU_DESCRIPTOR_HANDLE)
+{
+}
+
+
+void STDMETHODCALLTYPE NullDeviceClass::CreateUnorderedAccessView(ID3D12Resource *, ID3D12Resource *, const D3D12_UNORDERED_ACCESS_VIEW_DESC *, D3D12_CPU_DESCRIPTOR_HANDLE)
+{
+}
+
+
+void STDMETHODCALLTYPE NullDeviceClass::CreateRenderTargetView(ID3D12Resource *, const D3D12_RENDER_TARGET_VIEW_DESC *, D3D12_CPU_DESCRIPTOR_HANDLE)
+{
+}
+
+
+void STDMETHODCALLTYPE NullDeviceClass::CreateDepthStencilView(ID3D12Resource *, const D3D12_DEPTH_STENCIL_VIEW_DESC *, D3D12_CPU_DESCRIPTOR_HANDLE)
+{
+}
+
+
+void STDMETHODCALLTYPE NullDeviceClass::CreateSampler(const D3D12_SAMPLER_DESC *, D3D12_CPU_DESCRIPTOR_HANDLE)
+{
+}
+
+
+void STDMETHODCALLTYPE NullDeviceClass::CopyDescriptors(UINT, const D3D12_CPU_DESCRIPTOR_HANDLE *, const UINT *, UINT, const D3D12_CPU_DESCRIPTOR_HANDLE *, const UINT *, D3D12_DESCRIPTOR_HEAP_TYPE)
+{
+}
+
+
+void STDMETHODCALLTYPE NullDeviceClass::CopyDescriptorsSimple(UINT, D3D12_CPU_DESCRIPTOR_HANDLE, D3D12_CPU_DESCRIPTOR_HANDLE, D3D12_DESCRIPTOR_HEAP_TYPE)
+{
+}
+
+
+D3D12_RESOURCE_ALLOCATION_INFO STDMETHODCALLTYPE NullDeviceClass::GetResourceAllocationInfo(UINT, UINT numResourceDescs, const D3D12_RESOURCE_DESC *pResourceDescs)
+{
+    // Several resources are laid out one after the other, each on its own alignment.
+    D3D12_RESOURCE_ALLOCATION_INFO total{ 0ull, 1ull };
+    for (UINT i = 0u; i < numResourceDescs; ++i)
+    {
+        const D3D12_RESOURCE_ALLOCATION_INFO info = GetAllocationInfo(pResourceDescs[i]);
+        total.SizeInBytes = (total.SizeInBytes + info.Alignment - 1ull) / info.Alignment * info.Alignment + info.SizeInBytes;
+        total.Alignment   = info.Alignment > total.Alignment ? info.Alignment : total.Alignment;
+    }
+    total.SizeInBytes = (total.SizeInBytes + total.Alignment - 1ull) / total.Alignment * total.Alignment;
+    return total;
+}
+
+
+D3D12_HEAP_PROPERTIES STDMETHODCALLTYPE NullDeviceClass::GetCustomHeapProperties(UINT, D3D12_HEAP_TYPE heapType)
+{
+    // Describe the heap types the way a discrete adapter would.
+    D3D12_HEAP_PROPERTIES properties{};
+    properties.Type                 = D3D12_HEAP_TYPE_CUSTOM;
+    properties.CPUPageProperty      = heapType == D3D12_HEAP_TYPE_UPLOAD ? D3D12_CPU_PAGE_PROPERTY_WRITE_COMBINE :
+                                      heapType == D3D12_HEAP_TYPE_READBACK ? D3D12_CPU_PAGE_PROPERTY_WRITE_BACK : D3D12_CPU_PAGE_PROPERTY_NOT_AVAILABLE;
+    properties.MemoryPoolPreference = heapType == D3D12_HEAP_TYPE_DEFAULT ? D3D12_MEMORY_POOL_L1 : D3D12_MEMORY_POOL_L0;
+    properties.CreationNodeMask     = 1u;
+    properties.VisibleNodeMask      = 1u;
+    return properties;
+}
+
+
+HRESULT STDMETHODCALLTYPE NullDeviceClass::CreateCommittedResource(const D3D12_HEAP_PROPERTIES *pHeapProperties, D3D12_HEAP_FLAGS HeapFlags, const D3D12_RESOURCE_DESC *pDesc, D3D12_RESOURCE_STATES, const D3D12_CLEAR_VALUE *, REFIID riidResource, void **ppvResource)
+{
+    if (!pHeapProperties || !pDesc)
+    {
+        return E_INVALIDARG;
+    }
+
+    // A committed resource is placed at the start of a heap of its own.
+    const D3D12_RESOURCE_ALLOCATION_INFO allocation = GetAllocationInfo(*pDesc);
+
+    D3D12_HEAP_DESC heapDesc{};
+    heapDesc.SizeInBytes = allocation.SizeInBytes;
+    heapDesc.Properties  = *pHeapProperties;
+    heapDesc.Alignment   = allocation.Alignment;
+    heapDesc.Flags       = HeapFlags;
+
+    ComPtr<ID3D12Heap> heap;
+    const HRESULT result = CreateHeap(&heapDesc, IID_PPV_ARGS(heap.GetAddressOf()));
+    if (FAILED(result))
+    {
+        return result;
+    }
+    return ReturnObject(new ResourceType(this, static_cast<HeapType *>(heap.Get()), 0ull, *pDesc), riidResource, ppvResource);
+}
+
+
+HRESULT STDMETHODCALLTYPE NullDeviceClass::CreateHeap(const D3D12_HEAP_DESC *pDesc, REFIID riid, void **ppvHeap)
+{
+    if (!pDesc || pDesc->SizeInBytes == 0ull)
+    {
+        return E_INVALIDARG;
+    }
+
+    // Leave a gap after every heap, so an address just past the end of one is in none.
+    const UINT64 addressBytes = (pDesc->SizeInBytes + D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1ull) / D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT * D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+    const D3D12_GPU_VIRTUAL_ADDRESS address = m_nextHeapAddress.fetch_add(addressBytes + D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+    return ReturnObject(new HeapType(this, *pDesc, address), riid, ppvHeap);
+}
+
+
+HRESULT STDMETHODCALLTYPE NullDeviceClass::CreatePlacedResource(ID3D12Heap *pHeap, UINT64 HeapOffset, const D3D12_RESOURCE_DESC *pDesc, D3D12_RESOURCE_STATES, const D3D12_CLEAR_VALUE *, REFIID riid, void **ppvResource)
+{
+    if (!pHeap || !pDesc)
+    {
+        return E_INVALIDARG;
+    }
+
+    // The resource has to fit in the heap, at an offset its alignment allows.  Every heap on this
+    // device is one of ours.
+    const D3D12_RESOURCE_ALLOCATION_INFO allocation = GetAllocationInfo(*pDesc);
+    const UINT64 heapSize = pHeap->GetDesc().SizeInBytes;
+    if (HeapOffset % allocation.Alignment != 0ull || HeapOffset > heapSize || allocation.SizeInBytes > heapSize - HeapOffset)
+    {
+        return E_INVALIDARG;
+    }
+    return ReturnObject(new ResourceType(this, static_cast<HeapType *>(pHeap), HeapOffset, *pDesc), riid, ppvResource);
+}
+
+
+HRESULT STDMETHODCALLTYPE NullDeviceClass::CreateReservedResource(const D3D12_RESOURCE_DESC *, D3D12_RESOURCE_STATES, const D3D12_CLEAR_VALUE *, REFIID, void **)
+{
+    return E_NOTIMPL;
+}
+
+
+HRESULT STDMETHODCALLTYPE NullDeviceClass::CreateSharedHandle(ID3D12DeviceChild *, const SECURITY_ATTRIBUTES *, DWORD, LPCWSTR, HANDLE *)
+{
+    return E_NOTIMPL;
+}
+
+
+HRESULT STDMETHODCALLTYPE NullDeviceClass::OpenSharedHandle(HANDLE, REFIID, void **)
+{
+    return E_NOTIMPL;
+}
+
+
+HRESULT STDMETHODCALLTYPE NullDeviceClass::OpenSharedHandleByName(LPCWSTR, DWORD, HANDLE *)
+{
+    return E_NOTIMPL;
+}
+
+
+HRESULT STDMETHODCALLTYPE NullDeviceClass::MakeResident(UINT, ID3D12Pageable * const *)
+{
+    return S_OK;
+}
+
+
+HRESULT STDMETHODCALLTYPE NullDeviceClass::Evict(UINT, ID3D12Pageable * const *)
+{
+    return S_OK;
+}
+
+
+HRESULT STDMETHODCALLTYPE NullDeviceClass::CreateFence(UINT64 InitialValue, D3D12_FENCE_FLAGS, REFIID riid, void **ppFence)
+{
+    return ReturnObject(new FenceType(this, InitialValue), riid, ppFence);
+}
+
+
+HRESULT STDMETHODCALLTYPE NullDeviceClass::GetDeviceRemovedReason()
+{
+    return S_OK;
+}
+
+
+void STDMETHODCALLTYPE NullDeviceClass::GetCopyableFootprints(const D3D12_RESOURCE_DESC *pResourceDesc, UINT FirstSubresource, UINT NumSubresources, UINT64 BaseOffset, D3D12_PLACED_SUBRESOURCE_FOOTPRINT *pLayouts, UINT *pNumRows, UINT64 *pRowSizeInBytes, UINT64 *pTotalBytes)
+{
+    // Lay the subresources out the way copies expect them: rows 256 bytes apart, and every
+    // subresource starting on a 512 byte boundary.  A buffer is one row.
+    const bool   buffer    = pResourceDesc->Dimension == D3D12_RESOURCE_DIMENSION_BUFFER;
+    const UINT   mipLevels = pResourceDesc->MipLevels ? pResourceDesc->MipLevels : 1u;
+    const UINT64 texelSize = buffer ? 1ull : GetFormatSize(pResourceDesc->Format);
+
+    UINT64 offset = BaseOffset;
+    UINT64 end    = BaseOffset;
+    for (UINT i = 0u; i < NumSubresources; ++i)
+    {
+        const UINT   mip     = (FirstSubresource + i) % mipLevels;
+        const UINT   width   = static_cast<UINT>((pResourceDesc->Width >> mip) ? (pResourceDesc->Width >> mip) : 1ull);
+        const UINT   height  = (pResourceDesc->Height >> mip) ? (pResourceDesc->Height >> mip) : 1u;
+        const UINT   depth   = pResourceDesc->Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D && (pResourceDesc->DepthOrArraySize >> mip) ? (pResourceDesc->DepthOrArraySize >> mip) : 1u;
+        const UINT64 rowSize = width * texelSize;
+        const UINT64 pitch   = buffer ? rowSize : (rowSize + 255ull) & ~255ull;
+
+        offset = buffer ? offset : (offset + 511ull) & ~511ull;
+        if (pLayouts)
+        {
+            pLayouts[i].Offset             = offset;
+            pLayouts[i].Footprint.Format   = pResourceDesc->Format;
+            pLayouts[i].Footprint.Width    = width;
+            pLayouts[i].Footprint.Height   = height;
+            pLayouts[i].Footprint.Depth    = depth;
+            pLayouts[i].Footprint.RowPitch = static_cast<UINT>(pitch);
+        }
+        if (pNumRows)
+        {
+            pNumRows[i] = height;
+        }
+        if (pRowSizeInBytes)
+        {
+            pRowSizeInBytes[i] = rowSize;
+        }
+
+        // The last row of the last slice needs only its own bytes.
+        end     = offset + pitch * (static_cast<UINT64>(height) * depth - 1ull) + rowSize;
+        offset += pitch * height * depth;
+    }
+
+    if (pTotalBytes)
+    {
+        *pTotalBytes = end - BaseOffset;
+    }
+}
+
+
+HRESULT STDMETHODCALLTYPE NullDeviceClass::CreateQueryHeap(const D3D12_QUERY_HEAP_DESC *pDesc, REFIID riid, void **ppvHeap)
+{
+    if (!pDesc)
+    {
+        return E_INVALIDARG;
+    }
+    return ReturnObject(new QueryHeapType(this), riid, ppvHeap);
+}
+
+
+HRESULT STDMETHODCALLTYPE NullDeviceClass::SetStablePowerState(BOOL)
+{
+    return S_OK;
+}
+
+
+HRESULT STDMETHODCALLTYPE NullDeviceClass::CreateCommandSignature(const D3D12_COMMAND_SIGNATURE_DESC *pDesc, ID3D12RootSignature *, REFIID riid, void **ppvCommandSignature)
+{
+    if (!pDesc)
+    {
+        return E_INVALIDARG;
+    }
+    return ReturnObject(new CommandSignatureType(this), riid, ppvCommandSignature);
+}
+
+
+void STDMETHODCALLTYPE NullDeviceClass::GetResourceTiling(ID3D12Resource *, UINT *pNumTilesForEntireResource, D3D12_PACKED_MIP_INFO *pPackedMipDesc, D3D12_TILE_SHAPE *pStandardTileShapeForNonPackedMips, UINT *pNumSubresourceTilings, UINT, D3D12_SUBRESOURCE_TILING *)
+{
+    // No resource of ours is tiled.
+    if (pNumTilesForEntireResource)
+    {
+        *pNumTilesForEntireResource = 0u;
+    }
+    if (pPackedMipDesc)
+    {
+        *pPackedMipDesc = {};
+    }
+    if (pStandardTileShapeForNonPackedMips)
+    {
+        *pStandardTileShapeForNonPackedMips = {};
+    }
+    if (pNumSubresourceTilings)
+    {
+        *pNumSubresourceTilings = 0u;
+    }
+}
+
+
+LUID STDMETHODCALLTYPE NullDeviceClass::GetAdapterLuid()
+{
+    return LUID{};
+}
+
+
+UINT64 NullDeviceClass::GetFormatSize(DXGI_FORMAT format)
+{
+    // Bytes per texel of the uncompressed formats, which are numbered from the widest down.
+    if (format >= DXGI_FORMAT_R32G32B32A32_TYPELESS && format <= DXGI_FORMAT_R32G32B32A32_SINT)
+    {
+        return 16ull;
+    }
+    if (format >= DXGI_FORMAT_R32G32B32_TYPELESS && format <= DXGI_FORMAT_R32G32B32_SINT)
+    {
+        return 12ull;
+    }
+    if (format >= DXGI_FORMAT_R16G16B16A16_TYPELESS && format <= DXGI_FORMAT_X32_TYPELESS_G8X24_UINT)
+    {
+        return 8ull;
+    }
+    if (format >= DXGI_FORMAT_R8G8_TYPELESS && format <= DXGI_FORMAT_R16_SINT)
+    {
+        return 2ull;
+    }
+    if (format >= DXGI_FORMAT_R8_TYPELESS && format <= DXGI_FORMAT_A8_UNORM)
+    {
+        return 1ull;
+    }
+    return 4ull;
+}
+
+
+D3D12_RESOURCE_ALLOCATION_INFO NullDeviceClass::GetAllocationInfo(const D3D12_RESOURCE_DESC &desc)
+{
+    // Resources go on the default placement alignment unless they ask for another, and
+    // multisampled ones on the larger one they need.
+    D3D12_RESOURCE_ALLOCATION_INFO info{};
+    info.Alignment = desc.Alignment ? desc.Alignment :
+                     desc.SampleDesc.Count > 1u ? D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT : D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+
+    // A texture takes the texels of every level of every slice, for every sample.
+    UINT64 size = desc.Width;
+    if (desc.Dimension != D3D12_RESOURCE_DIMENSION_BUFFER)
+    {
+        const bool volume    = desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D;
+        const UINT mipLevels = desc.MipLevels ? desc.MipLevels : 1u;
+        UINT64     width     = desc.Width;
+        UINT64     height    = desc.Height;
+        UINT64     depth     = volume ? desc.DepthOrArraySize : 1ull;
+
+        size = 0ull;
+        for (UINT mip = 0u; mip < mipLevels; ++mip)
+        {
+            size  += width * height * depth * GetFormatSize(desc.Format);
+            width  = width > 1ull ? width / 2ull : 1ull;
+            height = height > 1ull ? height / 2ull : 1ull;
+            depth  = depth > 1ull ? depth / 2ull : 1ull;
+        }
+        size *= (volume ? 1ull : desc.DepthOrArraySize) * (desc.SampleDesc.Count ? desc.SampleDesc.Count : 1u);
+    }
+
+    info.SizeInBytes = (size + info.Alignment - 1ull) / info.Alignment * info.Alignment;
+    return info;
+}
@@ -0,0 +1,208 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: nulldeviceclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include "nullobjectclass.h"
+#include "nullcommandqueueclass.h"
+#include "nullcommandlistclass.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: NullDeviceClass
+////////////////////////////////////////////////////////////////////////////////
+// A device with no GPU, driver or DXGI behind it.  Its objects keep their descriptions, upload and
+// readback memory is real so the CPU can map it, its queues finish work the moment it is
+// submitted, and its command lists record into command streams instead of executing.  Everything
+// the engine never calls returns E_NOTIMPL.
+class NullDeviceClass : public NullObjectClass<ID3D12Device>
+{
+private:
+    class HeapType : public NullDeviceChildClass<ID3D12Heap>
+    {
+    public:
+        HeapType(ID3D12Device *, const D3D12_HEAP_DESC &, D3D12_GPU_VIRTUAL_ADDRESS);
+
+        D3D12_HEAP_DESC STDMETHODCALLTYPE GetDesc() override;
+
+        BYTE * GetMemory();
+        D3D12_GPU_VIRTUAL_ADDRESS GetGPUVirtualAddress();
+
+    private:
+        const D3D12_HEAP_DESC           m_desc    = {};
+        const D3D12_GPU_VIRTUAL_ADDRESS m_address = 0ull;
+
+        // Only heaps the CPU can see have memory, and it is left uninitialized like the real thing.
+        std::unique_ptr<BYTE[]> m_memory = nullptr;
+    };
+
+    class ResourceType : public NullDeviceChildClass<ID3D12Resource>
+    {
+    public:
+        ResourceType(ID3D12Device *, HeapType *, UINT64, const D3D12_RESOURCE_DESC &);
+
+        HRESULT STDMETHODCALLTYPE Map(UINT, const D3D12_RANGE *, void **) override;
+        void STDMETHODCALLTYPE Unmap(UINT, const D3D12_RANGE *) override;
+        D3D12_RESOURCE_DESC STDMETHODCALLTYPE GetDesc() override;
+        D3D12_GPU_VIRTUAL_ADDRESS STDMETHODCALLTYPE GetGPUVirtualAddress() override;
+        HRESULT STDMETHODCALLTYPE WriteToSubresource(UINT, const D3D12_BOX *, const void *, UINT, UINT) override;
+        HRESULT STDMETHODCALLTYPE ReadFromSubresource(void *, UINT, UINT, UINT, const D3D12_BOX *) override;
+        HRESULT STDMETHODCALLTYPE GetHeapProperties(D3D12_HEAP_PROPERTIES *, D3D12_HEAP_FLAGS *) override;
+
+    private:
+        ComPtr<HeapType>          m_heap   = nullptr;
+        const UINT64              m_offset = 0ull;
+        const D3D12_RESOURCE_DESC m_desc   = {};
+    };
+
+    class FenceType : public NullDeviceChildClass<ID3D12Fence>
+    {
+    public:
+        FenceType(ID3D12Device *, UINT64);
+
+        UINT64 STDMETHODCALLTYPE GetCompletedValue() override;
+        HRESULT STDMETHODCALLTYPE SetEventOnCompletion(UINT64, HANDLE) override;
+        HRESULT STDMETHODCALLTYPE Signal(UINT64) override;
+
+    private:
+        std::atomic<UINT64> m_completedValue = { 0ull };
+
+        // Events waiting on values not reached yet.  Queues signal as soon as they are asked to,
+        // so only a wait on a value nobody has signaled yet ever lands here.
+        std::mutex                             m_eventMutex    = {};
+        std::vector<std::pair<UINT64, HANDLE>> m_pendingEvents = {};
+    };
+
+    class DescriptorHeapType : public NullDeviceChildClass<ID3D12DescriptorHeap>
+    {
+    public:
+        DescriptorHeapType(ID3D12Device *, const D3D12_DESCRIPTOR_HEAP_DESC &, SIZE_T);
+
+        D3D12_DESCRIPTOR_HEAP_DESC STDMETHODCALLTYPE GetDesc() override;
+        D3D12_CPU_DESCRIPTOR_HANDLE STDMETHODCALLTYPE GetCPUDescriptorHandleForHeapStart() override;
+        D3D12_GPU_DESCRIPTOR_HANDLE STDMETHODCALLTYPE GetGPUDescriptorHandleForHeapStart() override;
+
+    private:
+        const D3D12_DESCRIPTOR_HEAP_DESC m_desc  = {};
+        const SIZE_T                     m_start = 0u;
+    };
+
+    class CommandAllocatorType : public NullDeviceChildClass<ID3D12CommandAllocator>
+    {
+    public:
+        using NullDeviceChildClass::NullDeviceChildClass;
+
+        HRESULT STDMETHODCALLTYPE Reset() override;
+    };
+
+    class PipelineStateType : public NullDeviceChildClass<ID3D12PipelineState>
+    {
+    public:
+        using NullDeviceChildClass::NullDeviceChildClass;
+
+        HRESULT STDMETHODCALLTYPE GetCachedBlob(ID3DBlob **) override;
+    };
+
+    class RootSignatureType : public NullDeviceChildClass<ID3D12RootSignature>
+    {
+    public:
+        using NullDeviceChildClass::NullDeviceChildClass;
+    };
+
+    class QueryHeapType : public NullDeviceChildClass<ID3D12QueryHeap>
+    {
+    public:
+        using NullDeviceChildClass::NullDeviceChildClass;
+    };
+
+    class CommandSignatureType : public NullDeviceChildClass<ID3D12CommandSignature>
+    {
+    public:
+        using NullDeviceChildClass::NullDeviceChildClass;
+    };
+
+public:
+    NullDeviceClass(const NullDeviceClass &) = delete;
+    NullDeviceClass & operator=(const NullDeviceClass &) = delete;
+
+    NullDeviceClass() = default;
+    ~NullDeviceClass() = default;
+
+    static HRESULT CreateDevice(REFIID, void **);
+
+    UINT STDMETHODCALLTYPE GetNodeCount() override;
+    HRESULT STDMETHODCALLTYPE CreateCommandQueue(const D3D12_COMMAND_QUEUE_DESC *, REFIID, void **) override;
+    HRESULT STDMETHODCALLTYPE CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE, REFIID, void **) override;
+    HRESULT STDMETHODCALLTYPE CreateGraphicsPipelineState(const D3D12_GRAPHICS_PIPELINE_STATE_DESC *, REFIID, void **) override;
+    HRESULT STDMETHODCALLTYPE CreateComputePipelineState(const D3D12_COMPUTE_PIPELINE_STATE_DESC *, REFIID, void **) override;
+    HRESULT STDMETHODCALLTYPE CreateCommandList(UINT, D3D12_COMMAND_LIST_TYPE, ID3D12CommandAllocator *, ID3D12PipelineState *, REFIID, void **) override;
+    HRESULT STDMETHODCALLTYPE CheckFeatureSupport(D3D12_FEATURE, void *, UINT) override;
+    HRESULT STDMETHODCALLTYPE CreateDescriptorHeap(const D3D12_DESCRIPTOR_HEAP_DESC *, REFIID, void **) override;
+    UINT STDMETHODCALLTYPE GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE) override;
+    HRESULT STDMETHODCALLTYPE CreateRootSignature(UINT, const void *, SIZE_T, REFIID, void **) override;
+    void STDMETHODCALLTYPE CreateConstantBufferView(const D3D12_CONSTANT_BUFFER_VIEW_DESC *, D3D12_CPU_DESCRIPTOR_HANDLE) override;
+    void STDMETHODCALLTYPE CreateShaderResourceView(ID3D12Resource *, const D3D12_SHADER_RESOURCE_VIEW_DESC *, D3D12_CPU_DESCRIPTOR_HANDLE) override;
+    void STDMETHODCALLTYPE CreateUnorderedAccessView(ID3D12Resource *, ID3D12Resource *, const D3D12_UNORDERED_ACCESS_VIEW_DESC *, D3D12_CPU_DESCRIPTOR_HANDLE) override;
+    void STDMETHODCALLTYPE CreateRenderTargetView(ID3D12Resource *, const D3D12_RENDER_TARGET_VIEW_DESC *, D3D12_CPU_DESCRIPTOR_HANDLE) override;
+    void STDMETHODCALLTYPE CreateDepthStencilView(ID3D12Resource *, const D3D12_DEPTH_STENCIL_VIEW_DESC *, D3D12_CPU_DESCRIPTOR_HANDLE) override;
+    void STDMETHODCALLTYPE CreateSampler(const D3D12_SAMPLER_DESC *, D3D12_CPU_DESCRIPTOR_HANDLE) override;
+    void STDMETHODCALLTYPE CopyDescriptors(UINT, const D3D12_CPU_DESCRIPTOR_HANDLE *, const UINT *, UINT, const D3D12_CPU_DESCRIPTOR_HANDLE *, const UINT *, D3D12_DESCRIPTOR_HEAP_TYPE) override;
+    void STDMETHODCALLTYPE CopyDescriptorsSimple(UINT, D3D12_CPU_DESCRIPTOR_HANDLE, D3D12_CPU_DESCRIPTOR_HANDLE, D3D12_DESCRIPTOR_HEAP_TYPE) override;
+    D3D12_RESOURCE_ALLOCATION_INFO STDMETHODCALLTYPE GetResourceAllocationInfo(UINT, UINT, const D3D12_RESOURCE_DESC *) override;
+    D3D12_HEAP_PROPERTIES STDMETHODCALLTYPE GetCustomHeapProperties(UINT, D3D12_HEAP_TYPE) override;
+    HRESULT STDMETHODCALLTYPE CreateCommittedResource(const D3D12_HEAP_PROPERTIES *, D3D12_HEAP_FLAGS, const D3D12_RESOURCE_DESC *, D3D12_RESOURCE_STATES, const D3D12_CLEAR_VALUE *, REFIID, void **) override;
+    HRESULT STDMETHODCALLTYPE CreateHeap(const D3D12_HEAP_DESC *, REFIID, void **) override;
+    HRESULT STDMETHODCALLTYPE CreatePlacedResource(ID3D12Heap *, UINT64, const D3D12_RESOURCE_DESC *, D3D12_RESOURCE_STATES, const D3D12_CLEAR_VALUE *, REFIID, void **) override;
+    HRESULT STDMETHODCALLTYPE CreateReservedResource(const D3D12_RESOURCE_DESC *, D3D12_RESOURCE_STATES, const D3D12_CLEAR_VALUE *, REFIID, void **) override;
+    HRESULT STDMETHODCALLTYPE CreateSharedHandle(ID3D12DeviceChild *, const SECURITY_ATTRIBUTES *, DWORD, LPCWSTR, HANDLE *) override;
+    HRESULT STDMETHODCALLTYPE OpenSharedHandle(HANDLE, REFIID, void **) override;
+    HRESULT STDMETHODCALLTYPE OpenSharedHandleByName(LPCWSTR, DWORD, HANDLE *) override;
+    HRESULT STDMETHODCALLTYPE MakeResident(UINT, ID3D12Pageable * const *) override;
+    HRESULT STDMETHODCALLTYPE Evict(UINT, ID3D12Pageable * const *) override;
+    HRESULT STDMETHODCALLTYPE CreateFence(UINT64, D3D12_FENCE_FLAGS, REFIID, void **) override;
+    HRESULT STDMETHODCALLTYPE GetDeviceRemovedReason() override;
+    void STDMETHODCALLTYPE GetCopyableFootprints(const D3D12_RESOURCE_DESC *, UINT, UINT, UINT64, D3D12_PLACED_SUBRESOURCE_FOOTPRINT *, UINT *, UINT64 *, UINT64 *) override;
+    HRESULT STDMETHODCALLTYPE CreateQueryHeap(const D3D12_QUERY_HEAP_DESC *, REFIID, void **) override;
+    HRESULT STDMETHODCALLTYPE SetStablePowerState(BOOL) override;
+    HRESULT STDMETHODCALLTYPE CreateCommandSignature(const D3D12_COMMAND_SIGNATURE_DESC *, ID3D12RootSignature *, REFIID, void **) override;
+    void STDMETHODCALLTYPE GetResourceTiling(ID3D12Resource *, UINT *, D3D12_PACKED_MIP_INFO *, D3D12_TILE_SHAPE *, UINT *, UINT, D3D12_SUBRESOURCE_TILING *) override;
+    LUID STDMETHODCALLTYPE GetAdapterLuid() override;
+
+private:
+    template<typename ObjectType>
+    static HRESULT ReturnObject(ObjectType *, REFIID, void **);
+
+    static UINT64 GetFormatSize(DXGI_FORMAT);
+    static D3D12_RESOURCE_ALLOCATION_INFO GetAllocationInfo(const D3D12_RESOURCE_DESC &);
+
+private:
+    // Every descriptor is this many bytes apart, whatever its type.
+    static constexpr UINT DESCRIPTOR_SIZE = 32u;
+
+    // Heaps and descriptor heaps are handed addresses from their own ranges, which are never
+    // reused, so an address always names the same object.  Neither starts at zero, which D3D12
+    // keeps for "no address".
+    std::atomic<D3D12_GPU_VIRTUAL_ADDRESS> m_nextHeapAddress       = { 0x1'0000'0000ull };
+    std::atomic<SIZE_T>                    m_nextDescriptorAddress = { 0x1000u };
+};
+
+
+///////////////////////////////
+// INLINE TEMPLATE FUNCTIONS //
+///////////////////////////////
+template<typename ObjectType>
+HRESULT NullDeviceClass::ReturnObject(ObjectType *object, REFIID riid, void **ppvObject)
+{
+    // Like the runtime, a null out pointer only checks that the object could be created.
+    HRESULT result = S_FALSE;
+    if (ppvObject)
+    {
+        result = object->QueryInterface(riid, ppvObject);
+    }
+    object->Release();
+    return result;
+}
@@ -0,0 +1,214 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: nullobjectclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: NullObjectClass
+////////////////////////////////////////////////////////////////////////////////
+// The part every object of the null device shares: reference counting, interface queries along
+// the interface's own inheritance chain, and the private data store of ID3D12Object.
+template<typename Interface>
+class NullObjectClass : public Interface
+{
+public:
+    NullObjectClass(const NullObjectClass &) = delete;
+    NullObjectClass & operator=(const NullObjectClass &) = delete;
+
+    NullObjectClass() = default;
+    virtual ~NullObjectClass() = default;
+
+    HRESULT STDMETHODCALLTYPE QueryInterface(REFIID, void **) override;
+    ULONG STDMETHODCALLTYPE AddRef() override;
+    ULONG STDMETHODCALLTYPE Release() override;
+
+    HRESULT STDMETHODCALLTYPE GetPrivateData(REFGUID, UINT *, void *) override;
+    HRESULT STDMETHODCALLTYPE SetPrivateData(REFGUID, UINT, const void *) override;
+    HRESULT STDMETHODCALLTYPE SetPrivateDataInterface(REFGUID, const IUnknown *) override;
+    HRESULT STDMETHODCALLTYPE SetName(LPCWSTR) override;
+
+private:
+    struct PrivateDataType
+    {
+        GUID              guid = {};
+        std::vector<BYTE> data = {};
+    };
+
+private:
+    std::atomic<ULONG> m_referenceCount = { 1u };
+    std::wstring       m_name           = L"";
+
+    // Objects carry only a handful of entries, so a list is quicker to search than a map.
+    std::mutex                   m_privateDataMutex = {};
+    std::vector<PrivateDataType> m_privateData      = {};
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: NullDeviceChildClass
+////////////////////////////////////////////////////////////////////////////////
+// An object created by the null device, which it keeps alive the way D3D12 objects do.
+template<typename Interface>
+class NullDeviceChildClass : public NullObjectClass<Interface>
+{
+public:
+    NullDeviceChildClass() = delete;
+    NullDeviceChildClass(const NullDeviceChildClass &) = delete;
+    NullDeviceChildClass & operator=(const NullDeviceChildClass &) = delete;
+
+    NullDeviceChildClass(ID3D12Device *);
+    virtual ~NullDeviceChildClass() = default;
+
+    HRESULT STDMETHODCALLTYPE GetDevice(REFIID, void **) override;
+
+private:
+    ComPtr<ID3D12Device> m_device = nullptr;
+};
+
+
+///////////////////////////////
+// INLINE TEMPLATE FUNCTIONS //
+///////////////////////////////
+template<typename Interface>
+HRESULT STDMETHODCALLTYPE NullObjectClass<Interface>::QueryInterface(REFIID riid, void **ppvObject)
+{
+    if (!ppvObject)
+    {
+        return E_POINTER;
+    }
+
+    // Every interface up the chain shares our address, since each one only adds to the last.
+    const bool supported = riid == __uuidof(IUnknown) ||
+                           riid == __uuidof(ID3D12Object) ||
+                           riid == __uuidof(Interface) ||
+                           (std::is_base_of<ID3D12DeviceChild, Interface>::value && riid == __uuidof(ID3D12DeviceChild)) ||
+                           (std::is_base_of<ID3D12Pageable, Interface>::value && riid == __uuidof(ID3D12Pageable)) ||
+                           (std::is_base_of<ID3D12CommandList, Interface>::value && riid == __uuidof(ID3D12CommandList));
+    if (!supported)
+    {
+        *ppvObject = nullptr;
+        return E_NOINTERFACE;
+    }
+
+    AddRef();
+    *ppvObject = static_cast<Interface *>(this);
+    return S_OK;
+}
+
+
+template<typename Interface>
+ULONG STDMETHODCALLTYPE NullObjectClass<Interface>::AddRef()
+{
+    return m_referenceCount.fetch_add(1u) + 1u;
+}
+
+
+template<typename Interface>
+ULONG STDMETHODCALLTYPE NullObjectClass<Interface>::Release()
+{
+    const ULONG count = m_referenceCount.fetch_sub(1u) - 1u;
+    if (count == 0u)
+    {
+        delete this;
+    }
+    return count;
+}
+
+
+template<typename Interface>
+HRESULT STDMETHODCALLTYPE NullObjectClass<Interface>::GetPrivateData(REFGUID guid, UINT *pDataSize, void *pData)
+{
+    if (!pDataSize)
+    {
+        return E_INVALIDARG;
+    }
+
+    std::lock_guard<std::mutex> lock(m_privateDataMutex);
+
+    auto entry = std::find_if(m_privateData.begin(), m_privateData.end(), [&guid](const PrivateDataType &data) { return data.guid == guid; });
+    if (entry == m_privateData.end())
+    {
+        *pDataSize = 0u;
+        return DXGI_ERROR_NOT_FOUND;
+    }
+
+    // Without a buffer, or with one too small, only the size is handed back.
+    const UINT size = static_cast<UINT>(entry->data.size());
+    if (pData && *pDataSize < size)
+    {
+        *pDataSize = size;
+        return DXGI_ERROR_MORE_DATA;
+    }
+    if (pData)
+    {
+        memcpy(pData, entry->data.data(), size);
+    }
+    *pDataSize = size;
+    return S_OK;
+}
+
+
+template<typename Interface>
+HRESULT STDMETHODCALLTYPE NullObjectClass<Interface>::SetPrivateData(REFGUID guid, UINT DataSize, const void *pData)
+{
+    std::lock_guard<std::mutex> lock(m_privateDataMutex);
+
+    // Setting no data removes the entry.
+    auto entry = std::find_if(m_privateData.begin(), m_privateData.end(), [&guid](const PrivateDataType &data) { return data.guid == guid; });
+    if (!pData)
+    {
+        if (entry != m_privateData.end())
+        {
+            m_privateData.erase(entry);
+        }
+        return S_OK;
+    }
+
+    if (entry == m_privateData.end())
+    {
+        m_privateData.emplace_back();
+        entry = m_privateData.end() - 1;
+        entry->guid = guid;
+    }
+    entry->data.assign(reinterpret_cast<const BYTE *>(pData), reinterpret_cast<const BYTE *>(pData) + DataSize);
+    return S_OK;
+}
+
+
+template<typename Interface>
+HRESULT STDMETHODCALLTYPE NullObjectClass<Interface>::SetPrivateDataInterface(REFGUID, const IUnknown *)
+{
+    // Nothing of ours hangs interfaces off an object.
+    return E_NOTIMPL;
+}
+
+
+template<typename Interface>
+HRESULT STDMETHODCALLTYPE NullObjectClass<Interface>::SetName(LPCWSTR Name)
+{
+    m_name = Name ? Name : L"";
+    return S_OK;
+}
+
+
+template<typename Interface>
+NullDeviceChildClass<Interface>::NullDeviceChildClass(ID3D12Device *device)
+    : m_device(device)
+{
+}
+
+
+template<typename Interface>
+HRESULT STDMETHODCALLTYPE NullDeviceChildClass<Interface>::GetDevice(REFIID riid, void **ppvDevice)
+{
+    return m_device->QueryInterface(riid, ppvDevice);
+}
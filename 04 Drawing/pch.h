@@ -15,6 +15,13 @@
 #define DX12_ENABLE_DEBUG_LAYER
 #endif
 
+// Replaces the global allocation functions so the benchmark can count heap allocations per
+// frame.  Every allocation then pays for an atomic add, so only debug builds count by default;
+// define it for a release build to have its benchmark report allocations too.
+#if defined(_DEBUG) && !defined(BENCHMARK_COUNT_ALLOCATIONS)
+#define BENCHMARK_COUNT_ALLOCATIONS
+#endif
+
 
 /////////////
 // LINKING //
@@ -22,6 +29,7 @@
 
 #pragma comment(lib, "d3d12.lib")
 #pragma comment(lib, "dxgi.lib")
+#pragma comment(lib, "shell32.lib")
 
 #ifdef DX12_ENABLE_DEBUG_LAYER
 #pragma comment(lib, "dxguid.lib")
@@ -39,7 +47,7 @@
 // DirectX
 #include <d3d12.h>
 #include <directxmath.h>
-#include <dxgi1_4.h>
+#include <dxgi1_5.h>
 
 #ifdef DX12_ENABLE_DEBUG_LAYER
 #include <dxgidebug.h>
@@ -47,10 +55,16 @@
 
 // C++ Standard Library
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <stdexcept>
+#include <thread>
 #include <vector>
 
 
@@ -58,9 +72,13 @@
 // CONSTANTS //
 ///////////////
 
-// Defines the number of back buffers and other variable length resources.
+// Defines the number of back buffers in the swap chain.
 constexpr uint32_t FRAME_BUFFER_COUNT = 3u;
 
+// The most frames the CPU may record ahead of the GPU.  Per-frame resources are sized for this
+// many, while the engine decides how many of them are actually in flight.
+constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 4u;
+
 // The value of pi divided by 180.  Used to convert degrees to radians.
 constexpr float PI_180 = 0.0174532925f;
 
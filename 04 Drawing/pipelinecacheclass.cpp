@@ -0,0 +1,549 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: pipelinecacheclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "pipelinecacheclass.h"
+
+
+void PipelineCacheClass::HasherType::Add(const void *data, size_t size)
+{
+    const BYTE *bytes = reinterpret_cast<const BYTE *>(data);
+    for (size_t i = 0; i < size; ++i)
+    {
+        value ^= bytes[i];
+        value *= 0x100000001B3ull;
+    }
+}
+
+
+PipelineCacheClass::PipelineCacheClass(const std::wstring &filename)
+    : m_filename(filename)
+{
+    // Pick up whatever the last run left behind; a missing or stale file just means an empty cache.
+    Load();
+}
+
+
+ComPtr<ID3D12RootSignature> PipelineCacheClass::GetRootSignature(ID3D12Device *device, const D3D12_ROOT_SIGNATURE_DESC &desc)
+{
+    // Contexts with the same layout share one root signature.  Otherwise, take the serialized
+    // signature from an earlier run if there is one.
+    const uint64_t hash = Hash(desc);
+
+    std::vector<BYTE> blob;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto found = m_rootSignatures.find(hash);
+        if (found != m_rootSignatures.end())
+        {
+            return found->second;
+        }
+
+        auto cached = m_rootSignatureBlobs.find(hash);
+        if (cached != m_rootSignatureBlobs.end())
+        {
+            blob = cached->second;
+        }
+    }
+
+    // Create the root signature straight from the cached blob, and only serialize the description
+    // if there was none or the device did not accept it.
+    ComPtr<ID3D12RootSignature> rootSignature;
+    HRESULT result = E_FAIL;
+    if (!blob.empty())
+    {
+        result = device->CreateRootSignature(0, blob.data(), blob.size(), IID_PPV_ARGS(rootSignature.ReleaseAndGetAddressOf()));
+    }
+
+    const bool serialize = FAILED(result);
+    if (serialize)
+    {
+        ComPtr<ID3D10Blob> signature;
+        THROW_IF_FAILED(
+            D3D12SerializeRootSignature(
+                &desc,
+                D3D_ROOT_SIGNATURE_VERSION_1,
+                signature.ReleaseAndGetAddressOf(),
+                nullptr),
+            "Unable to serialize the root signature for initialization on the graphics device."
+        );
+
+        THROW_IF_FAILED(
+            device->CreateRootSignature(
+                0,
+                signature->GetBufferPointer(),
+                signature->GetBufferSize(),
+                IID_PPV_ARGS(rootSignature.ReleaseAndGetAddressOf())),
+            "Unable to create the root signature for this pipeline."
+        );
+
+        const BYTE *signatureData = reinterpret_cast<const BYTE *>(signature->GetBufferPointer());
+        blob.assign(signatureData, signatureData + signature->GetBufferSize());
+    }
+
+    // Keep the blob with the root signature, so a captured command stream can create it again.
+    CommandStreamClass::SetRecipe(rootSignature.Get(), blob.data(), blob.size());
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // If another thread created the same root signature in the meantime, settle on theirs.
+    auto inserted = m_rootSignatures.emplace(hash, rootSignature);
+    if (!inserted.second)
+    {
+        return inserted.first->second;
+    }
+
+    if (serialize)
+    {
+        m_rootSignatureBlobs[hash] = std::move(blob);
+        m_dirty                    = true;
+    }
+
+    return rootSignature;
+}
+
+
+ComPtr<ID3D12PipelineState> PipelineCacheClass::GetGraphicsState(ID3D12Device *device, D3D12_GRAPHICS_PIPELINE_STATE_DESC desc)
+{
+    // Reuse a state we already created with the same description and root signature.
+    const uint64_t hash = Hash(desc);
+    const uint64_t key  = GetStateKey(hash, desc.pRootSignature);
+
+    ComPtr<ID3D12PipelineState> state;
+    std::vector<BYTE> blob;
+    if (FindState(key, hash, state, blob))
+    {
+        return state;
+    }
+    desc.CachedPSO.pCachedBlob           = blob.data();
+    desc.CachedPSO.CachedBlobSizeInBytes = blob.size();
+
+    // Let the driver skip compilation if it recognizes the blob from an earlier run.  A blob from
+    // another driver or adapter is rejected, in which case we compile from scratch.
+    HRESULT result = E_FAIL;
+    if (desc.CachedPSO.CachedBlobSizeInBytes)
+    {
+        result = device->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(state.ReleaseAndGetAddressOf()));
+    }
+    if (FAILED(result))
+    {
+        desc.CachedPSO = {};
+        THROW_IF_FAILED(
+            device->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(state.ReleaseAndGetAddressOf())),
+            "The pipeline state object failed to initialize."
+        );
+    }
+    CommandStreamClass::SetRecipe(state.Get(), desc);
+
+    return AddState(hash, key, state);
+}
+
+
+ComPtr<ID3D12PipelineState> PipelineCacheClass::GetComputeState(ID3D12Device *device, D3D12_COMPUTE_PIPELINE_STATE_DESC desc)
+{
+    // Reuse a state we already created with the same description and root signature.
+    const uint64_t hash = Hash(desc);
+    const uint64_t key  = GetStateKey(hash, desc.pRootSignature);
+
+    ComPtr<ID3D12PipelineState> state;
+    std::vector<BYTE> blob;
+    if (FindState(key, hash, state, blob))
+    {
+        return state;
+    }
+    desc.CachedPSO.pCachedBlob           = blob.data();
+    desc.CachedPSO.CachedBlobSizeInBytes = blob.size();
+
+    // Try the blob from an earlier run first, and compile from scratch if the driver rejects it.
+    HRESULT result = E_FAIL;
+    if (desc.CachedPSO.CachedBlobSizeInBytes)
+    {
+        result = device->CreateComputePipelineState(&desc, IID_PPV_ARGS(state.ReleaseAndGetAddressOf()));
+    }
+    if (FAILED(result))
+    {
+        desc.CachedPSO = {};
+        THROW_IF_FAILED(
+            device->CreateComputePipelineState(&desc, IID_PPV_ARGS(state.ReleaseAndGetAddressOf())),
+            "The pipeline state object failed to initialize."
+        );
+    }
+    CommandStreamClass::SetRecipe(state.Get(), desc);
+
+    return AddState(hash, key, state);
+}
+
+
+void PipelineCacheClass::Save()
+{
+    // Only write the file if we compiled something new.
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_dirty)
+        {
+            return;
+        }
+        m_dirty = false;
+    }
+    const std::vector<BYTE> data = Serialize();
+
+    // The cache is only an optimization, so failing to write it is not an error.
+    HANDLE file = CreateFileW(m_filename.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return;
+    }
+
+    DWORD written = 0u;
+    const BOOL result = WriteFile(file, data.data(), static_cast<DWORD>(data.size()), &written, nullptr);
+    CloseHandle(file);
+
+    // Do not leave a truncated cache behind for the next run.
+    if (!result || written != data.size())
+    {
+        DeleteFileW(m_filename.c_str());
+    }
+}
+
+
+uint64_t PipelineCacheClass::Hash(const D3D12_ROOT_SIGNATURE_DESC &desc)
+{
+    HasherType hasher;
+
+    // Only hash the union members that each parameter type actually uses, and hash descriptor
+    // tables by their ranges.
+    hasher.Add(desc.NumParameters);
+    for (UINT i = 0u; i < desc.NumParameters; ++i)
+    {
+        const D3D12_ROOT_PARAMETER &parameter = desc.pParameters[i];
+        hasher.Add(parameter.ParameterType);
+        hasher.Add(parameter.ShaderVisibility);
+
+        switch (parameter.ParameterType)
+        {
+        case D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE:
+            hasher.Add(parameter.DescriptorTable.NumDescriptorRanges);
+            hasher.Add(parameter.DescriptorTable.pDescriptorRanges, parameter.DescriptorTable.NumDescriptorRanges * sizeof(D3D12_DESCRIPTOR_RANGE));
+            break;
+
+        case D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS:
+            hasher.Add(parameter.Constants);
+            break;
+
+        default:
+            hasher.Add(parameter.Descriptor);
+            break;
+        }
+    }
+
+    // The static samplers hold no padding, so they can be hashed whole.
+    hasher.Add(desc.NumStaticSamplers);
+    if (desc.NumStaticSamplers)
+    {
+        hasher.Add(desc.pStaticSamplers, desc.NumStaticSamplers * sizeof(D3D12_STATIC_SAMPLER_DESC));
+    }
+    hasher.Add(desc.Flags);
+
+    return hasher.value;
+}
+
+
+uint64_t PipelineCacheClass::Hash(const D3D12_GRAPHICS_PIPELINE_STATE_DESC &desc)
+{
+    HasherType hasher;
+
+    // Hash the shaders by their bytecode, not where it happens to sit in memory.
+    HashShader(hasher, desc.VS);
+    HashShader(hasher, desc.PS);
+    HashShader(hasher, desc.DS);
+    HashShader(hasher, desc.HS);
+    HashShader(hasher, desc.GS);
+
+    // The blend and depth stencil descriptions contain padding, so hash them member by member.
+    hasher.Add(desc.BlendState.AlphaToCoverageEnable);
+    hasher.Add(desc.BlendState.IndependentBlendEnable);
+    for (const D3D12_RENDER_TARGET_BLEND_DESC &target : desc.BlendState.RenderTarget)
+    {
+        hasher.Add(target.BlendEnable);
+        hasher.Add(target.LogicOpEnable);
+        hasher.Add(target.SrcBlend);
+        hasher.Add(target.DestBlend);
+        hasher.Add(target.BlendOp);
+        hasher.Add(target.SrcBlendAlpha);
+        hasher.Add(target.DestBlendAlpha);
+        hasher.Add(target.BlendOpAlpha);
+        hasher.Add(target.LogicOp);
+        hasher.Add(target.RenderTargetWriteMask);
+    }
+    hasher.Add(desc.SampleMask);
+    hasher.Add(desc.RasterizerState);
+
+    hasher.Add(desc.DepthStencilState.DepthEnable);
+    hasher.Add(desc.DepthStencilState.DepthWriteMask);
+    hasher.Add(desc.DepthStencilState.DepthFunc);
+    hasher.Add(desc.DepthStencilState.StencilEnable);
+    hasher.Add(desc.DepthStencilState.StencilReadMask);
+    hasher.Add(desc.DepthStencilState.StencilWriteMask);
+    hasher.Add(desc.DepthStencilState.FrontFace);
+    hasher.Add(desc.DepthStencilState.BackFace);
+
+    // Hash the input layout by its contents, including the semantic names.
+    hasher.Add(desc.InputLayout.NumElements);
+    for (UINT i = 0u; i < desc.InputLayout.NumElements; ++i)
+    {
+        const D3D12_INPUT_ELEMENT_DESC &element = desc.InputLayout.pInputElementDescs[i];
+        hasher.Add(element.SemanticName, strlen(element.SemanticName));
+        hasher.Add(element.SemanticIndex);
+        hasher.Add(element.Format);
+        hasher.Add(element.InputSlot);
+        hasher.Add(element.AlignedByteOffset);
+        hasher.Add(element.InputSlotClass);
+        hasher.Add(element.InstanceDataStepRate);
+    }
+
+    // Stream output changes what the state writes, so hash its declaration the same way.  Entries
+    // that only skip components have no semantic name.
+    hasher.Add(desc.StreamOutput.NumEntries);
+    for (UINT i = 0u; i < desc.StreamOutput.NumEntries; ++i)
+    {
+        const D3D12_SO_DECLARATION_ENTRY &entry = desc.StreamOutput.pSODeclaration[i];
+        hasher.Add(entry.Stream);
+        if (entry.SemanticName)
+        {
+            hasher.Add(entry.SemanticName, strlen(entry.SemanticName) + 1ull);
+        }
+        hasher.Add(entry.SemanticIndex);
+        hasher.Add(entry.StartComponent);
+        hasher.Add(entry.ComponentCount);
+        hasher.Add(entry.OutputSlot);
+    }
+    hasher.Add(desc.StreamOutput.NumStrides);
+    if (desc.StreamOutput.NumStrides)
+    {
+        hasher.Add(desc.StreamOutput.pBufferStrides, desc.StreamOutput.NumStrides * sizeof(UINT));
+    }
+    hasher.Add(desc.StreamOutput.RasterizedStream);
+
+    // Finish with the output formats and the remaining settings.
+    hasher.Add(desc.IBStripCutValue);
+    hasher.Add(desc.PrimitiveTopologyType);
+    hasher.Add(desc.NumRenderTargets);
+    hasher.Add(desc.RTVFormats);
+    hasher.Add(desc.DSVFormat);
+    hasher.Add(desc.SampleDesc);
+    hasher.Add(desc.NodeMask);
+    hasher.Add(desc.Flags);
+
+    return hasher.value;
+}
+
+
+uint64_t PipelineCacheClass::Hash(const D3D12_COMPUTE_PIPELINE_STATE_DESC &desc)
+{
+    HasherType hasher;
+    HashShader(hasher, desc.CS);
+    hasher.Add(desc.NodeMask);
+    hasher.Add(desc.Flags);
+    return hasher.value;
+}
+
+
+std::vector<BYTE> PipelineCacheClass::Serialize()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const std::pair<KindType, const BlobMapType *> kinds[] =
+    {
+        { KindType::RootSignature, &m_rootSignatureBlobs },
+        { KindType::PipelineState, &m_stateBlobs         },
+    };
+
+    // Work out how big the file will be, so it is written out in one go.
+    size_t size = sizeof(FileHeaderType);
+    for (const auto &kind : kinds)
+    {
+        for (const auto &blob : *kind.second)
+        {
+            size += sizeof(EntryHeaderType) + blob.second.size();
+        }
+    }
+
+    std::vector<BYTE> data;
+    data.reserve(size);
+
+    // The file header, followed by every blob behind a header of its own that says what it is.
+    FileHeaderType header;
+    header.magic      = CACHE_MAGIC;
+    header.version    = CACHE_VERSION;
+    header.entryCount = m_rootSignatureBlobs.size() + m_stateBlobs.size();
+    data.insert(data.end(), reinterpret_cast<const BYTE *>(&header), reinterpret_cast<const BYTE *>(&header + 1));
+
+    for (const auto &kind : kinds)
+    {
+        for (const auto &blob : *kind.second)
+        {
+            EntryHeaderType entry;
+            entry.hash = blob.first;
+            entry.size = blob.second.size();
+            entry.kind = kind.first;
+            data.insert(data.end(), reinterpret_cast<const BYTE *>(&entry), reinterpret_cast<const BYTE *>(&entry + 1));
+            data.insert(data.end(), blob.second.begin(), blob.second.end());
+        }
+    }
+
+    return data;
+}
+
+
+bool PipelineCacheClass::Deserialize(const BYTE *data, size_t size)
+{
+    // Check that this is a cache file in the layout we write.
+    FileHeaderType header;
+    if (size < sizeof(FileHeaderType))
+    {
+        return false;
+    }
+    memcpy(&header, data, sizeof(FileHeaderType));
+    if (header.magic != CACHE_MAGIC || header.version != CACHE_VERSION)
+    {
+        return false;
+    }
+
+    // Read every entry, making sure none of them run past the end of the file.
+    BlobMapType rootSignatureBlobs;
+    BlobMapType stateBlobs;
+    size_t offset = sizeof(FileHeaderType);
+    for (uint64_t i = 0ull; i < header.entryCount; ++i)
+    {
+        EntryHeaderType entry;
+        if (size - offset < sizeof(EntryHeaderType))
+        {
+            return false;
+        }
+        memcpy(&entry, data + offset, sizeof(EntryHeaderType));
+        offset += sizeof(EntryHeaderType);
+
+        if (size - offset < entry.size)
+        {
+            return false;
+        }
+        if (entry.kind != KindType::RootSignature && entry.kind != KindType::PipelineState)
+        {
+            return false;
+        }
+
+        BlobMapType &blobs = entry.kind == KindType::RootSignature ? rootSignatureBlobs : stateBlobs;
+        blobs[entry.hash].assign(data + offset, data + offset + entry.size);
+        offset += static_cast<size_t>(entry.size);
+    }
+
+    // Only replace our blobs once the whole file has checked out.
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_rootSignatureBlobs = std::move(rootSignatureBlobs);
+    m_stateBlobs         = std::move(stateBlobs);
+    return true;
+}
+
+
+void PipelineCacheClass::Load()
+{
+    HANDLE file = CreateFileW(m_filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return;
+    }
+
+    // Read the whole file, then let Deserialize check it.
+    LARGE_INTEGER fileSize{};
+    std::vector<BYTE> data;
+    DWORD read = 0u;
+    BOOL result = GetFileSizeEx(file, &fileSize) && fileSize.QuadPart < MAXDWORD;
+    if (result)
+    {
+        data.resize(static_cast<size_t>(fileSize.QuadPart));
+        result = ReadFile(file, data.data(), static_cast<DWORD>(data.size()), &read, nullptr);
+    }
+    CloseHandle(file);
+
+    // A file we cannot read or do not understand is simply ignored, and replaced on the next save.
+    if (!result || read != data.size() || !Deserialize(data.data(), data.size()))
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_rootSignatureBlobs.clear();
+        m_stateBlobs.clear();
+        m_dirty = true;
+    }
+}
+
+
+bool PipelineCacheClass::FindState(uint64_t key, uint64_t hash, ComPtr<ID3D12PipelineState> &state, std::vector<BYTE> &blob)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Hand out the state itself if it was already created this run.
+    auto found = m_states.find(key);
+    if (found != m_states.end())
+    {
+        state = found->second;
+        return true;
+    }
+
+    // Otherwise copy out the blob from an earlier run, if there is one, since another thread may
+    // replace it while we compile.
+    auto cached = m_stateBlobs.find(hash);
+    if (cached != m_stateBlobs.end())
+    {
+        blob = cached->second;
+    }
+    return false;
+}
+
+
+ComPtr<ID3D12PipelineState> PipelineCacheClass::AddState(uint64_t hash, uint64_t key, ComPtr<ID3D12PipelineState> state)
+{
+    // Keep the driver's blob for the next run.
+    ComPtr<ID3DBlob> blob;
+    const bool hasBlob = SUCCEEDED(state->GetCachedBlob(blob.GetAddressOf()));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // If another thread created the same state in the meantime, settle on theirs.
+    auto inserted = m_states.emplace(key, state);
+    if (!inserted.second)
+    {
+        return inserted.first->second;
+    }
+
+    if (hasBlob)
+    {
+        const BYTE *blobData = reinterpret_cast<const BYTE *>(blob->GetBufferPointer());
+        std::vector<BYTE> &stored = m_stateBlobs[hash];
+        if (stored.size() != blob->GetBufferSize() || memcmp(stored.data(), blobData, stored.size()) != 0)
+        {
+            stored.assign(blobData, blobData + blob->GetBufferSize());
+            m_dirty = true;
+        }
+    }
+
+    return state;
+}
+
+
+uint64_t PipelineCacheClass::GetStateKey(uint64_t hash, ID3D12RootSignature *rootSignature)
+{
+    // States are only interchangeable if they were created with the same root signature.
+    HasherType hasher;
+    hasher.value = hash;
+    hasher.Add(rootSignature);
+    return hasher.value;
+}
+
+
+void PipelineCacheClass::HashShader(HasherType &hasher, const D3D12_SHADER_BYTECODE &shader)
+{
+    hasher.Add(shader.BytecodeLength);
+    if (shader.pShaderBytecode)
+    {
+        hasher.Add(shader.pShaderBytecode, shader.BytecodeLength);
+    }
+}
@@ -0,0 +1,112 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: pipelinecacheclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <unordered_map>
+#include "commandstreamclass.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: PipelineCacheClass
+////////////////////////////////////////////////////////////////////////////////
+class PipelineCacheClass
+{
+private:
+    // Root signature and pipeline state blobs are hashed from different descriptions, so they
+    // are kept apart in case two of those hashes ever meet.
+    enum class KindType : uint32_t
+    {
+        RootSignature,
+        PipelineState
+    };
+
+    struct FileHeaderType
+    {
+        uint32_t magic      = 0u;
+        uint32_t version    = 0u;
+        uint64_t entryCount = 0ull;
+    };
+
+    struct EntryHeaderType
+    {
+        uint64_t hash    = 0ull;
+        uint64_t size    = 0ull;
+        KindType kind    = KindType::RootSignature;
+        uint32_t padding = 0u;
+    };
+
+    using BlobMapType = std::unordered_map<uint64_t, std::vector<BYTE>>;
+
+    // Folds bytes into a 64-bit FNV-1a hash.
+    struct HasherType
+    {
+        uint64_t value = 0xCBF29CE484222325ull;
+
+        void Add(const void *, size_t);
+        template<typename Type>
+        void Add(const Type &);
+    };
+
+public:
+    PipelineCacheClass() = delete;
+    PipelineCacheClass(const PipelineCacheClass &) = delete;
+    PipelineCacheClass & operator=(const PipelineCacheClass &) = delete;
+
+    PipelineCacheClass(const std::wstring &);
+    ~PipelineCacheClass() = default;
+
+    ComPtr<ID3D12RootSignature> GetRootSignature(ID3D12Device *, const D3D12_ROOT_SIGNATURE_DESC &);
+    ComPtr<ID3D12PipelineState> GetGraphicsState(ID3D12Device *, D3D12_GRAPHICS_PIPELINE_STATE_DESC);
+    ComPtr<ID3D12PipelineState> GetComputeState(ID3D12Device *, D3D12_COMPUTE_PIPELINE_STATE_DESC);
+
+    void Save();
+
+    static uint64_t Hash(const D3D12_ROOT_SIGNATURE_DESC &);
+    static uint64_t Hash(const D3D12_GRAPHICS_PIPELINE_STATE_DESC &);
+    static uint64_t Hash(const D3D12_COMPUTE_PIPELINE_STATE_DESC &);
+
+    std::vector<BYTE> Serialize();
+    bool Deserialize(const BYTE *, size_t);
+
+private:
+    void Load();
+
+    bool FindState(uint64_t, uint64_t, ComPtr<ID3D12PipelineState> &, std::vector<BYTE> &);
+    ComPtr<ID3D12PipelineState> AddState(uint64_t, uint64_t, ComPtr<ID3D12PipelineState>);
+
+    static uint64_t GetStateKey(uint64_t, ID3D12RootSignature *);
+    static void HashShader(HasherType &, const D3D12_SHADER_BYTECODE &);
+
+private:
+    // Identifies the file as a pipeline cache, and which layout and hash it was written with.
+    static constexpr uint32_t CACHE_MAGIC   = 0x434F5350u; // "PSOC"
+    static constexpr uint32_t CACHE_VERSION = 2u;
+
+    const std::wstring m_filename = L"";
+
+    std::mutex m_mutex = {};
+    bool       m_dirty = false;
+
+    // Serialized root signatures and driver blobs by description hash, as loaded from and saved to
+    // disk.  The root signatures created this run by description hash, and the states created this
+    // run by description hash and root signature.
+    BlobMapType                                               m_rootSignatureBlobs = {};
+    BlobMapType                                               m_stateBlobs         = {};
+    std::unordered_map<uint64_t, ComPtr<ID3D12RootSignature>> m_rootSignatures     = {};
+    std::unordered_map<uint64_t, ComPtr<ID3D12PipelineState>> m_states             = {};
+};
+
+
+///////////////////////////////
+// INLINE TEMPLATE FUNCTIONS //
+///////////////////////////////
+template<typename Type>
+void PipelineCacheClass::HasherType::Add(const Type &value)
+{
+    Add(&value, sizeof(Type));
+}
@@ -1,94 +1,480 @@
-////////////////////////////////////////////////////////////////////////////////
-// Filename: pipelineclass.h
-////////////////////////////////////////////////////////////////////////////////
-#include "pch.h"
-#include "pipelineclass.h"
-
-
-PipelineClass::PipelineClass(ID3D12Device *device, const UINT &frameIndex, D3D12_COMMAND_LIST_TYPE type)
-    : r_frameIndex(frameIndex)
-{
-    // Create command allocators, one for each frame.
-    for (uint32_t i = 0; i < FRAME_BUFFER_COUNT; ++i)
-    {
-        THROW_IF_FAILED(
-            device->CreateCommandAllocator(
-                type,
-                IID_PPV_ARGS(m_commandAllocators[i].ReleaseAndGetAddressOf())),
-            "Unable to create the command allocator object."
-        );
-    }
-
-    // Create a command list.  We use the first command allocator, since allocators get reset before use.
-    THROW_IF_FAILED(
-        device->CreateCommandList(
-            0,
-            type,
-            m_commandAllocators[0].Get(),
-            nullptr,
-            IID_PPV_ARGS(m_commandList.ReleaseAndGetAddressOf())),
-        "Unable to create the command list object."
-    );
-
-    // Initially we need to close the command list during initialization as it is created in a recording state.
-    Close();
-
-    NameD3DResources();
-}
-
-
-ID3D12GraphicsCommandList * PipelineClass::GetCommandList()
-{
-    return m_commandList.Get();
-}
-
-
-void PipelineClass::Open()
-{
-    // Reset the memory that was holding the previously submitted command list.
-    THROW_IF_FAILED(
-        m_commandAllocators[r_frameIndex]->Reset(),
-        "Unable to reset command allocator.  Its associated memory may still be in use."
-    );
-
-    // Reset our command list to prepare it for new commands.
-    THROW_IF_FAILED(
-        m_commandList->Reset(m_commandAllocators[r_frameIndex].Get(), nullptr),
-        "Unable to reset command list.  It may not have been closed or submitted properly."
-    );
-}
-
-
-void PipelineClass::Close()
-{
-    // Close the command list so it can be submitted to a command queue.
-    THROW_IF_FAILED(
-        m_commandList->Close(),
-        "Unable to close command list.  It may not have been reset properly."
-    );
-}
-
-
-void PipelineClass::AddBarrier(const D3D12_RESOURCE_BARRIER barrier)
-{
-    // Only need to add the barrier.
-    m_commandList->ResourceBarrier(1, &barrier);
-}
-
-
-void PipelineClass::SetState(ID3D12PipelineState* state)
-{
-    m_commandList->SetPipelineState(state);
-}
-
-
-void PipelineClass::NameD3DResources()
-{
-    // Name all DirectX objects.
-    m_commandList->SetName(L"PC command list");
-    for (UINT i = 0; i < FRAME_BUFFER_COUNT; ++i)
-    {
-        std::wstring name = L"PC command list " + std::to_wstring(i);
-        m_commandAllocators[i]->SetName(name.c_str());
-    }
-}
+////////////////////////////////////////////////////////////////////////////////
+// Filename: pipelineclass.h
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "pipelineclass.h"
+
+
+PipelineClass::PipelineClass(ID3D12Device *device, const UINT &frameIndex, const ResourceStateTrackerClass *resourceStates, D3D12_COMMAND_LIST_TYPE type)
+    : r_frameIndex(frameIndex)
+    , m_ResourceStates(std::make_unique<ResourceStateTrackerClass>(resourceStates))
+{
+    // Create command allocators, one for each frame.
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+    {
+        THROW_IF_FAILED(
+            device->CreateCommandAllocator(
+                type,
+                IID_PPV_ARGS(m_commandAllocators[i].ReleaseAndGetAddressOf())),
+            "Unable to create the command allocator object."
+        );
+    }
+
+    // Create a command list.  We use the first command allocator, since allocators get reset before use.
+    THROW_IF_FAILED(
+        device->CreateCommandList(
+            0,
+            type,
+            m_commandAllocators[0].Get(),
+            nullptr,
+            IID_PPV_ARGS(m_commandList.ReleaseAndGetAddressOf())),
+        "Unable to create the command list object."
+    );
+
+    // Initially we need to close the command list during initialization as it is created in a recording state.
+    Close();
+
+    NameD3DResources();
+}
+
+
+ID3D12GraphicsCommandList * PipelineClass::GetCommandList()
+{
+    return m_commandList.Get();
+}
+
+
+ResourceStateTrackerClass * PipelineClass::GetResourceStates()
+{
+    return m_ResourceStates.get();
+}
+
+
+UINT PipelineClass::GetBindCount()
+{
+    return m_bindCount;
+}
+
+
+UINT PipelineClass::GetElidedCount()
+{
+    return m_elidedCount;
+}
+
+
+void PipelineClass::Open()
+{
+    // Reset the memory that was holding the previously submitted command list.
+    THROW_IF_FAILED(
+        m_commandAllocators[r_frameIndex]->Reset(),
+        "Unable to reset command allocator.  Its associated memory may still be in use."
+    );
+
+    // Reset our command list to prepare it for new commands.
+    THROW_IF_FAILED(
+        m_commandList->Reset(m_commandAllocators[r_frameIndex].Get(), nullptr),
+        "Unable to reset command list.  It may not have been closed or submitted properly."
+    );
+
+    // A reset list starts out with nothing bound.
+    p_state                = nullptr;
+    p_rootSignature        = nullptr;
+    p_computeRootSignature = nullptr;
+    m_indexBufferView      = {};
+    m_topology             = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
+    m_bindCount            = 0u;
+    m_elidedCount          = 0u;
+    m_vertexBufferViews.fill({});
+
+    // Every resource starts out where the lists submitted before this one leave it.
+    m_ResourceStates->Reset();
+}
+
+
+void PipelineClass::Close()
+{
+    // Send out the barriers still waiting, ending any split barrier the list began.
+    m_ResourceStates->EndTransitions();
+    FlushBarriers();
+
+    // Close the command list so it can be submitted to a command queue.
+    THROW_IF_FAILED(
+        m_commandList->Close(),
+        "Unable to close command list.  It may not have been reset properly."
+    );
+}
+
+
+void PipelineClass::StartRecording(CommandStreamClass *recorder)
+{
+    // Every command we forward to the command list from now on is also appended to this stream.
+    m_recorder = recorder;
+}
+
+
+void PipelineClass::StopRecording()
+{
+    m_recorder = nullptr;
+}
+
+
+void PipelineClass::Transition(ID3D12Resource *resource, D3D12_RESOURCE_STATES state, UINT subresource)
+{
+    // The barrier is only queued, and goes out with the rest of the batch before the next command
+    // that reads or writes a resource.
+    m_ResourceStates->Transition(resource, state, subresource);
+}
+
+
+void PipelineClass::BeginTransition(ID3D12Resource *resource, D3D12_RESOURCE_STATES state, UINT subresource)
+{
+    m_ResourceStates->BeginTransition(resource, state, subresource);
+}
+
+
+void PipelineClass::AddUavBarrier(ID3D12Resource *resource)
+{
+    m_ResourceStates->AddUavBarrier(resource);
+}
+
+
+void PipelineClass::AddAliasingBarrier(ID3D12Resource *before, ID3D12Resource *after)
+{
+    m_ResourceStates->AddAliasingBarrier(before, after);
+}
+
+
+void PipelineClass::FlushBarriers()
+{
+    // Issue every queued barrier with a single call.
+    const UINT count = m_ResourceStates->GetBarrierCount();
+    if (count == 0u)
+    {
+        return;
+    }
+
+    m_commandList->ResourceBarrier(count, m_ResourceStates->GetBarriers());
+
+    if (m_recorder)
+    {
+        m_recorder->RecordResourceBarrier(count, m_ResourceStates->GetBarriers());
+    }
+
+    m_ResourceStates->ClearBarriers();
+}
+
+
+void PipelineClass::SetState(ID3D12PipelineState* state)
+{
+    if (state == p_state)
+    {
+        ++m_elidedCount;
+        return;
+    }
+    p_state = state;
+    ++m_bindCount;
+
+    m_commandList->SetPipelineState(state);
+
+    if (m_recorder)
+    {
+        m_recorder->RecordSetPipelineState(state);
+    }
+}
+
+
+void PipelineClass::SetRootSignature(ID3D12RootSignature *rootSignature)
+{
+    // Contexts that share a root signature do not need to bind it again, which also keeps the
+    // root arguments set so far from being invalidated.
+    if (rootSignature == p_rootSignature)
+    {
+        ++m_elidedCount;
+        return;
+    }
+    p_rootSignature = rootSignature;
+    ++m_bindCount;
+
+    m_commandList->SetGraphicsRootSignature(rootSignature);
+
+    if (m_recorder)
+    {
+        m_recorder->RecordSetRootSignature(rootSignature);
+    }
+}
+
+
+void PipelineClass::SetRootConstantBufferView(UINT index, D3D12_GPU_VIRTUAL_ADDRESS address)
+{
+    m_commandList->SetGraphicsRootConstantBufferView(index, address);
+
+    if (m_recorder)
+    {
+        m_recorder->RecordSetRootConstantBufferView(index, address);
+    }
+}
+
+
+void PipelineClass::SetRootShaderResourceView(UINT index, D3D12_GPU_VIRTUAL_ADDRESS address)
+{
+    m_commandList->SetGraphicsRootShaderResourceView(index, address);
+
+    if (m_recorder)
+    {
+        m_recorder->RecordSetRootShaderResourceView(index, address);
+    }
+}
+
+
+void PipelineClass::SetRoot32BitConstant(UINT index, UINT value, UINT offset)
+{
+    m_commandList->SetGraphicsRoot32BitConstant(index, value, offset);
+
+    if (m_recorder)
+    {
+        m_recorder->RecordSetRoot32BitConstant(index, value, offset);
+    }
+}
+
+
+void PipelineClass::SetViewport(const D3D12_VIEWPORT &viewport, const D3D12_RECT &scissorRect)
+{
+    m_commandList->RSSetViewports(1, &viewport);
+    m_commandList->RSSetScissorRects(1, &scissorRect);
+
+    if (m_recorder)
+    {
+        m_recorder->RecordSetViewport(viewport, scissorRect);
+    }
+}
+
+
+void PipelineClass::SetRenderTargets(D3D12_CPU_DESCRIPTOR_HANDLE renderTarget, D3D12_CPU_DESCRIPTOR_HANDLE depthStencil)
+{
+    m_commandList->OMSetRenderTargets(1, &renderTarget, FALSE, &depthStencil);
+
+    if (m_recorder)
+    {
+        m_recorder->RecordSetRenderTargets(renderTarget, depthStencil);
+    }
+}
+
+
+void PipelineClass::ClearRenderTarget(D3D12_CPU_DESCRIPTOR_HANDLE renderTarget, const float *color)
+{
+    FlushBarriers();
+    m_commandList->ClearRenderTargetView(renderTarget, color, 0u, nullptr);
+
+    if (m_recorder)
+    {
+        m_recorder->RecordClearRenderTarget(renderTarget, color);
+    }
+}
+
+
+void PipelineClass::ClearDepthStencil(D3D12_CPU_DESCRIPTOR_HANDLE depthStencil)
+{
+    FlushBarriers();
+    m_commandList->ClearDepthStencilView(depthStencil, D3D12_CLEAR_FLAG_DEPTH, 1.0f, 0u, 0u, nullptr);
+
+    if (m_recorder)
+    {
+        m_recorder->RecordClearDepthStencil(depthStencil);
+    }
+}
+
+
+void PipelineClass::DiscardResource(ID3D12Resource *resource)
+{
+    FlushBarriers();
+    m_commandList->DiscardResource(resource, nullptr);
+
+    if (m_recorder)
+    {
+        m_recorder->RecordDiscardResource(resource);
+    }
+}
+
+
+void PipelineClass::SetVertexBuffers(UINT startSlot, UINT count, const D3D12_VERTEX_BUFFER_VIEW *views)
+{
+    // Geometry sharing its buffers with the previous draw does not need to bind them again.
+    if (memcmp(&m_vertexBufferViews[startSlot], views, count * sizeof(D3D12_VERTEX_BUFFER_VIEW)) == 0)
+    {
+        ++m_elidedCount;
+        return;
+    }
+    memcpy(&m_vertexBufferViews[startSlot], views, count * sizeof(D3D12_VERTEX_BUFFER_VIEW));
+    ++m_bindCount;
+
+    m_commandList->IASetVertexBuffers(startSlot, count, views);
+
+    if (m_recorder)
+    {
+        m_recorder->RecordSetVertexBuffers(startSlot, count, views);
+    }
+}
+
+
+void PipelineClass::SetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW &view)
+{
+    if (memcmp(&m_indexBufferView, &view, sizeof(D3D12_INDEX_BUFFER_VIEW)) == 0)
+    {
+        ++m_elidedCount;
+        return;
+    }
+    m_indexBufferView = view;
+    ++m_bindCount;
+
+    m_commandList->IASetIndexBuffer(&view);
+
+    if (m_recorder)
+    {
+        m_recorder->RecordSetIndexBuffer(view);
+    }
+}
+
+
+void PipelineClass::SetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY topology)
+{
+    if (topology == m_topology)
+    {
+        ++m_elidedCount;
+        return;
+    }
+    m_topology = topology;
+    ++m_bindCount;
+
+    m_commandList->IASetPrimitiveTopology(topology);
+
+    if (m_recorder)
+    {
+        m_recorder->RecordSetPrimitiveTopology(topology);
+    }
+}
+
+
+void PipelineClass::DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, INT baseVertex, UINT startInstance)
+{
+    FlushBarriers();
+    m_commandList->DrawIndexedInstanced(indexCount, instanceCount, startIndex, baseVertex, startInstance);
+
+    if (m_recorder)
+    {
+        m_recorder->RecordDrawIndexedInstanced(indexCount, instanceCount, startIndex, baseVertex, startInstance);
+    }
+}
+
+
+void PipelineClass::SetComputeRootSignature(ID3D12RootSignature *rootSignature)
+{
+    if (rootSignature == p_computeRootSignature)
+    {
+        ++m_elidedCount;
+        return;
+    }
+    p_computeRootSignature = rootSignature;
+    ++m_bindCount;
+
+    m_commandList->SetComputeRootSignature(rootSignature);
+
+    if (m_recorder)
+    {
+        m_recorder->RecordSetComputeRootSignature(rootSignature);
+    }
+}
+
+
+void PipelineClass::SetComputeRootConstantBufferView(UINT index, D3D12_GPU_VIRTUAL_ADDRESS address)
+{
+    m_commandList->SetComputeRootConstantBufferView(index, address);
+
+    if (m_recorder)
+    {
+        m_recorder->RecordSetComputeRootConstantBufferView(index, address);
+    }
+}
+
+
+void PipelineClass::SetComputeRootShaderResourceView(UINT index, D3D12_GPU_VIRTUAL_ADDRESS address)
+{
+    m_commandList->SetComputeRootShaderResourceView(index, address);
+
+    if (m_recorder)
+    {
+        m_recorder->RecordSetComputeRootShaderResourceView(index, address);
+    }
+}
+
+
+void PipelineClass::SetComputeRootUnorderedAccessView(UINT index, D3D12_GPU_VIRTUAL_ADDRESS address)
+{
+    m_commandList->SetComputeRootUnorderedAccessView(index, address);
+
+    if (m_recorder)
+    {
+        m_recorder->RecordSetComputeRootUnorderedAccessView(index, address);
+    }
+}
+
+
+void PipelineClass::Dispatch(UINT x, UINT y, UINT z)
+{
+    FlushBarriers();
+    m_commandList->Dispatch(x, y, z);
+
+    if (m_recorder)
+    {
+        m_recorder->RecordDispatch(x, y, z);
+    }
+}
+
+
+void PipelineClass::CopyBufferRegion(ID3D12Resource *destination, UINT64 destinationOffset, ID3D12Resource *source, UINT64 sourceOffset, UINT64 size)
+{
+    FlushBarriers();
+    m_commandList->CopyBufferRegion(destination, destinationOffset, source, sourceOffset, size);
+
+    if (m_recorder)
+    {
+        m_recorder->RecordCopyBufferRegion(destination, destinationOffset, source, sourceOffset, size);
+    }
+}
+
+
+void PipelineClass::ExecuteIndirect(ID3D12CommandSignature *signature, UINT maxCount, ID3D12Resource *argumentBuffer, UINT64 argumentOffset)
+{
+    FlushBarriers();
+    m_commandList->ExecuteIndirect(signature, maxCount, argumentBuffer, argumentOffset, nullptr, 0ull);
+
+    if (m_recorder)
+    {
+        m_recorder->RecordExecuteIndirect(signature, maxCount, argumentBuffer, argumentOffset);
+    }
+}
+
+
+void PipelineClass::EndQuery(ID3D12QueryHeap *queryHeap, D3D12_QUERY_TYPE type, UINT index)
+{
+    // Queries only measure the frame, so they are left out of captures.
+    m_commandList->EndQuery(queryHeap, type, index);
+}
+
+
+void PipelineClass::ResolveQueryData(ID3D12QueryHeap *queryHeap, D3D12_QUERY_TYPE type, UINT startIndex, UINT count, ID3D12Resource *destination, UINT64 destinationOffset)
+{
+    FlushBarriers();
+    m_commandList->ResolveQueryData(queryHeap, type, startIndex, count, destination, destinationOffset);
+}
+
+
+void PipelineClass::NameD3DResources()
+{
+    // Name all DirectX objects.
+    m_commandList->SetName(L"PC command list");
+    for (UINT i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+    {
+        std::wstring name = L"PC command list " + std::to_wstring(i);
+        m_commandAllocators[i]->SetName(name.c_str());
+    }
+}
@@ -1,32 +1,89 @@
-////////////////////////////////////////////////////////////////////////////////
-// Filename: pipelineclass.h
-////////////////////////////////////////////////////////////////////////////////
-#pragma once
-
-
-////////////////////////////////////////////////////////////////////////////////
-// Class name: PipelineClass
-////////////////////////////////////////////////////////////////////////////////
-class PipelineClass
-{
-public:
-    PipelineClass(ID3D12Device *, const UINT &, D3D12_COMMAND_LIST_TYPE = D3D12_COMMAND_LIST_TYPE_DIRECT);
-    ~PipelineClass() = default;
-
-    ID3D12GraphicsCommandList * GetCommandList();
-
-    void Open();
-    void Close();
-
-    void AddBarrier(const D3D12_RESOURCE_BARRIER);
-    void SetState(ID3D12PipelineState *);
-
-private:
-    void NameD3DResources();
-
-private:
-    const UINT &r_frameIndex;
-
-    std::array<ComPtr<ID3D12CommandAllocator>, FRAME_BUFFER_COUNT> m_commandAllocators = {};
-    ComPtr<ID3D12GraphicsCommandList>                              m_commandList       = nullptr;
-};
+////////////////////////////////////////////////////////////////////////////////
+// Filename: pipelineclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include "commandstreamclass.h"
+#include "resourcestatetrackerclass.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: PipelineClass
+////////////////////////////////////////////////////////////////////////////////
+class PipelineClass
+{
+public:
+    PipelineClass(ID3D12Device *, const UINT &, const ResourceStateTrackerClass * = nullptr, D3D12_COMMAND_LIST_TYPE = D3D12_COMMAND_LIST_TYPE_DIRECT);
+    ~PipelineClass() = default;
+
+    ID3D12GraphicsCommandList * GetCommandList();
+    ResourceStateTrackerClass * GetResourceStates();
+    UINT GetBindCount();
+    UINT GetElidedCount();
+
+    void Open();
+    void Close();
+
+    void StartRecording(CommandStreamClass *);
+    void StopRecording();
+
+    void Transition(ID3D12Resource *, D3D12_RESOURCE_STATES, UINT = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES);
+    void BeginTransition(ID3D12Resource *, D3D12_RESOURCE_STATES, UINT = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES);
+    void AddUavBarrier(ID3D12Resource *);
+    void AddAliasingBarrier(ID3D12Resource *, ID3D12Resource *);
+    void FlushBarriers();
+    void SetState(ID3D12PipelineState *);
+    void SetRootSignature(ID3D12RootSignature *);
+    void SetRootConstantBufferView(UINT, D3D12_GPU_VIRTUAL_ADDRESS);
+    void SetRootShaderResourceView(UINT, D3D12_GPU_VIRTUAL_ADDRESS);
+    void SetRoot32BitConstant(UINT, UINT, UINT);
+    void SetViewport(const D3D12_VIEWPORT &, const D3D12_RECT &);
+    void SetRenderTargets(D3D12_CPU_DESCRIPTOR_HANDLE, D3D12_CPU_DESCRIPTOR_HANDLE);
+    void ClearRenderTarget(D3D12_CPU_DESCRIPTOR_HANDLE, const float *);
+    void ClearDepthStencil(D3D12_CPU_DESCRIPTOR_HANDLE);
+    void DiscardResource(ID3D12Resource *);
+    void SetVertexBuffers(UINT, UINT, const D3D12_VERTEX_BUFFER_VIEW *);
+    void SetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW &);
+    void SetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY);
+    void DrawIndexedInstanced(UINT, UINT, UINT, INT, UINT);
+    void SetComputeRootSignature(ID3D12RootSignature *);
+    void SetComputeRootConstantBufferView(UINT, D3D12_GPU_VIRTUAL_ADDRESS);
+    void SetComputeRootShaderResourceView(UINT, D3D12_GPU_VIRTUAL_ADDRESS);
+    void SetComputeRootUnorderedAccessView(UINT, D3D12_GPU_VIRTUAL_ADDRESS);
+    void Dispatch(UINT, UINT, UINT);
+    void CopyBufferRegion(ID3D12Resource *, UINT64, ID3D12Resource *, UINT64, UINT64);
+    void ExecuteIndirect(ID3D12CommandSignature *, UINT, ID3D12Resource *, UINT64);
+    void EndQuery(ID3D12QueryHeap *, D3D12_QUERY_TYPE, UINT);
+    void ResolveQueryData(ID3D12QueryHeap *, D3D12_QUERY_TYPE, UINT, UINT, ID3D12Resource *, UINT64);
+
+private:
+    void NameD3DResources();
+
+private:
+    const UINT &r_frameIndex;
+
+    std::array<ComPtr<ID3D12CommandAllocator>, MAX_FRAMES_IN_FLIGHT> m_commandAllocators = {};
+    ComPtr<ID3D12GraphicsCommandList>                                m_commandList       = nullptr;
+
+    CommandStreamClass *m_recorder = nullptr;
+
+    // The state of every resource the list has used, and the barriers that go out together right
+    // before the next command that needs them.
+    std::unique_ptr<ResourceStateTrackerClass> m_ResourceStates = nullptr;
+
+    // The state currently bound on the list, so binding the same again can be skipped, and how
+    // many binds went through or were skipped since the list was opened.
+    ID3D12PipelineState      *p_state                = nullptr;
+    ID3D12RootSignature      *p_rootSignature        = nullptr;
+    ID3D12RootSignature      *p_computeRootSignature = nullptr;
+    D3D12_INDEX_BUFFER_VIEW   m_indexBufferView      = {};
+    D3D12_PRIMITIVE_TOPOLOGY  m_topology             = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
+    UINT                      m_bindCount            = 0u;
+    UINT                      m_elidedCount          = 0u;
+
+    std::array<D3D12_VERTEX_BUFFER_VIEW, D3D12_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT> m_vertexBufferViews = {};
+};
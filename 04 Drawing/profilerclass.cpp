@@ -0,0 +1,246 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: profilerclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "profilerclass.h"
+
+
+ProfilerClass::ScopeType::ScopeType(ProfilerClass *profiler, const char *name)
+    : p_profiler(profiler)
+    , p_name(name)
+{
+    if (p_profiler)
+    {
+        m_start = p_profiler->Now();
+    }
+}
+
+
+ProfilerClass::ScopeType::~ScopeType()
+{
+    if (p_profiler)
+    {
+        p_profiler->AddEvent(p_name, m_start, p_profiler->Now() - m_start);
+    }
+}
+
+
+ProfilerClass::ProfilerClass(UINT capacity, UINT windowSize)
+    : m_capacity(capacity)
+    , m_windowSize(windowSize)
+{
+    // The ring is indexed by masking, so its size has to be a power of two.
+    THROW_IF_TRUE(
+        capacity == 0u || (capacity & (capacity - 1u)) != 0u,
+        "The profiler capacity must be a power of two."
+    );
+    THROW_IF_TRUE(
+        windowSize == 0u,
+        "The profiler needs room for at least one sample per span."
+    );
+
+    m_slots = std::make_unique<SlotType[]>(static_cast<size_t>(m_capacity));
+}
+
+
+int64_t ProfilerClass::Now()
+{
+    // Every event is measured in nanoseconds since the profiler was created.
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_epoch).count();
+}
+
+
+void ProfilerClass::AddEvent(const char *name, int64_t start, int64_t duration, TrackType track)
+{
+    // Claim the next slot.  If the ring has wrapped, this overwrites the oldest event.
+    const uint64_t index = m_head.fetch_add(1ull);
+    SlotType &slot = m_slots[index & (m_capacity - 1ull)];
+
+    // Mark the slot as being written, fill it in, then publish it under its new index.
+    slot.sequence.store(0ull, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.event.name     = name;
+    slot.event.start    = start;
+    slot.event.duration = duration;
+    slot.event.thread   = track == TrackType::Cpu ? GetThreadId() : 0u;
+    slot.event.track    = track;
+
+    slot.sequence.store(index + 1ull, std::memory_order_release);
+}
+
+
+void ProfilerClass::EndFrame()
+{
+    // Anything older than a full ring has already been overwritten.
+    const uint64_t head = m_head.load(std::memory_order_acquire);
+    if (head - m_tail > m_capacity)
+    {
+        m_droppedCount += head - m_tail - m_capacity;
+        m_tail          = head - m_capacity;
+    }
+
+    // Fold every finished event into its span's window.  An event that is being written right now
+    // stops us here, and is picked up at the end of the next frame instead.  Any other slot that
+    // does not hold its event lost it to a writer that lapped the ring.
+    for (; m_tail < head; ++m_tail)
+    {
+        EventType event;
+        if (ReadEvent(m_tail, event))
+        {
+            AddSample(event);
+        }
+        else if (m_slots[m_tail & (m_capacity - 1ull)].sequence.load(std::memory_order_acquire) == 0ull)
+        {
+            break;
+        }
+        else
+        {
+            ++m_droppedCount;
+        }
+    }
+}
+
+
+std::vector<ProfilerClass::SummaryType> ProfilerClass::GetSummary()
+{
+    std::vector<SummaryType> summary;
+    std::vector<double> sorted;
+    for (const WindowType &window : m_windows)
+    {
+        // Sort the window once and take each percentile by its nearest rank.
+        sorted.assign(window.samples.begin(), window.samples.begin() + window.count);
+        std::sort(sorted.begin(), sorted.end());
+
+        auto percentile = [&sorted](double fraction)
+        {
+            const size_t rank = static_cast<size_t>(std::ceil(fraction * static_cast<double>(sorted.size())));
+            return sorted[rank ? rank - 1u : 0u];
+        };
+
+        SummaryType span;
+        span.name  = window.name;
+        span.track = window.track;
+        span.count = window.count;
+        span.p50   = percentile(0.50);
+        span.p95   = percentile(0.95);
+        span.p99   = percentile(0.99);
+        summary.push_back(span);
+    }
+    return summary;
+}
+
+
+uint64_t ProfilerClass::GetDroppedCount()
+{
+    return m_droppedCount;
+}
+
+
+void ProfilerClass::SaveChromeTrace(const std::wstring &filename)
+{
+    // Write whatever the ring still holds in the trace event format, which chrome://tracing and
+    // Perfetto both open.  Complete events carry their start and duration in microseconds, and the
+    // CPU and the GPU each get a process of their own.
+    std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    json += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"CPU\"}},\n";
+    json += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"GPU\"}}";
+
+    const uint64_t head  = m_head.load(std::memory_order_acquire);
+    const uint64_t first = head > m_capacity ? head - m_capacity : 0ull;
+    for (uint64_t index = first; index < head; ++index)
+    {
+        EventType event;
+        if (!ReadEvent(index, event))
+        {
+            continue;
+        }
+
+        char line[256];
+        snprintf(line, sizeof(line),
+                 ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                 event.name,
+                 static_cast<UINT>(event.track),
+                 event.thread,
+                 static_cast<double>(event.start) / 1000.0,
+                 static_cast<double>(event.duration) / 1000.0);
+        json += line;
+    }
+    json += "\n]}\n";
+
+    // Open the file for writing, replacing any earlier trace.
+    HANDLE file = CreateFileW(filename.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    THROW_IF_TRUE(
+        file == INVALID_HANDLE_VALUE,
+        "Unable to create the trace file."
+    );
+
+    DWORD written = 0u;
+    const BOOL result = WriteFile(file, json.data(), static_cast<DWORD>(json.size()), &written, nullptr);
+    CloseHandle(file);
+
+    THROW_IF_FALSE(
+        result,
+        "Unable to write the trace file."
+    );
+}
+
+
+bool ProfilerClass::ReadEvent(uint64_t index, EventType &event)
+{
+    // Copy the event out, then make sure no writer touched the slot while we did.
+    const SlotType &slot = m_slots[index & (m_capacity - 1ull)];
+    const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence != index + 1ull)
+    {
+        return false;
+    }
+
+    event = slot.event;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.sequence.load(std::memory_order_relaxed) == sequence;
+}
+
+
+void ProfilerClass::AddSample(const EventType &event)
+{
+    // Find the window of this span.  The same name may live at different addresses in different
+    // translation units, so a name seen for the first time is matched by its text.
+    std::unordered_map<const char *, UINT> &indices = m_windowIndices[static_cast<size_t>(event.track)];
+    auto found = indices.find(event.name);
+    if (found == indices.end())
+    {
+        UINT index = 0u;
+        while (index < m_windows.size() &&
+               (m_windows[index].track != event.track || strcmp(m_windows[index].name, event.name) != 0))
+        {
+            ++index;
+        }
+
+        if (index == m_windows.size())
+        {
+            WindowType window;
+            window.name  = event.name;
+            window.track = event.track;
+            window.samples.resize(m_windowSize);
+            m_windows.push_back(std::move(window));
+        }
+        found = indices.emplace(event.name, index).first;
+    }
+
+    // Overwrite the oldest sample once the window is full.
+    WindowType &window = m_windows[found->second];
+    window.samples[window.next] = static_cast<double>(event.duration) / 1'000'000.0;
+    window.next  = (window.next + 1u) % m_windowSize;
+    window.count = window.count < m_windowSize ? window.count + 1u : m_windowSize;
+}
+
+
+uint32_t ProfilerClass::GetThreadId()
+{
+    // Give every thread a small id the first time it records an event, which reads better in a
+    // trace than the operating system's ids.
+    static std::atomic<uint32_t> nextThreadId = { 0u };
+    thread_local const uint32_t threadId = nextThreadId.fetch_add(1u);
+    return threadId;
+}
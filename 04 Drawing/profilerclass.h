@@ -0,0 +1,130 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: profilerclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: ProfilerClass
+////////////////////////////////////////////////////////////////////////////////
+class ProfilerClass
+{
+public:
+    // Which clock an event was measured on.  GPU events are moved onto the CPU timeline before
+    // they are added.
+    enum class TrackType : uint32_t
+    {
+        Cpu,
+        Gpu,
+    };
+
+    // One timed span.  Names are expected to be string literals, so only the pointer is kept.
+    struct EventType
+    {
+        const char *name     = nullptr;
+        int64_t     start    = 0ll;
+        int64_t     duration = 0ll;
+        uint32_t    thread   = 0u;
+        TrackType   track    = TrackType::Cpu;
+    };
+
+    // Percentiles of the most recent durations of one named span, in milliseconds.
+    struct SummaryType
+    {
+        std::string name  = "";
+        TrackType   track = TrackType::Cpu;
+        UINT        count = 0u;
+        double      p50   = 0.0;
+        double      p95   = 0.0;
+        double      p99   = 0.0;
+    };
+
+    // Times the block it lives in.  A null profiler turns the scope into a no-op.
+    class ScopeType
+    {
+    public:
+        ScopeType() = delete;
+        ScopeType(const ScopeType &) = delete;
+        ScopeType & operator=(const ScopeType &) = delete;
+
+        ScopeType(ProfilerClass *, const char *);
+        ~ScopeType();
+
+    private:
+        ProfilerClass *p_profiler = nullptr;
+        const char    *p_name     = nullptr;
+        int64_t        m_start    = 0ll;
+    };
+
+private:
+    // A slot of the ring.  Its sequence holds one past the index of the event written into it, or
+    // zero while a writer is filling it in, so readers can tell a finished event from one that is
+    // being written or has been overwritten.
+    struct SlotType
+    {
+        std::atomic<uint64_t> sequence = { 0ull };
+        EventType             event    = {};
+    };
+
+    // The most recent durations of one named span, oldest overwritten first.
+    struct WindowType
+    {
+        const char         *name    = nullptr;
+        TrackType           track   = TrackType::Cpu;
+        std::vector<double> samples = {};
+        UINT                next    = 0u;
+        UINT                count   = 0u;
+    };
+
+public:
+    ProfilerClass(const ProfilerClass &) = delete;
+    ProfilerClass & operator=(const ProfilerClass &) = delete;
+
+    ProfilerClass(UINT = 65'536u, UINT = 512u);
+    ~ProfilerClass() = default;
+
+    int64_t Now();
+    void AddEvent(const char *, int64_t, int64_t, TrackType = TrackType::Cpu);
+
+    void EndFrame();
+
+    std::vector<SummaryType> GetSummary();
+    uint64_t GetDroppedCount();
+
+    void SaveChromeTrace(const std::wstring &);
+
+private:
+    bool ReadEvent(uint64_t, EventType &);
+    void AddSample(const EventType &);
+
+    static uint32_t GetThreadId();
+
+private:
+    const std::chrono::steady_clock::time_point m_epoch = std::chrono::steady_clock::now();
+
+    // The ring every thread writes its events into.  Writers only ever claim the next index, so
+    // recording an event takes no lock.
+    const uint64_t              m_capacity = 0ull;
+    std::unique_ptr<SlotType[]> m_slots    = nullptr;
+    std::atomic<uint64_t>       m_head     = { 0ull };
+
+    // Only the thread ending frames reads the ring, from the first event it has not yet folded
+    // into the rolling windows.
+    const UINT              m_windowSize   = 0u;
+    uint64_t                m_tail         = 0ull;
+    uint64_t                m_droppedCount = 0ull;
+    std::vector<WindowType> m_windows      = {};
+
+    // Where each name's window lives, for either track.
+    std::array<std::unordered_map<const char *, UINT>, 2> m_windowIndices = {};
+};
@@ -1,79 +1,186 @@
-////////////////////////////////////////////////////////////////////////////////
-// Filename: quadclass.cpp
-////////////////////////////////////////////////////////////////////////////////
-#include "pch.h"
-#include "quadclass.h"
-
-
-QuadClass::QuadClass(ID3D12Device *device)
-{
-    // Create the containers that we will build our geoemetry inside.
-    std::vector<VertexType>   vertices;
-    std::vector<uint32_t>     indices;
-    std::vector<InstanceType> instances;
-
-    // Preset the sizes of our vectors.
-    vertices.resize(4);
-    indices.resize(6);
-    instances.resize(4);
-
-    // Load the vertex vector with points of a square.
-    vertices[0].position = { -1.0f, 1.0f, 0.0f };   // Top left.
-    vertices[0].color    = { 1.0f, 0.0f, 1.0f, 1.0f };
-
-    vertices[1].position = { 1.0f, 1.0f, 0.0f };    // Top right.
-    vertices[1].color    = { 1.0f, 0.0f, 0.0f, 1.0f };
-
-    vertices[2].position = { 1.0f, -1.0f, 0.0f };   // Bottom right.
-    vertices[2].color    = { 1.0f, 1.0f, 0.0f, 1.0f };
-
-    vertices[3].position = { -1.0f, -1.0f, 0.0f };  // Bottom left.
-    vertices[3].color    = { 1.0f, 1.0f, 1.0f, 1.0f };
-
-    // Describe the two triangles that make up a square.
-    indices[0] = 0u;  // Top left.
-    indices[1] = 1u;  // Top right.
-    indices[2] = 2u;  // Bottom right.
-
-    indices[3] = 0u;  // Top left.
-    indices[4] = 2u;  // Bottom right.
-    indices[5] = 3u;  // Bottom left.
-
-    // Set four distinct copies of this square.
-    instances[0].position = { -2.0f, 2.0f, 0.0f };
-    instances[0].hsv      = { 0.25f, 1.0f, 1.0f };
-
-    instances[1].position = { 2.0f, 2.0f, 0.0f };
-    instances[1].hsv      = { 0.5f, 1.0f, 1.0f };
-
-    instances[2].position = { 2.0f, -2.0f, 0.0f };
-    instances[2].hsv      = { 0.75f, 1.0f, 1.0f };
-
-    instances[3].position = { -2.0f, -2.0f, 0.0f };
-    instances[3].hsv      = { 1.0f, 1.0f, 1.0f };
-
-    // Initialize the buffers and their views.
-    m_vertexBuffer   = BufferType(device, vertices,  L"QC vertex buffer");
-    m_indexBuffer    = BufferType(device, indices,   L"QC index buffer");
-    m_instanceBuffer = BufferType(device, instances, L"QC instance buffer");
-}
-
-
-void QuadClass::Render(ID3D12GraphicsCommandList *commandList)
-{
-    // Set the views associated with this geometry vertex buffers.
-    D3D12_VERTEX_BUFFER_VIEW pViews[2];
-    pViews[0] = m_vertexBuffer.vertexView;
-    pViews[1] = m_instanceBuffer.vertexView;
-
-    // Set the vertex and index buffers as active in the input assembler so they will be used for
-    // rendering.
-    commandList->IASetVertexBuffers(0, 2, pViews);
-    commandList->IASetIndexBuffer(&m_indexBuffer.indexView);
-
-    // Set the type of primitive that the input assembler will try to assemble next.
-    commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-
-    // Issue the draw call for this geometry.
-    commandList->DrawIndexedInstanced(static_cast<UINT>(m_indexBuffer.count), static_cast<UINT>(m_instanceBuffer.count), 0u, 0, 0u);
-}
+////////////////////////////////////////////////////////////////////////////////
+// Filename: quadclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "quadclass.h"
+
+
+QuadClass::QuadClass(GeometryPoolClass *geometryPool, GpuAllocatorClass *allocator, UploadRingClass *uploader, UINT instanceCount)
+{
+    // Create the containers that we will build our geoemetry inside.  The instances stay with
+    // us for culling, so they are built in place.
+    std::vector<MeshPackerClass::VertexType>  vertices;
+    std::vector<uint32_t>                     indices;
+    std::vector<InstanceType>                &instances = m_instances;
+
+    THROW_IF_TRUE(
+        instanceCount == 0u,
+        "A quad needs at least one instance to draw."
+    );
+
+    // Preset the sizes of our vectors.
+    vertices.resize(4);
+    indices.resize(6);
+    instances.resize(instanceCount);
+
+    // Load the vertex vector with points of a square.
+    vertices[0].position = { -1.0f, 1.0f, 0.0f };   // Top left.
+    vertices[0].color    = { 1.0f, 0.0f, 1.0f, 1.0f };
+
+    vertices[1].position = { 1.0f, 1.0f, 0.0f };    // Top right.
+    vertices[1].color    = { 1.0f, 0.0f, 0.0f, 1.0f };
+
+    vertices[2].position = { 1.0f, -1.0f, 0.0f };   // Bottom right.
+    vertices[2].color    = { 1.0f, 1.0f, 0.0f, 1.0f };
+
+    vertices[3].position = { -1.0f, -1.0f, 0.0f };  // Bottom left.
+    vertices[3].color    = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+    // Describe the two triangles that make up a square.
+    indices[0] = 0u;  // Top left.
+    indices[1] = 1u;  // Top right.
+    indices[2] = 2u;  // Bottom right.
+
+    indices[3] = 0u;  // Top left.
+    indices[4] = 2u;  // Bottom right.
+    indices[5] = 3u;  // Bottom left.
+
+    // Lay the copies of this square out on a grid centered on the origin, going back and forth
+    // along its rows, and walk the hue around the color wheel from one copy to the next.  Four
+    // copies make the two by two grid we always had.
+    const UINT  columns = static_cast<UINT>(std::ceil(std::sqrt(static_cast<float>(instanceCount))));
+    const UINT  rows    = columns ? (instanceCount + columns - 1u) / columns : 0u;
+    const float left    = -0.5f * INSTANCE_SPACING * static_cast<float>(columns - 1u);
+    const float top     =  0.5f * INSTANCE_SPACING * static_cast<float>(rows - 1u);
+    for (UINT i = 0u; i < instanceCount; ++i)
+    {
+        const UINT row    = i / columns;
+        const UINT column = (row % 2u) ? columns - 1u - i % columns : i % columns;
+
+        instances[i].position = { left + INSTANCE_SPACING * static_cast<float>(column), top - INSTANCE_SPACING * static_cast<float>(row), 0.0f };
+        instances[i].hsv      = { static_cast<float>(i + 1u) / static_cast<float>(instanceCount), 1.0f, 1.0f };
+    }
+
+    // Bound every instance with a sphere around its square, for culling.
+    m_instanceBounds.Resize(instances.size());
+    for (size_t i = 0; i < instances.size(); ++i)
+    {
+        m_instanceBounds.x[i]      = instances[i].position.x;
+        m_instanceBounds.y[i]      = instances[i].position.y;
+        m_instanceBounds.z[i]      = instances[i].position.z;
+        m_instanceBounds.radius[i] = INSTANCE_RADIUS;
+    }
+    m_survivors.resize(instances.size());
+
+    // Optimize and pack the mesh, and add it to the shared vertex and index buffers.  The
+    // instances are ours alone, so they get a buffer of their own; they are also kept on the CPU,
+    // and the visible ones are written out again every frame by whichever culler we use.
+    MeshOptimizerClass::Optimize(vertices, indices);
+    m_mesh           = geometryPool->AddMesh(MeshPackerClass::Pack(vertices, indices));
+    p_geometryPool   = geometryPool;
+    m_instanceBuffer = BufferType(allocator, uploader, instances, L"QC instance buffer");
+
+    // Create the buffers the cull kernel writes the visible instances and our draw arguments to.
+    m_visibleBuffer  = BufferType(allocator, instances.size(), sizeof(InstanceType), L"QC visible instance buffer");
+    m_argumentBuffer = BufferType(allocator, 1u, sizeof(D3D12_DRAW_INDEXED_ARGUMENTS), L"QC draw argument buffer");
+}
+
+
+void QuadClass::Cull(FrustumCullerClass *culler, ConstantArenaClass *arena, const XMMATRIX &viewProjection)
+{
+    // Cull the instances in our own space, against the frustum moved into it by our world matrix.
+    const FrustumCullerClass::FrustumType frustum = FrustumCullerClass::ExtractFrustum(XMMatrixMultiply(m_worldMatrix, viewProjection));
+    m_visibleInstanceCount = culler->Cull(frustum, m_instanceBounds, m_survivors.data());
+
+    // Compact the survivors into this frame's instance buffer, straight into upload memory.
+    const UINT visibleSize = m_visibleInstanceCount * static_cast<UINT>(sizeof(InstanceType));
+    BYTE *mappedData = nullptr;
+    m_visibleInstanceView.BufferLocation = arena->Allocate(visibleSize, &mappedData);
+    m_visibleInstanceView.SizeInBytes    = visibleSize;
+    m_visibleInstanceView.StrideInBytes  = static_cast<UINT>(sizeof(InstanceType));
+
+    InstanceType *visibleInstances = reinterpret_cast<InstanceType*>(mappedData);
+    for (UINT i = 0u; i < m_visibleInstanceCount; ++i)
+    {
+        visibleInstances[i] = m_instances[m_survivors[i]];
+    }
+
+    m_drawIndirect = false;
+}
+
+
+void QuadClass::CullIndirect(PipelineClass *pipeline, CullContextClass *context, ConstantArenaClass *arena, const XMMATRIX &viewProjection)
+{
+    // Cull the instances in our own space, against the frustum moved into it by our world matrix.
+    const FrustumCullerClass::FrustumType frustum = FrustumCullerClass::ExtractFrustum(XMMatrixMultiply(m_worldMatrix, viewProjection));
+
+    // Stage our draw arguments with no instances yet; the kernel counts them up as it goes.
+    D3D12_DRAW_INDEXED_ARGUMENTS arguments = CullContextClass::PackDrawArguments(m_mesh.indexCount, 0u, m_mesh.startIndex, static_cast<INT>(m_mesh.baseVertex));
+    ID3D12Resource *arenaResource = arena->GetResource();
+    const UINT64 argumentsOffset = arena->Allocate(reinterpret_cast<BYTE*>(&arguments), sizeof(arguments)) - arenaResource->GetGPUVirtualAddress();
+
+    // Reset the arguments, then let the kernel write both outputs.  The pipeline works out the
+    // barriers, and sends each batch out together with those of the other geometry.
+    ID3D12Resource *visibleBuffer  = m_visibleBuffer.buffer.Get();
+    ID3D12Resource *argumentBuffer = m_argumentBuffer.buffer.Get();
+    pipeline->Transition(visibleBuffer, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+    pipeline->Transition(argumentBuffer, D3D12_RESOURCE_STATE_COPY_DEST);
+    pipeline->CopyBufferRegion(argumentBuffer, 0ull, arenaResource, argumentsOffset, sizeof(arguments));
+    pipeline->Transition(argumentBuffer, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+
+    context->Dispatch(pipeline,
+                      frustum,
+                      INSTANCE_RADIUS,
+                      static_cast<UINT>(m_instanceBuffer.count),
+                      m_instanceBuffer.buffer->GetGPUVirtualAddress(),
+                      visibleBuffer->GetGPUVirtualAddress(),
+                      argumentBuffer->GetGPUVirtualAddress());
+
+    // Hand the results over to the draw.  Nothing else in the setup list touches them, so the
+    // transitions are split and only have to be done by the time the list ends.
+    pipeline->BeginTransition(visibleBuffer, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
+    pipeline->BeginTransition(argumentBuffer, D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT);
+
+    p_commandSignature = context->GetCommandSignature();
+    m_drawIndirect     = true;
+}
+
+
+bool QuadClass::IsResident()
+{
+    // We can only draw once our mesh and our instances have arrived on the GPU.
+    return p_geometryPool->IsResident(m_mesh) && m_instanceBuffer.IsResident();
+}
+
+
+void QuadClass::Render(PipelineClass *pipeline)
+{
+    // There is nothing to draw if the CPU culled every instance.
+    if (!m_drawIndirect && m_visibleInstanceCount == 0u)
+    {
+        return;
+    }
+
+    // The shared vertex and index buffers are already bound, so only our instances are left to
+    // set, in the second slot.
+    const D3D12_VERTEX_BUFFER_VIEW &instanceView = m_drawIndirect ? m_visibleBuffer.vertexView : m_visibleInstanceView;
+    pipeline->SetVertexBuffers(1, 1, &instanceView);
+    p_geometryPool->SetIndexBuffer(pipeline, m_mesh);
+
+    // Set the type of primitive that the input assembler will try to assemble next.
+    pipeline->SetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+    // Issue the draw call for this geometry.  When the GPU culled our instances, it also wrote out
+    // the arguments for the draw, and the setup list has already moved both into the states we
+    // read them in.
+    if (m_drawIndirect)
+    {
+        pipeline->Transition(m_visibleBuffer.buffer.Get(), D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
+        pipeline->Transition(m_argumentBuffer.buffer.Get(), D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT);
+        pipeline->ExecuteIndirect(p_commandSignature, 1u, m_argumentBuffer.buffer.Get(), 0ull);
+    }
+    else
+    {
+        pipeline->DrawIndexedInstanced(m_mesh.indexCount, m_visibleInstanceCount, m_mesh.startIndex, static_cast<INT>(m_mesh.baseVertex), 0u);
+    }
+}
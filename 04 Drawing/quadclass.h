@@ -16,30 +16,44 @@
 class QuadClass : public GeometryInterface
 {
 private:
-    struct VertexType
-    {
-        XMFLOAT3 position = {};
-        XMFLOAT4 color    = {};
-    };
-
     struct InstanceType
     {
         XMFLOAT3 position = {};
         XMFLOAT3 hsv      = {};
     };
 
+    // Every instance fits inside a sphere of this radius around its position.
+    static constexpr float INSTANCE_RADIUS = 1.41421356f;
+
+    // The distance between neighbouring instances on their grid.
+    static constexpr float INSTANCE_SPACING = 4.0f;
+
 public:
     QuadClass() = delete;
     QuadClass(const QuadClass &) = delete;
     QuadClass & operator=(const QuadClass &) = delete;
 
-    QuadClass(ID3D12Device *);
+    QuadClass(GeometryPoolClass *, GpuAllocatorClass *, UploadRingClass *, UINT = 4u);
     ~QuadClass() = default;
 
-    void Render(ID3D12GraphicsCommandList *) override;
+    void Cull(FrustumCullerClass *, ConstantArenaClass *, const XMMATRIX &) override;
+    void CullIndirect(PipelineClass *, CullContextClass *, ConstantArenaClass *, const XMMATRIX &) override;
+
+    bool IsResident() override;
+    void Render(PipelineClass *) override;
 
 private:
-    BufferType m_vertexBuffer   = {};
-    BufferType m_indexBuffer    = {};
     BufferType m_instanceBuffer = {};
+    BufferType m_visibleBuffer  = {};
+    BufferType m_argumentBuffer = {};
+
+    std::vector<InstanceType>      m_instances      = {};
+    FrustumCullerClass::BoundsType m_instanceBounds = {};
+    std::vector<UINT>              m_survivors      = {};
+
+    D3D12_VERTEX_BUFFER_VIEW m_visibleInstanceView  = {};
+    UINT                     m_visibleInstanceCount = 0u;
+
+    bool                    m_drawIndirect     = false;
+    ID3D12CommandSignature *p_commandSignature = nullptr;
 };
@@ -0,0 +1,612 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: rendergraphclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "rendergraphclass.h"
+
+
+constexpr UINT RenderGraphClass::NO_USE;
+
+
+UINT RenderGraphClass::ImportResource(const char *name, D3D12_RESOURCE_STATES state)
+{
+    // Imported resources live outside the graph, which only moves them between states.  Something
+    // outside the graph may look at them afterwards, so the passes writing them are never culled.
+    ResourceType resource;
+    resource.name         = name;
+    resource.imported     = true;
+    resource.initialState = state;
+    m_resources.push_back(resource);
+    return static_cast<UINT>(m_resources.size() - 1u);
+}
+
+
+UINT RenderGraphClass::CreateTexture(const char *name, const D3D12_RESOURCE_DESC &desc, const D3D12_RESOURCE_ALLOCATION_INFO &allocation)
+{
+    // Transient textures only live from their first pass to their last, so they can share memory
+    // with each other.  They all go into one heap, which has to be restricted to render targets and
+    // depth stencils on the oldest hardware.
+    THROW_IF_TRUE(
+        (desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)) == 0,
+        "Transient textures have to be render targets or depth stencils."
+    );
+
+    ResourceType resource;
+    resource.name       = name;
+    resource.desc       = desc;
+    resource.allocation = allocation;
+    m_resources.push_back(resource);
+    return static_cast<UINT>(m_resources.size() - 1u);
+}
+
+
+UINT RenderGraphClass::AddPass(const char *name, ExecuteType execute, bool sideEffects)
+{
+    // A pass with side effects does something the graph cannot see, so it is never culled.
+    PassType pass;
+    pass.name        = name;
+    pass.execute     = std::move(execute);
+    pass.sideEffects = sideEffects;
+    m_passes.push_back(std::move(pass));
+    return static_cast<UINT>(m_passes.size() - 1u);
+}
+
+
+void RenderGraphClass::Read(UINT pass, UINT resource, D3D12_RESOURCE_STATES state)
+{
+    AddUse(pass, resource, state, false);
+}
+
+
+void RenderGraphClass::Write(UINT pass, UINT resource, D3D12_RESOURCE_STATES state)
+{
+    AddUse(pass, resource, state, true);
+}
+
+
+void RenderGraphClass::Compile()
+{
+    // Compiling only looks at what the passes declared, so it needs no device and can run again
+    // whenever the graph changes.
+    const auto start = std::chrono::steady_clock::now();
+
+    CullPasses();
+    SchedulePasses();
+    PlaceTransients();
+    PlanTransitions();
+
+    m_statistics.passCount      = static_cast<UINT>(m_passes.size());
+    m_statistics.culledCount    = static_cast<UINT>(m_passes.size() - m_schedule.size());
+    m_statistics.compileSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+void RenderGraphClass::Realize(ID3D12Device *device, ResourceStateTrackerClass *resourceStates)
+{
+    // Nothing to create if no pass we kept uses a transient texture.  Otherwise the next frame
+    // has to discard every texture placed here before drawing to it.
+    m_uninitialized = true;
+    if (m_statistics.heapBytes == 0ull)
+    {
+        return;
+    }
+
+    // Grow the heap when the transients no longer fit.  Everything placed in the old heap has to
+    // be created again, so this belongs with the rest of the setup and not in the middle of frames.
+    if (m_statistics.heapBytes > m_heapSize)
+    {
+        UINT64 alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+        for (const ResourceType &resource : m_resources)
+        {
+            alignment = resource.allocation.Alignment > alignment ? resource.allocation.Alignment : alignment;
+        }
+
+        D3D12_HEAP_DESC heapDesc{};
+        heapDesc.SizeInBytes                     = m_statistics.heapBytes;
+        heapDesc.Properties.Type                 = D3D12_HEAP_TYPE_DEFAULT;
+        heapDesc.Properties.CPUPageProperty      = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+        heapDesc.Properties.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+        heapDesc.Properties.CreationNodeMask     = 1;
+        heapDesc.Properties.VisibleNodeMask      = 1;
+        heapDesc.Alignment                       = alignment;
+        heapDesc.Flags                           = D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+
+        THROW_IF_FAILED(
+            device->CreateHeap(
+                &heapDesc,
+                IID_PPV_ARGS(m_heap.ReleaseAndGetAddressOf())),
+            "Unable to create the transient texture heap."
+        );
+        m_heap->SetName(L"RGC transient heap");
+        m_heapSize = m_statistics.heapBytes;
+    }
+
+    // Place every transient texture where compiling put it, in the state it is discarded in.
+    for (ResourceType &resource : m_resources)
+    {
+        if (resource.imported || resource.firstUse == NO_USE)
+        {
+            continue;
+        }
+
+        THROW_IF_FAILED(
+            device->CreatePlacedResource(
+                m_heap.Get(),
+                resource.heapOffset,
+                &resource.desc,
+                GetDiscardState(resource.desc),
+                nullptr,
+                IID_PPV_ARGS(resource.placed.ReleaseAndGetAddressOf())),
+            "Unable to place a transient texture in its heap."
+        );
+        resource.resource = resource.placed.Get();
+        resourceStates->Register(resource.resource, GetDiscardState(resource.desc));
+
+        const std::wstring name = L"RGC " + std::wstring(resource.name, resource.name + strlen(resource.name));
+        resource.placed->SetName(name.c_str());
+    }
+}
+
+
+void RenderGraphClass::SetResource(UINT resource, ID3D12Resource *d3dResource)
+{
+    // Imported resources may change from frame to frame, like the back buffer does.
+    m_resources[resource].resource = d3dResource;
+}
+
+
+ID3D12Resource * RenderGraphClass::GetResource(UINT resource)
+{
+    return m_resources[resource].resource;
+}
+
+
+void RenderGraphClass::Execute(PipelineClass *pipeline)
+{
+    // Run the passes in their scheduled order.  Each one first discards the transients that hold
+    // nothing yet, then moves its resources into the states it uses them in.  The barriers go out
+    // in one batch with the pass's first command.
+    for (UINT index : m_schedule)
+    {
+        PassType &pass = m_passes[index];
+
+        // Memory taken over from another texture holds whatever that texture left there, and so
+        // does a texture just placed.  A render target or depth stencil in either has to be
+        // discarded before anything else touches it, which needs it in the state it is drawn to in.
+        for (UINT resource : pass.firstUses)
+        {
+            const ResourceType &transient = m_resources[resource];
+            if (!transient.aliased && !m_uninitialized)
+            {
+                continue;
+            }
+
+            if (transient.aliased)
+            {
+                pipeline->AddAliasingBarrier(nullptr, transient.resource);
+            }
+            pipeline->Transition(transient.resource, GetDiscardState(transient.desc));
+            pipeline->DiscardResource(transient.resource);
+        }
+        for (const TransitionType &transition : pass.transitions)
+        {
+            pipeline->Transition(m_resources[transition.resource].resource, transition.state);
+        }
+
+        pass.execute(pipeline);
+    }
+    m_uninitialized = false;
+}
+
+
+UINT64 RenderGraphClass::GetHeapOffset(UINT resource)
+{
+    return m_resources[resource].heapOffset;
+}
+
+
+const std::vector<UINT> & RenderGraphClass::GetSchedule()
+{
+    return m_schedule;
+}
+
+
+RenderGraphClass::StatisticsType RenderGraphClass::GetStatistics()
+{
+    return m_statistics;
+}
+
+
+void RenderGraphClass::AddUse(UINT pass, UINT resource, D3D12_RESOURCE_STATES state, bool write)
+{
+    THROW_IF_TRUE(
+        pass >= m_passes.size() || resource >= m_resources.size(),
+        "The render graph has no such pass or resource."
+    );
+
+    // A pass uses each resource in one state only.  Reading what it also writes makes it a write.
+    for (UseType &use : m_passes[pass].uses)
+    {
+        if (use.resource == resource)
+        {
+            if (write || !use.write)
+            {
+                use.state = write ? state : static_cast<D3D12_RESOURCE_STATES>(use.state | state);
+            }
+            use.write = use.write || write;
+            return;
+        }
+    }
+
+    UseType use;
+    use.resource = resource;
+    use.state    = state;
+    use.write    = write;
+    m_passes[pass].uses.push_back(use);
+}
+
+
+void RenderGraphClass::CullPasses()
+{
+    // Count how many passes read each resource, with imported resources read from outside as
+    // well, and how many resources each pass writes.
+    std::vector<UINT> readCounts(m_resources.size(), 0u);
+    std::vector<UINT> writeCounts(m_passes.size(), 0u);
+    std::vector<std::vector<UINT>> writers(m_resources.size());
+    for (UINT resource = 0u; resource < m_resources.size(); ++resource)
+    {
+        readCounts[resource] = m_resources[resource].imported ? 1u : 0u;
+    }
+    for (UINT pass = 0u; pass < m_passes.size(); ++pass)
+    {
+        m_passes[pass].culled = false;
+        for (const UseType &use : m_passes[pass].uses)
+        {
+            if (use.write)
+            {
+                ++writeCounts[pass];
+                writers[use.resource].push_back(pass);
+            }
+            else
+            {
+                ++readCounts[use.resource];
+            }
+        }
+    }
+
+    // Cull a pass once nothing reads anything it writes, which may in turn leave the resources
+    // it read unread.  Work through them until nothing else can go.
+    std::vector<UINT> unread;
+    auto cullPass = [&](UINT pass)
+    {
+        m_passes[pass].culled = true;
+        for (const UseType &use : m_passes[pass].uses)
+        {
+            if (!use.write && --readCounts[use.resource] == 0u)
+            {
+                unread.push_back(use.resource);
+            }
+        }
+    };
+
+    for (UINT pass = 0u; pass < m_passes.size(); ++pass)
+    {
+        if (writeCounts[pass] == 0u && !m_passes[pass].sideEffects)
+        {
+            cullPass(pass);
+        }
+    }
+    for (UINT resource = 0u; resource < m_resources.size(); ++resource)
+    {
+        if (readCounts[resource] == 0u)
+        {
+            unread.push_back(resource);
+        }
+    }
+
+    while (!unread.empty())
+    {
+        const UINT resource = unread.back();
+        unread.pop_back();
+
+        for (UINT pass : writers[resource])
+        {
+            if (!m_passes[pass].culled && --writeCounts[pass] == 0u && !m_passes[pass].sideEffects)
+            {
+                cullPass(pass);
+            }
+        }
+    }
+}
+
+
+void RenderGraphClass::SchedulePasses()
+{
+    // A pass depends on the last pass to write each resource it uses, and a pass writing a
+    // resource also waits for every pass reading what was there before.
+    const UINT passCount = static_cast<UINT>(m_passes.size());
+    std::vector<std::vector<UINT>> successors(passCount);
+    std::vector<UINT> dependencyCounts(passCount, 0u);
+    std::vector<UINT> lastWriters(m_resources.size(), NO_USE);
+    std::vector<std::vector<UINT>> readers(m_resources.size());
+
+    auto addDependency = [&](UINT before, UINT after)
+    {
+        if (before != NO_USE && before != after)
+        {
+            successors[before].push_back(after);
+            ++dependencyCounts[after];
+        }
+    };
+
+    for (UINT pass = 0u; pass < passCount; ++pass)
+    {
+        if (m_passes[pass].culled)
+        {
+            continue;
+        }
+
+        for (const UseType &use : m_passes[pass].uses)
+        {
+            addDependency(lastWriters[use.resource], pass);
+            if (use.write)
+            {
+                for (UINT reader : readers[use.resource])
+                {
+                    addDependency(reader, pass);
+                }
+                readers[use.resource].clear();
+                lastWriters[use.resource] = pass;
+            }
+            else
+            {
+                readers[use.resource].push_back(pass);
+            }
+        }
+    }
+
+    // Passes without dependencies could run in any order.  Of those that are ready, take the one
+    // whose inputs were finished most recently, so the transients it reads die sooner and more of
+    // them can share memory.  Ties keep the order the passes were added in.
+    std::vector<UINT> ready;
+    std::vector<UINT> latestInput(passCount, 0u);
+    for (UINT pass = 0u; pass < passCount; ++pass)
+    {
+        if (!m_passes[pass].culled && dependencyCounts[pass] == 0u)
+        {
+            ready.push_back(pass);
+        }
+    }
+
+    m_schedule.clear();
+    while (!ready.empty())
+    {
+        size_t best = 0;
+        for (size_t i = 1; i < ready.size(); ++i)
+        {
+            if (latestInput[ready[i]] > latestInput[ready[best]] ||
+                (latestInput[ready[i]] == latestInput[ready[best]] && ready[i] < ready[best]))
+            {
+                best = i;
+            }
+        }
+
+        const UINT pass = ready[best];
+        ready.erase(ready.begin() + best);
+        m_schedule.push_back(pass);
+
+        for (UINT successor : successors[pass])
+        {
+            latestInput[successor] = static_cast<UINT>(m_schedule.size());
+            if (--dependencyCounts[successor] == 0u)
+            {
+                ready.push_back(successor);
+            }
+        }
+    }
+
+    // Note where in the schedule each resource is first and last used, which placing the
+    // transients and planning their transitions both go by.
+    for (ResourceType &resource : m_resources)
+    {
+        resource.firstUse = NO_USE;
+        resource.lastUse  = NO_USE;
+    }
+    for (UINT position = 0u; position < m_schedule.size(); ++position)
+    {
+        for (const UseType &use : m_passes[m_schedule[position]].uses)
+        {
+            ResourceType &resource = m_resources[use.resource];
+            resource.firstUse = resource.firstUse == NO_USE ? position : resource.firstUse;
+            resource.lastUse  = position;
+        }
+    }
+}
+
+
+void RenderGraphClass::PlanTransitions()
+{
+    // Gather every use of every resource in the order the passes run.
+    struct ScheduledUseType
+    {
+        UINT    position = 0u;
+        UseType use      = {};
+    };
+
+    std::vector<std::vector<ScheduledUseType>> uses(m_resources.size());
+    for (UINT position = 0u; position < m_schedule.size(); ++position)
+    {
+        PassType &pass = m_passes[m_schedule[position]];
+        pass.transitions.clear();
+        for (const UseType &use : pass.uses)
+        {
+            ScheduledUseType scheduled;
+            scheduled.position = position;
+            scheduled.use      = use;
+            uses[use.resource].push_back(scheduled);
+        }
+    }
+    for (PassType &pass : m_passes)
+    {
+        if (pass.culled)
+        {
+            pass.transitions.clear();
+        }
+    }
+
+    // Passes reading a resource one after another read it in one combined state, so only the
+    // first of them needs a barrier.  A write always gets its own.
+    m_statistics.barrierCount = 0u;
+    for (UINT index = 0u; index < m_resources.size(); ++index)
+    {
+        ResourceType &resource = m_resources[index];
+        const std::vector<ScheduledUseType> &resourceUses = uses[index];
+
+        if (resourceUses.empty())
+        {
+            continue;
+        }
+
+        std::vector<TransitionType> planned;
+        std::vector<UINT>           positions;
+        for (size_t i = 0; i < resourceUses.size();)
+        {
+            TransitionType transition;
+            transition.resource = index;
+            transition.state    = resourceUses[i].use.state;
+
+            size_t next = i + 1;
+            if (!resourceUses[i].use.write)
+            {
+                while (next < resourceUses.size() && !resourceUses[next].use.write)
+                {
+                    transition.state = static_cast<D3D12_RESOURCE_STATES>(transition.state | resourceUses[next].use.state);
+                    ++next;
+                }
+            }
+
+            planned.push_back(transition);
+            positions.push_back(resourceUses[i].position);
+            i = next;
+        }
+
+        // Imported resources start where they were imported.  Transients start where they are
+        // discarded when aliased, and otherwise where the previous frame left them, except on the
+        // first frame, which discards them all.  So the first transition of a transient is always
+        // made, and the state tracker drops it whenever the texture is already there.
+        resource.finalState = planned.back().state;
+        D3D12_RESOURCE_STATES state = resource.imported ? resource.initialState :
+                                      resource.aliased ? GetDiscardState(resource.desc) : resource.finalState;
+        for (size_t i = 0; i < planned.size(); ++i)
+        {
+            if (planned[i].state != state || (i == 0 && !resource.imported))
+            {
+                m_passes[m_schedule[positions[i]]].transitions.push_back(planned[i]);
+            }
+            if (planned[i].state != state)
+            {
+                ++m_statistics.barrierCount;
+            }
+            state = planned[i].state;
+        }
+    }
+}
+
+
+void RenderGraphClass::PlaceTransients()
+{
+    // Place the largest textures first, each at the lowest offset where it does not overlap any
+    // texture already placed that is alive at the same time.
+    std::vector<UINT> order;
+    m_statistics.transientCount = 0u;
+    m_statistics.transientBytes = 0ull;
+    for (UINT index = 0u; index < m_resources.size(); ++index)
+    {
+        ResourceType &resource = m_resources[index];
+        resource.aliased = false;
+        if (!resource.imported && resource.firstUse != NO_USE)
+        {
+            order.push_back(index);
+            ++m_statistics.transientCount;
+            m_statistics.transientBytes += resource.allocation.SizeInBytes;
+        }
+    }
+    std::stable_sort(order.begin(), order.end(), [this](UINT a, UINT b)
+    {
+        return m_resources[a].allocation.SizeInBytes > m_resources[b].allocation.SizeInBytes;
+    });
+
+    std::vector<UINT> placed;
+    std::vector<UINT> overlapping;
+    UINT64 heapBytes = 0ull;
+    for (UINT index : order)
+    {
+        ResourceType &resource = m_resources[index];
+
+        overlapping.clear();
+        for (UINT other : placed)
+        {
+            if (m_resources[other].firstUse <= resource.lastUse && resource.firstUse <= m_resources[other].lastUse)
+            {
+                overlapping.push_back(other);
+            }
+        }
+        std::sort(overlapping.begin(), overlapping.end(), [this](UINT a, UINT b)
+        {
+            return m_resources[a].heapOffset < m_resources[b].heapOffset;
+        });
+
+        // Walk the live textures from the bottom of the heap up and take the first gap we fit in.
+        const UINT64 alignment = resource.allocation.Alignment ? resource.allocation.Alignment : D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+        UINT64 offset = 0ull;
+        for (UINT other : overlapping)
+        {
+            const ResourceType &live = m_resources[other];
+            if (offset + resource.allocation.SizeInBytes <= live.heapOffset)
+            {
+                break;
+            }
+            const UINT64 end = live.heapOffset + live.allocation.SizeInBytes;
+            offset = end > offset ? end : offset;
+            offset = (offset + alignment - 1ull) / alignment * alignment;
+        }
+
+        resource.heapOffset = offset;
+        heapBytes = offset + resource.allocation.SizeInBytes > heapBytes ? offset + resource.allocation.SizeInBytes : heapBytes;
+        placed.push_back(index);
+    }
+    m_statistics.heapBytes = heapBytes;
+
+    // A texture sharing memory with any other has to take that memory over before its first pass,
+    // so it is discarded there every frame instead of only after being placed.
+    for (UINT a = 0u; a < placed.size(); ++a)
+    {
+        for (UINT b = a + 1u; b < placed.size(); ++b)
+        {
+            ResourceType &first  = m_resources[placed[a]];
+            ResourceType &second = m_resources[placed[b]];
+            if (first.heapOffset < second.heapOffset + second.allocation.SizeInBytes &&
+                second.heapOffset < first.heapOffset + first.allocation.SizeInBytes)
+            {
+                first.aliased  = true;
+                second.aliased = true;
+            }
+        }
+    }
+
+    for (PassType &pass : m_passes)
+    {
+        pass.firstUses.clear();
+    }
+    for (UINT index : placed)
+    {
+        m_passes[m_schedule[m_resources[index].firstUse]].firstUses.push_back(index);
+    }
+}
+
+
+D3D12_RESOURCE_STATES RenderGraphClass::GetDiscardState(const D3D12_RESOURCE_DESC &desc)
+{
+    // Transients are either depth stencils or render targets.
+    return desc.Flags & D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL ? D3D12_RESOURCE_STATE_DEPTH_WRITE : D3D12_RESOURCE_STATE_RENDER_TARGET;
+}
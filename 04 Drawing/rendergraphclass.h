@@ -0,0 +1,135 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: rendergraphclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <cstring>
+#include "pipelineclass.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: RenderGraphClass
+////////////////////////////////////////////////////////////////////////////////
+class RenderGraphClass
+{
+public:
+    using ExecuteType = std::function<void(PipelineClass *)>;
+
+    struct StatisticsType
+    {
+        UINT   passCount      = 0u;
+        UINT   culledCount    = 0u;
+        UINT   barrierCount   = 0u;
+        UINT   transientCount = 0u;
+        UINT64 transientBytes = 0ull;
+        UINT64 heapBytes      = 0ull;
+        double compileSeconds = 0.0;
+    };
+
+private:
+    struct UseType
+    {
+        UINT                  resource = 0u;
+        D3D12_RESOURCE_STATES state    = D3D12_RESOURCE_STATE_COMMON;
+        bool                  write    = false;
+    };
+
+    struct TransitionType
+    {
+        UINT                  resource = 0u;
+        D3D12_RESOURCE_STATES state    = D3D12_RESOURCE_STATE_COMMON;
+    };
+
+    struct PassType
+    {
+        const char  *name        = nullptr;
+        ExecuteType  execute     = nullptr;
+        bool         sideEffects = false;
+
+        std::vector<UseType> uses = {};
+
+        // Filled in by compiling: whether the pass is needed at all, the transitions it has to make
+        // before it runs, and the transient textures it is the first to use.
+        bool                        culled      = false;
+        std::vector<TransitionType> transitions = {};
+        std::vector<UINT>           firstUses   = {};
+    };
+
+    struct ResourceType
+    {
+        const char                     *name         = nullptr;
+        bool                            imported     = false;
+        D3D12_RESOURCE_STATES           initialState = D3D12_RESOURCE_STATE_COMMON;
+        D3D12_RESOURCE_DESC             desc         = {};
+        D3D12_RESOURCE_ALLOCATION_INFO  allocation   = {};
+
+        // Filled in by compiling: where in the schedule the resource is first and last used, the
+        // state it is left in, and where it lives in the transient heap.
+        UINT                   firstUse   = NO_USE;
+        UINT                   lastUse    = NO_USE;
+        D3D12_RESOURCE_STATES  finalState = D3D12_RESOURCE_STATE_COMMON;
+        UINT64                 heapOffset = 0ull;
+        bool                   aliased    = false;
+
+        ID3D12Resource         *resource = nullptr;
+        ComPtr<ID3D12Resource>  placed   = nullptr;
+    };
+
+public:
+    RenderGraphClass(const RenderGraphClass &) = delete;
+    RenderGraphClass & operator=(const RenderGraphClass &) = delete;
+
+    RenderGraphClass() = default;
+    ~RenderGraphClass() = default;
+
+    UINT ImportResource(const char *, D3D12_RESOURCE_STATES);
+    UINT CreateTexture(const char *, const D3D12_RESOURCE_DESC &, const D3D12_RESOURCE_ALLOCATION_INFO &);
+    UINT AddPass(const char *, ExecuteType, bool = false);
+    void Read(UINT, UINT, D3D12_RESOURCE_STATES);
+    void Write(UINT, UINT, D3D12_RESOURCE_STATES);
+
+    void Compile();
+    void Realize(ID3D12Device *, ResourceStateTrackerClass *);
+
+    void SetResource(UINT, ID3D12Resource *);
+    ID3D12Resource * GetResource(UINT);
+    UINT64 GetHeapOffset(UINT);
+
+    void Execute(PipelineClass *);
+
+    const std::vector<UINT> & GetSchedule();
+    StatisticsType GetStatistics();
+
+private:
+    void AddUse(UINT, UINT, D3D12_RESOURCE_STATES, bool);
+
+    void CullPasses();
+    void SchedulePasses();
+    void PlanTransitions();
+    void PlaceTransients();
+
+    static D3D12_RESOURCE_STATES GetDiscardState(const D3D12_RESOURCE_DESC &);
+
+private:
+    // Marks a resource the schedule never uses.
+    static constexpr UINT NO_USE = ~0u;
+
+    std::vector<PassType>     m_passes    = {};
+    std::vector<ResourceType> m_resources = {};
+
+    // The passes that survived culling, in the order they run.
+    std::vector<UINT> m_schedule = {};
+
+    ComPtr<ID3D12Heap> m_heap       = nullptr;
+    UINT64             m_heapSize   = 0ull;
+    StatisticsType     m_statistics = {};
+
+    // Set when the transients were just placed and hold nothing yet, so the next frame discards
+    // every one of them and not only the aliased ones.
+    bool m_uninitialized = false;
+};
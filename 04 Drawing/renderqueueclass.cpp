@@ -0,0 +1,189 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: renderqueueclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "renderqueueclass.h"
+
+
+RenderQueueClass::RenderQueueClass(UINT capacity)
+    : m_capacity(capacity)
+{
+    // Size everything up front, so submitting and sorting never allocate.
+    m_packets.resize(m_capacity);
+    m_sorted.resize(m_capacity);
+    m_scratch.resize(m_capacity);
+}
+
+
+uint64_t RenderQueueClass::MakeSortKey(UINT rootSignatureId, UINT stateId, UINT bufferId, float depth)
+{
+    // Quantize the depth, clamped to the unit range, so that nearer draws sort first.
+    const float    clampedDepth = depth < 0.0f ? 0.0f : (depth > 1.0f ? 1.0f : depth);
+    const uint64_t depthBits    = static_cast<uint64_t>(clampedDepth * static_cast<float>((1u << DEPTH_BITS) - 1u));
+
+    // Ids too large for their field wrap around, which only costs some grouping.
+    return (static_cast<uint64_t>(rootSignatureId & ((1u << ROOT_SIGNATURE_BITS) - 1u)) << ROOT_SIGNATURE_SHIFT)
+         | (static_cast<uint64_t>(stateId         & ((1u << STATE_BITS) - 1u))          << STATE_SHIFT)
+         | (static_cast<uint64_t>(bufferId        & ((1u << BUFFER_BITS) - 1u))         << BUFFER_SHIFT)
+         | (depthBits << DEPTH_SHIFT);
+}
+
+
+uint64_t RenderQueueClass::MakeSortKey(RenderContextInterface *context, GeometryInterface *geometry, float depth)
+{
+    // Look up the ids of the objects the draw will bind, handing out new ones for any we have not
+    // seen before.
+    std::lock_guard<std::mutex> lock(m_idMutex);
+    return MakeSortKey(GetSortId(m_rootSignatureIds, context->GetRootSignature(), ROOT_SIGNATURE_BITS),
+                       GetSortId(m_stateIds, context->GetState(), STATE_BITS),
+                       GetSortId(m_bufferIds, geometry->GetVertexBuffer(), BUFFER_BITS),
+                       depth);
+}
+
+
+void RenderQueueClass::Reset()
+{
+    // Start a new frame with an empty queue.
+    m_packetCount.store(0u);
+    m_sortedCount = 0u;
+}
+
+
+void RenderQueueClass::Submit(const DrawPacketType &packet)
+{
+    // Claim the next slot; any number of threads can submit at once.
+    const UINT index = m_packetCount.fetch_add(1u);
+    THROW_IF_TRUE(
+        index >= m_capacity,
+        "The render queue is out of room for this frame's draws."
+    );
+
+    m_packets[index] = packet;
+}
+
+
+void RenderQueueClass::Sort()
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    const UINT count = GetPacketCount();
+    for (UINT i = 0u; i < count; ++i)
+    {
+        m_sorted[i].key   = m_packets[i].sortKey;
+        m_sorted[i].index = i;
+    }
+
+    // A least significant digit radix sort, one byte of the key per pass.  It is stable, so
+    // packets with equal keys keep the order they were submitted in.
+    for (UINT shift = 0u; count && shift < 64u; shift += RADIX_BITS)
+    {
+        UINT histogram[RADIX_BUCKETS] = {};
+        for (UINT i = 0u; i < count; ++i)
+        {
+            ++histogram[(m_sorted[i].key >> shift) & (RADIX_BUCKETS - 1u)];
+        }
+
+        // Keys mostly differ in only a few of their bytes.  Passes over a byte every key shares
+        // would not change the order, so skip them.
+        if (histogram[(m_sorted[0].key >> shift) & (RADIX_BUCKETS - 1u)] == count)
+        {
+            continue;
+        }
+
+        // Turn the counts into the offset where each bucket starts, then scatter the entries.
+        UINT offset = 0u;
+        for (UINT &bucket : histogram)
+        {
+            const UINT bucketCount = bucket;
+            bucket  = offset;
+            offset += bucketCount;
+        }
+
+        for (UINT i = 0u; i < count; ++i)
+        {
+            m_scratch[histogram[(m_sorted[i].key >> shift) & (RADIX_BUCKETS - 1u)]++] = m_sorted[i];
+        }
+        m_sorted.swap(m_scratch);
+    }
+
+    m_sortedCount = count;
+    m_sortSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+void RenderQueueClass::Record(PipelineClass *pipeline, UINT first, UINT last, ProfilerClass *profiler)
+{
+    RenderContextInterface *context = nullptr;
+    for (UINT i = first; i < last && i < m_sortedCount; ++i)
+    {
+        const DrawPacketType &packet = m_packets[m_sorted[i].index];
+
+        // Only bind a context's state and parameters when it differs from the last packet's.
+        // The pipeline drops whatever redundant state the contexts and geometry still set.
+        if (packet.context != context)
+        {
+            ProfilerClass::ScopeType scope(profiler, "SetShaderParameters");
+            context = packet.context;
+            pipeline->SetState(context->GetState());
+            context->SetShaderParameters(pipeline);
+        }
+
+        ProfilerClass::ScopeType scope(profiler, "Geometry Render");
+        context->SetObjectIndex(pipeline, packet.objectIndex);
+        packet.geometry->Render(pipeline);
+    }
+}
+
+
+UINT RenderQueueClass::GetPacketCount()
+{
+    const UINT count = m_packetCount.load();
+    return count < m_capacity ? count : m_capacity;
+}
+
+
+const RenderQueueClass::DrawPacketType & RenderQueueClass::GetPacket(UINT index)
+{
+    // Packets come out in the order they would be recorded: sorted once Sort has run, and in
+    // submission order before that.
+    return m_sortedCount == GetPacketCount() ? m_packets[m_sorted[index].index] : m_packets[index];
+}
+
+
+RenderQueueClass::StateChangeType RenderQueueClass::CountStateChanges()
+{
+    // Walk the packets in the order they would be recorded: sorted once Sort has run, and in
+    // submission order before that.
+    const UINT count  = GetPacketCount();
+    const bool sorted = m_sortedCount == count;
+
+    StateChangeType changes;
+    uint64_t previousKey = 0ull;
+    for (UINT i = 0u; i < count; ++i)
+    {
+        const uint64_t key = sorted ? m_sorted[i].key : m_packets[i].sortKey;
+
+        // The first packet binds everything.
+        const uint64_t changed = i ? key ^ previousKey : ~0ull;
+        changes.rootSignatures += (changed >> ROOT_SIGNATURE_SHIFT) & ((1u << ROOT_SIGNATURE_BITS) - 1u) ? 1u : 0u;
+        changes.states         += (changed >> STATE_SHIFT)          & ((1u << STATE_BITS) - 1u)          ? 1u : 0u;
+        changes.vertexBuffers  += (changed >> BUFFER_SHIFT)         & ((1u << BUFFER_BITS) - 1u)         ? 1u : 0u;
+        previousKey = key;
+    }
+
+    return changes;
+}
+
+
+double RenderQueueClass::GetSortSeconds()
+{
+    return m_sortSeconds;
+}
+
+
+UINT RenderQueueClass::GetSortId(std::unordered_map<const void *, UINT> &ids, const void *object, UINT bits)
+{
+    // Ids are handed out in the order objects are first seen, and stay the same from then on.
+    auto inserted = ids.emplace(object, static_cast<UINT>(ids.size()));
+    return inserted.first->second & ((1u << bits) - 1u);
+}
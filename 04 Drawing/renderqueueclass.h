@@ -0,0 +1,104 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: renderqueueclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <unordered_map>
+#include "rendercontextinterface.h"
+#include "geometryinterface.h"
+#include "profilerclass.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: RenderQueueClass
+////////////////////////////////////////////////////////////////////////////////
+class RenderQueueClass
+{
+public:
+    // Everything needed to record one draw.  Packets are recorded in the order of their sort keys.
+    struct DrawPacketType
+    {
+        uint64_t                sortKey     = 0ull;
+        RenderContextInterface *context     = nullptr;
+        GeometryInterface      *geometry    = nullptr;
+        UINT                    objectIndex = 0u;
+    };
+
+    // How often consecutive packets switch root signature, pipeline state or vertex buffer.
+    struct StateChangeType
+    {
+        UINT rootSignatures = 0u;
+        UINT states         = 0u;
+        UINT vertexBuffers  = 0u;
+    };
+
+private:
+    struct SortEntryType
+    {
+        uint64_t key   = 0ull;
+        UINT     index = 0u;
+    };
+
+public:
+    RenderQueueClass(const RenderQueueClass &) = delete;
+    RenderQueueClass & operator=(const RenderQueueClass &) = delete;
+
+    RenderQueueClass(UINT = 131'072u);
+    ~RenderQueueClass() = default;
+
+    static uint64_t MakeSortKey(UINT, UINT, UINT, float);
+    uint64_t MakeSortKey(RenderContextInterface *, GeometryInterface *, float);
+
+    void Reset();
+    void Submit(const DrawPacketType &);
+    void Sort();
+    void Record(PipelineClass *, UINT, UINT, ProfilerClass * = nullptr);
+
+    UINT GetPacketCount();
+    const DrawPacketType & GetPacket(UINT);
+    StateChangeType CountStateChanges();
+    double GetSortSeconds();
+
+private:
+    UINT GetSortId(std::unordered_map<const void *, UINT> &, const void *, UINT);
+
+private:
+    // The sort key, from the most to the least significant bits: root signature, pipeline state,
+    // vertex buffer, and depth.  Changing a root signature costs the most, since it throws away
+    // every root argument, so it is grouped first.
+    static constexpr UINT ROOT_SIGNATURE_BITS = 8u;
+    static constexpr UINT STATE_BITS          = 16u;
+    static constexpr UINT BUFFER_BITS         = 16u;
+    static constexpr UINT DEPTH_BITS          = 24u;
+
+    static constexpr UINT DEPTH_SHIFT          = 0u;
+    static constexpr UINT BUFFER_SHIFT         = DEPTH_SHIFT + DEPTH_BITS;
+    static constexpr UINT STATE_SHIFT          = BUFFER_SHIFT + BUFFER_BITS;
+    static constexpr UINT ROOT_SIGNATURE_SHIFT = STATE_SHIFT + STATE_BITS;
+
+    // The keys are sorted one byte at a time.
+    static constexpr UINT RADIX_BITS    = 8u;
+    static constexpr UINT RADIX_BUCKETS = 1u << RADIX_BITS;
+
+    const UINT m_capacity = 0u;
+
+    std::vector<DrawPacketType> m_packets     = {};
+    std::atomic<UINT>           m_packetCount = { 0u };
+
+    std::vector<SortEntryType> m_sorted      = {};
+    std::vector<SortEntryType> m_scratch     = {};
+    UINT                       m_sortedCount = 0u;
+
+    // Small, stable ids for the root signatures, states and buffers seen so far, so that they fit
+    // into the sort key.
+    std::mutex                             m_idMutex          = {};
+    std::unordered_map<const void *, UINT> m_rootSignatureIds = {};
+    std::unordered_map<const void *, UINT> m_stateIds         = {};
+    std::unordered_map<const void *, UINT> m_bufferIds        = {};
+
+    double m_sortSeconds = 0.0;
+};
@@ -0,0 +1,407 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: resourcestatetrackerclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "resourcestatetrackerclass.h"
+
+
+ResourceStateTrackerClass::ResourceStateTrackerClass(const ResourceStateTrackerClass *parent)
+    : p_parent(parent)
+{
+}
+
+
+void ResourceStateTrackerClass::Register(ID3D12Resource *resource, D3D12_RESOURCE_STATES state)
+{
+    // Resources that are not created in the common state have to tell us where they start.
+    Remove(resource);
+
+    StateType entry;
+    entry.resource = resource;
+    entry.state    = state;
+    entry.decays   = Decays(resource);
+    m_states.push_back(entry);
+}
+
+
+void ResourceStateTrackerClass::Transition(ID3D12Resource *resource, D3D12_RESOURCE_STATES state, UINT subresource)
+{
+    Track(resource);
+
+    if (subresource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES)
+    {
+        // Subresources that have come apart each need a barrier of their own, unless they all
+        // ended up in the same state again.
+        Collapse(resource);
+        for (StateType &entry : m_states)
+        {
+            if (entry.resource == resource)
+            {
+                Apply(entry, state);
+            }
+        }
+        Collapse(resource);
+    }
+    else
+    {
+        // Give every subresource an entry of its own before moving just the one.
+        Split(resource);
+        StateType *entry = Find(resource, subresource);
+        Apply(entry ? *entry : *Find(resource, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES), state);
+    }
+}
+
+
+void ResourceStateTrackerClass::BeginTransition(ID3D12Resource *resource, D3D12_RESOURCE_STATES state, UINT subresource)
+{
+    // Start the transition now, and let the next transition of the resource to the same state end
+    // it.  The resource may not be used in between, which leaves the GPU free to do the work in the
+    // background.
+    Track(resource);
+
+    if (subresource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES)
+    {
+        Collapse(resource);
+        for (StateType &entry : m_states)
+        {
+            if (entry.resource == resource)
+            {
+                Begin(entry, state);
+            }
+        }
+    }
+    else
+    {
+        Split(resource);
+        StateType *entry = Find(resource, subresource);
+        Begin(entry ? *entry : *Find(resource, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES), state);
+    }
+}
+
+
+void ResourceStateTrackerClass::AddUavBarrier(ID3D12Resource *resource)
+{
+    // Make the writes of an unordered access visible to whatever reads or writes the resource next.
+    D3D12_RESOURCE_BARRIER barrier{};
+    barrier.Type          = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+    barrier.Flags         = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+    barrier.UAV.pResource = resource;
+    m_barriers.push_back(barrier);
+}
+
+
+void ResourceStateTrackerClass::AddAliasingBarrier(ID3D12Resource *before, ID3D12Resource *after)
+{
+    // Hand memory shared by placed resources over from one to the other.  Leaving out the one
+    // before means any resource that used the memory.
+    D3D12_RESOURCE_BARRIER barrier{};
+    barrier.Type                     = D3D12_RESOURCE_BARRIER_TYPE_ALIASING;
+    barrier.Flags                    = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+    barrier.Aliasing.pResourceBefore = before;
+    barrier.Aliasing.pResourceAfter  = after;
+    m_barriers.push_back(barrier);
+}
+
+
+void ResourceStateTrackerClass::EndTransitions()
+{
+    // A list has to end every split barrier it began before it is closed.
+    for (StateType &entry : m_states)
+    {
+        if (entry.splitState != NO_SPLIT)
+        {
+            Apply(entry, entry.splitState);
+        }
+    }
+}
+
+
+UINT ResourceStateTrackerClass::GetBarrierCount()
+{
+    return static_cast<UINT>(m_barriers.size());
+}
+
+
+const D3D12_RESOURCE_BARRIER * ResourceStateTrackerClass::GetBarriers()
+{
+    return m_barriers.data();
+}
+
+
+void ResourceStateTrackerClass::ClearBarriers()
+{
+    m_barriers.clear();
+}
+
+
+void ResourceStateTrackerClass::Reset()
+{
+    // Forget everything the list did, keeping the memory for the next time it is recorded.
+    m_states.clear();
+    m_barriers.clear();
+}
+
+
+void ResourceStateTrackerClass::Commit(const ResourceStateTrackerClass *list)
+{
+    // The list executes after everything committed so far, so whatever it leaves a resource in
+    // replaces what we knew about it.  Lists have to be committed in the order they execute, and
+    // never while another list is reading from us.
+    for (size_t i = 0; i < list->m_states.size(); ++i)
+    {
+        const StateType &entry = list->m_states[i];
+
+        bool first = true;
+        for (size_t j = 0; j < i && first; ++j)
+        {
+            first = list->m_states[j].resource != entry.resource;
+        }
+        if (first)
+        {
+            Remove(entry.resource);
+        }
+
+        m_states.push_back(entry);
+        m_states.back().splitState = NO_SPLIT;
+    }
+}
+
+
+void ResourceStateTrackerClass::Decay()
+{
+    // Buffers, and textures that allow simultaneous access, fall back to the common state once the
+    // lists using them have finished executing, which is also where untracked resources start.
+    m_states.erase(std::remove_if(m_states.begin(), m_states.end(), [](const StateType &entry) { return entry.decays; }), m_states.end());
+}
+
+
+void ResourceStateTrackerClass::Track(ID3D12Resource *resource)
+{
+    // The first time we see a resource, pick it up where our parent left it, or in the common
+    // state if nobody knows about it yet.
+    for (const StateType &entry : m_states)
+    {
+        if (entry.resource == resource)
+        {
+            return;
+        }
+    }
+
+    bool found = false;
+    if (p_parent)
+    {
+        for (const StateType &entry : p_parent->m_states)
+        {
+            if (entry.resource == resource)
+            {
+                m_states.push_back(entry);
+                m_states.back().splitState = NO_SPLIT;
+                found = true;
+            }
+        }
+    }
+
+    if (!found)
+    {
+        StateType entry;
+        entry.resource = resource;
+        entry.decays   = Decays(resource);
+        m_states.push_back(entry);
+    }
+}
+
+
+void ResourceStateTrackerClass::Split(ID3D12Resource *resource)
+{
+    // Nothing to do if the resource is already split up, or has only the one subresource.
+    StateType *whole = Find(resource, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES);
+    const UINT subresourceCount = GetSubresourceCount(resource);
+    if (!whole || subresourceCount == 1u)
+    {
+        return;
+    }
+
+    // A split barrier that covers every subresource has to be ended the same way.
+    if (whole->splitState != NO_SPLIT)
+    {
+        Apply(*whole, whole->splitState);
+    }
+
+    StateType entry = *whole;
+    whole->subresource = 0u;
+    for (UINT i = 1u; i < subresourceCount; ++i)
+    {
+        entry.subresource = i;
+        m_states.push_back(entry);
+    }
+}
+
+
+void ResourceStateTrackerClass::Collapse(ID3D12Resource *resource)
+{
+    // Fold the subresources back into a single entry once they all share one state again.
+    StateType *first = nullptr;
+    for (StateType &entry : m_states)
+    {
+        if (entry.resource != resource)
+        {
+            continue;
+        }
+        if (!first)
+        {
+            first = &entry;
+        }
+        else if (entry.state != first->state || entry.splitState != NO_SPLIT || first->splitState != NO_SPLIT)
+        {
+            return;
+        }
+    }
+
+    if (!first || first->subresource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES)
+    {
+        return;
+    }
+
+    StateType whole = *first;
+    whole.subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+    Remove(resource);
+    m_states.push_back(whole);
+}
+
+
+ResourceStateTrackerClass::StateType * ResourceStateTrackerClass::Find(ID3D12Resource *resource, UINT subresource)
+{
+    for (StateType &entry : m_states)
+    {
+        if (entry.resource == resource && entry.subresource == subresource)
+        {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+
+void ResourceStateTrackerClass::Apply(StateType &entry, D3D12_RESOURCE_STATES state)
+{
+    // Finish a split barrier under way first.  If it was heading somewhere else, carry on from there.
+    // A split that has not gone out yet gained nothing, so it becomes an ordinary barrier instead.
+    if (entry.splitState != NO_SPLIT)
+    {
+        D3D12_RESOURCE_BARRIER *begin = nullptr;
+        for (D3D12_RESOURCE_BARRIER &barrier : m_barriers)
+        {
+            if (barrier.Type == D3D12_RESOURCE_BARRIER_TYPE_TRANSITION && barrier.Flags == D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY &&
+                barrier.Transition.pResource == entry.resource && barrier.Transition.Subresource == entry.subresource)
+            {
+                begin = &barrier;
+            }
+        }
+
+        if (begin)
+        {
+            begin->Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+        }
+        else
+        {
+            AddTransition(entry, entry.state, entry.splitState, D3D12_RESOURCE_BARRIER_FLAG_END_ONLY);
+        }
+        entry.state      = entry.splitState;
+        entry.splitState = NO_SPLIT;
+    }
+
+    if (entry.state == state)
+    {
+        return;
+    }
+
+    // Nothing can have used the resource since a barrier still waiting in the batch, so that
+    // barrier can go straight to the new state, or be dropped if it now goes nowhere.
+    for (size_t i = m_barriers.size(); i-- > 0;)
+    {
+        D3D12_RESOURCE_BARRIER &barrier = m_barriers[i];
+        if (barrier.Type != D3D12_RESOURCE_BARRIER_TYPE_TRANSITION || barrier.Transition.pResource != entry.resource)
+        {
+            continue;
+        }
+
+        if (barrier.Flags == D3D12_RESOURCE_BARRIER_FLAG_NONE && barrier.Transition.Subresource == entry.subresource)
+        {
+            barrier.Transition.StateAfter = state;
+            if (barrier.Transition.StateBefore == state)
+            {
+                m_barriers.erase(m_barriers.begin() + i);
+            }
+            entry.state = state;
+            return;
+        }
+        break;
+    }
+
+    AddTransition(entry, entry.state, state, D3D12_RESOURCE_BARRIER_FLAG_NONE);
+    entry.state = state;
+}
+
+
+void ResourceStateTrackerClass::Begin(StateType &entry, D3D12_RESOURCE_STATES state)
+{
+    // A resource can only be in the middle of one transition at a time.
+    if (entry.splitState != NO_SPLIT)
+    {
+        Apply(entry, entry.splitState);
+    }
+
+    if (entry.state == state)
+    {
+        return;
+    }
+
+    AddTransition(entry, entry.state, state, D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY);
+    entry.splitState = state;
+}
+
+
+void ResourceStateTrackerClass::AddTransition(const StateType            &entry,
+                                              D3D12_RESOURCE_STATES        stateBefore,
+                                              D3D12_RESOURCE_STATES        stateAfter,
+                                              D3D12_RESOURCE_BARRIER_FLAGS flags)
+{
+    D3D12_RESOURCE_BARRIER barrier{};
+    barrier.Flags                  = flags;
+    barrier.Transition.pResource   = entry.resource;
+    barrier.Transition.StateBefore = stateBefore;
+    barrier.Transition.StateAfter  = stateAfter;
+    barrier.Transition.Subresource = entry.subresource;
+    barrier.Type                   = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+    m_barriers.push_back(barrier);
+}
+
+
+void ResourceStateTrackerClass::Remove(ID3D12Resource *resource)
+{
+    m_states.erase(std::remove_if(m_states.begin(), m_states.end(), [resource](const StateType &entry) { return entry.resource == resource; }), m_states.end());
+}
+
+
+bool ResourceStateTrackerClass::Decays(ID3D12Resource *resource)
+{
+    const D3D12_RESOURCE_DESC desc = resource->GetDesc();
+    return desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER || (desc.Flags & D3D12_RESOURCE_FLAG_ALLOW_SIMULTANEOUS_ACCESS) != 0;
+}
+
+
+UINT ResourceStateTrackerClass::GetSubresourceCount(ID3D12Resource *resource)
+{
+    // Every mip of every array slice is a subresource of its own.  Planar formats are tracked as a
+    // single plane.
+    const D3D12_RESOURCE_DESC desc = resource->GetDesc();
+    switch (desc.Dimension)
+    {
+    case D3D12_RESOURCE_DIMENSION_BUFFER:
+        return 1u;
+    case D3D12_RESOURCE_DIMENSION_TEXTURE3D:
+        return desc.MipLevels;
+    default:
+        return static_cast<UINT>(desc.MipLevels) * desc.DepthOrArraySize;
+    }
+}
@@ -0,0 +1,77 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: resourcestatetrackerclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: ResourceStateTrackerClass
+////////////////////////////////////////////////////////////////////////////////
+class ResourceStateTrackerClass
+{
+public:
+    ResourceStateTrackerClass(const ResourceStateTrackerClass &) = delete;
+    ResourceStateTrackerClass & operator=(const ResourceStateTrackerClass &) = delete;
+
+    ResourceStateTrackerClass(const ResourceStateTrackerClass * = nullptr);
+    ~ResourceStateTrackerClass() = default;
+
+    void Register(ID3D12Resource *, D3D12_RESOURCE_STATES);
+
+    void Transition(ID3D12Resource *, D3D12_RESOURCE_STATES, UINT = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES);
+    void BeginTransition(ID3D12Resource *, D3D12_RESOURCE_STATES, UINT = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES);
+    void AddUavBarrier(ID3D12Resource *);
+    void AddAliasingBarrier(ID3D12Resource *, ID3D12Resource *);
+    void EndTransitions();
+
+    UINT GetBarrierCount();
+    const D3D12_RESOURCE_BARRIER * GetBarriers();
+    void ClearBarriers();
+
+    void Reset();
+    void Commit(const ResourceStateTrackerClass *);
+    void Decay();
+
+private:
+    struct StateType
+    {
+        ID3D12Resource        *resource    = nullptr;
+        UINT                   subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+        D3D12_RESOURCE_STATES  state       = D3D12_RESOURCE_STATE_COMMON;
+        D3D12_RESOURCE_STATES  splitState  = NO_SPLIT;
+        bool                   decays      = false;
+    };
+
+private:
+    void Track(ID3D12Resource *);
+    void Split(ID3D12Resource *);
+    void Collapse(ID3D12Resource *);
+    StateType * Find(ID3D12Resource *, UINT);
+
+    void Apply(StateType &, D3D12_RESOURCE_STATES);
+    void Begin(StateType &, D3D12_RESOURCE_STATES);
+    void AddTransition(const StateType &, D3D12_RESOURCE_STATES, D3D12_RESOURCE_STATES, D3D12_RESOURCE_BARRIER_FLAGS);
+    void Remove(ID3D12Resource *);
+
+    static bool Decays(ID3D12Resource *);
+    static UINT GetSubresourceCount(ID3D12Resource *);
+
+private:
+    // Marks a state with no split barrier under way.
+    static constexpr D3D12_RESOURCE_STATES NO_SPLIT = static_cast<D3D12_RESOURCE_STATES>(-1);
+
+    // Where the resources this tracker has not touched yet start out.  A list's tracker starts from
+    // what the lists submitted before it leave behind.
+    const ResourceStateTrackerClass *p_parent = nullptr;
+
+    // The state of every resource we have touched, either as a whole or one entry per subresource,
+    // and the barriers waiting to go out with the next batch.
+    std::vector<StateType>              m_states   = {};
+    std::vector<D3D12_RESOURCE_BARRIER> m_barriers = {};
+};
@@ -1,22 +1,22 @@
-////////////////////////////////////////////////////////////////////////////////
-// Filename: color.ps.hlsl
-////////////////////////////////////////////////////////////////////////////////
-
-
-//////////////
-// TYPEDEFS //
-//////////////
-struct PixelInputType
-{
-    float4 position : SV_POSITION;
-    float4 color    : COLOR;
-};
-
-
-////////////////////////////////////////////////////////////////////////////////
-// Pixel Shader
-////////////////////////////////////////////////////////////////////////////////
-float4 PSMain(PixelInputType input) : SV_TARGET
-{
-    return input.color;
-}
+////////////////////////////////////////////////////////////////////////////////
+// Filename: color.ps.hlsl
+////////////////////////////////////////////////////////////////////////////////
+
+
+//////////////
+// TYPEDEFS //
+//////////////
+struct PixelInputType
+{
+    float4 position : SV_POSITION;
+    float4 color    : COLOR;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Pixel Shader
+////////////////////////////////////////////////////////////////////////////////
+float4 PSMain(PixelInputType input) : SV_TARGET
+{
+    return input.color;
+}
@@ -1,51 +1,66 @@
-////////////////////////////////////////////////////////////////////////////////
-// Filename: color.vs.hlsl
-////////////////////////////////////////////////////////////////////////////////
-
-
-/////////////
-// GLOBALS //
-/////////////
-cbuffer MatrixBuffer : register(b0)
-{
-    matrix worldMatrix;
-    matrix viewMatrix;
-    matrix projectionMatrix;
-};
-
-
-//////////////
-// TYPEDEFS //
-//////////////
-struct VertexInputType
-{
-    float4 position : POSITION;
-    float4 color    : COLOR;
-};
-
-struct PixelInputType
-{
-    float4 position : SV_POSITION;
-    float4 color    : COLOR;
-};
-
-
-////////////////////////////////////////////////////////////////////////////////
-// Vertex Shader
-////////////////////////////////////////////////////////////////////////////////
-PixelInputType VSMain(VertexInputType input)
-{
-    // Convert the position vector to homogeneous coordinates for matrix calculations.
-    input.position.w = 1.0f;
-
-    // Calculate the position of the vertex against the world, view, and projection matrices.
-    PixelInputType output;
-    output.position = mul(input.position, worldMatrix);
-    output.position = mul(output.position, viewMatrix);
-    output.position = mul(output.position, projectionMatrix);
-
-    // Store the input color for the pixel shader to use.
-    output.color = input.color;
-
-    return output;
-}
+////////////////////////////////////////////////////////////////////////////////
+// Filename: color.vs.hlsl
+////////////////////////////////////////////////////////////////////////////////
+
+
+/////////////
+// GLOBALS //
+/////////////
+cbuffer FrameBuffer : register(b0)
+{
+    matrix viewProjectionMatrix;
+};
+
+cbuffer ObjectBuffer : register(b1)
+{
+    uint objectIndex;
+};
+
+struct ObjectType
+{
+    matrix world;
+    float4 positionScale;
+    float4 positionBias;
+};
+
+StructuredBuffer<ObjectType> objects : register(t0);
+
+
+//////////////
+// TYPEDEFS //
+//////////////
+struct VertexInputType
+{
+    float4 position : POSITION;
+    float4 color    : COLOR;
+};
+
+struct PixelInputType
+{
+    float4 position : SV_POSITION;
+    float4 color    : COLOR;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Vertex Shader
+////////////////////////////////////////////////////////////////////////////////
+PixelInputType VSMain(VertexInputType input)
+{
+    // Unpack the position into the object's space, and convert it to homogeneous coordinates for
+    // matrix calculations.
+    ObjectType object = objects[objectIndex];
+    input.position.xyz = input.position.xyz * object.positionScale.xyz + object.positionBias.xyz;
+    input.position.w   = 1.0f;
+
+    // Calculate the position of the vertex against this object's world matrix, then the combined
+    // view and projection matrix.
+    PixelInputType output;
+    output.position = mul(input.position, object.world);
+    output.position = mul(output.position, viewProjectionMatrix);
+
+    // Store the input color for the pixel shader to use.
+    output.color = input.color;
+
+    return output;
+}
@@ -0,0 +1,64 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: cull.cs.hlsl
+////////////////////////////////////////////////////////////////////////////////
+
+
+/////////////
+// DEFINES //
+/////////////
+#define THREAD_GROUP_SIZE 64
+
+
+//////////////
+// TYPEDEFS //
+//////////////
+struct InstanceType
+{
+    float3 position;
+    float3 hsv;
+};
+
+
+/////////////
+// GLOBALS //
+/////////////
+cbuffer CullBuffer : register(b0)
+{
+    float4 frustumPlanes[6];
+    uint   instanceCount;
+    float  instanceRadius;
+};
+
+StructuredBuffer<InstanceType>   instances        : register(t0);
+RWStructuredBuffer<InstanceType> visibleInstances : register(u0);
+RWByteAddressBuffer              drawArguments    : register(u1);
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Compute Shader
+////////////////////////////////////////////////////////////////////////////////
+[numthreads(THREAD_GROUP_SIZE, 1, 1)]
+void CSMain(uint3 dispatchThreadID : SV_DispatchThreadID)
+{
+    // The last group may run past the end of the instances.
+    if (dispatchThreadID.x >= instanceCount)
+    {
+        return;
+    }
+
+    // The instance is visible unless its bounding sphere is entirely behind one of the planes.
+    InstanceType instance = instances[dispatchThreadID.x];
+    for (uint i = 0; i < 6; ++i)
+    {
+        if (dot(frustumPlanes[i].xyz, instance.position) + frustumPlanes[i].w < -instanceRadius)
+        {
+            return;
+        }
+    }
+
+    // Claim the next slot by bumping the instance count of the draw arguments, which sits four
+    // bytes in, and copy the instance into it.
+    uint slot;
+    drawArguments.InterlockedAdd(4, 1, slot);
+    visibleInstances[slot] = instance;
+}
@@ -1,60 +1,75 @@
-////////////////////////////////////////////////////////////////////////////////
-// Filename: instance.vs.hlsl
-////////////////////////////////////////////////////////////////////////////////
-
-
-/////////////
-// GLOBALS //
-/////////////
-cbuffer MatrixBuffer : register(b0)
-{
-    matrix worldMatrix;
-    matrix viewMatrix;
-    matrix projectionMatrix;
-};
-
-
-//////////////
-// TYPEDEFS //
-//////////////
-struct VertexInputType
-{
-    float4 position         : POSITION0;
-    float4 color            : COLOR0;
-    float4 instancePosition : POSITION1;
-    float3 instanceHSV      : COLOR1;
-};
-
-struct PixelInputType
-{
-    float4 position : SV_POSITION;
-    float4 color    : COLOR0;
-    float3 HSV      : COLOR1;
-};
-
-
-////////////////////////////////////////////////////////////////////////////////
-// Vertex Shader
-////////////////////////////////////////////////////////////////////////////////
-PixelInputType VSMain(VertexInputType input)
-{
-    // Convert the position vector to homogeneous coordinates for matrix calculations.
-    input.position.w = 1.0f;
-
-    // Update the position of the vertices based on the data for this particular instance.
-    input.position.xyz += input.instancePosition.xyz;
-
-    // Calculate the position of the vertex against the world, view, and projection matrices.
-    PixelInputType output;
-    output.position = mul(input.position, worldMatrix);
-    output.position = mul(output.position, viewMatrix);
-    output.position = mul(output.position, projectionMatrix);
-
-    // Store the input color for the pixel shader to use.
-    output.color = input.color;
-
-    // Pass along the HSV for the pixel shader to use.
-    output.HSV = input.instanceHSV;
-
-    return output;
-}
+////////////////////////////////////////////////////////////////////////////////
+// Filename: instance.vs.hlsl
+////////////////////////////////////////////////////////////////////////////////
+
+
+/////////////
+// GLOBALS //
+/////////////
+cbuffer FrameBuffer : register(b0)
+{
+    matrix viewProjectionMatrix;
+};
+
+cbuffer ObjectBuffer : register(b1)
+{
+    uint objectIndex;
+};
+
+struct ObjectType
+{
+    matrix world;
+    float4 positionScale;
+    float4 positionBias;
+};
+
+StructuredBuffer<ObjectType> objects : register(t0);
+
+
+//////////////
+// TYPEDEFS //
+//////////////
+struct VertexInputType
+{
+    float4 position         : POSITION0;
+    float4 color            : COLOR0;
+    float4 instancePosition : POSITION1;
+    float3 instanceHSV      : COLOR1;
+};
+
+struct PixelInputType
+{
+    float4 position : SV_POSITION;
+    float4 color    : COLOR0;
+    float3 HSV      : COLOR1;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Vertex Shader
+////////////////////////////////////////////////////////////////////////////////
+PixelInputType VSMain(VertexInputType input)
+{
+    // Unpack the position into the object's space, and convert it to homogeneous coordinates for
+    // matrix calculations.
+    ObjectType object = objects[objectIndex];
+    input.position.xyz = input.position.xyz * object.positionScale.xyz + object.positionBias.xyz;
+    input.position.w   = 1.0f;
+
+    // Update the position of the vertices based on the data for this particular instance.
+    input.position.xyz += input.instancePosition.xyz;
+
+    // Calculate the position of the vertex against this object's world matrix, then the combined
+    // view and projection matrix.
+    PixelInputType output;
+    output.position = mul(input.position, object.world);
+    output.position = mul(output.position, viewProjectionMatrix);
+
+    // Store the input color for the pixel shader to use.
+    output.color = input.color;
+
+    // Pass along the HSV for the pixel shader to use.
+    output.HSV = input.instanceHSV;
+
+    return output;
+}
@@ -0,0 +1,205 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: startupschedulerclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "startupschedulerclass.h"
+
+
+StartupSchedulerClass::StartupSchedulerClass(UINT threadCount)
+    : m_threadCount(threadCount ? threadCount : 1u)
+{
+}
+
+
+StartupSchedulerClass::~StartupSchedulerClass()
+{
+    // The tasks capture objects that are about to be released, so let every one of them finish.
+    // A failure has already been reported through Wait, or is of no interest while shutting down.
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_tasksDone.wait(lock, [this] { return !m_started || m_tasksRemaining == 0u; });
+    }
+
+    for (std::thread &thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+
+UINT StartupSchedulerClass::AddTask(const std::string &name, TaskType function, const std::vector<UINT> &dependencies)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    THROW_IF_TRUE(
+        m_started,
+        "Startup tasks cannot be added once the scheduler has started."
+    );
+
+    // Tasks can only depend on tasks added before them, which also rules out cycles.
+    const UINT index = static_cast<UINT>(m_tasks.size());
+    for (UINT dependency : dependencies)
+    {
+        THROW_IF_TRUE(
+            dependency >= index,
+            "A startup task depends on a task that does not exist yet."
+        );
+        m_tasks[dependency].dependents.push_back(index);
+    }
+
+    TaskEntryType task;
+    task.name                  = name;
+    task.function              = std::move(function);
+    task.remainingDependencies = static_cast<UINT>(dependencies.size());
+    m_tasks.push_back(std::move(task));
+    ++m_tasksRemaining;
+
+    return index;
+}
+
+
+void StartupSchedulerClass::Start()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_started   = true;
+        m_startTime = std::chrono::steady_clock::now();
+
+        // Queue up every task that does not wait on another one.
+        for (UINT i = 0u; i < static_cast<UINT>(m_tasks.size()); ++i)
+        {
+            if (m_tasks[i].remainingDependencies == 0u)
+            {
+                m_readyTasks.push_back(i);
+            }
+        }
+    }
+
+    // No more threads than tasks are ever useful.  The threads go away once every task is done.
+    const UINT taskCount   = static_cast<UINT>(m_tasks.size());
+    const UINT threadCount = m_threadCount < taskCount ? m_threadCount : taskCount;
+    for (UINT i = 0u; i < threadCount; ++i)
+    {
+        m_threads.emplace_back(&StartupSchedulerClass::WorkerLoop, this);
+    }
+}
+
+
+bool StartupSchedulerClass::IsComplete()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_started && m_tasksRemaining == 0u;
+}
+
+
+void StartupSchedulerClass::Wait()
+{
+    // Block until the last task is done, then surface the first failure on the calling thread.
+    std::exception_ptr exception;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        THROW_IF_FALSE(
+            m_started,
+            "The startup scheduler was never started."
+        );
+        m_tasksDone.wait(lock, [this] { return m_tasksRemaining == 0u; });
+        exception = m_exception;
+    }
+
+    if (exception)
+    {
+        std::rethrow_exception(exception);
+    }
+}
+
+
+double StartupSchedulerClass::GetElapsedSeconds()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_elapsedSeconds;
+}
+
+
+double StartupSchedulerClass::GetTaskSeconds(UINT index)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_tasks[index].seconds;
+}
+
+
+void StartupSchedulerClass::WorkerLoop()
+{
+    while (true)
+    {
+        // Sleep until a task is ready to run, or leave once there are none left.
+        UINT index = 0u;
+        TaskType *function = nullptr;
+        bool skip = false;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_taskReady.wait(lock, [this] { return !m_readyTasks.empty() || m_tasksRemaining == 0u; });
+            if (m_readyTasks.empty())
+            {
+                return;
+            }
+
+            index = m_readyTasks.front();
+            m_readyTasks.pop_front();
+            function = &m_tasks[index].function;
+
+            // Once a task has failed, startup has failed, so there is no point running the rest.
+            skip = static_cast<bool>(m_exception);
+        }
+
+        // Run the task outside the lock, timing it and catching whatever it throws.
+        const auto start = std::chrono::steady_clock::now();
+        if (!skip)
+        {
+            try
+            {
+                (*function)();
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_exception)
+                {
+                    m_exception = std::current_exception();
+                }
+            }
+        }
+
+        FinishTask(index, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+}
+
+
+void StartupSchedulerClass::FinishTask(UINT index, double seconds)
+{
+    bool finished = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks[index].seconds = seconds;
+
+        // Release every task that was only waiting on this one.
+        for (UINT dependent : m_tasks[index].dependents)
+        {
+            if (--m_tasks[dependent].remainingDependencies == 0u)
+            {
+                m_readyTasks.push_back(dependent);
+            }
+        }
+
+        finished = (--m_tasksRemaining == 0u);
+        if (finished)
+        {
+            m_elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_startTime).count();
+        }
+    }
+
+    // Wake the threads for the tasks we released, and anyone waiting if that was the last one.
+    m_taskReady.notify_all();
+    if (finished)
+    {
+        m_tasksDone.notify_all();
+    }
+}
@@ -0,0 +1,69 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: startupschedulerclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <deque>
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: StartupSchedulerClass
+////////////////////////////////////////////////////////////////////////////////
+class StartupSchedulerClass
+{
+public:
+    using TaskType = std::function<void()>;
+
+private:
+    struct TaskEntryType
+    {
+        std::string       name                  = "";
+        TaskType          function              = nullptr;
+        std::vector<UINT> dependents            = {};
+        UINT              remainingDependencies = 0u;
+        double            seconds               = 0.0;
+    };
+
+public:
+    StartupSchedulerClass() = delete;
+    StartupSchedulerClass(const StartupSchedulerClass &) = delete;
+    StartupSchedulerClass & operator=(const StartupSchedulerClass &) = delete;
+
+    StartupSchedulerClass(UINT);
+    ~StartupSchedulerClass();
+
+    UINT AddTask(const std::string &, TaskType, const std::vector<UINT> & = {});
+    void Start();
+
+    bool IsComplete();
+    void Wait();
+
+    double GetElapsedSeconds();
+    double GetTaskSeconds(UINT);
+
+private:
+    void WorkerLoop();
+    void FinishTask(UINT, double);
+
+private:
+    const UINT m_threadCount = 0u;
+
+    std::vector<std::thread> m_threads = {};
+
+    std::mutex              m_mutex     = {};
+    std::condition_variable m_taskReady = {};
+    std::condition_variable m_tasksDone = {};
+
+    std::vector<TaskEntryType> m_tasks          = {};
+    std::deque<UINT>           m_readyTasks     = {};
+    UINT                       m_tasksRemaining = 0u;
+    bool                       m_started        = false;
+    std::exception_ptr         m_exception      = nullptr;
+
+    std::chrono::steady_clock::time_point m_startTime      = {};
+    double                                m_elapsedSeconds = 0.0;
+};
@@ -0,0 +1,307 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: tlsfallocatorclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "tlsfallocatorclass.h"
+
+
+TlsfAllocatorClass::TlsfAllocatorClass(UINT64 size, UINT64 granularity)
+    : m_size(size & ~(granularity - 1ull))
+    , m_granularity(granularity)
+{
+    // Offsets are aligned by masking, so the granularity has to be a power of two.
+    THROW_IF_TRUE(
+        granularity == 0ull || (granularity & (granularity - 1ull)) != 0ull,
+        "The allocator granularity must be a power of two."
+    );
+    THROW_IF_TRUE(
+        m_size == 0ull,
+        "The allocator needs room for at least one allocation."
+    );
+
+    for (std::array<UINT, SECOND_LEVEL_COUNT> &freeLists : m_freeLists)
+    {
+        for (UINT &head : freeLists)
+        {
+            head = NO_BLOCK;
+        }
+    }
+
+    // The whole range starts out as a single free block.
+    InsertFreeBlock(AddBlock(0ull, m_size));
+}
+
+
+UINT64 TlsfAllocatorClass::Allocate(UINT64 size, UINT64 alignment)
+{
+    // Everything is handed out in whole units of the granularity, so every block stays aligned to
+    // it.  A larger alignment may need some of the block before the allocation as padding.
+    size      = size ? (size + m_granularity - 1ull) & ~(m_granularity - 1ull) : m_granularity;
+    alignment = alignment > m_granularity ? alignment : m_granularity;
+
+    UINT block = FindFreeBlock(size + alignment - m_granularity);
+    if (block == NO_BLOCK)
+    {
+        return INVALID_OFFSET;
+    }
+    RemoveFreeBlock(block);
+
+    // Give the padding back as a free block of its own.
+    const UINT64 offset  = m_blocks[block].offset;
+    const UINT64 aligned = (offset + alignment - 1ull) & ~(alignment - 1ull);
+    if (aligned != offset)
+    {
+        SplitBlock(block, aligned - offset);
+        InsertFreeBlock(block);
+        block = m_blocks[block].nextPhysical;
+    }
+
+    // Likewise with whatever is left over past the end of the allocation.
+    if (m_blocks[block].size > size)
+    {
+        SplitBlock(block, size);
+        InsertFreeBlock(m_blocks[block].nextPhysical);
+    }
+
+    m_usedBytes += size;
+    m_allocations.emplace(aligned, block);
+    return aligned;
+}
+
+
+void TlsfAllocatorClass::Free(UINT64 offset)
+{
+    auto found = m_allocations.find(offset);
+    THROW_IF_TRUE(
+        found == m_allocations.end(),
+        "The offset freed was never allocated."
+    );
+    UINT block = found->second;
+    m_allocations.erase(found);
+    m_usedBytes -= m_blocks[block].size;
+
+    // Merge the block with its free neighbours, so free memory is never split into more pieces
+    // than it has to be.
+    const UINT next = m_blocks[block].nextPhysical;
+    if (next != NO_BLOCK && m_blocks[next].free)
+    {
+        RemoveFreeBlock(next);
+        MergeBlocks(block, next);
+    }
+
+    const UINT prev = m_blocks[block].prevPhysical;
+    if (prev != NO_BLOCK && m_blocks[prev].free)
+    {
+        RemoveFreeBlock(prev);
+        MergeBlocks(prev, block);
+        block = prev;
+    }
+
+    InsertFreeBlock(block);
+}
+
+
+bool TlsfAllocatorClass::IsEmpty()
+{
+    return m_allocations.empty();
+}
+
+
+TlsfAllocatorClass::StatisticsType TlsfAllocatorClass::GetStatistics()
+{
+    StatisticsType statistics;
+    statistics.size            = m_size;
+    statistics.usedBytes       = m_usedBytes;
+    statistics.allocationCount = static_cast<UINT>(m_allocations.size());
+
+    // The block at the start of the range never merges into another, so it starts the walk
+    // through every block in memory order.
+    for (UINT block = 0u; block != NO_BLOCK; block = m_blocks[block].nextPhysical)
+    {
+        if (m_blocks[block].free)
+        {
+            ++statistics.freeBlockCount;
+            statistics.largestFreeBlock = m_blocks[block].size > statistics.largestFreeBlock ? m_blocks[block].size : statistics.largestFreeBlock;
+        }
+    }
+    return statistics;
+}
+
+
+double TlsfAllocatorClass::GetFragmentation()
+{
+    // How much of the free memory is out of reach of the largest allocation that could still be
+    // made.  No free memory, or all of it in one block, is no fragmentation at all.
+    const UINT64 freeBytes = m_size - m_usedBytes;
+    if (freeBytes == 0ull)
+    {
+        return 0.0;
+    }
+    return 1.0 - static_cast<double>(GetStatistics().largestFreeBlock) / static_cast<double>(freeBytes);
+}
+
+
+void TlsfAllocatorClass::GetIndices(UINT64 size, UINT &firstLevel, UINT &secondLevel)
+{
+    if (size < SECOND_LEVEL_COUNT)
+    {
+        firstLevel  = 0u;
+        secondLevel = static_cast<UINT>(size);
+        return;
+    }
+
+    // The highest bit picks the power of two, and the bits right below it pick the list.
+    unsigned long highestBit = 0ul;
+    _BitScanReverse64(&highestBit, size);
+    firstLevel  = static_cast<UINT>(highestBit) - SECOND_LEVEL_BITS + 1u;
+    secondLevel = static_cast<UINT>(size >> (highestBit - SECOND_LEVEL_BITS)) - SECOND_LEVEL_COUNT;
+}
+
+
+UINT TlsfAllocatorClass::FindFreeBlock(UINT64 size)
+{
+    // Round the size up to the next list, where every block is large enough, so the first block
+    // found always fits and no list has to be searched.
+    if (size >= SECOND_LEVEL_COUNT)
+    {
+        unsigned long highestBit = 0ul;
+        _BitScanReverse64(&highestBit, size);
+        const UINT64 rounding = (1ull << (highestBit - SECOND_LEVEL_BITS)) - 1ull;
+        if (size > ~0ull - rounding)
+        {
+            return NO_BLOCK;
+        }
+        size += rounding;
+    }
+
+    UINT firstLevel  = 0u;
+    UINT secondLevel = 0u;
+    GetIndices(size, firstLevel, secondLevel);
+
+    // Look for a list in the same power of two first, then for the smallest larger one.
+    UINT32 secondLevelMap = m_secondLevelMaps[firstLevel] & (~0u << secondLevel);
+    if (!secondLevelMap)
+    {
+        const UINT64 firstLevelMap = firstLevel + 1u < FIRST_LEVEL_COUNT ? m_firstLevelMap & (~0ull << (firstLevel + 1u)) : 0ull;
+        if (!firstLevelMap)
+        {
+            return NO_BLOCK;
+        }
+
+        unsigned long lowestBit = 0ul;
+        _BitScanForward64(&lowestBit, firstLevelMap);
+        firstLevel     = static_cast<UINT>(lowestBit);
+        secondLevelMap = m_secondLevelMaps[firstLevel];
+    }
+
+    unsigned long lowestBit = 0ul;
+    _BitScanForward(&lowestBit, secondLevelMap);
+    return m_freeLists[firstLevel][lowestBit];
+}
+
+
+UINT TlsfAllocatorClass::AddBlock(UINT64 offset, UINT64 size)
+{
+    // Use a block left over from a merge if there is one.
+    UINT block = 0u;
+    if (m_unusedBlocks.empty())
+    {
+        block = static_cast<UINT>(m_blocks.size());
+        m_blocks.emplace_back();
+    }
+    else
+    {
+        block = m_unusedBlocks.back();
+        m_unusedBlocks.pop_back();
+        m_blocks[block] = BlockType();
+    }
+
+    m_blocks[block].offset = offset;
+    m_blocks[block].size   = size;
+    return block;
+}
+
+
+void TlsfAllocatorClass::SplitBlock(UINT block, UINT64 size)
+{
+    // Cut the block after `size` bytes, and link the rest in right behind it.
+    const UINT rest = AddBlock(m_blocks[block].offset + size, m_blocks[block].size - size);
+    m_blocks[block].size = size;
+
+    m_blocks[rest].prevPhysical = block;
+    m_blocks[rest].nextPhysical = m_blocks[block].nextPhysical;
+    if (m_blocks[rest].nextPhysical != NO_BLOCK)
+    {
+        m_blocks[m_blocks[rest].nextPhysical].prevPhysical = rest;
+    }
+    m_blocks[block].nextPhysical = rest;
+}
+
+
+void TlsfAllocatorClass::MergeBlocks(UINT first, UINT second)
+{
+    // Grow the first block over the second, which follows it in memory.
+    m_blocks[first].size         += m_blocks[second].size;
+    m_blocks[first].nextPhysical  = m_blocks[second].nextPhysical;
+    if (m_blocks[first].nextPhysical != NO_BLOCK)
+    {
+        m_blocks[m_blocks[first].nextPhysical].prevPhysical = first;
+    }
+    m_unusedBlocks.push_back(second);
+}
+
+
+void TlsfAllocatorClass::InsertFreeBlock(UINT block)
+{
+    UINT firstLevel  = 0u;
+    UINT secondLevel = 0u;
+    GetIndices(m_blocks[block].size, firstLevel, secondLevel);
+
+    // Push the block onto the front of its list, and mark the list as holding a free block.
+    UINT &head = m_freeLists[firstLevel][secondLevel];
+    m_blocks[block].free     = true;
+    m_blocks[block].prevFree = NO_BLOCK;
+    m_blocks[block].nextFree = head;
+    if (head != NO_BLOCK)
+    {
+        m_blocks[head].prevFree = block;
+    }
+    head = block;
+
+    m_secondLevelMaps[firstLevel] |= 1u << secondLevel;
+    m_firstLevelMap               |= 1ull << firstLevel;
+}
+
+
+void TlsfAllocatorClass::RemoveFreeBlock(UINT block)
+{
+    UINT firstLevel  = 0u;
+    UINT secondLevel = 0u;
+    GetIndices(m_blocks[block].size, firstLevel, secondLevel);
+
+    // Unlink the block from its list, and clear the list's bits once it runs empty.
+    const UINT prev = m_blocks[block].prevFree;
+    const UINT next = m_blocks[block].nextFree;
+    if (prev != NO_BLOCK)
+    {
+        m_blocks[prev].nextFree = next;
+    }
+    else
+    {
+        m_freeLists[firstLevel][secondLevel] = next;
+    }
+    if (next != NO_BLOCK)
+    {
+        m_blocks[next].prevFree = prev;
+    }
+    m_blocks[block].free = false;
+
+    if (m_freeLists[firstLevel][secondLevel] == NO_BLOCK)
+    {
+        m_secondLevelMaps[firstLevel] &= ~(1u << secondLevel);
+        if (!m_secondLevelMaps[firstLevel])
+        {
+            m_firstLevelMap &= ~(1ull << firstLevel);
+        }
+    }
+}
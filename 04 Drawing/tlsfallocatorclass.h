@@ -0,0 +1,96 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: tlsfallocatorclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <intrin.h>
+#include <unordered_map>
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: TlsfAllocatorClass
+////////////////////////////////////////////////////////////////////////////////
+class TlsfAllocatorClass
+{
+public:
+    struct StatisticsType
+    {
+        UINT64 size             = 0ull;
+        UINT64 usedBytes        = 0ull;
+        UINT64 largestFreeBlock = 0ull;
+        UINT   allocationCount  = 0u;
+        UINT   freeBlockCount   = 0u;
+    };
+
+    // Returned when no free block is large enough.
+    static constexpr UINT64 INVALID_OFFSET = ~0ull;
+
+private:
+    struct BlockType
+    {
+        UINT64 offset       = 0ull;
+        UINT64 size         = 0ull;
+        UINT   prevPhysical = NO_BLOCK;
+        UINT   nextPhysical = NO_BLOCK;
+        UINT   prevFree     = NO_BLOCK;
+        UINT   nextFree     = NO_BLOCK;
+        bool   free         = false;
+    };
+
+public:
+    TlsfAllocatorClass() = delete;
+    TlsfAllocatorClass(const TlsfAllocatorClass &) = delete;
+    TlsfAllocatorClass & operator=(const TlsfAllocatorClass &) = delete;
+
+    TlsfAllocatorClass(UINT64, UINT64 = 1ull);
+    ~TlsfAllocatorClass() = default;
+
+    UINT64 Allocate(UINT64, UINT64 = 1ull);
+    void Free(UINT64);
+
+    bool IsEmpty();
+    StatisticsType GetStatistics();
+    double GetFragmentation();
+
+private:
+    static void GetIndices(UINT64, UINT &, UINT &);
+    UINT FindFreeBlock(UINT64);
+
+    UINT AddBlock(UINT64, UINT64);
+    void SplitBlock(UINT, UINT64);
+    void MergeBlocks(UINT, UINT);
+    void InsertFreeBlock(UINT);
+    void RemoveFreeBlock(UINT);
+
+private:
+    // Marks the end of a list of blocks.
+    static constexpr UINT NO_BLOCK = ~0u;
+
+    // Free blocks are kept in lists by size.  The first level splits sizes by powers of two, and
+    // the second level splits every power of two into sixteen lists.  Sizes below sixteen all fall
+    // into the first list of the first level, one list per size.
+    static constexpr UINT SECOND_LEVEL_BITS  = 4u;
+    static constexpr UINT SECOND_LEVEL_COUNT = 1u << SECOND_LEVEL_BITS;
+    static constexpr UINT FIRST_LEVEL_COUNT  = 64u - SECOND_LEVEL_BITS + 1u;
+
+    const UINT64 m_size        = 0ull;
+    const UINT64 m_granularity = 0ull;
+    UINT64       m_usedBytes   = 0ull;
+
+    // Every block in the range, free or not, is linked to its neighbours in memory.  Blocks that
+    // merged into another are left in the pool to be used again.
+    std::vector<BlockType> m_blocks       = {};
+    std::vector<UINT>      m_unusedBlocks = {};
+
+    // One bit per list that holds a free block, so finding a large enough block is two bit scans.
+    UINT64                                                              m_firstLevelMap   = 0ull;
+    std::array<UINT32, FIRST_LEVEL_COUNT>                               m_secondLevelMaps = {};
+    std::array<std::array<UINT, SECOND_LEVEL_COUNT>, FIRST_LEVEL_COUNT> m_freeLists       = {};
+
+    // The block at the start of every allocation handed out.
+    std::unordered_map<UINT64, UINT> m_allocations = {};
+};
@@ -1,38 +1,28 @@
-////////////////////////////////////////////////////////////////////////////////
-// Filename: triangleclass.h
-////////////////////////////////////////////////////////////////////////////////
-#pragma once
-
-
-//////////////
-// INCLUDES //
-//////////////
-#include "geometryinterface.h"
-
-
-////////////////////////////////////////////////////////////////////////////////
-// Class name: TriangleClass
-////////////////////////////////////////////////////////////////////////////////
-class TriangleClass : public GeometryInterface
-{
-private:
-    struct VertexType
-    {
-        XMFLOAT3 position = {};
-        XMFLOAT4 color    = {};
-    };
-
-public:
-    TriangleClass() = delete;
-    TriangleClass(const TriangleClass &) = delete;
-    TriangleClass & operator=(const TriangleClass &) = delete;
-
-    TriangleClass(ID3D12Device *);
-    ~TriangleClass() = default;
-
-    void Render(ID3D12GraphicsCommandList *) override;
-
-private:
-    BufferType m_vertexBuffer = {};
-    BufferType m_indexBuffer  = {};
-};
+////////////////////////////////////////////////////////////////////////////////
+// Filename: triangleclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include "geometryinterface.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: TriangleClass
+////////////////////////////////////////////////////////////////////////////////
+class TriangleClass : public GeometryInterface
+{
+public:
+    TriangleClass() = delete;
+    TriangleClass(const TriangleClass &) = delete;
+    TriangleClass & operator=(const TriangleClass &) = delete;
+
+    TriangleClass(GeometryPoolClass *);
+    ~TriangleClass() = default;
+
+    bool IsResident() override;
+    void Render(PipelineClass *) override;
+};
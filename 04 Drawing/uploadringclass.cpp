@@ -0,0 +1,297 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: uploadringclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "uploadringclass.h"
+
+
+UploadRingClass::UploadRingClass(GpuAllocatorClass *allocator, UINT64 capacity)
+    : p_device(allocator->GetDevice())
+    , p_allocator(allocator)
+    , m_capacity(capacity)
+{
+    // The ring lives in a single upload heap that the CPU can write to.
+    m_buffer = allocator->CreateBuffer(
+        GpuAllocatorClass::CategoryType::Uploads,
+        D3D12_HEAP_TYPE_UPLOAD,
+        m_capacity,
+        D3D12_RESOURCE_FLAG_NONE,
+        D3D12_RESOURCE_STATE_GENERIC_READ,
+        L"URC upload ring"
+    );
+
+    // Map the ring once and leave it mapped for its whole life; upload heaps allow this.
+    D3D12_RANGE readRange{};
+    THROW_IF_FAILED(
+        m_buffer->Map(0, &readRange, reinterpret_cast<void**>(&m_mappedData)),
+        "Unable to map the upload ring."
+    );
+
+    // Fill out a description for the queue all of our copies go through.  A dedicated copy queue
+    // runs alongside the direct queue, so uploads do not hold up rendering.
+    D3D12_COMMAND_QUEUE_DESC queueDesc{};
+    queueDesc.Type     = D3D12_COMMAND_LIST_TYPE_COPY;
+    queueDesc.Priority = D3D12_COMMAND_QUEUE_PRIORITY_NORMAL;
+    queueDesc.Flags    = D3D12_COMMAND_QUEUE_FLAG_NONE;
+    queueDesc.NodeMask = 0;
+
+    THROW_IF_FAILED(
+        p_device->CreateCommandQueue(
+            &queueDesc,
+            IID_PPV_ARGS(m_commandQueue.ReleaseAndGetAddressOf())),
+        "Unable to create the upload command queue on the device."
+    );
+
+    // Create the first allocator, and the one command list that every batch of copies is recorded into.
+    THROW_IF_FAILED(
+        p_device->CreateCommandAllocator(
+            D3D12_COMMAND_LIST_TYPE_COPY,
+            IID_PPV_ARGS(m_allocator.ReleaseAndGetAddressOf())),
+        "Unable to create the upload command allocator on the device."
+    );
+
+    THROW_IF_FAILED(
+        p_device->CreateCommandList(
+            0,
+            D3D12_COMMAND_LIST_TYPE_COPY,
+            m_allocator.Get(),
+            nullptr,
+            IID_PPV_ARGS(m_commandList.ReleaseAndGetAddressOf())),
+        "Unable to create the upload command list on the device."
+    );
+    m_listOpen = true;
+
+    // Create the fence that tells us which parts of the ring the GPU is done with.
+    THROW_IF_FAILED(
+        p_device->CreateFence(
+            0,
+            D3D12_FENCE_FLAG_NONE,
+            IID_PPV_ARGS(m_fence.ReleaseAndGetAddressOf())),
+        "Unable to create the upload fence on the device."
+    );
+
+    m_fenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    THROW_IF_TRUE(
+        m_fenceEvent == NULL,
+        "Unable to create system event for synchronization."
+    );
+
+    // Buffers we copy into may be released before the copies finish, so the allocator has to
+    // wait for our fence before handing their memory out again.
+    p_allocator->AddCopyQueue(m_fence.Get(), m_uploadedValue);
+
+    NameD3DResources();
+}
+
+
+UploadRingClass::~UploadRingClass()
+{
+    // Make sure the GPU is done reading from the ring before it is released.  Copies recorded but
+    // never flushed will not run at all, so nothing is left for the allocator to wait for.
+    if (m_fence)
+    {
+        WaitForFenceValue(m_fenceValue);
+        p_allocator->RemoveCopyQueue(m_fence.Get());
+    }
+
+    if (m_fenceEvent)
+    {
+        CloseHandle(m_fenceEvent);
+    }
+}
+
+
+UINT64 UploadRingClass::Upload(ID3D12Resource *destination, const BYTE *data, UINT64 dataSize, UINT64 destinationOffset)
+{
+    // Claim space in the ring and copy the data into it.
+    const UINT64 offset = Allocate(dataSize);
+    memcpy(m_mappedData + offset, data, static_cast<size_t>(dataSize));
+
+    // Record the copy from the ring into the destination resource, at the offset asked for.
+    OpenCommandList();
+    m_commandList->CopyBufferRegion(destination, destinationOffset, m_buffer.Get(), offset, dataSize);
+
+    // The copy is done once the fence reaches the value the next flush will signal.
+    m_uploadedValue = m_fenceValue + 1ull;
+    return m_uploadedValue;
+}
+
+
+bool UploadRingClass::IsComplete(UINT64 fenceValue)
+{
+    return m_fence->GetCompletedValue() >= fenceValue;
+}
+
+
+UINT64 UploadRingClass::Flush()
+{
+    // Nothing to do if no copies were recorded since the last flush.
+    if (!m_listOpen || m_pendingSize == 0ull)
+    {
+        return m_fenceValue;
+    }
+
+    // Close the list.  The copy queue cannot transition buffers into the states we draw with, but
+    // it does not need to: buffers decay back to the common state once the copies finish, and are
+    // promoted implicitly on their first use on the direct queue.
+    THROW_IF_FAILED(
+        m_commandList->Close(),
+        "Unable to close the upload command list."
+    );
+    m_listOpen = false;
+
+    // Queue the list, starting the execution.
+    ID3D12CommandList *ppCommandLists[] = { m_commandList.Get() };
+    m_commandQueue->ExecuteCommandLists(1, ppCommandLists);
+
+    // Tell the command queue what value to signal once this batch of copies is done.
+    THROW_IF_FAILED(
+        m_commandQueue->Signal(m_fence.Get(), ++m_fenceValue),
+        "Unable to signal to the upload fence."
+    );
+
+    // Remember which part of the ring and which allocator this batch holds on to.
+    SubmissionType submission;
+    submission.fenceValue = m_fenceValue;
+    submission.size       = m_pendingSize;
+    submission.allocator  = std::move(m_allocator);
+    m_submissions.push_back(std::move(submission));
+    m_pendingSize = 0ull;
+
+    return m_fenceValue;
+}
+
+
+void UploadRingClass::WaitForIdle()
+{
+    // Submit anything still pending, then block until all of it has finished.
+    WaitForFenceValue(Flush());
+    Retire();
+}
+
+
+UINT64 UploadRingClass::Allocate(UINT64 size)
+{
+    THROW_IF_TRUE(
+        size > m_capacity,
+        "The upload is larger than the whole upload ring."
+    );
+
+    while (true)
+    {
+        // Reclaim whatever the GPU has finished copying out of.
+        Retire();
+
+        // Try to fit the allocation after the head, or wrap around to the start of the ring and
+        // give up the space at the end.
+        UINT64 offset = (m_head + UPLOAD_ALIGNMENT - 1ull) & ~(UPLOAD_ALIGNMENT - 1ull);
+        UINT64 needed = offset - m_head + size;
+        if (offset + size > m_capacity)
+        {
+            offset = 0ull;
+            needed = m_capacity - m_head + size;
+        }
+
+        if (m_used + needed <= m_capacity)
+        {
+            m_head         = offset + size;
+            m_used        += needed;
+            m_pendingSize += needed;
+            return offset;
+        }
+
+        // The ring is full.  Push out our own pending copies if they are what is in the way,
+        // otherwise wait for the oldest batch to finish.
+        if (m_submissions.empty())
+        {
+            Flush();
+        }
+        THROW_IF_TRUE(
+            m_submissions.empty(),
+            "The upload ring is too small for this upload."
+        );
+        WaitForFenceValue(m_submissions.front().fenceValue);
+    }
+}
+
+
+void UploadRingClass::Retire()
+{
+    // Every batch the fence has passed gives its space and its allocator back.
+    const UINT64 completedValue = m_fence->GetCompletedValue();
+    while (!m_submissions.empty() && m_submissions.front().fenceValue <= completedValue)
+    {
+        m_used -= m_submissions.front().size;
+        m_freeAllocators.push_back(std::move(m_submissions.front().allocator));
+        m_submissions.pop_front();
+    }
+
+    // With nothing in flight, start the next allocation back at the beginning of the ring.
+    if (m_used == 0ull)
+    {
+        m_head = 0ull;
+    }
+}
+
+
+void UploadRingClass::WaitForFenceValue(UINT64 fenceValue)
+{
+    if (m_fence->GetCompletedValue() < fenceValue)
+    {
+        // Give our fence the event to use and the value to wait for.
+        THROW_IF_FAILED(
+            m_fence->SetEventOnCompletion(fenceValue, m_fenceEvent),
+            "Unable to set a fence event for synchronization."
+        );
+
+        // Wait for the copies to complete, with no timeout.
+        WaitForSingleObject(m_fenceEvent, INFINITE);
+    }
+}
+
+
+void UploadRingClass::OpenCommandList()
+{
+    if (m_listOpen)
+    {
+        return;
+    }
+
+    // Reuse an allocator the GPU is finished with, or make a new one if they are all busy.
+    if (!m_freeAllocators.empty())
+    {
+        m_allocator = std::move(m_freeAllocators.back());
+        m_freeAllocators.pop_back();
+
+        THROW_IF_FAILED(
+            m_allocator->Reset(),
+            "Unable to reset the upload command allocator."
+        );
+    }
+    else
+    {
+        THROW_IF_FAILED(
+            p_device->CreateCommandAllocator(
+                D3D12_COMMAND_LIST_TYPE_COPY,
+                IID_PPV_ARGS(m_allocator.ReleaseAndGetAddressOf())),
+            "Unable to create the upload command allocator on the device."
+        );
+    }
+
+    // Reset the list to start recording the next batch.
+    THROW_IF_FAILED(
+        m_commandList->Reset(m_allocator.Get(), nullptr),
+        "Unable to reset the upload command list."
+    );
+    m_listOpen = true;
+}
+
+
+void UploadRingClass::NameD3DResources()
+{
+    // Name all DirectX objects.
+    m_buffer->SetName(L"URC upload ring");
+    m_commandQueue->SetName(L"URC command queue");
+    m_commandList->SetName(L"URC command list");
+    m_fence->SetName(L"URC fence");
+}
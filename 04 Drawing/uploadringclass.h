@@ -0,0 +1,78 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: uploadringclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <deque>
+#include "gpuallocatorclass.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: UploadRingClass
+////////////////////////////////////////////////////////////////////////////////
+class UploadRingClass
+{
+private:
+    struct SubmissionType
+    {
+        UINT64                         fenceValue = 0ull;
+        UINT64                         size       = 0ull;
+        ComPtr<ID3D12CommandAllocator> allocator  = nullptr;
+    };
+
+public:
+    UploadRingClass() = delete;
+    UploadRingClass(const UploadRingClass &) = delete;
+    UploadRingClass & operator=(const UploadRingClass &) = delete;
+
+    UploadRingClass(GpuAllocatorClass *, UINT64 = 16ull * 1024ull * 1024ull);
+    ~UploadRingClass();
+
+    UINT64 Upload(ID3D12Resource *, const BYTE *, UINT64, UINT64 = 0ull);
+    bool IsComplete(UINT64);
+
+    UINT64 Flush();
+    void WaitForIdle();
+
+private:
+    UINT64 Allocate(UINT64);
+    void Retire();
+    void WaitForFenceValue(UINT64);
+    void OpenCommandList();
+
+    void NameD3DResources();
+
+private:
+    // Copies out of the ring start on this boundary.
+    static constexpr UINT64 UPLOAD_ALIGNMENT = 16ull;
+
+    ID3D12Device      *p_device    = nullptr;
+    GpuAllocatorClass *p_allocator = nullptr;
+
+    const UINT64 m_capacity    = 0ull;
+    UINT64       m_head        = 0ull;
+    UINT64       m_used        = 0ull;
+    UINT64       m_pendingSize = 0ull;
+    BYTE        *m_mappedData  = nullptr;
+
+    GpuAllocatorClass::AllocationType m_buffer       = {};
+    ComPtr<ID3D12CommandQueue>        m_commandQueue = nullptr;
+    ComPtr<ID3D12GraphicsCommandList> m_commandList  = nullptr;
+    bool                              m_listOpen     = false;
+
+    ComPtr<ID3D12CommandAllocator>              m_allocator      = nullptr;
+    std::vector<ComPtr<ID3D12CommandAllocator>> m_freeAllocators = {};
+    std::deque<SubmissionType>                  m_submissions    = {};
+
+    ComPtr<ID3D12Fence> m_fence      = nullptr;
+    UINT64              m_fenceValue = 0ull;
+    HANDLE              m_fenceEvent = nullptr;
+
+    // The value the fence reaches once every copy recorded so far is done, which memory the
+    // allocator is given back waits for.
+    UINT64 m_uploadedValue = 0ull;
+};
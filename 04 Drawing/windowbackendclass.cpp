@@ -0,0 +1,261 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: windowbackendclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "windowbackendclass.h"
+
+
+WindowBackendClass::WindowBackendClass(HWND hWnd,
+                                       UINT screenWidth,
+                                       UINT screenHeight,
+                                       bool fullscreen,
+                                       bool vsync,
+                                       UINT maximumFrameLatency)
+{
+    // Create the device on the default video card, then its queue, then the swap chain on top.
+    ComPtr<IDXGIFactory4> factory = CreateFactory();
+    InitializeDevice(nullptr);
+    InitializeCommandQueue();
+    InitializeSwapChain(factory.Get(), hWnd, screenWidth, screenHeight, fullscreen, vsync, maximumFrameLatency);
+    InitializeFenceEvent();
+
+    NameD3DResources();
+}
+
+
+WindowBackendClass::~WindowBackendClass()
+{
+    // Before shutting down, set to windowed mode or when you release the swap chain it will throw
+    // an exception.
+    if (m_swapChain)
+    {
+        m_swapChain->SetFullscreenState(false, nullptr);
+    }
+
+    // The waitable object belongs to us once we have asked the swap chain for it.
+    if (m_frameLatencyWaitableObject)
+    {
+        CloseHandle(m_frameLatencyWaitableObject);
+    }
+}
+
+
+ID3D12Resource * WindowBackendClass::GetBackBuffer(UINT index)
+{
+    // Get a pointer to the requested back buffer from the swap chain.
+    ComPtr<ID3D12Resource> backBuffer;
+    THROW_IF_FAILED(
+        m_swapChain->GetBuffer(
+            index,
+            IID_PPV_ARGS(backBuffer.GetAddressOf())),
+        "Unable to communicate with the swap chain."
+    );
+
+    // The swap chain keeps its own reference, so the caller is free to take another one.
+    return backBuffer.Get();
+}
+
+
+UINT WindowBackendClass::GetCurrentBackBufferIndex()
+{
+    return m_swapChain->GetCurrentBackBufferIndex();
+}
+
+
+bool WindowBackendClass::WaitForFrameLatency(DWORD timeout)
+{
+    // A successful wait takes one count from the waitable object, which lets exactly one frame
+    // through, so remember it until that frame is presented.
+    if (!m_frameLatencyWaited)
+    {
+        m_frameLatencyWaited = WaitForSingleObjectEx(m_frameLatencyWaitableObject, timeout, TRUE) == WAIT_OBJECT_0;
+    }
+    return m_frameLatencyWaited;
+}
+
+
+void WindowBackendClass::Present(bool vsync)
+{
+    // Without vsync, let the frame tear onto the screen instead of waiting for the next vertical
+    // blank, as long as we are in a window where tearing is allowed.
+    const UINT flags = !vsync && m_tearingSupported && m_windowed ? DXGI_PRESENT_ALLOW_TEARING : 0u;
+
+    // Present the back buffer to the screen since rendering is complete.
+    THROW_IF_FAILED(
+        m_swapChain->Present(vsync ? 1u : 0u, flags),
+        "Unable to present frame to the display."
+    );
+    m_frameLatencyWaited = false;
+}
+
+
+bool WindowBackendClass::CheckTearingSupport(IDXGIFactory4 *factory)
+{
+    // Tearing needs a newer factory, and a display and driver that allow variable refresh rates.
+    ComPtr<IDXGIFactory5> factory5;
+    BOOL allowTearing = FALSE;
+    if (SUCCEEDED(factory->QueryInterface(IID_PPV_ARGS(factory5.GetAddressOf()))))
+    {
+        if (FAILED(factory5->CheckFeatureSupport(DXGI_FEATURE_PRESENT_ALLOW_TEARING, &allowTearing, sizeof(allowTearing))))
+        {
+            allowTearing = FALSE;
+        }
+    }
+    return allowTearing == TRUE;
+}
+
+
+void WindowBackendClass::InitializeSwapChain(IDXGIFactory4 *factory,
+                                             HWND hWnd,
+                                             UINT screenWidth,
+                                             UINT screenHeight,
+                                             bool fullscreen,
+                                             bool vsync,
+                                             UINT maximumFrameLatency)
+{
+    // Use the factory to create an adapter for the primary graphics interface (video card).
+    ComPtr<IDXGIAdapter> adapter;
+    THROW_IF_FAILED(
+        factory->EnumAdapters(0, adapter.GetAddressOf()),
+        "Unable to enumerate adapters."
+    );
+
+    // Enumerate the primary adapter output (monitor).
+    ComPtr<IDXGIOutput> adapterOutput;
+    THROW_IF_FAILED(
+        adapter->EnumOutputs(0, adapterOutput.GetAddressOf()),
+        "Unable to communicate with graphics adapter."
+    );
+
+    // Initialize numModes to zero.
+    UINT numModes = 0u;
+
+    // Get the number of modes that fit the DXGI_FORMAT_R8G8B8A8_UNORM display format for the
+    // adapter output (monitor).
+    THROW_IF_FAILED(
+        adapterOutput->GetDisplayModeList(
+            DXGI_FORMAT_R8G8B8A8_UNORM,
+            DXGI_ENUM_MODES_INTERLACED,
+            &numModes,
+            nullptr),
+        "Unable to communicate with graphics adapter."
+    );
+
+    // Create a list to hold all the possible display modes for this monitor/video card combination.
+    DXGI_MODE_DESC* displayModeList = new DXGI_MODE_DESC[numModes];
+
+    // Now fill the display mode list structures.
+    THROW_IF_FAILED(
+        adapterOutput->GetDisplayModeList(
+            DXGI_FORMAT_R8G8B8A8_UNORM,
+            DXGI_ENUM_MODES_INTERLACED,
+            &numModes,
+            displayModeList),
+        "Unable to communicate with graphics adapter."
+    );
+
+    // Initialize numerator and denominator to 0.
+    UINT numerator = 0u, denominator = 0u;
+
+    // Now go through all the display modes and find the one that matches the screen height and
+    // width.  When a match is found store the numerator and denominator of the refresh rate for
+    // that monitor.
+    for (uint32_t i = 0u; i < numModes; ++i)
+    {
+        if (displayModeList[i].Height == screenHeight && displayModeList[i].Width == screenWidth)
+        {
+            numerator   = displayModeList[i].RefreshRate.Numerator;
+            denominator = displayModeList[i].RefreshRate.Denominator;
+        }
+    }
+
+    // Get the adapter (video card) description.
+    DXGI_ADAPTER_DESC adapterDesc;
+    THROW_IF_FAILED(
+        adapter->GetDesc(&adapterDesc),
+        "Unable to communicate with graphics adapter."
+    );
+
+    // Store the dedicated video card memory in megabytes.
+    m_videoCardMemory = adapterDesc.DedicatedVideoMemory;
+
+    // Release the display mode list.
+    delete[] displayModeList;
+    displayModeList = nullptr;
+
+    // Check whether we can let presents tear when vsync is off.
+    m_tearingSupported = CheckTearingSupport(factory);
+    m_windowed         = !fullscreen;
+
+    // Create a description for the swap chain.  It hands out a waitable object that tells us when
+    // to start a frame, and allows tearing if the system supports it.
+    DXGI_SWAP_CHAIN_DESC1 swapChainDesc{};
+    swapChainDesc.Width              = screenWidth;
+    swapChainDesc.Height             = screenHeight;
+    swapChainDesc.Format             = DXGI_FORMAT_R8G8B8A8_UNORM;
+    swapChainDesc.Stereo             = FALSE;
+    swapChainDesc.SampleDesc.Count   = 1u;
+    swapChainDesc.SampleDesc.Quality = 0u;
+    swapChainDesc.BufferUsage        = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+    swapChainDesc.BufferCount        = FRAME_BUFFER_COUNT;
+    swapChainDesc.Scaling            = DXGI_SCALING_STRETCH;
+    swapChainDesc.SwapEffect         = DXGI_SWAP_EFFECT_FLIP_DISCARD;
+    swapChainDesc.AlphaMode          = DXGI_ALPHA_MODE_UNSPECIFIED;
+    swapChainDesc.Flags              = DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT;
+    if (m_tearingSupported)
+    {
+        swapChainDesc.Flags |= DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING;
+    }
+
+    // Describe the fullscreen mode, using the refresh rate we found when vsync is on.
+    DXGI_SWAP_CHAIN_FULLSCREEN_DESC fullscreenDesc{};
+    fullscreenDesc.ScanlineOrdering = DXGI_MODE_SCANLINE_ORDER_UNSPECIFIED;
+    fullscreenDesc.Scaling          = DXGI_MODE_SCALING_UNSPECIFIED;
+    fullscreenDesc.Windowed         = !fullscreen;
+    if (vsync)
+    {
+        fullscreenDesc.RefreshRate.Numerator   = numerator;
+        fullscreenDesc.RefreshRate.Denominator = denominator;
+    }
+    else
+    {
+        fullscreenDesc.RefreshRate.Numerator   = 0u;
+        fullscreenDesc.RefreshRate.Denominator = 1u;
+    }
+
+    // Create the swap chain using the swap chain description.
+    ComPtr<IDXGISwapChain1> swapChain;
+    THROW_IF_FAILED(
+        factory->CreateSwapChainForHwnd(
+            m_commandQueue.Get(),
+            hWnd,
+            &swapChainDesc,
+            &fullscreenDesc,
+            nullptr,
+            swapChain.GetAddressOf()),
+        "Unable to create the swap chain on the graphics device."
+    );
+
+    // Upgrade the swap chain to a IDXGISwapChain3 interface and store it in the private member
+    // variable m_swapChain.  This will allow us to use the function GetCurrentBackBufferIndex().
+    THROW_IF_FAILED(
+        swapChain.As(&m_swapChain),
+        "This graphics device does not support the 'IDXGISwapChain3' Interface."
+    );
+
+    // Finally, limit how many frames can queue up behind the display.  Every queued frame is
+    // another frame of delay between the input it was built from and the screen.
+    THROW_IF_FAILED(
+        m_swapChain->SetMaximumFrameLatency(maximumFrameLatency),
+        "Unable to set the maximum frame latency of the swap chain."
+    );
+    m_frameLatencyWaitableObject = m_swapChain->GetFrameLatencyWaitableObject();
+}
+
+
+void WindowBackendClass::NameD3DResources()
+{
+    // Name all DirectX objects.
+    m_device->SetName(L"WBC device");
+    m_commandQueue->SetName(L"WBC command queue");
+}
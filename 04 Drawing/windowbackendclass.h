@@ -0,0 +1,49 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: windowbackendclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include "backendinterface.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: WindowBackendClass
+////////////////////////////////////////////////////////////////////////////////
+class WindowBackendClass : public BackendInterface
+{
+public:
+    WindowBackendClass() = delete;
+    WindowBackendClass(const WindowBackendClass &) = delete;
+    WindowBackendClass & operator=(const WindowBackendClass &) = delete;
+
+    WindowBackendClass(HWND, UINT, UINT, bool, bool, UINT);
+    ~WindowBackendClass();
+
+    ID3D12Resource * GetBackBuffer(UINT) override;
+    UINT GetCurrentBackBufferIndex() override;
+
+    bool WaitForFrameLatency(DWORD) override;
+    void Present(bool) override;
+
+private:
+    bool CheckTearingSupport(IDXGIFactory4 *);
+    void InitializeSwapChain(IDXGIFactory4 *, HWND, UINT, UINT, bool, bool, UINT);
+
+    void NameD3DResources() override;
+
+private:
+    ComPtr<IDXGISwapChain3> m_swapChain = nullptr;
+
+    // Signaled by the swap chain whenever it can take another frame without exceeding its maximum
+    // frame latency.
+    HANDLE m_frameLatencyWaitableObject = nullptr;
+    bool   m_frameLatencyWaited         = false;
+
+    // Tearing lets an unsynchronized present reach the screen right away, but only in a window.
+    bool m_tearingSupported = false;
+    bool m_windowed         = true;
+};
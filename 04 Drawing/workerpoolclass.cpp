@@ -0,0 +1,145 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: workerpoolclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pch.h"
+#include "workerpoolclass.h"
+
+
+WorkerPoolClass::WorkerPoolClass(UINT workerCount)
+{
+    // The thread calling Dispatch also runs jobs, so we only need to spawn the remaining workers.
+    for (UINT i = 1u; i < workerCount; ++i)
+    {
+        m_workers.emplace_back(&WorkerPoolClass::WorkerLoop, this);
+    }
+}
+
+
+WorkerPoolClass::~WorkerPoolClass()
+{
+    // Wake every worker and tell them to leave their loops.
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shutdown = true;
+    }
+    m_workReady.notify_all();
+
+    // Wait for them all to exit before the pool goes away.
+    for (std::thread &worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+
+UINT WorkerPoolClass::GetWorkerCount()
+{
+    return static_cast<UINT>(m_workers.size()) + 1u;
+}
+
+
+void WorkerPoolClass::Dispatch(UINT jobCount, const JobType &job)
+{
+    if (jobCount == 0u)
+    {
+        return;
+    }
+
+    // Publish the new batch of jobs to the workers.
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job           = &job;
+        m_jobCount      = jobCount;
+        m_jobsRemaining = jobCount;
+        m_exception     = nullptr;
+        m_nextJob.store(0u);
+        ++m_generation;
+    }
+    m_workReady.notify_all();
+
+    // Help out with the jobs instead of sitting idle.
+    RunJobs(&job, jobCount);
+
+    // Wait until every job has finished and every worker has let go of the batch, since the job
+    // only lives as long as this call.
+    std::exception_ptr exception;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_workDone.wait(lock, [this] { return m_jobsRemaining == 0u && m_activeWorkers == 0u; });
+        m_job     = nullptr;
+        exception = m_exception;
+    }
+
+    // Surface the first failure on the calling thread, just like a serial loop would.
+    if (exception)
+    {
+        std::rethrow_exception(exception);
+    }
+}
+
+
+void WorkerPoolClass::WorkerLoop()
+{
+    uint64_t generation = 0ull;
+    while (true)
+    {
+        // Sleep until a new batch is published or the pool is shutting down.
+        const JobType *job      = nullptr;
+        UINT           jobCount = 0u;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_workReady.wait(lock, [&] { return m_shutdown || (m_job && m_generation != generation); });
+            if (m_shutdown)
+            {
+                return;
+            }
+
+            generation = m_generation;
+            job        = m_job;
+            jobCount   = m_jobCount;
+            ++m_activeWorkers;
+        }
+
+        RunJobs(job, jobCount);
+
+        // Let Dispatch know we are no longer touching this batch.
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_activeWorkers;
+        }
+        m_workDone.notify_all();
+    }
+}
+
+
+void WorkerPoolClass::RunJobs(const JobType *job, UINT jobCount)
+{
+    // Keep claiming job indices until the batch is exhausted.
+    for (UINT index = m_nextJob.fetch_add(1u); index < jobCount; index = m_nextJob.fetch_add(1u))
+    {
+        try
+        {
+            (*job)(index);
+        }
+        catch (...)
+        {
+            // Only keep the first failure; it will be rethrown by Dispatch.
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_exception)
+            {
+                m_exception = std::current_exception();
+            }
+        }
+
+        // Count the job as finished and wake Dispatch if it was the last one.
+        bool finished = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            finished = (--m_jobsRemaining == 0u);
+        }
+        if (finished)
+        {
+            m_workDone.notify_all();
+        }
+    }
+}
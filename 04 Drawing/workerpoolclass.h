@@ -0,0 +1,46 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: workerpoolclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: WorkerPoolClass
+////////////////////////////////////////////////////////////////////////////////
+class WorkerPoolClass
+{
+public:
+    using JobType = std::function<void(UINT)>;
+
+public:
+    WorkerPoolClass() = delete;
+    WorkerPoolClass(const WorkerPoolClass &) = delete;
+    WorkerPoolClass & operator=(const WorkerPoolClass &) = delete;
+
+    WorkerPoolClass(UINT);
+    ~WorkerPoolClass();
+
+    UINT GetWorkerCount();
+
+    void Dispatch(UINT, const JobType &);
+
+private:
+    void WorkerLoop();
+    void RunJobs(const JobType *, UINT);
+
+private:
+    std::vector<std::thread> m_workers = {};
+
+    std::mutex              m_mutex     = {};
+    std::condition_variable m_workReady = {};
+    std::condition_variable m_workDone  = {};
+
+    const JobType      *m_job           = nullptr;
+    UINT                m_jobCount      = 0u;
+    std::atomic<UINT>   m_nextJob       = { 0u };
+    UINT                m_jobsRemaining = 0u;
+    UINT                m_activeWorkers = 0u;
+    uint64_t            m_generation    = 0ull;
+    bool                m_shutdown      = false;
+    std::exception_ptr  m_exception     = nullptr;
+};